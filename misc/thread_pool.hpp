@@ -0,0 +1,167 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "config_macros.hpp"
+
+namespace misc {
+
+/**
+ * @brief Worker threads shared by the whole program (see thread_pool::instance()).
+ *         Workers are started on demand, at most tasks - 1 ones for the run(tasks, func)
+ *         with the biggest tasks, and wait for the new tasks until the pool is destroyed,
+ *         so the parallel loops do not create the threads on every call.
+ */
+class thread_pool final {
+public:
+    thread_pool() = default;
+    thread_pool(const thread_pool&) = delete;
+    thread_pool(thread_pool&&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    thread_pool& operator=(thread_pool&&) = delete;
+
+    ~thread_pool() {
+        {
+            const std::lock_guard lock{mutex_};
+            stop_ = true;
+        }
+        new_job_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    [[nodiscard]] static thread_pool& instance() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    /// @brief Calls func(i) for all i in [0, tasks) and waits until all calls are finished.
+    ///         Calls are taken by the current thread and the idle workers, so the calls that
+    ///         no worker has taken (e.g. if the new thread can not be created) are done by
+    ///         the current thread, and func may call run() itself.
+    ///         First exception thrown by func is rethrown after all calls are finished.
+    template <class Function>
+    void run(const std::size_t tasks, const Function& func) {
+        if (tasks <= 1) {
+            if (tasks == 1) {
+                func(std::size_t{0});
+            }
+            return;
+        }
+
+        Job job{
+            static_cast<const void*>(&func),
+            [](const void* const f, const std::size_t i) { (*static_cast<const Function*>(f))(i); },
+            tasks,
+        };
+
+        std::unique_lock lock{mutex_};
+        start_workers(tasks - 1);
+        jobs_.push_back(&job);
+        lock.unlock();
+        new_job_.notify_all();
+
+        lock.lock();
+        while (job.next_task < tasks) {
+            execute_next_task(job, lock);
+        }
+        job_finished_.wait(lock, [&job]() noexcept { return job.finished_tasks == job.tasks; });
+        lock.unlock();
+
+        if (job.error != nullptr) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+    /// @brief Starts the workers so that at least @a workers_count of them are running
+    ///         (less if the new threads can not be created). Nested run() calls that are made
+    ///         by the workers can be executed in parallel only by the idle workers.
+    void reserve(const std::size_t workers_count) noexcept {
+        const std::lock_guard lock{mutex_};
+        start_workers(workers_count);
+    }
+
+private:
+    struct Job final {
+        const void* func;
+        void (*call)(const void* func, std::size_t i);
+        std::size_t tasks;
+        std::size_t next_task = 0;
+        std::size_t finished_tasks = 0;
+        std::exception_ptr error{};
+    };
+
+    /// @brief Takes the next task of the @a job, the lock is released while it is executed.
+    ///         Job is removed from the queue when its last task is taken, and it stays alive
+    ///         while its taken tasks are not finished (see run()).
+    void execute_next_task(Job& job, std::unique_lock<std::mutex>& lock) noexcept {
+        const std::size_t task = job.next_task++;
+        if (job.next_task == job.tasks) {
+            for (auto it = jobs_.begin(); it != jobs_.end(); ++it) {
+                if (*it == &job) {
+                    jobs_.erase(it);
+                    break;
+                }
+            }
+        }
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            job.call(job.func, task);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (unlikely(error != nullptr) && job.error == nullptr) {
+            job.error = std::move(error);
+        }
+        if (++job.finished_tasks == job.tasks) {
+            job_finished_.notify_all();
+        }
+    }
+
+    /// @note Called under the mutex_
+    void start_workers(const std::size_t workers_count) noexcept {
+        while (workers_.size() < workers_count) {
+            try {
+                workers_.emplace_back([this]() noexcept { worker_loop(); });
+            } catch (const std::system_error&) {
+                break;
+            } catch (const std::bad_alloc&) {
+                break;
+            }
+        }
+    }
+
+    void worker_loop() noexcept {
+        std::unique_lock lock{mutex_};
+        while (true) {
+            new_job_.wait(lock, [this]() noexcept { return stop_ || !jobs_.empty(); });
+            if (stop_) {
+                return;
+            }
+            execute_next_task(*jobs_.front(), lock);
+        }
+    }
+
+    std::mutex mutex_{};
+    std::condition_variable new_job_{};
+    std::condition_variable job_finished_{};
+    /// @brief Jobs with the tasks that are not taken yet
+    std::deque<Job*> jobs_{};
+    std::vector<std::thread> workers_{};
+    bool stop_ = false;
+};
+
+}  // namespace misc
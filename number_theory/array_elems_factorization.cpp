@@ -1,43 +1,25 @@
+#include <cstdint>
 #include <ext/pb_ds/assoc_container.hpp>
 #include <iostream>
 
+#include "math_functions.hpp"
+#include "pollard_rho.hpp"
+
 template <typename K, typename V>
 using unordered_map = __gnu_pbds::gp_hash_table<K, V>;
 
 int main() {
     uint32_t n = 0;
     std::cin >> n;
-    unordered_map<uint32_t, uint64_t> divisors;
+    unordered_map<uint64_t, uint64_t> divisors;
 
     for (uint32_t i = n; i != 0; i--) {
-        uint32_t a = 0;
+        uint64_t a = 0;
         std::cin >> a;
 
-        if (a % 2 == 0) {
-            if (a == 0) {
-                continue;
-            }
-
-            // k = s * 2^pow_of_2, where s is odd
-            uint32_t pow_of_2 = uint32_t(__builtin_ctz(a));
-            a >>= pow_of_2;
-            divisors[2] += pow_of_2;
-        }
-
-        for (uint32_t d = 3; d * d <= a; d += 2) {
-            if (a % d == 0) {
-                uint32_t pow_of_d = 0;
-                do {
-                    pow_of_d++;
-                    a /= d;
-                } while (a % d == 0);
-                divisors[d] += pow_of_d;
-            }
-        }
-
-        if (a != 1) {
-            divisors[a]++;
-        }
+        math_functions::visit_prime_factors_rho(a, [&divisors](const math_functions::PrimeFactor<uint64_t> pf) {
+            divisors[pf.factor] += pf.factor_power;
+        });
     }
 
     for (const auto& pair : divisors) {
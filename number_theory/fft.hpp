@@ -1,16 +1,23 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <complex>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "../misc/assert.hpp"
 #include "../misc/config_macros.hpp"
+#include "../misc/thread_pool.hpp"
 
 #if defined(__cpp_lib_math_constants) && __cpp_lib_math_constants >= 201907L && CONFIG_HAS_INCLUDE(<numbers>)
 #include <numbers>
@@ -22,6 +29,12 @@
 #define FFT_HAS_SPAN
 #endif
 
+#if (defined(__x86_64__) || defined(__i386__)) && CONFIG_COMPILER_IS_GCC_OR_ANY_CLANG && \
+    !defined(_MSC_VER) && CONFIG_HAS_INCLUDE(<immintrin.h>)
+#include <immintrin.h>
+#define FFT_HAS_X86_SIMD_KERNELS
+#endif
+
 namespace fft {
 
 using f64 = double;
@@ -29,15 +42,77 @@ using complex = std::complex<f64>;
 
 using std::size_t;
 
+/// @brief Polynomials of size less than kMinParallelFFTSize are always transformed in one thread
+inline constexpr size_t kMinParallelFFTSize = size_t{1} << 17U;
+
 /// @brief Multiply polynomials @a p1 and @a p2 of size @a n
 ///         and store their product into @a p2
+/// @note If @a max_threads > 1 and @a n >= kMinParallelFFTSize, transforms are split
+///        between at most @a max_threads threads (the calling thread is one of them)
 /// @param p1
 /// @param p2
 /// @param n
+/// @param max_threads
 ATTRIBUTE_SIZED_ACCESS(read_write, 1, 3)
 ATTRIBUTE_SIZED_ACCESS(read_write, 2, 3)
 ATTRIBUTE_NONNULL_ALL_ARGS
-inline void forward_backward_fft(complex* RESTRICT_QUALIFIER p1, complex* RESTRICT_QUALIFIER p2, size_t n);
+inline void forward_backward_fft(complex* RESTRICT_QUALIFIER p1,
+                                 complex* RESTRICT_QUALIFIER p2,
+                                 size_t n,
+                                 size_t max_threads = 1);
+
+/// @brief Computes the roots of unity and the bit reversal tables used by the
+///         transforms of size at most @a n, so that the first big multiplication
+///         does not pay for them (e.g. call it once at the program startup)
+/// @note Tables are grown lazily by the transforms anyway, this function is
+///        thread-safe like them
+/// @throws std::runtime_error if @a n is not a power of two
+///         std::bad_alloc if the memory for the tables can not be allocated
+inline void precompute_tables(size_t n);
+
+/**
+ * @brief Spectrum of the real polynomial, computed once and then reused for
+ *         the products by many other real polynomials.
+ *
+ * Real polynomial a_0 + a_1 x + ... + a_{n - 1} x^{n - 1} is passed in the packed form:
+ *  n / 2 complex numbers p[j] = a_{2 j} + i * a_{2 j + 1}, so every product needs two
+ *  transforms of size n / 2 instead of two transforms of size n done by the forward_backward_fft.
+ */
+class PrecomputedOperand;
+
+/// @brief Linear convolution of the real sequences @a a and @a b:
+///         c_k = \sum_{i + j = k} a_i * b_j for k = 0, ..., a_size + b_size - 2
+/// @note Sequences are padded to the power of two n >= a_size + b_size - 1 internally and
+///        transformed in the packed form (see PrecomputedOperand), so the convolution takes
+///        three transforms of size n / 2 and n + 1 complex numbers of memory instead of
+///        two transforms of size n and 2 n complex numbers needed by the forward_backward_fft.
+///       @a c is not changed if a_size == 0 or b_size == 0
+/// @param c array of at least a_size + b_size - 1 elements, should not overlap with @a a and @a b
+/// @param max_threads see forward_backward_fft()
+/// @throws std::bad_alloc if the memory for the transforms can not be allocated
+ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+ATTRIBUTE_ACCESS(write_only, 5)
+inline void convolve_real(const f64* a,
+                          size_t a_size,
+                          const f64* b,
+                          size_t b_size,
+                          f64* c,
+                          size_t max_threads = 1);
+
+/// @brief Same as convolve_real(const f64*, size_t, const f64*, size_t, f64*, size_t),
+///         but for the integer sequences, c_k are rounded to the nearest integers
+/// @note Result is exact while max|a_i| * max|b_j| * min(a_size, b_size) is far below 2^53
+///        (e.g. up to 2^40 for the sequences of 2^20 elements)
+ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+ATTRIBUTE_ACCESS(write_only, 5)
+inline void convolve_real(const std::int64_t* a,
+                          size_t a_size,
+                          const std::int64_t* b,
+                          size_t b_size,
+                          std::int64_t* c,
+                          size_t max_threads = 1);
 
 #ifdef FFT_HAS_SPAN
 
@@ -52,23 +127,49 @@ inline void forward_backward_fft(complex* RESTRICT_QUALIFIER p1, complex* RESTRI
 /// @param poly2
 inline void forward_backward_fft(std::span<complex> poly1, std::span<complex> poly2);
 
+/// @brief See convolve_real(const f64*, size_t, const f64*, size_t, f64*, size_t)
+/// @throws std::runtime_error if @a c.size() < @a a.size() + @a b.size() - 1 and both @a a and @a b are not empty
+inline void convolve_real(std::span<const f64> a, std::span<const f64> b, std::span<f64> c, size_t max_threads = 1);
+
+/// @brief See convolve_real(const std::int64_t*, size_t, const std::int64_t*, size_t, std::int64_t*, size_t)
+/// @throws std::runtime_error if @a c.size() < @a a.size() + @a b.size() - 1 and both @a a and @a b are not empty
+inline void convolve_real(std::span<const std::int64_t> a,
+                          std::span<const std::int64_t> b,
+                          std::span<std::int64_t> c,
+                          size_t max_threads = 1);
+
 #endif
 
 namespace detail {
 
 struct private_impl final {
 private:
+    /// @brief Max number of the roots tiers, tier t holds the roots for the polynomials of size 2^{t + 1}
+    static constexpr size_t kMaxRootsTiers = sizeof(size_t) * 8;
+
     /*
-     * Save only e^{2pi*0/1}, e^{2pi*0/2}, e^{2pi*0/4}, e^{2pi*1/4}, e^{2pi*0/8},
-     * e^{2pi*1/8}, e^{2pi*2/8}, e^{2pi*3/8}, ... because only low n / 2 roots are
-     * used
-     * (fft_roots[0] is never used btw, because in fft step >= 1,
-     *  so fft_roots[0] can be initialized with anything)
+     * fft_roots_tiers[t][j] = e^{i pi j / 2^t} for j = 0, 1, ..., 2^t - 1, so the transform
+     * step with the roots e^{2 pi i j / (2 step)} uses fft_roots_tiers[log2(step)] (see roots_for_step()).
+     *
+     * Tiers are never changed or freed after being published, so the transforms read them
+     * without locking, only the growth (see ensure_roots_capacity()) is done under the mutex.
      */
-    static inline std::vector<complex> fft_roots = {
-        complex{0, 0},
-        complex{1, 0},
-    };
+    static inline std::atomic<const complex*> fft_roots_tiers[kMaxRootsTiers]{};
+    /// @brief Roots are computed for all polynomials of size at most fft_roots_capacity
+    static inline std::atomic<size_t> fft_roots_capacity{1};
+    static inline std::unique_ptr<complex[]> fft_roots_tiers_storage[kMaxRootsTiers]{};
+    static inline std::mutex fft_tables_mutex{};
+
+    ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_PURE [[nodiscard]]
+    static const complex* roots_for_step(const size_t step) noexcept {
+        CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(step));
+#if CONFIG_COMPILER_IS_GCC_OR_ANY_CLANG
+        const auto tier_index = static_cast<std::uint32_t>(__builtin_ctzll(step));
+#else
+        const std::uint32_t tier_index = math_log2(step);
+#endif
+        return fft_roots_tiers[tier_index].load(std::memory_order_acquire);
+    }
 
     ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST [[nodiscard]]
     static constexpr bool is_valid_polynomial_size(const size_t n) noexcept {
@@ -92,112 +193,681 @@ private:
                ((array_1_end_int <= array_2_begin_int) ^ (array_2_end_int <= array_1_begin_int));
     }
 
-    template <bool IsBackwardFFT = false /* Forward of backward FFT */>
-    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
-    ATTRIBUTE_NONNULL(1) static void forward_or_backward_fft(complex* const p, const size_t k) noexcept {
+    /// @brief Max size of the polynomial for which the bit reversal permutation table is cached
+    static constexpr size_t kMaxBitReversalTableSize = size_t{1} << 22U;
+
+    /// @brief bit_reversal_tables[log2(k)][i] = reverse_bits(i) for the polynomials of size k,
+    ///         published once like the fft_roots_tiers
+    static inline std::atomic<const std::uint32_t*> bit_reversal_tables[kMaxRootsTiers]{};
+    static inline std::unique_ptr<std::uint32_t[]> bit_reversal_tables_storage[kMaxRootsTiers]{};
+
+    static void ensure_bit_reversal_table(const size_t k) {
         CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(k));
+        if (k > kMaxBitReversalTableSize) {
+            return;
+        }
+
+        const std::uint32_t log2_k = math_log2(k);
+        if (likely(bit_reversal_tables[log2_k].load(std::memory_order_acquire) != nullptr)) {
+            return;
+        }
+
+        const std::lock_guard lock{fft_tables_mutex};
+        if (bit_reversal_tables[log2_k].load(std::memory_order_relaxed) != nullptr) {
+            return;
+        }
+
+        std::unique_ptr<std::uint32_t[]> table = std::make_unique<std::uint32_t[]>(k);
+        for (size_t i = 1; i < k; i++) {
+            table[i] = static_cast<std::uint32_t>((table[i >> 1U] >> 1U) | ((i & 1U) * (k >> 1U)));
+        }
+        bit_reversal_tables[log2_k].store(table.get(), std::memory_order_release);
+        bit_reversal_tables_storage[log2_k] = std::move(table);
+    }
+
+    ATTRIBUTE_CONST [[nodiscard]] static constexpr std::uint32_t math_log2(size_t n) noexcept {
+        std::uint32_t log2_n = 0;
+        while (n > 1) {
+            n >>= 1U;
+            log2_n++;
+        }
+        return log2_n;
+    }
+
+    /// @brief Puts p[i] to the position reverse_bits(i) for all i in [begin, end)
+    ///         (along with the p[reverse_bits(i)] to the position i)
+    /// @note Calls for the disjoint ranges may be run concurrently: every
+    ///        pair (i, reverse_bits(i)) is swapped by the owner of min(i, reverse_bits(i))
+    ATTRIBUTE_NONNULL(1)
+    static void bit_reverse_permutation(complex* const p,
+                                        const size_t k,
+                                        const size_t begin,
+                                        const size_t end) noexcept {
+        CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(k));
+
+        if (k <= kMaxBitReversalTableSize) {
+            const std::uint32_t* const reversed =
+                bit_reversal_tables[math_log2(k)].load(std::memory_order_acquire);
+            for (size_t i = begin; i < end; i++) {
+                const size_t k_reversed_i = reversed[i];
+                if (i < k_reversed_i) {
+                    std::swap(p[i], p[k_reversed_i]);
+                }
+            }
+            return;
+        }
+
+        std::size_t k_reversed_i = 0;
+        for (std::size_t bit = k >> 1U, i_bits = begin; i_bits != 0; bit >>= 1U, i_bits >>= 1U) {
+            if (i_bits & 1U) {
+                k_reversed_i |= bit;
+            }
+        }
+
+        for (std::size_t i = begin; i < end; i++) {
+            if (i < k_reversed_i) {
+                std::swap(p[i], p[k_reversed_i]);
+            }
 
-        for (std::size_t i = 1, k_reversed_i = 0; i < k; i++) {
             // 'Increase' k_reversed_i by one
             std::size_t bit = k >> 1U;
-            for (; k_reversed_i >= bit; bit >>= 1U) {
+            for (; k_reversed_i >= bit && bit != 0; bit >>= 1U) {
                 k_reversed_i -= bit;
             }
-
             k_reversed_i += bit;
-            if (i < k_reversed_i) {
-                std::swap(p[i], p[k_reversed_i]);
+        }
+    }
+
+    ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST [[nodiscard]] static complex mult_by_i(const complex z) noexcept {
+        return complex{-z.imag(), z.real()};
+    }
+
+    /*
+     * Butterfly kernels. The transform is always the forward one (with the roots e^{+i pi j / step}),
+     * the backward one is computed as
+     *  backward(p)[j] = forward(p)[(k - j) mod k] / k
+     * (see reverse_and_scale()), so no conjugated roots are needed.
+     *
+     * Two consecutive steps s and 2 s are fused into one radix-4 pass over the
+     * quadruples (p[j], p[j + s], p[j + 2 s], p[j + 3 s]):
+     *  roots of the step 2 s for the pairs (j + s, j + 3 s) are roots for the pairs (j, j + 2 s)
+     *  multiplied by the e^{i pi s / (2 s)} = i, so the pass needs 3 complex multiplications instead of 4.
+     */
+
+    /// @brief Butterflies (p[j], p[j + step]) for j in [first_index, last_index) of one block
+    ATTRIBUTE_NONNULL(1)
+    static void butterflies_default(complex* const p,
+                                    const size_t step,
+                                    const size_t first_index,
+                                    const size_t last_index) noexcept {
+        const complex* const roots = roots_for_step(step);
+        for (std::size_t j = first_index; j < last_index; j++) {
+            const complex p0_i = p[j];
+            const complex w_j_p1_i = roots[j] * p[j + step];
+            p[j] = p0_i + w_j_p1_i;
+            p[j + step] = p0_i - w_j_p1_i;
+        }
+    }
+
+    /// @brief Radix-4 pass for the steps @a step and 2 * @a step on the block p[0..4 * step)
+    ATTRIBUTE_NONNULL(1)
+    static void radix4_pass_default(complex* const p, const size_t step) noexcept {
+        const complex* const roots_1 = roots_for_step(step);
+        const complex* const roots_2 = roots_for_step(2 * step);
+        for (std::size_t j = 0; j < step; j++) {
+            const complex w1 = roots_1[j];
+            const complex w2 = roots_2[j];
+            const complex w1_a1 = w1 * p[j + step];
+            const complex w1_a3 = w1 * p[j + 3 * step];
+            const complex b0 = p[j] + w1_a1;
+            const complex b1 = p[j] - w1_a1;
+            const complex b2 = p[j + 2 * step] + w1_a3;
+            const complex b3 = p[j + 2 * step] - w1_a3;
+            const complex w2_b2 = w2 * b2;
+            const complex w2_b3_i = mult_by_i(w2 * b3);
+            p[j] = b0 + w2_b2;
+            p[j + 2 * step] = b0 - w2_b2;
+            p[j + step] = b1 + w2_b3_i;
+            p[j + 3 * step] = b1 - w2_b3_i;
+        }
+    }
+
+    /// @brief Fused steps 1 and 2 (all the roots are 1 and i) on the block p[0..block_size)
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+    ATTRIBUTE_NONNULL(1) static void first_radix4_pass(complex* const p, const size_t block_size) noexcept {
+        for (std::size_t i = 0; i < block_size; i += 4) {
+            const complex b0 = p[i] + p[i + 1];
+            const complex b1 = p[i] - p[i + 1];
+            const complex b2 = p[i + 2] + p[i + 3];
+            const complex b3_i = mult_by_i(p[i + 2] - p[i + 3]);
+            p[i] = b0 + b2;
+            p[i + 2] = b0 - b2;
+            p[i + 1] = b1 + b3_i;
+            p[i + 3] = b1 - b3_i;
+        }
+    }
+
+    /// @brief All the steps < @a block_size on the block p[0..block_size)
+    template <void (*Radix4Pass)(complex*, size_t) noexcept,
+              void (*Butterflies)(complex*, size_t, size_t, size_t) noexcept>
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+    ATTRIBUTE_NONNULL(1) static void transform_block(complex* const p, const size_t block_size) noexcept {
+        CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(block_size));
+
+        size_t step = 1;
+        if (block_size >= 4) {
+            first_radix4_pass(p, block_size);
+            step = 4;
+        }
+        for (; 2 * step < block_size; step *= 4) {
+            for (std::size_t block_start = 0; block_start < block_size; block_start += 4 * step) {
+                Radix4Pass(p + block_start, step);
             }
         }
+        if (step < block_size) {
+            Butterflies(p, step, 0, step);
+        }
+    }
 
-        const complex* const points = fft_roots.data();
-
-        // Unrolled loop for step = 1
-        for (std::size_t block_start = 0; block_start < k; block_start += 2) {
-            const complex p0_i = p[block_start];
-            const complex w_j_p1_i = p[block_start + 1];
-            p[block_start] = p0_i + w_j_p1_i;
-            p[block_start + 1] = p0_i - w_j_p1_i;
-        }
-
-        for (std::size_t step = 2; step < k; step *= 2) {
-            for (std::size_t block_start = 0; block_start < k;) {
-                const std::size_t block_end = block_start + step;
-                for (std::size_t pos_in_block = block_start, point_index = step; pos_in_block < block_end;
-                     pos_in_block++, point_index++) {
-                    const complex p0_i = p[pos_in_block];
-                    complex w_j_p1_i{};
-                    if constexpr (IsBackwardFFT) {
-                        w_j_p1_i = std::conj(points[point_index]) * p[pos_in_block + step];
-                    } else {
-                        w_j_p1_i = points[point_index] * p[pos_in_block + step];
-                    }
-                    p[pos_in_block] = p0_i + w_j_p1_i;
-                    p[pos_in_block + step] = p0_i - w_j_p1_i;
-                }
+#if defined(FFT_HAS_X86_SIMD_KERNELS)
+
+    /// @brief Products w[0] * z[0], w[1] * z[1] of the packed complex numbers
+    ATTRIBUTE_TARGET("avx2,fma")
+    ATTRIBUTE_ALWAYS_INLINE static __m256d complex_mul_avx2(const __m256d w, const __m256d z) noexcept {
+        const __m256d w_re = _mm256_movedup_pd(w);
+        const __m256d w_im = _mm256_permute_pd(w, 0b1111);
+        const __m256d z_swapped = _mm256_permute_pd(z, 0b0101);
+        return _mm256_fmaddsub_pd(w_re, z, _mm256_mul_pd(w_im, z_swapped));
+    }
+
+    ATTRIBUTE_TARGET("avx2,fma")
+    ATTRIBUTE_ALWAYS_INLINE static __m256d mult_by_i_avx2(const __m256d z) noexcept {
+        // (re, im) -> (-im, re)
+        const __m256d z_swapped = _mm256_permute_pd(z, 0b0101);
+        return _mm256_xor_pd(z_swapped, _mm256_setr_pd(-0.0, 0.0, -0.0, 0.0));
+    }
+
+    ATTRIBUTE_TARGET("avx2,fma")
+    ATTRIBUTE_ALWAYS_INLINE static __m256d load_avx2(const complex* const z) noexcept {
+        return _mm256_loadu_pd(reinterpret_cast<const f64*>(z));
+    }
+
+    ATTRIBUTE_TARGET("avx2,fma")
+    ATTRIBUTE_ALWAYS_INLINE static void store_avx2(complex* const z, const __m256d value) noexcept {
+        _mm256_storeu_pd(reinterpret_cast<f64*>(z), value);
+    }
+
+    ATTRIBUTE_TARGET("avx2,fma")
+    ATTRIBUTE_NONNULL(1)
+    static void butterflies_avx2(complex* const p,
+                                 const size_t step,
+                                 const size_t first_index,
+                                 const size_t last_index) noexcept {
+        const complex* const roots = roots_for_step(step);
+        std::size_t j = first_index;
+        for (; j + 2 <= last_index; j += 2) {
+            const __m256d p0_i = load_avx2(p + j);
+            const __m256d w_j_p1_i = complex_mul_avx2(load_avx2(roots + j), load_avx2(p + j + step));
+            store_avx2(p + j, _mm256_add_pd(p0_i, w_j_p1_i));
+            store_avx2(p + j + step, _mm256_sub_pd(p0_i, w_j_p1_i));
+        }
+        butterflies_default(p, step, j, last_index);
+    }
+
+    /// @note @a step >= 4 (steps 1 and 2 are done by the first_radix4_pass())
+    ATTRIBUTE_TARGET("avx2,fma")
+    ATTRIBUTE_NONNULL(1)
+    static void radix4_pass_avx2(complex* const p, const size_t step) noexcept {
+        const complex* const roots_1 = roots_for_step(step);
+        const complex* const roots_2 = roots_for_step(2 * step);
+        for (std::size_t j = 0; j < step; j += 2) {
+            const __m256d w1 = load_avx2(roots_1 + j);
+            const __m256d w2 = load_avx2(roots_2 + j);
+            const __m256d a0 = load_avx2(p + j);
+            const __m256d a2 = load_avx2(p + j + 2 * step);
+            const __m256d w1_a1 = complex_mul_avx2(w1, load_avx2(p + j + step));
+            const __m256d w1_a3 = complex_mul_avx2(w1, load_avx2(p + j + 3 * step));
+            const __m256d b0 = _mm256_add_pd(a0, w1_a1);
+            const __m256d b1 = _mm256_sub_pd(a0, w1_a1);
+            const __m256d b2 = _mm256_add_pd(a2, w1_a3);
+            const __m256d b3 = _mm256_sub_pd(a2, w1_a3);
+            const __m256d w2_b2 = complex_mul_avx2(w2, b2);
+            const __m256d w2_b3_i = mult_by_i_avx2(complex_mul_avx2(w2, b3));
+            store_avx2(p + j, _mm256_add_pd(b0, w2_b2));
+            store_avx2(p + j + 2 * step, _mm256_sub_pd(b0, w2_b2));
+            store_avx2(p + j + step, _mm256_add_pd(b1, w2_b3_i));
+            store_avx2(p + j + 3 * step, _mm256_sub_pd(b1, w2_b3_i));
+        }
+    }
+
+    /// @brief Products w[i] * z[i] of the 4 packed complex numbers
+    ATTRIBUTE_TARGET("avx512f")
+    ATTRIBUTE_ALWAYS_INLINE static __m512d complex_mul_avx512(const __m512d w, const __m512d z) noexcept {
+        // Shuffles instead of the movedup / permute, which trigger gcc's -Wmaybe-uninitialized in avx512fintrin.h
+        const __m512d w_re = _mm512_shuffle_pd(w, w, 0b00000000);
+        const __m512d w_im = _mm512_shuffle_pd(w, w, 0b11111111);
+        const __m512d z_swapped = _mm512_shuffle_pd(z, z, 0b01010101);
+        return _mm512_fmaddsub_pd(w_re, z, _mm512_mul_pd(w_im, z_swapped));
+    }
+
+    ATTRIBUTE_TARGET("avx512f")
+    ATTRIBUTE_ALWAYS_INLINE static __m512d mult_by_i_avx512(const __m512d z) noexcept {
+        // (re, im) -> (-im, re)
+        const __m512d z_swapped = _mm512_shuffle_pd(z, z, 0b01010101);
+        return _mm512_mask_sub_pd(z_swapped, 0b01010101, _mm512_setzero_pd(), z_swapped);
+    }
+
+    ATTRIBUTE_TARGET("avx512f")
+    ATTRIBUTE_ALWAYS_INLINE static __m512d load_avx512(const complex* const z) noexcept {
+        return _mm512_loadu_pd(reinterpret_cast<const f64*>(z));
+    }
+
+    ATTRIBUTE_TARGET("avx512f")
+    ATTRIBUTE_ALWAYS_INLINE static void store_avx512(complex* const z, const __m512d value) noexcept {
+        _mm512_storeu_pd(reinterpret_cast<f64*>(z), value);
+    }
+
+    ATTRIBUTE_TARGET("avx512f")
+    ATTRIBUTE_NONNULL(1)
+    static void butterflies_avx512(complex* const p,
+                                   const size_t step,
+                                   const size_t first_index,
+                                   const size_t last_index) noexcept {
+        const complex* const roots = roots_for_step(step);
+        std::size_t j = first_index;
+        for (; j + 4 <= last_index; j += 4) {
+            const __m512d p0_i = load_avx512(p + j);
+            const __m512d w_j_p1_i = complex_mul_avx512(load_avx512(roots + j), load_avx512(p + j + step));
+            store_avx512(p + j, _mm512_add_pd(p0_i, w_j_p1_i));
+            store_avx512(p + j + step, _mm512_sub_pd(p0_i, w_j_p1_i));
+        }
+        butterflies_default(p, step, j, last_index);
+    }
+
+    /// @note @a step >= 4 (steps 1 and 2 are done by the first_radix4_pass())
+    ATTRIBUTE_TARGET("avx512f")
+    ATTRIBUTE_NONNULL(1)
+    static void radix4_pass_avx512(complex* const p, const size_t step) noexcept {
+        const complex* const roots_1 = roots_for_step(step);
+        const complex* const roots_2 = roots_for_step(2 * step);
+        for (std::size_t j = 0; j < step; j += 4) {
+            const __m512d w1 = load_avx512(roots_1 + j);
+            const __m512d w2 = load_avx512(roots_2 + j);
+            const __m512d a0 = load_avx512(p + j);
+            const __m512d a2 = load_avx512(p + j + 2 * step);
+            const __m512d w1_a1 = complex_mul_avx512(w1, load_avx512(p + j + step));
+            const __m512d w1_a3 = complex_mul_avx512(w1, load_avx512(p + j + 3 * step));
+            const __m512d b0 = _mm512_add_pd(a0, w1_a1);
+            const __m512d b1 = _mm512_sub_pd(a0, w1_a1);
+            const __m512d b2 = _mm512_add_pd(a2, w1_a3);
+            const __m512d b3 = _mm512_sub_pd(a2, w1_a3);
+            const __m512d w2_b2 = complex_mul_avx512(w2, b2);
+            const __m512d w2_b3_i = mult_by_i_avx512(complex_mul_avx512(w2, b3));
+            store_avx512(p + j, _mm512_add_pd(b0, w2_b2));
+            store_avx512(p + j + 2 * step, _mm512_sub_pd(b0, w2_b2));
+            store_avx512(p + j + step, _mm512_add_pd(b1, w2_b3_i));
+            store_avx512(p + j + 3 * step, _mm512_sub_pd(b1, w2_b3_i));
+        }
+    }
+
+#endif
+
+    struct fft_kernels final {
+        void (*transform_block)(complex* p, size_t block_size) noexcept;
+        void (*butterflies)(complex* p, size_t step, size_t first_index, size_t last_index) noexcept;
+    };
+
+    [[nodiscard]] static fft_kernels select_kernels() noexcept {
+#if defined(FFT_HAS_X86_SIMD_KERNELS)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return fft_kernels{
+                &transform_block<&radix4_pass_avx512, &butterflies_avx512>,
+                &butterflies_avx512,
+            };
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return fft_kernels{
+                &transform_block<&radix4_pass_avx2, &butterflies_avx2>,
+                &butterflies_avx2,
+            };
+        }
+#endif
+        return fft_kernels{
+            &transform_block<&radix4_pass_default, &butterflies_default>,
+            &butterflies_default,
+        };
+    }
+
+    /// @brief Kernels for the current CPU, selected at runtime on the first call
+    [[nodiscard]] static const fft_kernels& kernels() noexcept {
+        static const fft_kernels selected_kernels = select_kernels();
+        return selected_kernels;
+    }
 
-                block_start = block_end + step;
+    /// @brief p[j] = p[(k - j) mod k] / k for all the j in [0, k), run on the j in [begin, end) of [0, k / 2)
+    ATTRIBUTE_NONNULL(1)
+    static void reverse_and_scale(complex* const p, const size_t k, const size_t begin, const size_t end) noexcept {
+        const f64 one_kth = 1.0 / static_cast<f64>(k);
+        size_t j = begin;
+        if (j == 0) {
+            p[0] *= one_kth;
+            if (k > 1) {
+                p[k / 2] *= one_kth;
             }
+            j++;
+        }
+        for (; j < end; j++) {
+            const complex p_j = p[j];
+            p[j] = p[k - j] * one_kth;
+            p[k - j] = p_j * one_kth;
         }
+    }
 
+    template <bool IsBackwardFFT = false /* Forward of backward FFT */>
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+    ATTRIBUTE_NONNULL(1) static void forward_or_backward_fft(complex* const p, const size_t k) noexcept {
+        CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(k));
+
+        bit_reverse_permutation(p, k, 0, k);
+        kernels().transform_block(p, k);
         if constexpr (IsBackwardFFT) {
-            const f64 one_kth = 1.0 / static_cast<f64>(k);
-            for (complex *p_iter = p, *p_end = p_iter + k; p_iter != p_end; ++p_iter) {
-                *p_iter *= one_kth;
-            }
+            reverse_and_scale(p, k, 0, std::max(k / 2, size_t{1}));
         }
     }
 
-    static void ensure_roots_capacity(const size_t n) {
-        ensure_roots_capacity_impl(n, fft_roots);
+    /// @brief Number of threads (power of two) used to transform the polynomial of size @a n
+    ATTRIBUTE_CONST [[nodiscard]]
+    static constexpr size_t parallel_fft_threads(const size_t n, const size_t max_threads) noexcept {
+        if (n < kMinParallelFFTSize) {
+            return 1;
+        }
+        size_t threads = 1;
+        // Every thread gets at least kMinParallelFFTSize / 4 points
+        while (threads * 2 <= max_threads && threads * 2 <= n / (kMinParallelFFTSize / 4)) {
+            threads *= 2;
+        }
+        return threads;
     }
 
-    static void ensure_roots_capacity_impl(const size_t n, std::vector<complex>& roots) {
-        CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(n));
+    /// @brief Calls func(i) for all i in [0, threads) in the workers of the misc::thread_pool
+    ///         and the current thread
+    template <class Function>
+    static void run_in_parallel(const size_t threads, const Function& func) {
+        misc::thread_pool::instance().run(threads, func);
+    }
+
+    /**
+     * After the bit reversal permutation the first log2(k / threads) steps of the
+     * transform work on the independent contiguous blocks of size k / threads
+     * (each one is a complete sub-transform), so every thread takes its own block.
+     * Each of the remaining log2(threads) steps is split between the threads
+     * by the butterfly index, with one join per step.
+     */
+    template <bool IsBackwardFFT>
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+    ATTRIBUTE_NONNULL(1) static void parallel_forward_or_backward_fft(complex* const p,
+                                                                      const size_t k,
+                                                                      const size_t threads) {
+        CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(k));
+        CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(threads));
+        if (threads <= 1) {
+            forward_or_backward_fft<IsBackwardFFT>(p, k);
+            return;
+        }
+
+        const size_t block_size = k / threads;
+        run_in_parallel(threads, [p, k, block_size](const size_t thread_index) noexcept {
+            bit_reverse_permutation(p, k, thread_index * block_size, (thread_index + 1) * block_size);
+        });
+        run_in_parallel(threads, [p, block_size](const size_t thread_index) noexcept {
+            kernels().transform_block(p + thread_index * block_size, block_size);
+        });
+
+        const size_t butterflies_per_thread = k / 2 / threads;
+        for (size_t step = block_size; step < k; step *= 2) {
+            run_in_parallel(threads, [p, step, butterflies_per_thread](const size_t thread_index) noexcept {
+                // Butterflies [first, last) of the step, the j-th one is in the block j / step
+                size_t first = thread_index * butterflies_per_thread;
+                const size_t last = first + butterflies_per_thread;
+                while (first < last) {
+                    const size_t block_index = first / step;
+                    const size_t block_last = std::min(last, (block_index + 1) * step);
+                    kernels().butterflies(p + 2 * step * block_index, step, first - block_index * step,
+                                          block_last - block_index * step);
+                    first = block_last;
+                }
+            });
+        }
+
+        if constexpr (IsBackwardFFT) {
+            const size_t pairs_per_thread = k / 2 / threads;
+            run_in_parallel(threads, [p, k, pairs_per_thread](const size_t thread_index) noexcept {
+                reverse_and_scale(p, k, thread_index * pairs_per_thread, (thread_index + 1) * pairs_per_thread);
+            });
+        }
+    }
+
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void multiply_transformed(const complex* RESTRICT_QUALIFIER p1,
+                                     complex* RESTRICT_QUALIFIER p2,
+                                     const size_t n,
+                                     const size_t begin,
+                                     const size_t end) noexcept {
+        constexpr complex one_over_four_i(f64{0}, f64{-0.25});  // 1 / (4 * i) == -i / 4
+        for (std::size_t j = begin; j < end; j++) {
+            const std::size_t n_j = (n - j) & (n - 1);  // <=> mod n because n is power of two
+            const complex p_w_j = p1[j];
+            const complex p_w_n_j = std::conj(p1[n_j]);
+            p2[j] = (p_w_j + p_w_n_j) * (p_w_j - p_w_n_j) * one_over_four_i;
+        }
+    }
+
+    ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST [[nodiscard]] static complex mult_by_minus_i(const complex z) noexcept {
+        return complex{z.imag(), -z.real()};
+    }
+
+    /*
+     * Let z_j = a_{2 j} + i * a_{2 j + 1}, j = 0, ..., n / 2 - 1 be the packed real polynomial,
+     * Z = FFT_{n / 2}(z), w = e^{2 pi i / n} and m = (n / 2 - k) mod (n / 2). Then
+     *  FFT_n(a)_k = (Z_k + conj(Z_m)) / 2 + w^k * (Z_k - conj(Z_m)) / (2 i)
+     *
+     * For the real c with C = FFT_n(c) (so C_{k + n / 2} = conj(C_{n / 2 - k})), the packed
+     * c is the backward FFT_{n / 2} of the
+     *  Y_k = (C_k + conj(C_{n / 2 - k})) / 2 + i * w^{-k} * (C_k - conj(C_{n / 2 - k})) / 2
+     */
+
+    ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST [[nodiscard]]
+    static complex unpack_real_spectrum(const complex z_k, const complex z_m, const complex w_k) noexcept {
+        const complex conj_z_m = std::conj(z_m);
+        return (z_k + conj_z_m + w_k * mult_by_minus_i(z_k - conj_z_m)) * f64{0.5};
+    }
+
+    ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST [[nodiscard]]
+    static complex pack_real_spectrum(const complex c_k, const complex c_m, const complex w_k) noexcept {
+        const complex conj_c_m = std::conj(c_m);
+        return (c_k + conj_c_m + mult_by_i(std::conj(w_k) * (c_k - conj_c_m))) * f64{0.5};
+    }
+
+    /// @brief Replaces Z = FFT_{n / 2}(z) of the packed real polynomial
+    ///         with the FFT_n(a)_k, k = 0, ..., n / 2 (@a z should have n / 2 + 1 elements)
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void unpack_real_spectrum_inplace(complex* const z, const size_t n) noexcept {
+        const size_t half = n / 2;
+        const complex* const w = roots_for_step(half);
+        const complex z_0 = z[0];
+        z[0] = complex{z_0.real() + z_0.imag(), 0};
+        z[half] = complex{z_0.real() - z_0.imag(), 0};
+        for (size_t k = 1; k <= half / 2; k++) {
+            const size_t m = half - k;
+            const complex z_k = z[k];
+            const complex z_m = z[m];
+            z[k] = unpack_real_spectrum(z_k, z_m, w[k]);
+            z[m] = unpack_real_spectrum(z_m, z_k, w[m]);
+        }
+    }
+
+    /// @brief Replaces Z = FFT_{n / 2}(z) of the packed real polynomial a with the Y_k
+    ///         (see above) of the product of a and b with @a b_spectrum = FFT_n(b)_k, k = 0, ..., n / 2
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void multiply_by_real_spectrum(complex* RESTRICT_QUALIFIER const z,
+                                          const complex* RESTRICT_QUALIFIER const b_spectrum,
+                                          const size_t n) noexcept {
+        const size_t half = n / 2;
+        const complex* const w = roots_for_step(half);
+        {
+            const complex z_0 = z[0];
+            const complex c_0 = (z_0.real() + z_0.imag()) * b_spectrum[0];
+            const complex c_half = (z_0.real() - z_0.imag()) * b_spectrum[half];
+            z[0] = pack_real_spectrum(c_0, c_half, complex{1, 0});
+        }
+        for (size_t k = 1; k <= half / 2; k++) {
+            const size_t m = half - k;
+            const complex z_k = z[k];
+            const complex z_m = z[m];
+            const complex c_k = unpack_real_spectrum(z_k, z_m, w[k]) * b_spectrum[k];
+            const complex c_m = unpack_real_spectrum(z_m, z_k, w[m]) * b_spectrum[m];
+            z[k] = pack_real_spectrum(c_k, c_m, w[k]);
+            z[m] = pack_real_spectrum(c_m, c_k, w[m]);
+        }
+    }
+
+    /// @brief Sequences with at most kMaxNaiveConvolutionSize elements are convolved directly
+    static constexpr size_t kMaxNaiveConvolutionSize = 32;
+
+    /// @brief c_k = \sum_{i + j = k} a_i * b_j, every c_k is passed to the store(k, c_k)
+    template <class T, class StoreFunction>
+    ATTRIBUTE_NONNULL(1, 3)
+    static void convolve_real(const T* const a,
+                              const size_t a_size,
+                              const T* const b,
+                              const size_t b_size,
+                              const size_t max_threads,
+                              StoreFunction store) {
+        if (unlikely(a_size == 0 || b_size == 0)) {
+            return;
+        }
 
-        size_t current_len = roots.size();
-        assert(current_len >= 2 && (current_len & (current_len - 1)) == 0);
-        CONFIG_ASSUME_STATEMENT(current_len >= 2 && (current_len & (current_len - 1)) == 0);
-        if (current_len >= n) {
+        const size_t c_size = a_size + b_size - 1;
+        if (std::min(a_size, b_size) <= kMaxNaiveConvolutionSize) {
+            std::vector<T> c(c_size);
+            for (size_t i = 0; i < a_size; i++) {
+                for (size_t j = 0; j < b_size; j++) {
+                    c[i + j] += a[i] * b[j];
+                }
+            }
+            for (size_t k = 0; k < c_size; k++) {
+                store(k, c[k]);
+            }
             return;
         }
 
-        roots.reserve(n);
-        const auto add_point = [roots_data = roots.data(), &current_len, &roots](const size_t i) noexcept {
+        size_t n = 2;
+        while (n < c_size) {
+            n *= 2;
+        }
+        const size_t half = n / 2;
+        // z_j = x_{2 j} + i * x_{2 j + 1}, see unpack_real_spectrum_inplace()
+        const auto pack = [half](const T* const x, const size_t x_size, complex* const z) noexcept {
+            for (size_t j = 0; j < half; j++) {
+                const f64 re = 2 * j < x_size ? static_cast<f64>(x[2 * j]) : f64{0};
+                const f64 im = 2 * j + 1 < x_size ? static_cast<f64>(x[2 * j + 1]) : f64{0};
+                z[j] = complex{re, im};
+            }
+        };
+        std::vector<complex> a_packed(half);
+        std::vector<complex> b_spectrum(half + 1);
+        pack(a, a_size, a_packed.data());
+        pack(b, b_size, b_spectrum.data());
+
+        ensure_roots_capacity(n);
+        ensure_bit_reversal_table(half);
+        const size_t threads = parallel_fft_threads(half, max_threads);
+        parallel_forward_or_backward_fft</*IsBackwardFFT = */ false>(b_spectrum.data(), half, threads);
+        unpack_real_spectrum_inplace(b_spectrum.data(), n);
+        parallel_forward_or_backward_fft</*IsBackwardFFT = */ false>(a_packed.data(), half, threads);
+        multiply_by_real_spectrum(a_packed.data(), b_spectrum.data(), n);
+        parallel_forward_or_backward_fft</*IsBackwardFFT = */ true>(a_packed.data(), half, threads);
+
+        for (size_t k = 0; k < c_size; k++) {
+            const complex z = a_packed[k / 2];
+            store(k, k % 2 == 0 ? z.real() : z.imag());
+        }
+    }
+
+    /// @brief Makes roots_for_step(step) available for all step < n
+    static void ensure_roots_capacity(const size_t n) {
+        CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(n));
+        if (likely(fft_roots_capacity.load(std::memory_order_acquire) >= n)) {
+            return;
+        }
+
+        const std::lock_guard lock{fft_tables_mutex};
+        size_t current_len = fft_roots_capacity.load(std::memory_order_relaxed);
+        CONFIG_ASSUME_STATEMENT(is_valid_polynomial_size(current_len));
+        for (; current_len < n; current_len *= 2) {
+            add_roots_tier(current_len);
+            fft_roots_capacity.store(current_len * 2, std::memory_order_release);
+        }
+    }
+
+    /// @brief Computes the tier with e^{i pi j / step}, j = 0, 1, ..., step - 1
+    static void add_roots_tier(const size_t step) {
 #ifdef FFT_HAS_NUMBERS
-            constexpr f64 kPi = std::numbers::pi_v<f64>;
+        constexpr f64 kPi = std::numbers::pi_v<f64>;
 #else
-            const f64 kPi = std::acos(static_cast<f64>(-1));
+        const f64 kPi = std::acos(static_cast<f64>(-1));
 #endif
-            roots.emplace_back(roots_data[i]);
-            // double phi = 2 * kPi * (2 * i - current_len + 1) / (2 * current_len);
-            const f64 phi = kPi * static_cast<f64>(2 * i - current_len + 1) / static_cast<f64>(current_len);
-            roots.emplace_back(std::cos(phi), std::sin(phi));
-        };
-        do {
-            for (size_t i = current_len / 2; i != current_len; i++) {
-                add_point(i);
+        const std::uint32_t tier_index = math_log2(step);
+        std::unique_ptr<complex[]> tier = std::make_unique<complex[]>(step);
+        tier[0] = complex{1, 0};
+        if (step >= 2) {
+            // Even roots are taken from the previous tier
+            const complex* const previous_tier = fft_roots_tiers[tier_index - 1].load(std::memory_order_relaxed);
+            for (size_t j = 1; j < step; j++) {
+                if (j % 2 == 0) {
+                    tier[j] = previous_tier[j / 2];
+                } else {
+                    const f64 phi = kPi * static_cast<f64>(j) / static_cast<f64>(step);
+                    tier[j] = complex{std::cos(phi), std::sin(phi)};
+                }
             }
-            current_len *= 2;
-            assert(current_len == roots.size());
-        } while (current_len < n);
-        assert(current_len == n);
+        }
+        fft_roots_tiers[tier_index].store(tier.get(), std::memory_order_release);
+        fft_roots_tiers_storage[tier_index] = std::move(tier);
     }
 
     friend inline void fft::forward_backward_fft(complex* RESTRICT_QUALIFIER p1,
                                                  complex* RESTRICT_QUALIFIER p2,
-                                                 size_t n);
+                                                 size_t n,
+                                                 size_t max_threads);
 
 #ifdef FFT_HAS_SPAN
     friend inline void fft::forward_backward_fft(std::span<complex> poly1, std::span<complex> poly2);
 #endif
+
+    friend class fft::PrecomputedOperand;
+    friend inline void fft::precompute_tables(size_t n);
+    friend inline void fft::convolve_real(const f64* a,
+                                          size_t a_size,
+                                          const f64* b,
+                                          size_t b_size,
+                                          f64* c,
+                                          size_t max_threads);
+    friend inline void fft::convolve_real(const std::int64_t* a,
+                                          size_t a_size,
+                                          const std::int64_t* b,
+                                          size_t b_size,
+                                          std::int64_t* c,
+                                          size_t max_threads);
 };
 
 }  // namespace detail
 
 inline void forward_backward_fft(complex* const RESTRICT_QUALIFIER p1,
                                  complex* const RESTRICT_QUALIFIER p2,
-                                 const size_t n) {
+                                 const size_t n,
+                                 const size_t max_threads) {
     if (unlikely(n == 0)) {
         return;
     }
@@ -206,7 +876,9 @@ inline void forward_backward_fft(complex* const RESTRICT_QUALIFIER p1,
     THROW_IF_NOT(fft::detail::private_impl::are_distinct_non_empty_ranges(p1, p2, n));
 
     fft::detail::private_impl::ensure_roots_capacity(n);
-    fft::detail::private_impl::forward_or_backward_fft</*IsBackwardFFT = */ false>(p1, n);
+    fft::detail::private_impl::ensure_bit_reversal_table(n);
+    const size_t threads = fft::detail::private_impl::parallel_fft_threads(n, max_threads);
+    fft::detail::private_impl::parallel_forward_or_backward_fft</*IsBackwardFFT = */ false>(p1, n, threads);
 
     // clang-format off
     /*
@@ -235,16 +907,112 @@ inline void forward_backward_fft(complex* const RESTRICT_QUALIFIER p1,
      */
     // clang-format on
 
-    constexpr complex one_over_four_i(f64{0}, f64{-0.25});  // 1 / (4 * i) == -i / 4
-    for (std::size_t j = 0; j < n; j++) {
-        const std::size_t n_j = (n - j) & (n - 1);  // <=> mod n because n is power of two
-        const complex p_w_j = p1[j];
-        const complex p_w_n_j = std::conj(p1[n_j]);
-        p2[j] = (p_w_j + p_w_n_j) * (p_w_j - p_w_n_j) * one_over_four_i;
+    if (threads <= 1) {
+        fft::detail::private_impl::multiply_transformed(p1, p2, n, 0, n);
+    } else {
+        const size_t block_size = n / threads;
+        const auto multiply_block = [p1, p2, n, block_size](const size_t thread_index) noexcept {
+            fft::detail::private_impl::multiply_transformed(p1, p2, n, thread_index * block_size,
+                                                            (thread_index + 1) * block_size);
+        };
+        fft::detail::private_impl::run_in_parallel(threads, multiply_block);
+    }
+    fft::detail::private_impl::parallel_forward_or_backward_fft</*IsBackwardFFT = */ true>(p2, n, threads);
+}
+
+inline void precompute_tables(const size_t n) {
+    THROW_IF_NOT(fft::detail::private_impl::is_valid_polynomial_size(n));
+    fft::detail::private_impl::ensure_roots_capacity(n);
+    fft::detail::private_impl::ensure_bit_reversal_table(n);
+    if (n >= 2) {
+        // Transforms of the packed real polynomials, see PrecomputedOperand
+        fft::detail::private_impl::ensure_bit_reversal_table(n / 2);
     }
-    fft::detail::private_impl::forward_or_backward_fft</*IsBackwardFFT = */ true>(p2, n);
 }
 
+inline void convolve_real(const f64* const a,
+                          const size_t a_size,
+                          const f64* const b,
+                          const size_t b_size,
+                          f64* const c,
+                          const size_t max_threads) {
+    fft::detail::private_impl::convolve_real(a, a_size, b, b_size, max_threads,
+                                             [c](const size_t k, const f64 value) noexcept { c[k] = value; });
+}
+
+inline void convolve_real(const std::int64_t* const a,
+                          const size_t a_size,
+                          const std::int64_t* const b,
+                          const size_t b_size,
+                          std::int64_t* const c,
+                          const size_t max_threads) {
+    fft::detail::private_impl::convolve_real(a, a_size, b, b_size, max_threads,
+                                             [c](const size_t k, const auto value) noexcept {
+                                                 if constexpr (std::is_integral_v<decltype(value)>) {
+                                                     // Direct convolution of the short sequences is exact
+                                                     c[k] = value;
+                                                 } else {
+                                                     c[k] = static_cast<std::int64_t>(std::llround(value));
+                                                 }
+                                             });
+}
+
+class PrecomputedOperand final {
+public:
+    PrecomputedOperand() = default;
+
+    /// @brief Computes the spectrum of the real polynomial of size at most @a n for the products of size at most @a n
+    /// @param packed_poly real polynomial in the packed form (n / 2 complex numbers)
+    /// @param n power of two, n >= 2
+    /// @param max_threads see forward_backward_fft()
+    /// @throws std::runtime_error if n is not a power of two or n < 2
+    PrecomputedOperand(const complex* const packed_poly, const size_t n, const size_t max_threads = 1)
+        : spectrum_(), n_(n) {
+        using fft::detail::private_impl;
+        THROW_IF_NOT(n >= 2 && private_impl::is_valid_polynomial_size(n));
+
+        const size_t half = n / 2;
+        spectrum_.reserve(half + 1);
+        spectrum_.assign(packed_poly, packed_poly + half);
+        spectrum_.emplace_back();
+        private_impl::ensure_roots_capacity(n);
+        private_impl::ensure_bit_reversal_table(half);
+        private_impl::parallel_forward_or_backward_fft</*IsBackwardFFT = */ false>(
+            spectrum_.data(), half, private_impl::parallel_fft_threads(half, max_threads));
+        private_impl::unpack_real_spectrum_inplace(spectrum_.data(), n);
+    }
+
+    /// @brief Size of the products (and of the polynomials) this operand can be multiplied by
+    [[nodiscard]] size_t size() const noexcept {
+        return n_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return n_ == 0;
+    }
+
+    /// @brief Multiplies real polynomial @a packed_poly (in the packed form, size() / 2 complex numbers)
+    ///         by this operand and stores the product (in the packed form too) into @a packed_poly
+    /// @note Product should fit into the size() coefficients
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    void multiply(complex* const packed_poly, const size_t max_threads = 1) const {
+        using fft::detail::private_impl;
+        assert(!empty());
+
+        const size_t half = n_ / 2;
+        const size_t threads = private_impl::parallel_fft_threads(half, max_threads);
+        private_impl::parallel_forward_or_backward_fft</*IsBackwardFFT = */ false>(packed_poly, half, threads);
+        private_impl::multiply_by_real_spectrum(packed_poly, spectrum_.data(), n_);
+        private_impl::parallel_forward_or_backward_fft</*IsBackwardFFT = */ true>(packed_poly, half, threads);
+    }
+
+private:
+    /// @brief FFT_n of the polynomial, only the first n / 2 + 1 values
+    ///         (the rest are their conjugates because the polynomial is real)
+    std::vector<complex> spectrum_{};
+    size_t n_ = 0;
+};
+
 #ifdef FFT_HAS_SPAN
 
 inline void forward_backward_fft(const std::span<complex> poly1, const std::span<complex> poly2) {
@@ -269,9 +1037,34 @@ inline void forward_backward_fft(const std::span<complex> poly1, const std::span
     forward_backward_fft(allocate_memory ? poly1_storage.data() : poly1.data(), poly2.data(), poly1.size());
 }
 
+inline void convolve_real(const std::span<const f64> a,
+                          const std::span<const f64> b,
+                          const std::span<f64> c,
+                          const size_t max_threads) {
+    if (unlikely(a.empty() || b.empty())) {
+        return;
+    }
+
+    THROW_IF(c.size() < a.size() + b.size() - 1);
+    convolve_real(a.data(), a.size(), b.data(), b.size(), c.data(), max_threads);
+}
+
+inline void convolve_real(const std::span<const std::int64_t> a,
+                          const std::span<const std::int64_t> b,
+                          const std::span<std::int64_t> c,
+                          const size_t max_threads) {
+    if (unlikely(a.empty() || b.empty())) {
+        return;
+    }
+
+    THROW_IF(c.size() < a.size() + b.size() - 1);
+    convolve_real(a.data(), a.size(), b.data(), b.size(), c.data(), max_threads);
+}
+
 #endif
 
 }  // namespace fft
 
+#undef FFT_HAS_X86_SIMD_KERNELS
 #undef FFT_HAS_SPAN
 #undef FFT_HAS_NUMBERS
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
+#include <climits>
 #include <cstdint>
 #include <exception>
+#include <limits>
 #include <numeric>
 #include <stdexcept>
+#include <type_traits>
 
 #include "../misc/config_macros.hpp"
 #include "integers_128_bit.hpp"
@@ -478,6 +482,256 @@ template <class T>
     return true;
 }
 
+/// @brief Returns n^-1 mod 2^k, where k is the bit width of T, for the odd n
+template <class T>
+[[nodiscard]] ATTRIBUTE_CONST I128_CONSTEXPR T inverse_mod_word(const T n) noexcept {
+    static_assert(std::is_same_v<T, uint64_t> || std::is_same_v<T, uint128_t>, "uint64_t or uint128_t expected");
+    CONFIG_ASSUME_STATEMENT(n % 2 == 1);
+
+    // n * n == 1 (mod 8) for the odd n, every Newton's step doubles the number of correct bits
+    T inverse = n;
+    for (uint32_t correct_bits = 3; correct_bits < sizeof(T) * CHAR_BIT; correct_bits *= 2) {
+        inverse *= T{2} - n * inverse;
+    }
+    return inverse;
+}
+
+/// @brief Returns (a * b) >> 128
+[[nodiscard]] ATTRIBUTE_CONST I128_CONSTEXPR uint128_t mul_high(const uint128_t a, const uint128_t b) noexcept {
+    const uint64_t a_low = static_cast<uint64_t>(a);
+    const uint64_t a_high = static_cast<uint64_t>(a >> 64U);
+    const uint64_t b_low = static_cast<uint64_t>(b);
+    const uint64_t b_high = static_cast<uint64_t>(b >> 64U);
+    const uint128_t low_low = uint128_t{a_low} * b_low;
+    const uint128_t low_high = uint128_t{a_low} * b_high;
+    const uint128_t high_low = uint128_t{a_high} * b_low;
+    const uint128_t high_high = uint128_t{a_high} * b_high;
+    // < 3 * 2^64
+    const uint128_t middle =
+        (low_low >> 64U) + uint128_t{static_cast<uint64_t>(low_high)} + uint128_t{static_cast<uint64_t>(high_low)};
+    return high_high + (low_high >> 64U) + (high_low >> 64U) + (middle >> 64U);
+}
+
+/**
+ * @brief Arithmetic modulo the odd n in the Montgomery form x * R mod n, R = 2^k,
+ *         where k is the bit width of T. All arguments and results are in [0; n).
+ *
+ * mul() is the REDC with the subtraction of m * n (m = t * n^-1 mod R) instead
+ * of the addition of m * (R - n^-1 mod R): the high halves of the products are
+ * both less than n, so the result never overflows T, even for n > R / 2.
+ *
+ * Any number coprime with n keeps its gcd with n in the Montgomery form, so
+ * the Pollard's rho can use the raw values without conversions.
+ */
+template <class T>
+class MontgomeryForm final {
+    static_assert(std::is_same_v<T, uint64_t> || std::is_same_v<T, uint128_t>, "uint64_t or uint128_t expected");
+
+public:
+    /// @param n odd number, n >= 3
+    I128_CONSTEXPR explicit MontgomeryForm(const T n) noexcept
+        : n_(n), n_inverse_(math_functions::detail::inverse_mod_word(n)) {
+        CONFIG_ASSUME_STATEMENT(n % 2 == 1);
+        CONFIG_ASSUME_STATEMENT(n >= 3);
+    }
+
+    [[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR T modulus() const noexcept {
+        return n_;
+    }
+
+    /// @brief Returns 1 in the Montgomery form, R mod n
+    [[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR T one() const noexcept {
+        return static_cast<T>(T{0} - n_) % n_;
+    }
+
+    /// @brief Returns R^2 mod n, mul(x, r_squared()) converts x < n to the Montgomery form
+    [[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR T r_squared() const noexcept {
+        const T r = one();
+        if constexpr (std::is_same_v<T, uint64_t>) {
+            return static_cast<uint64_t>((uint128_t{r} * r) % n_);
+        } else {
+            T r_squared = r;
+            for (uint32_t i = 0; i < sizeof(T) * CHAR_BIT; i++) {
+                r_squared = add(r_squared, r_squared);
+            }
+            return r_squared;
+        }
+    }
+
+    /// @brief Returns a * b * R^-1 mod n
+    [[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR T mul(const T a, const T b) const noexcept {
+        CONFIG_ASSUME_STATEMENT(a < n_);
+        CONFIG_ASSUME_STATEMENT(b < n_);
+        T low{};
+        T high{};
+        T mn_high{};
+        if constexpr (std::is_same_v<T, uint64_t>) {
+            const uint128_t ab = uint128_t{a} * b;
+            low = static_cast<uint64_t>(ab);
+            high = static_cast<uint64_t>(ab >> 64U);
+            const uint64_t m = low * n_inverse_;
+            mn_high = static_cast<uint64_t>((uint128_t{m} * n_) >> 64U);
+        } else {
+            low = a * b;
+            high = math_functions::detail::mul_high(a, b);
+            const uint128_t m = low * n_inverse_;
+            mn_high = math_functions::detail::mul_high(m, n_);
+        }
+        // Low halves of a * b and m * n are equal
+        const T res = high - mn_high;
+        return high >= mn_high ? res : res + n_;
+    }
+
+    [[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR T add(const T a, const T b) const noexcept {
+        CONFIG_ASSUME_STATEMENT(a < n_);
+        CONFIG_ASSUME_STATEMENT(b < n_);
+        const T n_minus_b = n_ - b;
+        return a >= n_minus_b ? a - n_minus_b : a + b;
+    }
+
+    [[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR T sub(const T a, const T b) const noexcept {
+        CONFIG_ASSUME_STATEMENT(a < n_);
+        CONFIG_ASSUME_STATEMENT(b < n_);
+        const T res = a - b;
+        return a >= b ? res : res + n_;
+    }
+
+    /// @brief Returns base^exp in the Montgomery form for the base in the Montgomery form
+    [[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR T pow(T base, T exp) const noexcept {
+        T res = one();
+        while (true) {
+            if (exp % 2 != 0) {
+                res = mul(res, base);
+            }
+            exp /= 2;
+            if (exp == 0) {
+                return res;
+            }
+            base = mul(base, base);
+        }
+    }
+
+private:
+    T n_;
+    T n_inverse_;
+};
+
+/// @brief Strong probable prime test to the base 2 (see is_strong_prp) in the Montgomery form
+template <class T>
+[[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR bool is_strong_prp_base_2_montgomery(const MontgomeryForm<T>& mont) noexcept {
+    const T n = mont.modulus();
+    CONFIG_ASSUME_STATEMENT(n % 2 == 1);
+    auto [q, r] = math_functions::extract_pow2(T{n - 1});
+    CONFIG_ASSUME_STATEMENT(r >= 1);
+
+    const T one = mont.one();
+    const T minus_one = n - one;
+    T test = mont.pow(mont.add(one, one), q);
+    if (test == one || test == minus_one) {
+        return true;
+    }
+    while (--r) {
+        test = mont.mul(test, test);
+        if (test == minus_one) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Strong Lucas probable prime test with P = 1 (see is_strong_lucas_prp) in the Montgomery form
+template <class T>
+[[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR bool is_strong_lucas_prp_p1_montgomery(const MontgomeryForm<T>& mont,
+                                                                        const int32_t q) noexcept {
+    const T n = mont.modulus();
+    CONFIG_ASSUME_STATEMENT(n % 2 == 1);
+
+    const T q_abs = T{math_functions::uabs(q)} % n;
+    const T q_abs_mont = mont.mul(q_abs, mont.r_squared());
+    const T widen_q = q >= 0 ? q_abs_mont : mont.sub(T{0}, q_abs_mont);
+
+    /* Jacobi symbol (D/n) is -1, so nmj = n + 1 */
+    const auto [s, r] = math_functions::extract_pow2(T{n + 1});
+    CONFIG_ASSUME_STATEMENT(r >= 1);
+
+    const T one = mont.one();
+    T uh = one;                  // U_1
+    T vl = mont.add(one, one);   // V_0
+    T vh = one;                  // V_1 = P
+    T ql = one;
+    T qh = one;
+    for (uint32_t j = math_functions::log2_floor(s); j != 0; j--) {
+        ql = mont.mul(ql, qh);
+        if (((s >> j) & 1U) != 0) {
+            qh = mont.mul(ql, widen_q);
+            uh = mont.mul(uh, vh);
+            vl = mont.sub(mont.mul(vh, vl), ql);
+            vh = mont.sub(mont.mul(vh, vh), mont.add(qh, qh));
+        } else {
+            qh = ql;
+            uh = mont.sub(mont.mul(uh, vl), ql);
+            vh = mont.sub(mont.mul(vh, vl), ql);
+            vl = mont.sub(mont.mul(vl, vl), mont.add(ql, ql));
+        }
+    }
+
+    ql = mont.mul(ql, qh);
+    qh = mont.mul(ql, widen_q);
+    uh = mont.sub(mont.mul(uh, vl), ql);
+    /* uh contains LucasU_s */
+    if (uh == 0) {
+        return true;
+    }
+
+    vl = mont.sub(mont.mul(vh, vl), ql);
+    /* vl contains LucasV_s */
+    if (vl == 0) {
+        return true;
+    }
+
+    ql = mont.mul(ql, qh);
+    for (uint32_t j = 1; j < r; j++) {
+        vl = mont.sub(mont.mul(vl, vl), mont.add(ql, ql));
+        if (vl == 0) {
+            return true;
+        }
+        ql = mont.mul(ql, ql);
+    }
+    return false;
+}
+
+/// @brief Strong Lucas-Selfridge probable prime test (see is_strong_selfridge_prp) in the Montgomery form
+template <class T>
+[[nodiscard]] ATTRIBUTE_PURE I128_CONSTEXPR bool is_strong_selfridge_prp_montgomery(const MontgomeryForm<T>& mont) noexcept {
+    const T n = mont.modulus();
+    using SignedT = math_functions::make_signed_t<T>;
+    constexpr int32_t kStep = 2;
+    for (int32_t d = 5;; d += (d > 0) ? kStep : -kStep, d = -d) {
+        constexpr int32_t kMaxD = 999'997;
+        switch (math_functions::kronecker_symbol(SignedT{d}, n)) {
+            case 0: {
+                return T{math_functions::uabs(d)} == n && n != 9;
+            }
+            case 1: {
+                if (unlikely(d == 13 && math_functions::is_perfect_square(n))) {
+                    return false;
+                }
+                if (unlikely(d > kMaxD)) {
+                    return false;
+                }
+                break;
+            }
+            case -1: {
+                return math_functions::detail::is_strong_lucas_prp_p1_montgomery(mont, (1 - d) / 4);
+            }
+            default: {
+                assert(false);
+                std::terminate();
+            }
+        }
+    }
+}
+
 }  // namespace detail
 
 /// @brief Complexity - O(log(n) ^ 2 * log(log(n))) ( O(log(n) ^ 3) bit
@@ -511,6 +765,34 @@ template <class T>
            math_functions::detail::is_strong_selfridge_prp_without_basic_checks(n);
 }
 
+/// @brief 128-bit is_prime_bpsw: the same strong probable prime test to the base 2 and
+///         strong Lucas-Selfridge test, in the Montgomery form for n >= 2^64
+/// @param n number to test
+/// @return true if n is prime and false otherwise
+template <class T, std::enable_if_t<std::is_same_v<T, uint128_t>, int> = 0>
+[[nodiscard]] ATTRIBUTE_CONST I128_CONSTEXPR bool is_prime_bpsw(const T n) noexcept {
+    if (n <= std::numeric_limits<uint64_t>::max()) {
+        return math_functions::is_prime_bpsw(static_cast<uint64_t>(n));
+    }
+    if (n % 2 == 0) {
+        return false;
+    }
+    // Two 128-bit divisions instead of 14
+    const auto rem1 = static_cast<uint32_t>(n % (3U * 5U * 7U * 11U * 13U * 17U * 19U * 23U));
+    if (rem1 % 3 == 0 || rem1 % 5 == 0 || rem1 % 7 == 0 || rem1 % 11 == 0 || rem1 % 13 == 0 || rem1 % 17 == 0 ||
+        rem1 % 19 == 0 || rem1 % 23 == 0) {
+        return false;
+    }
+    const auto rem2 = static_cast<uint32_t>(n % (29ULL * 31ULL * 37ULL * 41ULL * 43ULL * 47ULL));
+    if (rem2 % 29 == 0 || rem2 % 31 == 0 || rem2 % 37 == 0 || rem2 % 41 == 0 || rem2 % 43 == 0 || rem2 % 47 == 0) {
+        return false;
+    }
+
+    const math_functions::detail::MontgomeryForm<uint128_t> mont(n);
+    return math_functions::detail::is_strong_prp_base_2_montgomery(mont) &&
+           math_functions::detail::is_strong_selfridge_prp_montgomery(mont);
+}
+
 [[nodiscard]] ATTRIBUTE_CONST constexpr bool is_prime_sqrt(const uint32_t n) noexcept {
     return detail::is_prime_sqrt_impl(n);
 }
@@ -1,16 +1,22 @@
 // #define NDEBUG 1
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cinttypes>
+#include <climits>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <new>
+#include <numeric>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -19,17 +25,27 @@
 #include <vector>
 
 #include "../misc/config_macros.hpp"
+#include "../misc/thread_pool.hpp"
 
 #if CONFIG_HAS_AT_LEAST_CXX_20 && CONFIG_HAS_INCLUDE("../misc/join_strings.hpp")
 #define HAS_JOIN_STRINGS
 #include "../misc/join_strings.hpp"
 #endif
 #include "fft.hpp"
+#include "ntt.hpp"
 #if CONFIG_HAS_INCLUDE("integers_128_bit.hpp")
 #include "integers_128_bit.hpp"
 #endif
 #include "math_functions.hpp"
 
+// x86 intrinsics used by the CPU-specific kernels (carry_kernels, dec_str_kernels),
+// the kernels themselves are selected at runtime with the __builtin_cpu_supports
+#if defined(__x86_64__) && CONFIG_COMPILER_IS_GCC_OR_ANY_CLANG && !defined(_MSC_VER) && \
+    CONFIG_HAS_INCLUDE(<immintrin.h>)
+#include <immintrin.h>
+#define LONGINT_HAS_X86_SIMD_INTRINSICS
+#endif
+
 #if defined(ENABLE_LONGINT_DEBUG_ASSERTS) && ENABLE_LONGINT_DEBUG_ASSERTS
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
 #define LONGINT_DEBUG_ASSERT(expr) assert(expr)
@@ -67,10 +83,34 @@
 
 #define HAS_CUSTOM_LONGINT_ALLOCATOR
 
+/*
+ * Page allocator for the longint digits. It is compiled in with the GCC and Clang but
+ * longint uses it only if LONGINT_USE_CUSTOM_ALLOCATOR is defined before including this
+ * header (e.g. -DLONGINT_USE_CUSTOM_ALLOCATOR), otherwise the digits are allocated by
+ * the global operator new. The allocator is tested with longint in test_long_int_custom_allocator.cpp
+ */
 namespace longint_allocator {
 
 // #define DEBUG_LI_ALLOC_PRINTING 1
 
+/// @brief Snapshot of the allocator counters, see longint_allocator::GetStats()
+struct AllocatorStats final {
+    std::size_t total_small_pages;
+    std::size_t total_middle_pages;
+    /// @brief Number of times the page was handed out by the Allocate()
+    std::size_t small_pages_rented;
+    std::size_t middle_pages_rented;
+    std::size_t small_pages_in_use;
+    std::size_t middle_pages_in_use;
+    /// @brief Max number of the pages taken from the shared pool at once (in use or kept in the thread caches)
+    std::size_t max_small_pages_in_use;
+    std::size_t max_middle_pages_in_use;
+    /// @brief Allocations that did not fit into the pages (or happened when all the pages were in use)
+    std::size_t heap_allocations;
+    std::size_t heap_bytes_allocated;
+    std::size_t heap_allocations_in_use;
+};
+
 class inner_impl final {
 private:
     static constexpr std::size_t kPageMemoryOffsetInBytes = sizeof(void*);
@@ -96,156 +136,392 @@ private:
     static_assert(sizeof(MiddlePage) % alignof(MiddlePage) == 0);
     static_assert(sizeof(MiddlePage) == sizeof(MiddlePage::memory) + kPageMemoryOffsetInBytes, "");
 
-    static constexpr std::size_t kTotalSmallPages = 32;
-    static constexpr std::size_t kTotalMiddlePages = 8;
+    static constexpr std::size_t kDefaultTotalSmallPages = 32;
+    static constexpr std::size_t kDefaultTotalMiddlePages = 8;
+    /// @brief Max number of the free pages kept by one thread, the rest are returned to the global pool
+    static constexpr std::size_t kThreadCacheSmallPages = 8;
+    static constexpr std::size_t kThreadCacheMiddlePages = 2;
 
-#if defined(__cpp_constinit) && __cpp_constinit >= 201907L
-#define LI_ALLOC_CONSTINIT constinit
-#else
-#define LI_ALLOC_CONSTINIT
-#endif
+    /**
+     * @brief Fixed array of the pages with the lock-free (Treiber) stack of the free ones.
+     *        Stack head stores the index of the top page in the lower 32 bits and
+     *        the modification counter in the higher 32 bits (protects from the ABA problem).
+     */
+    template <class PageType>
+    class PagePool final {
+    public:
+        explicit PagePool(const std::size_t total_pages)
+            : pages_(total_pages > 0 ? new PageType[total_pages] : nullptr)
+            , next_indexes_(total_pages > 0 ? new std::atomic<std::uint32_t>[total_pages] : nullptr)
+            , total_pages_(static_cast<std::uint32_t>(total_pages))
+            , head_(total_pages > 0 ? std::uint64_t{0} : std::uint64_t{kNoPageIndex}) {
+            for (std::uint32_t i = 0; i < total_pages_; i++) {
+                next_indexes_[i].store(i + 1 < total_pages_ ? i + 1 : kNoPageIndex, std::memory_order_relaxed);
+            }
+        }
 
-    LI_ALLOC_CONSTINIT
-    static inline SmallPage first_small_page[kTotalSmallPages] = {};
-    LI_ALLOC_CONSTINIT
-    static inline MiddlePage first_middle_page[kTotalMiddlePages] = {};
+        PagePool(const PagePool&) = delete;
+        PagePool& operator=(const PagePool&) = delete;
+        PagePool(PagePool&&) = delete;
+        PagePool& operator=(PagePool&&) = delete;
+        ~PagePool() = default;
 
-    LI_ALLOC_CONSTINIT
-    static inline SmallPage* free_small_pages_head = std::addressof(first_small_page[0]);
-    LI_ALLOC_CONSTINIT
-    static inline MiddlePage* free_middle_pages_head = std::addressof(first_middle_page[0]);
+        [[nodiscard]] ATTRIBUTE_ALWAYS_INLINE bool Owns(const std::byte* const memory) const noexcept {
+            const auto mem_addr = reinterpret_cast<std::uintptr_t>(memory);
+            const auto first_page_addr = reinterpret_cast<std::uintptr_t>(pages_.get());
+            return mem_addr - first_page_addr < std::uintptr_t{total_pages_} * sizeof(PageType);
+        }
 
-#ifdef DEBUG_LI_ALLOC_PRINTING
-    LI_ALLOC_CONSTINIT static inline std::size_t total_small_pages_used = 0;
-    LI_ALLOC_CONSTINIT static inline std::int32_t current_small_pages_used = 0;
-    LI_ALLOC_CONSTINIT static inline std::int32_t max_small_pages_used = -(1 << 30);
-    LI_ALLOC_CONSTINIT static inline std::size_t total_middle_pages_used = 0;
-    LI_ALLOC_CONSTINIT static inline std::int32_t current_middle_pages_used = 0;
-    LI_ALLOC_CONSTINIT static inline std::int32_t max_middle_pages_used = -(1 << 30);
-    LI_ALLOC_CONSTINIT static inline std::size_t bytes_allocated = 0;
-    LI_ALLOC_CONSTINIT static inline std::int32_t malloc_free_count = 0;
-#endif
+        [[nodiscard]] std::size_t TotalPages() const noexcept {
+            return total_pages_;
+        }
 
-#undef LI_ALLOC_CONSTINIT
+        [[nodiscard]] std::size_t MaxTakenPages() const noexcept {
+            return max_taken_pages_.load(std::memory_order_relaxed);
+        }
 
-/**
- * VS Code intellisense: "attribute "constructor" does not take arguments
- * C/C++(1094)"
- */
-#if defined(__INTELLISENSE__) && __INTELLISENSE__
-#pragma diag_suppress 1094
-#endif
+        [[nodiscard]] PageType* Pop() noexcept {
+            std::uint64_t head = head_.load(std::memory_order_acquire);
+            while (true) {
+                const auto index = static_cast<std::uint32_t>(head);
+                if (index == kNoPageIndex) {
+                    return nullptr;
+                }
+                const std::uint64_t new_head =
+                    NextTag(head) | next_indexes_[index].load(std::memory_order_relaxed);
+                if (head_.compare_exchange_weak(head, new_head, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                    OnPageTaken();
+                    return std::addressof(pages_[index]);
+                }
+            }
+        }
 
-    __attribute__((constructor(101))) static inline void InitPages() noexcept {
-        const auto init_small_pages = []() noexcept {
-            SmallPage* p = first_small_page;
-            for (const SmallPage* last_page = p + kTotalSmallPages - 1; p != last_page;) {
-                SmallPage* p_next = p + 1;
-                p->next = p_next;
-                p = p_next;
+        void Push(PageType* const page) noexcept {
+            const auto index = static_cast<std::uint32_t>(page - pages_.get());
+            std::uint64_t head = head_.load(std::memory_order_relaxed);
+            std::uint64_t new_head{};
+            do {
+                next_indexes_[index].store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+                new_head = NextTag(head) | index;
+            } while (!head_.compare_exchange_weak(head, new_head, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+            taken_pages_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr std::uint32_t kNoPageIndex = std::numeric_limits<std::uint32_t>::max();
+
+        void OnPageTaken() noexcept {
+            const std::uint32_t taken = taken_pages_.fetch_add(1, std::memory_order_relaxed) + 1;
+            std::uint32_t max_taken = max_taken_pages_.load(std::memory_order_relaxed);
+            while (max_taken < taken &&
+                   !max_taken_pages_.compare_exchange_weak(max_taken, taken, std::memory_order_relaxed)) {
             }
-            p->next = nullptr;
-        };
-        const auto init_middle_pages = []() noexcept {
-            MiddlePage* p = first_middle_page;
-            for (const MiddlePage* p_iter_end = p + kTotalMiddlePages - 1; p != p_iter_end;) {
-                MiddlePage* p_next = p + 1;
-                p->next = p_next;
-                p = p_next;
-            }
-            p->next = nullptr;
-        };
-        init_small_pages();
-        init_middle_pages();
-#ifdef DEBUG_LI_ALLOC_PRINTING
-        printf("[INIT] Inited pages in %s\n", CONFIG_CURRENT_FUNCTION_NAME);
-#endif
+        }
+
+        [[nodiscard]] ATTRIBUTE_CONST static constexpr std::uint64_t NextTag(const std::uint64_t head) noexcept {
+            return ((head >> 32U) + 1) << 32U;
+        }
+
+        std::unique_ptr<PageType[]> pages_;
+        std::unique_ptr<std::atomic<std::uint32_t>[]> next_indexes_;
+        std::uint32_t total_pages_;
+        std::atomic<std::uint64_t> head_;
+        /// @brief Pages out of the pool (in use or in the thread caches), changed only by the Pop() and Push()
+        std::atomic<std::uint32_t> taken_pages_{};
+        std::atomic<std::uint32_t> max_taken_pages_{};
+    };
+
+    struct GlobalPools final {
+        PagePool<SmallPage> small_pages;
+        PagePool<MiddlePage> middle_pages;
+    };
+
+    inline static std::atomic<std::size_t> requested_small_pages{kDefaultTotalSmallPages};
+    inline static std::atomic<std::size_t> requested_middle_pages{kDefaultTotalMiddlePages};
+    inline static std::atomic<bool> pools_initialized{false};
+
+    [[nodiscard]] static GlobalPools& Pools() {
+        // Never destroyed so that the longints with static or thread storage duration
+        // may be safely deallocated at any point of the program termination
+        static GlobalPools* const pools = []() {
+            pools_initialized.store(true, std::memory_order_release);
+            return new GlobalPools{
+                PagePool<SmallPage>{requested_small_pages.load(std::memory_order_acquire)},
+                PagePool<MiddlePage>{requested_middle_pages.load(std::memory_order_acquire)},
+            };
+        }();
+        return *pools;
     }
 
-#ifdef DEBUG_LI_ALLOC_PRINTING
-    __attribute__((destructor(101))) static inline void DeinitPages() noexcept {
-        printf(
-            "[DEINIT] Deinited pages in %s\n"
-            "[SMALL]:\n"
-            "    total pages rented: %zu\n"
-            "    max pages allocated per one time: %d\n"
-            "    current pages allocated: %d\n"
-            "[MIDDLE]:\n"
-            "    total pages rented: %zu\n"
-            "    max pages allocated per one time: %d\n"
-            "    current pages allocated: %d\n"
-            "[MALLOC]:\n"
-            "    total bytes allocated: %zd\n"
-            "    malloc calls - free calls: %d\n",
-            CONFIG_CURRENT_FUNCTION_NAME, total_small_pages_used, max_small_pages_used, current_small_pages_used,
-            total_middle_pages_used, max_middle_pages_used, current_middle_pages_used, bytes_allocated,
-            malloc_free_count);
+    template <class PageType>
+    struct ThreadCache final {
+        PageType* head = nullptr;
+        std::size_t size = 0;
+    };
+
+    enum Counter : std::size_t {
+        kSmallPagesRented,
+        kSmallPagesReturned,
+        kMiddlePagesRented,
+        kMiddlePagesReturned,
+        kHeapAllocations,
+        kHeapDeallocations,
+        kHeapBytesAllocated,
+        kCountersSize,
+    };
+
+    using CounterValues = std::array<std::size_t, kCountersSize>;
+
+    /// @brief Counters of one thread. They are changed only by their thread (without the
+    ///         read-modify-write operations on the shared cache lines) and summed by the GetStats()
+    struct alignas(64) ThreadCounters final {
+        std::array<std::atomic<std::size_t>, kCountersSize> values{};
+        /// @brief Links of the CountersRegistry list, guarded by its mutex
+        ThreadCounters* prev = nullptr;
+        ThreadCounters* next = nullptr;
+    };
+
+    struct CountersRegistry final {
+        std::mutex mutex{};
+        /// @brief Counters of the running threads
+        ThreadCounters* head = nullptr;
+        /// @brief Sums of the counters of the finished threads
+        CounterValues finished_threads{};
+    };
+
+    [[nodiscard]] static CountersRegistry& Registry() {
+        // Never destroyed, like the pools
+        static CountersRegistry* const registry = new CountersRegistry{};
+        return *registry;
     }
-#endif
 
-    template <class PageType, std::size_t TotalPages>
-    ATTRIBUTE_ALWAYS_INLINE static bool IsPage(const std::byte* memory, const PageType (&pages_array)[TotalPages]) {
-        const auto mem_addr = reinterpret_cast<std::uintptr_t>(memory);
-        const auto first_page_addr = reinterpret_cast<std::uintptr_t>(std::addressof(pages_array[0]));
-        return mem_addr - first_page_addr < TotalPages * sizeof(PageType);
+    /// @brief Free pages owned by the current thread, returned to the global pools on the thread exit
+    struct ThreadCaches final {
+        ThreadCache<SmallPage> small_pages;
+        ThreadCache<MiddlePage> middle_pages;
+        ThreadCounters counters;
+
+        ThreadCaches() noexcept : small_pages(), middle_pages(), counters() {
+            CountersRegistry& registry = Registry();
+            const std::lock_guard lock{registry.mutex};
+            counters.next = registry.head;
+            if (registry.head != nullptr) {
+                registry.head->prev = &counters;
+            }
+            registry.head = &counters;
+        }
+        ThreadCaches(const ThreadCaches&) = delete;
+        ThreadCaches& operator=(const ThreadCaches&) = delete;
+        ThreadCaches(ThreadCaches&&) = delete;
+        ThreadCaches& operator=(ThreadCaches&&) = delete;
+
+        ~ThreadCaches() {
+            thread_caches_destroyed = true;
+            GlobalPools& pools = Pools();
+            ReleaseAll(small_pages, pools.small_pages);
+            ReleaseAll(middle_pages, pools.middle_pages);
+
+            CountersRegistry& registry = Registry();
+            const std::lock_guard lock{registry.mutex};
+            for (std::size_t i = 0; i < kCountersSize; i++) {
+                registry.finished_threads[i] += counters.values[i].load(std::memory_order_relaxed);
+            }
+            (counters.prev != nullptr ? counters.prev->next : registry.head) = counters.next;
+            if (counters.next != nullptr) {
+                counters.next->prev = counters.prev;
+            }
+        }
+
+        template <class PageType>
+        static void ReleaseAll(ThreadCache<PageType>& cache, PagePool<PageType>& pool) noexcept {
+            for (PageType* page = cache.head; page != nullptr;) {
+                PageType* const next = page->next;
+                pool.Push(page);
+                page = next;
+            }
+            cache.head = nullptr;
+            cache.size = 0;
+        }
+    };
+
+    /// @brief Set in the ~ThreadCaches(), after that pages freed by the
+    ///         current thread go straight to the global pools
+    inline static thread_local bool thread_caches_destroyed = false;
+
+    [[nodiscard]] static ThreadCaches& GetThreadCaches() noexcept {
+        thread_local ThreadCaches caches;
+        return caches;
     }
 
-    [[nodiscard]]
-    ATTRIBUTE_ALWAYS_INLINE static bool IsSmallPage(const std::byte* offset_memory) noexcept {
-        return inner_impl::IsPage(offset_memory, first_small_page);
+    template <class PageType>
+    [[nodiscard]] ATTRIBUTE_ALWAYS_INLINE static PageType* RentPage(PagePool<PageType>& pool,
+                                                                    ThreadCache<PageType>& cache) noexcept {
+        if (PageType* const page = cache.head; page != nullptr) {
+            cache.head = page->next;
+            cache.size--;
+            return page;
+        }
+        return pool.Pop();
     }
 
-    [[nodiscard]]
-    ATTRIBUTE_ALWAYS_INLINE static bool IsMiddlePage(const std::byte* offset_memory) noexcept {
-        return inner_impl::IsPage(offset_memory, first_middle_page);
+    template <class PageType>
+    ATTRIBUTE_ALWAYS_INLINE static void ReturnPage(PageType* const page,
+                                                   PagePool<PageType>& pool,
+                                                   const std::size_t max_cache_size) noexcept {
+        if (unlikely(thread_caches_destroyed)) {
+            pool.Push(page);
+            return;
+        }
+
+        ThreadCache<PageType>& cache = []() noexcept -> ThreadCache<PageType>& {
+            if constexpr (std::is_same_v<PageType, SmallPage>) {
+                return GetThreadCaches().small_pages;
+            } else {
+                return GetThreadCaches().middle_pages;
+            }
+        }();
+        if (cache.size >= max_cache_size) {
+            pool.Push(page);
+            return;
+        }
+        page->next = cache.head;
+        cache.head = page;
+        cache.size++;
+    }
+
+    ATTRIBUTE_ALWAYS_INLINE static void Count(const Counter counter, const std::size_t value = 1) noexcept {
+        if (likely(!thread_caches_destroyed)) {
+            // Only the current thread changes its counters, so the load and store are not torn apart
+            std::atomic<std::size_t>& thread_counter = GetThreadCaches().counters.values[counter];
+            thread_counter.store(thread_counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            return;
+        }
+
+        CountersRegistry& registry = Registry();
+        const std::lock_guard lock{registry.mutex};
+        registry.finished_threads[counter] += value;
+    }
+
+    [[nodiscard]] static CounterValues SumCounters() {
+        CountersRegistry& registry = Registry();
+        const std::lock_guard lock{registry.mutex};
+        CounterValues sums = registry.finished_threads;
+        for (const ThreadCounters* thread_counters = registry.head; thread_counters != nullptr;
+             thread_counters = thread_counters->next) {
+            for (std::size_t i = 0; i < kCountersSize; i++) {
+                sums[i] += thread_counters->values[i].load(std::memory_order_relaxed);
+            }
+        }
+        return sums;
     }
 
+#ifdef DEBUG_LI_ALLOC_PRINTING
+    __attribute__((destructor(101))) static inline void PrintStats() noexcept;
+#endif
+
+    friend inline bool SetPoolSizes(std::size_t total_small_pages, std::size_t total_middle_pages) noexcept;
+    friend inline AllocatorStats GetStats();
     friend inline void* Allocate(std::size_t size);
     friend inline void Deallocate(void* memory) noexcept;
 };
 
+/**
+ * @brief Sets the number of the small (120 bytes) and middle (1016 bytes) pages shared by all the threads.
+ * @note Takes effect only if called before the first allocation by the longint_allocator.
+ * @return true if the sizes were applied and false if the pools are already in use
+ */
+inline bool SetPoolSizes(const std::size_t total_small_pages, const std::size_t total_middle_pages) noexcept {
+    if (inner_impl::pools_initialized.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    constexpr std::size_t kMaxPages = std::numeric_limits<std::uint32_t>::max() - 1;
+    inner_impl::requested_small_pages.store(std::min(total_small_pages, kMaxPages), std::memory_order_release);
+    inner_impl::requested_middle_pages.store(std::min(total_middle_pages, kMaxPages), std::memory_order_release);
+    return !inner_impl::pools_initialized.load(std::memory_order_acquire);
+}
+
+/// @brief Returns allocator counters summed over all the threads. Every thread updates
+///         only its own counters, so the snapshot may be slightly inconsistent
+///         while other threads are allocating.
+[[nodiscard]] inline AllocatorStats GetStats() {
+    using Counter = inner_impl::Counter;
+    const inner_impl::CounterValues counters = inner_impl::SumCounters();
+    const bool initialized = inner_impl::pools_initialized.load(std::memory_order_acquire);
+    // Page may be returned by another thread, so only the sums of the rented and returned pages match
+    return AllocatorStats{
+        /* total_small_pages = */ initialized ? inner_impl::Pools().small_pages.TotalPages() : 0,
+        /* total_middle_pages = */ initialized ? inner_impl::Pools().middle_pages.TotalPages() : 0,
+        /* small_pages_rented = */ counters[Counter::kSmallPagesRented],
+        /* middle_pages_rented = */ counters[Counter::kMiddlePagesRented],
+        /* small_pages_in_use = */ counters[Counter::kSmallPagesRented] - counters[Counter::kSmallPagesReturned],
+        /* middle_pages_in_use = */ counters[Counter::kMiddlePagesRented] - counters[Counter::kMiddlePagesReturned],
+        /* max_small_pages_in_use = */ initialized ? inner_impl::Pools().small_pages.MaxTakenPages() : 0,
+        /* max_middle_pages_in_use = */ initialized ? inner_impl::Pools().middle_pages.MaxTakenPages() : 0,
+        /* heap_allocations = */ counters[Counter::kHeapAllocations],
+        /* heap_bytes_allocated = */ counters[Counter::kHeapBytesAllocated],
+        /* heap_allocations_in_use = */ counters[Counter::kHeapAllocations] - counters[Counter::kHeapDeallocations],
+    };
+}
+
+#ifdef DEBUG_LI_ALLOC_PRINTING
+inline void inner_impl::PrintStats() noexcept {
+    const AllocatorStats stats = GetStats();
+    printf(
+        "[DEINIT] Allocator stats in %s\n"
+        "[SMALL]:\n"
+        "    total pages rented: %zu\n"
+        "    max pages allocated per one time: %zu\n"
+        "    current pages allocated: %zu\n"
+        "[MIDDLE]:\n"
+        "    total pages rented: %zu\n"
+        "    max pages allocated per one time: %zu\n"
+        "    current pages allocated: %zu\n"
+        "[MALLOC]:\n"
+        "    total bytes allocated: %zu\n"
+        "    malloc calls - free calls: %zu\n",
+        CONFIG_CURRENT_FUNCTION_NAME, stats.small_pages_rented, stats.max_small_pages_in_use,
+        stats.small_pages_in_use, stats.middle_pages_rented, stats.max_middle_pages_in_use,
+        stats.middle_pages_in_use, stats.heap_bytes_allocated, stats.heap_allocations_in_use);
+}
+#endif
+
 inline void Deallocate(void* const memory) noexcept {
     if (unlikely(memory == nullptr)) {
         return;
     }
 
     std::byte* const p = static_cast<std::byte*>(memory);
+    if (likely(inner_impl::pools_initialized.load(std::memory_order_acquire))) {
+        inner_impl::GlobalPools& pools = inner_impl::Pools();
 
 #if CONFIG_COMPILER_ID == CONFIG_GCC_COMPILER_ID
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wcast-align"
 #endif
 
-    if (inner_impl::IsSmallPage(p)) {
-#ifdef DEBUG_LI_ALLOC_PRINTING
-        inner_impl::current_small_pages_used--;
-        assert(inner_impl::current_small_pages_used >= 0);
-#endif
-        auto* page = reinterpret_cast<inner_impl::SmallPage*>(p);
-        page->next = inner_impl::free_small_pages_head;
-        inner_impl::free_small_pages_head = page;
-        return;
-    }
+        if (pools.small_pages.Owns(p)) {
+            inner_impl::Count(inner_impl::kSmallPagesReturned);
+            inner_impl::ReturnPage(reinterpret_cast<inner_impl::SmallPage*>(p), pools.small_pages,
+                                   inner_impl::kThreadCacheSmallPages);
+            return;
+        }
 
-    if (inner_impl::IsMiddlePage(p)) {
-#ifdef DEBUG_LI_ALLOC_PRINTING
-        inner_impl::current_middle_pages_used--;
-        assert(inner_impl::current_middle_pages_used >= 0);
-#endif
-        auto* page = reinterpret_cast<inner_impl::MiddlePage*>(p);
-        page->next = inner_impl::free_middle_pages_head;
-        inner_impl::free_middle_pages_head = page;
-        return;
-    }
+        if (pools.middle_pages.Owns(p)) {
+            inner_impl::Count(inner_impl::kMiddlePagesReturned);
+            inner_impl::ReturnPage(reinterpret_cast<inner_impl::MiddlePage*>(p), pools.middle_pages,
+                                   inner_impl::kThreadCacheMiddlePages);
+            return;
+        }
 
 #if CONFIG_COMPILER_ID == CONFIG_GCC_COMPILER_ID
 #pragma GCC diagnostic pop
 #endif
+    }
 
-#ifdef DEBUG_LI_ALLOC_PRINTING
-    inner_impl::malloc_free_count--;
-    assert(inner_impl::malloc_free_count >= 0);
-#endif
+    inner_impl::Count(inner_impl::kHeapDeallocations);
     ::operator delete(memory);
 }
 
@@ -264,37 +540,25 @@ inline void Deallocate(void* const memory) noexcept {
 #endif
 #endif
 ATTRIBUTE_RETURNS_NONNULL ATTRIBUTE_ALLOC_SIZE(1) INLINE_LONGINT_ALLOCATE void* Allocate(const std::size_t size) {
-    if (size <= inner_impl::SmallPage::kCapacity && inner_impl::free_small_pages_head != nullptr) {
-        inner_impl::SmallPage* p = inner_impl::free_small_pages_head;
-#ifdef DEBUG_LI_ALLOC_PRINTING
-        inner_impl::current_small_pages_used++;
-        if (inner_impl::current_small_pages_used > inner_impl::max_small_pages_used) {
-            inner_impl::max_small_pages_used = inner_impl::current_small_pages_used;
+    if (size <= inner_impl::MiddlePage::kCapacity && likely(!inner_impl::thread_caches_destroyed)) {
+        inner_impl::GlobalPools& pools = inner_impl::Pools();
+        inner_impl::ThreadCaches& caches = inner_impl::GetThreadCaches();
+        if (size <= inner_impl::SmallPage::kCapacity) {
+            if (inner_impl::SmallPage* const p = inner_impl::RentPage(pools.small_pages, caches.small_pages)) {
+                inner_impl::Count(inner_impl::kSmallPagesRented);
+                return static_cast<void*>(std::addressof(p->memory[0]));
+            }
         }
-        inner_impl::total_small_pages_used++;
-#endif
-        inner_impl::free_small_pages_head = p->next;
-        return static_cast<void*>(std::addressof(p->memory[0]));
-    }
 
-    if (size <= inner_impl::MiddlePage::kCapacity && inner_impl::free_middle_pages_head != nullptr) {
-        inner_impl::MiddlePage* p = inner_impl::free_middle_pages_head;
-#ifdef DEBUG_LI_ALLOC_PRINTING
-        inner_impl::current_middle_pages_used++;
-        if (inner_impl::current_middle_pages_used > inner_impl::max_middle_pages_used) {
-            inner_impl::max_middle_pages_used = inner_impl::current_middle_pages_used;
+        if (inner_impl::MiddlePage* const p = inner_impl::RentPage(pools.middle_pages, caches.middle_pages)) {
+            inner_impl::Count(inner_impl::kMiddlePagesRented);
+            return static_cast<void*>(std::addressof(p->memory[0]));
         }
-        inner_impl::total_middle_pages_used++;
-#endif
-        inner_impl::free_middle_pages_head = p->next;
-        return static_cast<void*>(std::addressof(p->memory[0]));
     }
 
     void* const p = ::operator new(size);
-#ifdef DEBUG_LI_ALLOC_PRINTING
-    inner_impl::bytes_allocated += static_cast<std::size_t>(size);
-    inner_impl::malloc_free_count++;
-#endif
+    inner_impl::Count(inner_impl::kHeapAllocations);
+    inner_impl::Count(inner_impl::kHeapBytesAllocated, size);
     return p;
 }
 
@@ -309,10 +573,349 @@ ATTRIBUTE_RETURNS_NONNULL ATTRIBUTE_ALLOC_SIZE(1) INLINE_LONGINT_ALLOCATE void*
 
 #endif
 
+namespace longint_detail {
+
+/**
+ * @brief Carry propagation and bit shift loops over the 32-bit digits of the longint.
+ *         On x86-64 the sums and differences run on the pairs of digits as 64-bit limbs
+ *         with the adc/sbb chain, the shifts process 8 digits
+ *         per AVX2 instruction. Kernels are selected at runtime by the CPU features.
+ */
+class carry_kernels final {
+public:
+    using digit_t = std::uint32_t;
+    using size_type = std::uint32_t;
+
+    static constexpr std::uint32_t kDigitBits = 32;
+
+    struct kernels_table final {
+        bool (*add_n)(digit_t* lhs, const digit_t* rhs, size_type n) noexcept;
+        bool (*sub_n)(digit_t* lhs, const digit_t* rhs, size_type n) noexcept;
+        void (*shift_left)(digit_t* nums, size_type n, std::uint32_t shift) noexcept;
+        void (*shift_right)(digit_t* nums, size_type n, std::uint32_t shift) noexcept;
+    };
+
+    /// @brief Kernels for the current CPU, selected at runtime on the first call
+    [[nodiscard]] static const kernels_table& kernels() noexcept {
+        static const kernels_table selected_kernels = select_kernels();
+        return selected_kernels;
+    }
+
+    /// @brief Portable kernels, used in the constant evaluation and on the CPUs without the extensions
+    [[nodiscard]] static constexpr kernels_table default_kernels() noexcept {
+        return kernels_table{&add_n_default, &sub_n_default, &shift_left_default, &shift_right_default};
+    }
+
+    /// @brief lhs[0..n) += rhs[0..n)
+    /// @return carry out of the lhs[n - 1]
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static constexpr bool add_n_default(digit_t* const lhs, const digit_t* const rhs, const size_type n) noexcept {
+        std::uint64_t carry = 0;
+        for (size_type i = 0; i < n; i++) {
+            const std::uint64_t res = std::uint64_t{lhs[i]} + std::uint64_t{rhs[i]} + carry;
+            lhs[i] = static_cast<digit_t>(res);
+            carry = res >> kDigitBits;
+        }
+        return carry != 0;
+    }
+
+    /// @brief lhs[0..n) -= rhs[0..n)
+    /// @return borrow out of the lhs[n - 1]
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static constexpr bool sub_n_default(digit_t* const lhs, const digit_t* const rhs, const size_type n) noexcept {
+        bool borrow = false;
+        for (size_type i = 0; i < n; i++) {
+            const digit_t lhs_val = lhs[i];
+            const auto sub_val = std::uint64_t{rhs[i]} + std::uint64_t{borrow};
+            lhs[i] = lhs_val - static_cast<digit_t>(sub_val);
+            borrow = lhs_val < sub_val;
+        }
+        return borrow;
+    }
+
+    /// @brief nums[0..n) <<= shift, bits shifted out of the nums[n - 1] are lost, 0 < shift < 32
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static constexpr void shift_left_default(digit_t* const nums, const size_type n, const std::uint32_t shift) noexcept {
+        for (size_type i = n; i > 1; i--) {
+            nums[i - 1] = (nums[i - 1] << shift) | (nums[i - 2] >> (kDigitBits - shift));
+        }
+        if (n > 0) {
+            nums[0] <<= shift;
+        }
+    }
+
+    /// @brief nums[0..n) >>= shift, 0 < shift < 32
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static constexpr void shift_right_default(digit_t* const nums, const size_type n, const std::uint32_t shift) noexcept {
+        for (size_type i = 0; i + 1 < n; i++) {
+            nums[i] = (nums[i] >> shift) | (nums[i + 1] << (kDigitBits - shift));
+        }
+        if (n > 0) {
+            nums[n - 1] >>= shift;
+        }
+    }
+
+private:
+#if defined(LONGINT_HAS_X86_SIMD_INTRINSICS)
+
+    ATTRIBUTE_ALWAYS_INLINE static std::uint64_t load_u64(const digit_t* const p) noexcept {
+        std::uint64_t value{};
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    ATTRIBUTE_ALWAYS_INLINE static void store_u64(digit_t* const p, const std::uint64_t value) noexcept {
+        std::memcpy(p, &value, sizeof(value));
+    }
+
+    /// @brief Same as add_n_default(), but adds the pairs of digits as the 64-bit limbs
+    ///         (digits are little endian on x86) with the carry chain unrolled 4 times.
+    /// @note There is no ADX version: the sum has a single carry chain, so the second
+    ///        flag chain of the adcx / adox has nothing to carry
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static bool add_n_adc(digit_t* const lhs, const digit_t* const rhs, const size_type n) noexcept {
+        unsigned char carry = 0;
+        size_type i = 0;
+        for (; i + 8 <= n; i += 8) {
+            unsigned long long s0{}, s1{}, s2{}, s3{};
+            carry = _addcarry_u64(carry, load_u64(lhs + i), load_u64(rhs + i), &s0);
+            carry = _addcarry_u64(carry, load_u64(lhs + i + 2), load_u64(rhs + i + 2), &s1);
+            carry = _addcarry_u64(carry, load_u64(lhs + i + 4), load_u64(rhs + i + 4), &s2);
+            carry = _addcarry_u64(carry, load_u64(lhs + i + 6), load_u64(rhs + i + 6), &s3);
+            store_u64(lhs + i, s0);
+            store_u64(lhs + i + 2, s1);
+            store_u64(lhs + i + 4, s2);
+            store_u64(lhs + i + 6, s3);
+        }
+        for (; i + 2 <= n; i += 2) {
+            unsigned long long s{};
+            carry = _addcarry_u64(carry, load_u64(lhs + i), load_u64(rhs + i), &s);
+            store_u64(lhs + i, s);
+        }
+        if (i < n) {
+            unsigned int s{};
+            carry = _addcarry_u32(carry, lhs[i], rhs[i], &s);
+            lhs[i] = s;
+        }
+        return carry != 0;
+    }
+
+    /// @brief Same as sub_n_default(), but subtracts the pairs of digits as the 64-bit limbs
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static bool sub_n_sbb(digit_t* const lhs, const digit_t* const rhs, const size_type n) noexcept {
+        unsigned char borrow = 0;
+        size_type i = 0;
+        for (; i + 8 <= n; i += 8) {
+            unsigned long long d0{}, d1{}, d2{}, d3{};
+            borrow = _subborrow_u64(borrow, load_u64(lhs + i), load_u64(rhs + i), &d0);
+            borrow = _subborrow_u64(borrow, load_u64(lhs + i + 2), load_u64(rhs + i + 2), &d1);
+            borrow = _subborrow_u64(borrow, load_u64(lhs + i + 4), load_u64(rhs + i + 4), &d2);
+            borrow = _subborrow_u64(borrow, load_u64(lhs + i + 6), load_u64(rhs + i + 6), &d3);
+            store_u64(lhs + i, d0);
+            store_u64(lhs + i + 2, d1);
+            store_u64(lhs + i + 4, d2);
+            store_u64(lhs + i + 6, d3);
+        }
+        for (; i + 2 <= n; i += 2) {
+            unsigned long long d{};
+            borrow = _subborrow_u64(borrow, load_u64(lhs + i), load_u64(rhs + i), &d);
+            store_u64(lhs + i, d);
+        }
+        if (i < n) {
+            unsigned int d{};
+            borrow = _subborrow_u32(borrow, lhs[i], rhs[i], &d);
+            lhs[i] = d;
+        }
+        return borrow != 0;
+    }
+
+    ATTRIBUTE_TARGET("avx2")
+    ATTRIBUTE_ALWAYS_INLINE static __m256i load_avx2(const digit_t* const p) noexcept {
+        return _mm256_loadu_si256(static_cast<const __m256i*>(static_cast<const void*>(p)));
+    }
+
+    ATTRIBUTE_TARGET("avx2")
+    ATTRIBUTE_ALWAYS_INLINE static void store_avx2(digit_t* const p, const __m256i value) noexcept {
+        _mm256_storeu_si256(static_cast<__m256i*>(static_cast<void*>(p)), value);
+    }
+
+    /// @brief Same as shift_left_default(), goes from the highest digits to the lowest ones,
+    ///         so every block of 8 digits reads the next lower digit before it is overwritten
+    ATTRIBUTE_TARGET("avx2")
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void shift_left_avx2(digit_t* const nums, const size_type n, const std::uint32_t shift) noexcept {
+        const __m128i left_shift = _mm_cvtsi32_si128(static_cast<int>(shift));
+        const __m128i right_shift = _mm_cvtsi32_si128(static_cast<int>(kDigitBits - shift));
+        size_type i = n;
+        for (; i >= 9; i -= 8) {
+            const __m256i current = load_avx2(nums + i - 8);
+            const __m256i lower = load_avx2(nums + i - 9);
+            store_avx2(nums + i - 8,
+                       _mm256_or_si256(_mm256_sll_epi32(current, left_shift), _mm256_srl_epi32(lower, right_shift)));
+        }
+        shift_left_default(nums, i, shift);
+    }
+
+    /// @brief Same as shift_right_default(), goes from the lowest digits to the highest ones
+    ATTRIBUTE_TARGET("avx2")
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void shift_right_avx2(digit_t* const nums, const size_type n, const std::uint32_t shift) noexcept {
+        const __m128i right_shift = _mm_cvtsi32_si128(static_cast<int>(shift));
+        const __m128i left_shift = _mm_cvtsi32_si128(static_cast<int>(kDigitBits - shift));
+        size_type i = 0;
+        for (; i + 9 <= n; i += 8) {
+            const __m256i current = load_avx2(nums + i);
+            const __m256i higher = load_avx2(nums + i + 1);
+            store_avx2(nums + i,
+                       _mm256_or_si256(_mm256_srl_epi32(current, right_shift), _mm256_sll_epi32(higher, left_shift)));
+        }
+        shift_right_default(nums + i, n - i, shift);
+    }
+
+#endif
+
+    [[nodiscard]] static kernels_table select_kernels() noexcept {
+        kernels_table table = default_kernels();
+#if defined(LONGINT_HAS_X86_SIMD_INTRINSICS)
+        __builtin_cpu_init();
+        table.add_n = &add_n_adc;
+        table.sub_n = &sub_n_sbb;
+        if (__builtin_cpu_supports("avx2")) {
+            table.shift_left = &shift_left_avx2;
+            table.shift_right = &shift_right_avx2;
+        }
+#endif
+        return table;
+    }
+};
+
+/**
+ * @brief Packing of the decimal string into the base 10^9 digits.
+ *         On x86-64 last 8 chars of every 9 chars block are combined by the pmaddubsw / pmaddwd
+ *         (2 blocks per SSE4.1 iteration, 4 blocks per AVX2 iteration), first char is added separately.
+ */
+class dec_str_kernels final {
+public:
+    using digit_t = std::uint32_t;
+
+    static constexpr std::uint32_t kBlockDigits = 9;
+
+    /// @brief Packs @a blocks blocks of kBlockDigits decimal chars at the @a str into the
+    ///         out_end[-1], out_end[-2], ..., out_end[-blocks] (first block goes to the out_end[-1])
+    using pack_function = void (*)(const unsigned char* str, std::size_t blocks, digit_t* out_end) noexcept;
+
+    /// @brief Kernel for the current CPU, selected at runtime on the first call
+    [[nodiscard]] static pack_function pack() noexcept {
+        static const pack_function selected_kernel = select_kernel();
+        return selected_kernel;
+    }
+
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void pack_default(const unsigned char* str, std::size_t blocks, digit_t* out_end) noexcept {
+        for (; blocks > 0; blocks--, str += kBlockDigits) {
+            static_assert(kBlockDigits == 9);
+            std::uint32_t current = std::uint32_t{str[0]} - '0';
+            current = current * 10 + std::uint32_t{str[1]} - '0';
+            current = current * 10 + std::uint32_t{str[2]} - '0';
+            current = current * 10 + std::uint32_t{str[3]} - '0';
+            current = current * 10 + std::uint32_t{str[4]} - '0';
+            current = current * 10 + std::uint32_t{str[5]} - '0';
+            current = current * 10 + std::uint32_t{str[6]} - '0';
+            current = current * 10 + std::uint32_t{str[7]} - '0';
+            current = current * 10 + std::uint32_t{str[8]} - '0';
+            *--out_end = current;
+        }
+    }
+
+private:
+#if defined(LONGINT_HAS_X86_SIMD_INTRINSICS)
+
+    static constexpr std::uint32_t kFirstCharMultiplier = 100'000'000;
+
+    ATTRIBUTE_ALWAYS_INLINE static long long load_i64(const unsigned char* const p) noexcept {
+        long long value{};
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    /// @brief 8 decimal chars in every 64-bit lane (first char in the lowest byte) => 8 digits number
+    ///         in the lowest 32 bits of the lane (mod 2^64)
+    ATTRIBUTE_TARGET("sse4.1")
+    ATTRIBUTE_ALWAYS_INLINE static __m128i pack_8_chars_sse41(const __m128i chars) noexcept {
+        const __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        // 10 * d_{2i} + d_{2i + 1} in the 16-bit lanes
+        const __m128i pairs = _mm_maddubs_epi16(digits, _mm_set1_epi16(0x010A));
+        // 100 * p_{2i} + p_{2i + 1} in the 32-bit lanes
+        const __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00010064));
+        // 10000 * q_{2i} + q_{2i + 1}, quads are < 10^4 and fit into the 16-bit lanes
+        const __m128i packed_quads = _mm_packus_epi32(quads, _mm_setzero_si128());
+        return _mm_madd_epi16(packed_quads, _mm_set1_epi32(0x00012710));
+    }
+
+    ATTRIBUTE_TARGET("sse4.1")
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void pack_sse41(const unsigned char* str, std::size_t blocks, digit_t* out_end) noexcept {
+        for (; blocks >= 2; blocks -= 2, str += 2 * kBlockDigits, out_end -= 2) {
+            const __m128i chars = _mm_set_epi64x(load_i64(str + kBlockDigits + 1), load_i64(str + 1));
+            const __m128i lows = pack_8_chars_sse41(chars);
+            out_end[-1] = static_cast<digit_t>(_mm_cvtsi128_si32(lows)) +
+                          (std::uint32_t{str[0]} - '0') * kFirstCharMultiplier;
+            out_end[-2] = static_cast<digit_t>(_mm_extract_epi32(lows, 1)) +
+                          (std::uint32_t{str[kBlockDigits]} - '0') * kFirstCharMultiplier;
+        }
+        pack_default(str, blocks, out_end);
+    }
+
+    ATTRIBUTE_TARGET("avx2")
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void pack_avx2(const unsigned char* str, std::size_t blocks, digit_t* out_end) noexcept {
+        for (; blocks >= 4; blocks -= 4, str += 4 * kBlockDigits, out_end -= 4) {
+            const __m256i chars =
+                _mm256_setr_epi64x(load_i64(str + 1), load_i64(str + kBlockDigits + 1),
+                                   load_i64(str + 2 * kBlockDigits + 1), load_i64(str + 3 * kBlockDigits + 1));
+            const __m256i digits = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+            const __m256i pairs = _mm256_maddubs_epi16(digits, _mm256_set1_epi16(0x010A));
+            const __m256i quads = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00010064));
+            // packus works inside the 128-bit lanes: blocks 0, 1 go to the 32-bit lanes 0, 1 and blocks 2, 3 to 4, 5
+            const __m256i packed_quads = _mm256_packus_epi32(quads, _mm256_setzero_si256());
+            const __m256i lows = _mm256_madd_epi16(packed_quads, _mm256_set1_epi32(0x00012710));
+            // Reversed order of the blocks: out_end[-4] = block 3, ..., out_end[-1] = block 0
+            const __m128i reversed_lows =
+                _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(lows, _mm256_setr_epi32(5, 4, 1, 0, 0, 0, 0, 0)));
+            const __m128i first_chars = _mm_sub_epi32(
+                _mm_setr_epi32(str[3 * kBlockDigits], str[2 * kBlockDigits], str[kBlockDigits], str[0]),
+                _mm_set1_epi32('0'));
+            const __m128i values = _mm_add_epi32(
+                reversed_lows, _mm_mullo_epi32(first_chars, _mm_set1_epi32(static_cast<int>(kFirstCharMultiplier))));
+            _mm_storeu_si128(static_cast<__m128i*>(static_cast<void*>(out_end - 4)), values);
+        }
+        pack_sse41(str, blocks, out_end);
+    }
+
+#endif
+
+    [[nodiscard]] static pack_function select_kernel() noexcept {
+#if defined(LONGINT_HAS_X86_SIMD_INTRINSICS)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return &pack_avx2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return &pack_sse41;
+        }
+#endif
+        return &pack_default;
+    }
+};
+
+}  // namespace longint_detail
+
 namespace longint_detail {
 struct longint_static_storage;
 }  // namespace longint_detail
 
+class longint_view;
+
 class longint final {
     // Bug in the clang 14.0.0: if this method is defined after
     //  longint::divmod(uint32_t) (where it is used), CE will occured
@@ -432,9 +1035,15 @@ public:
     using size_type = std::uint32_t;
     using ssize_type = std::int32_t;
 
-    static constexpr std::size_t kDefaultLINumsCapacity32 = 2;
-    static constexpr std::size_t kDefaultLINumsCapacity64 = 2;
-    static constexpr std::size_t kDefaultLINumsCapacity128 = 4;
+    /// @brief Numbers with at most kInlineDigitsCapacity digits (128 bits) are stored
+    ///         inside the longint object without the heap allocation
+    static constexpr size_type kInlineDigitsCapacity = 4;
+
+    /// @brief Capacities allocated by the longint before the inline digits storage was added,
+    ///         they are no longer used by the longint
+    [[deprecated("use longint::kInlineDigitsCapacity")]] static constexpr std::size_t kDefaultLINumsCapacity32 = 2;
+    [[deprecated("use longint::kInlineDigitsCapacity")]] static constexpr std::size_t kDefaultLINumsCapacity64 = 2;
+    [[deprecated("use longint::kInlineDigitsCapacity")]] static constexpr std::size_t kDefaultLINumsCapacity128 = 4;
 
     static constexpr std::uint32_t kStrConvBase = 1'000'000'000;
     static constexpr std::uint32_t kStrConvBaseDigits = math_functions::base_b_len(kStrConvBase - 1);
@@ -445,28 +1054,82 @@ public:
     static constexpr std::size_t kFFTPrecisionBorder = 1u << 18;
     static constexpr auto kFFTFloatRoundError = std::numeric_limits<typename fft::complex::value_type>::round_error();
 
+    /// @brief Policies that select the algorithm used to multiply numbers with
+    ///         at least kFFTMultThreshold digits, see multiply_inplace() and square_this_to()
+    /// @note FFTMultPolicy: complex FFT over doubles, digits are split into 16-bit chunks
+    ///        (8-bit ones after the kFFTPrecisionBorder, which doubles the transform size).
+    ///       NTTMultPolicy: exact NTT modulo three primes + CRT (see ntt.hpp),
+    ///        does not depend on the floating-point rounding at any size.
+    ///       AutoMultPolicy: FFT while it does not need the high precision mode, NTT after
+    ///        (FFT is ~2.5x faster below the kFFTPrecisionBorder, NTT is up to ~1.4x faster above it).
+    struct FFTMultPolicy final {};
+    struct NTTMultPolicy final {};
+    struct AutoMultPolicy final {};
+    using DefaultMultPolicy = AutoMultPolicy;
+
+    /// @brief Sets the max number of threads used by the FFT multiplication, 1 (default) disables it.
+    ///         Only the transforms of size at least fft::kMinParallelFFTSize are split between the threads,
+    ///         for the AutoMultPolicy these are products of 2^15..2^16 digits. Bigger ones are done by the NTT,
+    ///         its convolutions modulo three primes (and products of the blocks of the operands longer than
+    ///         ntt::kMaxProductSize / 2 digits) are computed in parallel. Threads are taken from misc::thread_pool.
+    ///         Levels of the decimal string conversion (see set_string()) are split between the same
+    ///         number of threads by the independent blocks.
+    static void set_max_fft_threads(const std::size_t threads) noexcept {
+        fft_max_threads_.store(std::max(threads, std::size_t{1}), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static std::size_t max_fft_threads() noexcept {
+        return fft_max_threads_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Computes the FFT and NTT tables needed by the products of at most @a max_product_size digits,
+    ///         otherwise they are computed by the first product of such size.
+    static void precompute_fft_tables(const size_type max_product_size) {
+        if (max_product_size == 0) {
+            return;
+        }
+        fft::precompute_tables(LongIntFFT::compute_fft_product_params(check_size(max_product_size)).poly_size);
+        // Longer products are split into the blocks of at most ntt::kMaxProductSize digits (see LongIntNTT)
+        ntt::precompute_tables(std::min(std::size_t{max_product_size}, ntt::kMaxProductSize));
+    }
+
     static constexpr uint32_t kDecimalBase = kStrConvBase;
     static constexpr uint32_t kFFTDecimalBase = 1'000;
 
     longint() = default;
 
-    longint(const longint& other) : nums_(nullptr), size_(0), capacity_(0) {
-        if (other.capacity_ > 0) {
+    longint(const longint& other) : size_(other.size_) {
+        const size_type other_usize = other.usize();
+        if (other_usize > kInlineDigitsCapacity) {
             nums_ = allocate_uninitialized(other.capacity_);
-            size_ = other.size_;
             capacity_ = other.capacity_;
-            std::uninitialized_copy_n(other.nums_, other.size_, nums_);
         }
+        std::uninitialized_copy_n(other.nums_, other_usize, nums_);
     }
 
     longint& operator=(const longint& other) ATTRIBUTE_LIFETIME_BOUND {
-        return *this = longint{other};
+        if (unlikely(this == &other)) {
+            return *this;
+        }
+
+        // Current digits are reused if they are enough
+        const size_type other_usize = other.usize();
+        reserveUninitializedWithoutCopy(other_usize);
+        std::copy_n(other.nums_, other_usize, nums_);
+        size_ = other.size_;
+        return *this;
     }
 
-    constexpr longint(longint&& other) noexcept : nums_(other.nums_), size_(other.size_), capacity_(other.capacity_) {
-        other.nums_ = nullptr;
+    constexpr longint(longint&& other) noexcept : size_(other.size_) {
+        if (other.has_inline_digits()) {
+            std::copy_n(other.inline_digits_, other.usize(), inline_digits_);
+        } else {
+            nums_ = other.nums_;
+            capacity_ = other.capacity_;
+            other.nums_ = other.inline_digits_;
+            other.capacity_ = kInlineDigitsCapacity;
+        }
         other.size_ = 0;
-        other.capacity_ = 0;
     }
 
 #if CONFIG_HAS_AT_LEAST_CXX_20
@@ -483,9 +1146,19 @@ public:
 #endif
         void
         swap(longint& other) noexcept {
+        const bool this_has_inline_digits = has_inline_digits();
+        const bool other_has_inline_digits = other.has_inline_digits();
+        std::swap(inline_digits_, other.inline_digits_);
         std::swap(nums_, other.nums_);
         std::swap(size_, other.size_);
         std::swap(capacity_, other.capacity_);
+        // Inline digits were swapped together with the arrays, pointers to them should not be swapped
+        if (this_has_inline_digits) {
+            other.nums_ = other.inline_digits_;
+        }
+        if (other_has_inline_digits) {
+            nums_ = inline_digits_;
+        }
     }
 #if CONFIG_HAS_AT_LEAST_CXX_20
     constexpr
@@ -496,28 +1169,22 @@ public:
     }
 
     /* implicit */ longint(const uint32_t n) {
-        this->allocate_default_capacity_32();
         this->assign_u32_unchecked(n);
     }
     /* implicit */ longint(const int32_t n) {
-        this->allocate_default_capacity_32();
         this->assign_i32_unchecked(n);
     }
     /* implicit */ longint(const uint64_t n) {
-        this->allocate_default_capacity_64();
         this->assign_u64_unchecked(n);
     }
     /* implicit */ longint(const int64_t n) {
-        this->allocate_default_capacity_64();
         this->assign_i64_unchecked(n);
     }
 #if defined(HAS_INT128_TYPEDEF)
     /* implicit */ longint(const uint128_t n) {
-        this->allocate_default_capacity_128();
         this->assign_u128_unchecked(n);
     }
     /* implicit */ longint(const int128_t n) {
-        this->allocate_default_capacity_128();
         this->assign_i128_unchecked(n);
     }
 #endif
@@ -545,33 +1212,27 @@ public:
     }
 
     longint& operator=(const uint32_t n) ATTRIBUTE_LIFETIME_BOUND {
-        this->ensure_default_capacity_op_asgn_32();
         this->assign_u32_unchecked(n);
         return *this;
     }
     longint& operator=(const int32_t n) ATTRIBUTE_LIFETIME_BOUND {
-        this->ensure_default_capacity_op_asgn_32();
         this->assign_i32_unchecked(n);
         return *this;
     }
     longint& operator=(const uint64_t n) ATTRIBUTE_LIFETIME_BOUND {
-        this->ensure_default_capacity_op_asgn_64();
         this->assign_u64_unchecked(n);
         return *this;
     }
     longint& operator=(const int64_t n) ATTRIBUTE_LIFETIME_BOUND {
-        this->ensure_default_capacity_op_asgn_64();
         this->assign_i64_unchecked(n);
         return *this;
     }
 #if defined(HAS_INT128_TYPEDEF)
     longint& operator=(const uint128_t n) ATTRIBUTE_LIFETIME_BOUND {
-        this->ensure_default_capacity_op_asgn_128();
         this->assign_u128_unchecked(n);
         return *this;
     }
     longint& operator=(const int128_t n) ATTRIBUTE_LIFETIME_BOUND {
-        this->ensure_default_capacity_op_asgn_128();
         this->assign_i128_unchecked(n);
         return *this;
     }
@@ -736,7 +1397,69 @@ public:
         return *this = std::move(res);
     }
 
-    void square_this_to(longint& other) const {
+    struct ExtendedGcdResult;
+
+    /// @brief Greatest common divisor of the |a| and |b|, gcd(0, 0) = 0.
+    ///         Lehmer's algorithm with the double digit lookahead is used for the medium sizes
+    ///         and the recursive half-gcd over the fast multiplication for the huge sizes
+    [[nodiscard]] static longint gcd(const longint& a, const longint& b);
+
+    /// @brief Finds such u and v that a * u + b * v = gcd(a, b), see gcd(const longint&, const longint&).
+    ///         If b != 0, then 0 <= u < |b| / gcd(a, b), otherwise u = sign(a) and v = 0
+    [[nodiscard]] static ExtendedGcdResult extended_gcd(const longint& a, const longint& b);
+
+    /// @brief Solves a * x ≡ 1 (mod m), m > 0
+    /// @return x such that 0 <= x < m or 0 if gcd(a, m) != 1
+    /// @throws std::invalid_argument if m <= 0
+    [[nodiscard]] static longint inv_mod(const longint& a, const longint& m);
+
+    class MontgomeryContext;
+
+    /// @brief *this := *this^exp mod mod, 0 <= *this < mod.
+    ///         Odd moduli are handled by the Montgomery multiplication (see longint::MontgomeryContext),
+    ///         even and huge ones by the fast multiplication and the division by the longint::Reciprocal
+    /// @throws std::invalid_argument if mod <= 0 or exp < 0
+    longint& pow_mod(const longint& exp, const longint& mod) ATTRIBUTE_LIFETIME_BOUND;
+
+    /// @brief floor(sqrt(n)), see iroot(const longint&, uint32_t)
+    /// @throws std::invalid_argument if n < 0
+    [[nodiscard]] static longint isqrt(const longint& n) {
+        return iroot(n, 2);
+    }
+
+    /// @brief floor(n^{1/k}) if n >= 0 and -floor(|n|^{1/k}) if n < 0 and k is odd.
+    ///         Newton's iteration starts from the root of the highest half of the bits,
+    ///         so every level of the recursion makes one division and one power of the doubled precision
+    /// @throws std::invalid_argument if k = 0 or n < 0 and k is even
+    [[nodiscard]] static longint iroot(const longint& n, uint32_t k);
+
+    /// @brief Checks whether @a n is perfect square or not, residues of the @a n
+    ///         modulo 64, 63, 65 and 11 reject 99% of the non-squares before the isqrt is computed
+    /// @return {sqrt(n), true} if @a n is perfect square and {0, false} otherwise
+    [[nodiscard]] static math_functions::IsPerfectSquareResult<longint> is_perfect_square(const longint& n);
+
+    /**
+     * @brief Product of the values in [first; last) (1 for the empty range). Values (longint or
+     *         integers with at most 32 bits) are packed into the leaves of about kProductLeafDigits digits,
+     *         which are multiplied pairwise level by level, so the operands of every product have
+     *         close sizes and big ones go to the FFT instead of the O(n^2) chain of the *= uint32_t.
+     * @param max_threads if > 1, subtrees are multiplied in parallel on the misc::thread_pool,
+     *         which is grown to at least @a max_threads - 1 workers (the calling thread also multiplies)
+     */
+    template <class Iterator>
+    [[nodiscard]] static longint product(Iterator first, Iterator last, std::size_t max_threads = 1);
+
+    /// @brief n! by the prime swing algorithm: n! = ((n / 2)!)^2 * swing(n), where the prime factors of
+    ///         the swing(n) = n! / ((n / 2)!)^2 are found by the sieve and multiplied by the product tree
+    [[nodiscard]] static longint factorial(uint32_t n, std::size_t max_threads = 1);
+
+    /// @brief Binomial coefficient C(n, k), 0 if k > n.
+    ///         Exponent of every prime p <= n is the number of carries when adding k and n - k
+    ///         in base p (Kummer's theorem), prime powers are multiplied by the product tree
+    [[nodiscard]] static longint binomial(uint32_t n, uint32_t k, std::size_t max_threads = 1);
+
+    template <class MultPolicy = DefaultMultPolicy>
+    void square_this_to(longint& other) const {
         const size_type nums_size = usize();
         if (unlikely(nums_size == 0)) {
             other.assign_zero();
@@ -762,6 +1485,10 @@ public:
                 ans[j + nums_size] = static_cast<digit_t>(carry);
             }
 
+            other.adopt_digits_sequence_without_changing_size(ans, prod_size);
+        } else if (nums_size < kFFTMultThreshold || !use_fft_for_product<MultPolicy>(prod_size)) {
+            digit_t* ans = allocate_uninitialized(prod_size);
+            multiply_and_store_to<MultPolicy>(nums_ptr, nums_size, nums_ptr, nums_size, ans);
             other.adopt_digits_sequence_without_changing_size(ans, prod_size);
         } else {
             const auto [n, need_high_precision] = LongIntFFT::compute_fft_product_params(prod_size);
@@ -770,7 +1497,7 @@ public:
             LongIntFFT::convert_longint_nums_to_fft_poly(nums_ptr, nums_size, p1.get(), n, need_high_precision);
             other.reserveUninitializedWithoutCopy(prod_size);
             fft::complex* p2 = p1.get() + n;
-            fft::forward_backward_fft(p1.get(), p2, n);
+            fft::forward_backward_fft(p1.get(), p2, n, max_fft_threads());
             LongIntFFT::convert_fft_poly_to_longint_nums(need_high_precision, p2, other.nums_, prod_size);
         }
 
@@ -778,8 +1505,9 @@ public:
         other.pop_leading_zeros();
     }
 
+    template <class MultPolicy = DefaultMultPolicy>
     longint& square_inplace() ATTRIBUTE_LIFETIME_BOUND {
-        square_this_to(*this);
+        square_this_to<MultPolicy>(*this);
         return *this;
     }
 
@@ -788,6 +1516,12 @@ public:
     }
 
     longint& operator*=(const longint& other) ATTRIBUTE_LIFETIME_BOUND {
+        return multiply_inplace<DefaultMultPolicy>(other);
+    }
+
+    /// @brief *this *= other using the MultPolicy for the big numbers
+    template <class MultPolicy>
+    longint& multiply_inplace(const longint& other) ATTRIBUTE_LIFETIME_BOUND {
         size_type k = usize();
         size_type m = other.usize();
         const digit_t* k_ptr = nums_;
@@ -803,15 +1537,14 @@ public:
             return *this;
         }
 
+        // Compute the sign before the buffers are reallocated
+        const ssize_type sign_product = size_ ^ other.size_;
         static_assert(max_size() + max_size() > max_size());
         const size_type prod_size = check_size(m + k);
-        if (m <= 16 || m * k <= 1024) {
+        if (m < kFFTMultThreshold || !use_fft_for_product<MultPolicy>(prod_size)) {
             digit_t* ans = allocate_uninitialized(prod_size);
-            std::fill_n(ans, prod_size, digit_t{0});
-            LongIntNaive::multiply_and_store_to(m_ptr, m, k_ptr, k, ans);
-            deallocate(nums_, capacity_);
-            nums_ = ans;
-            capacity_ = prod_size;
+            multiply_and_store_to<MultPolicy>(m_ptr, m, k_ptr, k, ans);
+            adopt_digits_sequence_without_changing_size(ans, prod_size);
         } else {
             const auto [n, need_high_precision] = LongIntFFT::compute_fft_product_params(prod_size);
             // Allocate n complex numbers for p1 and n complex numbers for p2
@@ -819,11 +1552,10 @@ public:
             LongIntFFT::convert_longint_nums_to_fft_poly(m_ptr, m, k_ptr, k, p1.get(), n, need_high_precision);
             reserveUninitializedWithoutCopy(prod_size);
             fft::complex* const p2 = p1.get() + n;
-            fft::forward_backward_fft(p1.get(), p2, n);
+            fft::forward_backward_fft(p1.get(), p2, n, max_fft_threads());
             LongIntFFT::convert_fft_poly_to_longint_nums(need_high_precision, p2, nums_, prod_size);
         }
 
-        const ssize_type sign_product = size_ ^ other.size_;
         set_ssize_from_size_and_sign(prod_size, /* sign = */ sign_product);
         pop_leading_zeros();
         return *this;
@@ -834,6 +1566,12 @@ public:
         return lhs;
     }
 
+    class PrecomputedMultiplier;
+
+    /// @brief Same as *this *= multiplier.multiplier(), but reuses the FFT
+    ///         of the multiplier computed once, see longint::PrecomputedMultiplier
+    longint& operator*=(const PrecomputedMultiplier& multiplier) ATTRIBUTE_LIFETIME_BOUND;
+
     [[nodiscard]] longint divmod(const longint& other) {
         longint rem;
         this->divmod(other, rem);
@@ -844,6 +1582,12 @@ public:
         this->divmod_impl(other, rem);
     }
 
+    class Reciprocal;
+
+    /// @brief Same as divmod(reciprocal.divisor(), rem), but reuses the reciprocal
+    ///         of the divisor computed once, see longint::Reciprocal
+    void divmod(const Reciprocal& reciprocal, longint& rem);
+
     longint& operator/=(const longint& other) ATTRIBUTE_LIFETIME_BOUND {
         std::ignore = divmod(other);
         return *this;
@@ -855,6 +1599,11 @@ public:
     }
 
     longint& operator+=(const longint& other) ATTRIBUTE_LIFETIME_BOUND {
+        if (unlikely(other.is_zero())) {
+            // other.nums_ may be nullptr
+            return *this;
+        }
+
         const bool find_sum = (size() ^ other.size()) >= 0;
         const size_type other_usize = other.usize();
 
@@ -892,6 +1641,78 @@ public:
         return lhs;
     }
 
+    /// @brief *this += a * b without creating the temporary longint for the product,
+    ///         so that the accumulations like sum(a_i * b_i) reuse the capacity of *this
+    longint& addmul(const longint& a, const longint& b) ATTRIBUTE_LIFETIME_BOUND {
+        add_product(a, b, /* negate_product = */ false);
+        return *this;
+    }
+
+    /// @brief *this -= a * b, see addmul(const longint&, const longint&)
+    longint& submul(const longint& a, const longint& b) ATTRIBUTE_LIFETIME_BOUND {
+        add_product(a, b, /* negate_product = */ true);
+        return *this;
+    }
+
+    /// @brief *this += a * b, see addmul(const longint&, const longint&)
+    longint& addmul(const longint& a, const uint32_t b) ATTRIBUTE_LIFETIME_BOUND {
+        add_product_u32(a, b, /* negate_product = */ false);
+        return *this;
+    }
+
+    /// @brief *this -= a * b, see addmul(const longint&, const longint&)
+    longint& submul(const longint& a, const uint32_t b) ATTRIBUTE_LIFETIME_BOUND {
+        add_product_u32(a, b, /* negate_product = */ true);
+        return *this;
+    }
+
+    /// @brief *this += a * a, see addmul(const longint&, const longint&)
+    longint& square_add(const longint& a) ATTRIBUTE_LIFETIME_BOUND {
+        if (a.usize() >= kFFTMultThreshold) {
+            // Squaring needs only one forward transform
+            longint square;
+            a.square_this_to(square);
+            return *this += square;
+        }
+
+        add_product(a, a, /* negate_product = */ false);
+        return *this;
+    }
+
+    /// @brief *this = *this * mult + add in one pass over the digits
+    longint& mul_add_u32(const uint32_t mult, const uint32_t add) ATTRIBUTE_LIFETIME_BOUND {
+        if (size_ < 0) {
+            *this *= mult;
+            return *this += add;
+        }
+        if (is_zero() || mult == 0) {
+            return *this = add;
+        }
+
+        double_digit_t carry = add;
+        const double_digit_t b_0 = mult;
+        const size_type usize_value = usize();
+        for (digit_t *nums_it = nums_, *nums_it_end = nums_it + usize_value; nums_it != nums_it_end; ++nums_it) {
+            const double_digit_t res = *nums_it * b_0 + carry;
+            *nums_it = static_cast<digit_t>(res);
+            carry = res >> kDigitBits;
+        }
+
+        // *this > 0 and mult != 0 => there will be no leading zeros
+        if (carry != 0) {
+            assert(usize_value <= capacity_);
+            if (unlikely(usize_value >= capacity_)) {
+                grow_capacity();
+                assert(usize_value < capacity_);
+            }
+
+            nums_[usize_value] = static_cast<digit_t>(carry);
+            size_++;
+        }
+
+        return *this;
+    }
+
     [[nodiscard]] ATTRIBUTE_PURE constexpr bool operator==(const int32_t n) const noexcept {
         if ((config::is_constant_evaluated() || config::is_gcc_constant_p(n)) && n == 0) {
             return is_zero();
@@ -1264,15 +2085,9 @@ public:
         }
 
         shift %= kDigitBits;
-        digit_t* nums_iter = nums_;
-        digit_t* const nums_iter_last = nums_iter + usize_value - 1;
+        digit_t* const nums_iter_last = nums_ + usize_value - 1;
         if (shift > 0) {
-            for (; nums_iter != nums_iter_last; ++nums_iter) {
-                const digit_t current_digit = nums_iter[0];
-                const digit_t next_digit = nums_iter[1];
-                *nums_iter = static_cast<digit_t>((current_digit | double_digit_t{next_digit} << kDigitBits) >> shift);
-            }
-            *nums_iter_last >>= shift;
+            shift_right_digits(nums_, usize_value, shift);
         }
 
         if (*nums_iter_last == 0) {
@@ -1306,15 +2121,8 @@ public:
 
         shift %= kDigitBits;
         if (shift > 0) {
-            digit_t* const nums_iter_begin = nums_ + new_trailig_zeros_digits;
-            digit_t* const nums_iter_end = nums_ + usize_value;
-            for (digit_t* nums_iter = nums_iter_end - 1; nums_iter > nums_iter_begin; nums_iter--) {
-                const digit_t prev_digit = *(nums_iter - 1);
-                const digit_t current_digit = *nums_iter;
-                const double_digit_t two_digits = (double_digit_t{current_digit} << kDigitBits) | prev_digit;
-                *nums_iter = static_cast<digit_t>(two_digits >> (kDigitBits - shift));
-            }
-            *nums_iter_begin = (*nums_iter_begin) << shift;
+            // The highest digit is zero, so no bits are lost
+            shift_left_digits(nums_ + new_trailig_zeros_digits, usize_value - new_trailig_zeros_digits, shift);
         }
 
         if (nums_[usize_value - 1] == 0) {
@@ -1330,6 +2138,36 @@ public:
         this->set_dec_str_impl(reinterpret_cast<const unsigned char*>(s.data()), s.size());
     }
 
+    /// @brief Sets *this to the number written in the @a base (2 <= base <= 36) with the optional leading '-',
+    ///         digits greater than 9 are the latin letters in any case. Power of two bases are converted
+    ///         in linear time, other bases by the divide and conquer over the powers of the base.
+    /// @throws std::invalid_argument if @a base or @a s is invalid
+    void set_string(const std::string_view s, const uint32_t base) {
+        check_base(LONGINT_FILE_LOCATION(), base);
+        if (base == 10) {
+            set_string(s);
+            return;
+        }
+
+        check_str_in_base(s, base);
+        const bool negative = s.front() == '-';
+        const std::string_view digits = negative ? s.substr(1) : s;
+        if (math_functions::is_power_of_two(base)) {
+            set_pow2_base_str_impl(digits, static_cast<uint32_t>(math_functions::countr_zero(base)));
+        } else {
+            set_base_str_impl(digits, base);
+        }
+        if (negative) {
+            flip_sign();
+        }
+    }
+
+    [[nodiscard]] static longint from_string(const std::string_view s, const uint32_t base) {
+        longint ret;
+        ret.set_string(s, base);
+        return ret;
+    }
+
     template <class T>
     [[nodiscard]]
     ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_PURE constexpr bool fits_in_uint() const noexcept {
@@ -1424,7 +2262,7 @@ public:
         const size_type usize_value = usize();
         switch (usize_value) {
             case 0: {
-                ans = "0";
+                ans.push_back('0');
                 return;
             }
             case 1: {
@@ -1450,6 +2288,11 @@ public:
 #pragma clang diagnostic pop
 #endif
 
+        if (usize_value < kDecimalToStringThreshold) {
+            append_to_string_div_conq(ans);
+            return;
+        }
+
         const Decimal result = [&]() {
             const size_type n = check_size(math_functions::nearest_greater_equal_power_of_two(usize_value));
             ensure_bin_base_pows_capacity(math_functions::log2_floor(n));
@@ -1480,6 +2323,40 @@ public:
             ptr--;
         } while (last_a_i);
     }
+
+    /// @brief Representation of *this in the @a base (2 <= base <= 36) with lowercase letters,
+    ///         see set_string(std::string_view, uint32_t)
+    /// @throws std::invalid_argument if @a base is invalid
+    [[nodiscard]] std::string to_string(const uint32_t base) const {
+        std::string s;
+        append_to_string(s, base);
+        return s;
+    }
+
+    void to_string(std::string& s, const uint32_t base) const {
+        s.clear();
+        append_to_string(s, base);
+    }
+
+    void append_to_string(std::string& ans, const uint32_t base) const {
+        check_base(LONGINT_FILE_LOCATION(), base);
+        if (base == 10) {
+            append_to_string(ans);
+            return;
+        }
+
+        if (size() < 0) {
+            ans.push_back('-');
+        }
+        if (is_zero()) {
+            ans.push_back('0');
+        } else if (math_functions::is_power_of_two(base)) {
+            append_pow2_base_str(ans, static_cast<uint32_t>(math_functions::countr_zero(base)));
+        } else {
+            append_base_str_div_conq(ans, base);
+        }
+    }
+
     [[nodiscard]] friend std::string to_string(const longint& n) {
         return n.to_string();
     }
@@ -1495,6 +2372,103 @@ public:
         return in;
     }
 
+    /// @brief Sets *this to (negative ? -1 : 1) * sum(digits[i] * 2^{32 i}), i = 0, ..., digits_count - 1
+    ///         (import of the little-endian 32-bit limbs, begin()..end() is the export)
+    /// @note Leading zero limbs are allowed, @a digits should not point to the digits of *this
+    ATTRIBUTE_SIZED_ACCESS(read_only, 2, 3)
+    longint& set_digits(const digit_t digits[],
+                        std::size_t digits_count,
+                        const bool negative = false) ATTRIBUTE_LIFETIME_BOUND {
+        while (digits_count > 0 && digits[digits_count - 1] == 0) {
+            digits_count--;
+        }
+        const size_type checked_digits_count = check_size(digits_count);
+        reserveUninitializedWithoutCopy(checked_digits_count);
+        std::copy_n(digits, checked_digits_count, nums_);
+        set_ssize_from_size_and_sign(checked_digits_count, /* sign = */ negative ? -1 : 1);
+        return *this;
+    }
+
+    ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+    [[nodiscard]] static longint from_digits(const digit_t digits[],
+                                             const std::size_t digits_count,
+                                             const bool negative = false) {
+        longint ret;
+        ret.set_digits(digits, digits_count, negative);
+        return ret;
+    }
+
+    /**
+     * Binary format of the longint (all integers are little-endian):
+     *   bytes [0, 4): kBinaryMagic
+     *   bytes [4, 8): size() as a 32-bit signed integer (sign of the number and the number of digits)
+     *   bytes [8, 8 + 4 * usize()): digits, lowest first, the highest one is non-zero
+     * Digits start at the offset 8, so a view over the 4-byte aligned buffer
+     *  may use them without copying (see longint_view::from_binary()).
+     */
+    static constexpr std::uint32_t kBinaryMagic = 0x544E494CU;  // "LINT"
+    static constexpr std::size_t kBinaryHeaderSize = 8;
+
+    [[nodiscard]] ATTRIBUTE_PURE constexpr std::size_t binary_size() const noexcept {
+        return kBinaryHeaderSize + std::size_t{usize()} * sizeof(digit_t);
+    }
+
+    /// @brief Writes binary_size() bytes of the binary format to the @a out
+    /// @return binary_size()
+    ATTRIBUTE_ACCESS(write_only, 2)
+    std::size_t to_binary(std::byte out[]) const noexcept {
+        store_u32_le(out, kBinaryMagic);
+        store_u32_le(out + 4, static_cast<std::uint32_t>(size_));
+        const size_type usize_value = usize();
+        std::byte* const digits_out = out + kBinaryHeaderSize;
+#if CONFIG_BYTE_ORDER_LITTLE_ENDIAN
+        if (usize_value > 0) {
+            std::memcpy(digits_out, nums_, usize_value * sizeof(digit_t));
+        }
+#else
+        for (size_type i = 0; i < usize_value; i++) {
+            store_u32_le(digits_out + i * sizeof(digit_t), nums_[i]);
+        }
+#endif
+        return binary_size();
+    }
+
+    [[nodiscard]] std::vector<std::byte> to_binary() const {
+        std::vector<std::byte> ret(binary_size());
+        to_binary(ret.data());
+        return ret;
+    }
+
+    /// @brief Reads the number written by the to_binary()
+    /// @throws std::invalid_argument if @a data[0..size) is not the longint binary format
+    ATTRIBUTE_SIZED_ACCESS(read_only, 2, 3)
+    void set_binary(const std::byte data[], const std::size_t size) {
+        const ssize_type ssize_value = check_binary(data, size);
+        const size_type usize_value = math_functions::uabs(ssize_value);
+        reserveUninitializedWithoutCopy(usize_value);
+        const std::byte* const digits = data + kBinaryHeaderSize;
+#if CONFIG_BYTE_ORDER_LITTLE_ENDIAN
+        if (usize_value > 0) {
+            std::memcpy(nums_, digits, usize_value * sizeof(digit_t));
+        }
+#else
+        for (size_type i = 0; i < usize_value; i++) {
+            nums_[i] = load_u32_le(digits + i * sizeof(digit_t));
+        }
+#endif
+        size_ = ssize_value;
+    }
+
+    ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+    [[nodiscard]] static longint from_binary(const std::byte data[], const std::size_t size) {
+        longint ret;
+        ret.set_binary(data, size);
+        return ret;
+    }
+
+    /// @brief *this = lhs * rhs, operands may point to the digits of *this
+    longint& assign_product(longint_view lhs, longint_view rhs) ATTRIBUTE_LIFETIME_BOUND;
+
     void reserve(const std::size_t requested_capacity) {
         LONGINT_ASSERT_ASSUME(usize() <= capacity());
 
@@ -1512,7 +2486,7 @@ public:
     }
 
     ~longint() {
-        deallocate(nums_, capacity_);
+        deallocate_nums();
     }
 
     struct Decimal final {
@@ -1819,7 +2793,7 @@ public:
             void multiply_and_store_to_impl(Decimal& product_result) const {
                 LONGINT_ASSERT_ASSUME(product_size_ <= kMaxDecFFTSize);
                 product_result.digits_.resize(product_size_);
-                fft::forward_backward_fft(lhs_poly(), rhs_poly(), poly_size());
+                fft::forward_backward_fft(lhs_poly(), rhs_poly(), poly_size(), max_fft_threads());
                 convert_fft_poly_to_decimal_digits(rhs_poly(), product_result.digits_.data(), product_size_);
             }
 
@@ -2090,8 +3064,9 @@ public:
     };
 
 private:
-#if defined(HAS_CUSTOM_LONGINT_ALLOCATOR)
-    static constexpr bool kUseCustomLongIntAllocator = false;
+#if defined(HAS_CUSTOM_LONGINT_ALLOCATOR) && defined(LONGINT_USE_CUSTOM_ALLOCATOR)
+    // Opt-in, see the longint_allocator
+    static constexpr bool kUseCustomLongIntAllocator = true;
 #else
     static constexpr bool kUseCustomLongIntAllocator = false;
 #endif
@@ -2122,97 +3097,762 @@ private:
         }
     };
 
-    struct LongIntFFT final {
-        using poly_size_type = std::size_t;
+    /**
+     * Multiplication tiers (by the length m of the shorter operand):
+     *   m < kKaratsubaMultThreshold                           -> LongIntNaive
+     *   kKaratsubaMultThreshold <= m < kToomCook3MultThreshold -> LongIntKaratsuba
+     *   kToomCook3MultThreshold <= m < kFFTMultThreshold       -> LongIntToomCook3
+     *   kFFTMultThreshold <= m                                 -> LongIntFFT or LongIntNTT (see MultPolicy)
+     * Big enough FFT products are split between at most max_fft_threads() threads.
+     * Thresholds were picked with number_theory/measure_longint.cpp (x86-64, -O2).
+     * If the longer operand is at least twice as long as the shorter one (and the FFT
+     *  is not used), it is sliced into blocks of m digits (see multiply_unbalanced).
+     */
+    static constexpr size_type kKaratsubaMultThreshold = 48;
+    static constexpr size_type kToomCook3MultThreshold = 192;
+    static constexpr size_type kFFTMultThreshold = 256;
 
-        struct FFTParams final {
-            poly_size_type poly_size;
-            bool need_high_precision;
-        };
+    struct LongIntKaratsuba final {
+        /// @brief Computes k_ptr[0..k) * m_ptr[0..m) and stores it to the ans[0..m + k)
+        /// @note k / 2 < m <= k, scratch should have at least scratch_size(m, k) digits
+        ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+        ATTRIBUTE_ACCESS(read_write, 5)
+        ATTRIBUTE_ACCESS(read_write, 6)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static void multiply_and_store_to(const digit_t m_ptr[],
+                                          const size_type m,
+                                          const digit_t k_ptr[],
+                                          const size_type k,
+                                          digit_t* const ans,
+                                          digit_t* const scratch) {
+            LONGINT_ASSERT_ASSUME(m <= k);
+            LONGINT_ASSERT_ASSUME(k / 2 < m);
+
+            // k = a1 * kNumsBase^s + a0, m = b1 * kNumsBase^s + b0
+            const size_type s = k / 2;
+            const digit_t* const a0 = k_ptr;
+            const digit_t* const a1 = k_ptr + s;
+            const size_type a1_size = k - s;
+            const digit_t* const b0 = m_ptr;
+            const digit_t* const b1 = m_ptr + s;
+            const size_type b1_size = m - s;
+            LONGINT_ASSERT_ASSUME(s <= a1_size);
+            LONGINT_ASSERT_ASSUME(0 < b1_size && b1_size <= a1_size);
+
+            // sum_a, sum_b and z1 are stored at the beginning of the scratch, the rest is passed to the subproducts
+            const size_type sum_a_size = a1_size + 1;
+            const size_type sum_b_size = std::max(s, b1_size) + 1;
+            const size_type z1_size = sum_a_size + sum_b_size;
+            digit_t* const sum_a = scratch;
+            digit_t* const sum_b = sum_a + sum_a_size;
+            digit_t* const z1 = sum_b + sum_b_size;
+            digit_t* const subproducts_scratch = z1 + z1_size;
+
+            // z0 = a0 * b0 and z2 = a1 * b1 are written to the non-overlapping parts of the ans
+            digit_t* const z0 = ans;
+            digit_t* const z2 = ans + 2 * s;
+            longint::multiply_and_store_to(b0, s, a0, s, z0, subproducts_scratch);
+            longint::multiply_and_store_to(b1, b1_size, a1, a1_size, z2, subproducts_scratch);
+
+            add_and_store_to(a1, a1_size, a0, s, sum_a);
+            if (b1_size >= s) {
+                add_and_store_to(b1, b1_size, b0, s, sum_b);
+            } else {
+                add_and_store_to(b0, s, b1, b1_size, sum_b);
+            }
 
-        ATTRIBUTE_NODISCARD_WITH_MESSAGE("impl error in fft longint product")
-        ATTRIBUTE_ALWAYS_INLINE
+            // z1 = (a0 + a1) * (b0 + b1) - z0 - z2 = a0 * b1 + a1 * b0
+            longint::multiply_and_store_to(sum_b, sum_b_size, sum_a, sum_a_size, z1, subproducts_scratch);
+            bool borrow = longint_subtract_with_carry(z1, z1_size, z0, 2 * s);
+            LONGINT_DEBUG_ASSERT(!borrow);
+            borrow = longint_subtract_with_carry(z1, z1_size, z2, a1_size + b1_size);
+            LONGINT_DEBUG_ASSERT(!borrow);
+            std::ignore = borrow;
+
+            add_shifted_to(ans, m + k, z1, z1_size, s);
+        }
+
+        /// @brief Number of the scratch digits needed by the multiply_and_store_to() for the m and k digits
         ATTRIBUTE_CONST
-        static constexpr FFTParams compute_fft_product_params(const size_type product_size) noexcept {
-            static_assert(max_size() * 2 > max_size());
-            static_assert(2 * math_functions::nearest_greater_equal_power_of_two(max_size()) >= 2 * max_size());
-            poly_size_type n = 2 * math_functions::nearest_greater_equal_power_of_two(product_size);
-            const bool need_high_precision = n > kFFTPrecisionBorder;
-            if (need_high_precision) {
-                n *= 2;
-            }
-            LONGINT_ASSERT_ASSUME(math_functions::is_power_of_two(n));
-            return {n, need_high_precision};
+        [[nodiscard]]
+        static constexpr std::size_t scratch_size(const size_type m, const size_type k) noexcept {
+            const size_type s = k / 2;
+            const size_type a1_size = k - s;
+            const size_type b1_size = m - s;
+            const size_type sum_a_size = a1_size + 1;
+            const size_type sum_b_size = std::max(s, b1_size) + 1;
+            const std::size_t subproducts_scratch_size =
+                std::max({longint::mult_scratch_size(s, s), longint::mult_scratch_size(b1_size, a1_size),
+                          longint::mult_scratch_size(sum_b_size, sum_a_size)});
+            return 2 * (std::size_t{sum_a_size} + sum_b_size) + subproducts_scratch_size;
         }
 
+        /// @brief out[0..x_size] = x[0..x_size) + y[0..y_size)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+        ATTRIBUTE_ACCESS(write_only, 5)
         ATTRIBUTE_NONNULL_ALL_ARGS
-        ATTRIBUTE_ACCESS(read_only, 2)
-        ATTRIBUTE_SIZED_ACCESS(write_only, 3, 4)
-        static void convert_fft_poly_to_longint_nums(const bool is_high_precision,
-                                                     const fft::complex* RESTRICT_QUALIFIER poly,
-                                                     digit_t* RESTRICT_QUALIFIER nums,
-                                                     const size_type nums_size) {
-            LONGINT_ASSERT_ASSUME(nums_size > 0);
-
-            static_assert(sizeof(digit_t) == sizeof(uint32_t));
+        static constexpr void add_and_store_to(const digit_t x[],
+                                               const size_type x_size,
+                                               const digit_t y[],
+                                               const size_type y_size,
+                                               digit_t out[]) noexcept {
+            LONGINT_ASSERT_ASSUME(y_size <= x_size);
             double_digit_t carry = 0;
-            const digit_t* const nums_end = nums + nums_size;
-            if (likely(!is_high_precision)) {
-                do {
-                    double_digit_t res = carry;
-                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError);
-                    poly++;
-                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError) << 16;
-                    poly++;
-                    *nums = static_cast<digit_t>(res);
-                    carry = res / kNumsBase;
-                    nums++;
-                } while (nums < nums_end);
-            } else {
-                do {
-                    double_digit_t res = carry;
-                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError);
-                    poly++;
-                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError) << 8;
-                    poly++;
-                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError) << 16;
-                    poly++;
-                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError) << 24;
-                    poly++;
-                    *nums = static_cast<digit_t>(res);
-                    carry = res / kNumsBase;
-                    nums++;
-                } while (nums < nums_end);
+            size_type i = 0;
+            for (; i < y_size; i++) {
+                const double_digit_t res = double_digit_t{x[i]} + double_digit_t{y[i]} + carry;
+                out[i] = static_cast<digit_t>(res);
+                carry = res >> kDigitBits;
             }
-            assert(carry == 0);
+            for (; i < x_size; i++) {
+                const double_digit_t res = double_digit_t{x[i]} + carry;
+                out[i] = static_cast<digit_t>(res);
+                carry = res >> kDigitBits;
+            }
+            out[x_size] = static_cast<digit_t>(carry);
         }
 
+        /// @brief dst[0..dst_size) += src[0..src_size) * kNumsBase^shift
+        /// @note The sum should fit in the dst_size digits (all digits of
+        ///        the src that do not fit in the dst should be zeros)
+        ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
         ATTRIBUTE_NONNULL_ALL_ARGS
+        static constexpr void add_shifted_to(digit_t dst[],
+                                             const size_type dst_size,
+                                             const digit_t src[],
+                                             size_type src_size,
+                                             const size_type shift) noexcept {
+            LONGINT_ASSERT_ASSUME(shift < dst_size);
+            const size_type free_space = dst_size - shift;
+            while (src_size > free_space) {
+                src_size--;
+                LONGINT_DEBUG_ASSERT(src[src_size] == 0);
+            }
+
+            const bool carry = longint_add_with_carry(dst + shift, free_space, src, src_size);
+            LONGINT_DEBUG_ASSERT(!carry);
+            std::ignore = carry;
+        }
+    };
+
+    struct LongIntToomCook3 final {
+        /// @brief Computes k_ptr[0..k) * m_ptr[0..m) and stores it to the ans[0..m + k)
+        /// @note 2 * ceil(k / 3) < m <= k, scratch should have at least scratch_size(m, k) digits
         ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
         ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
-        ATTRIBUTE_SIZED_ACCESS(write_only, 5, 6)
-        static void convert_longint_nums_to_fft_poly(const digit_t m_ptr[],
-                                                     const size_type m,
-                                                     const digit_t k_ptr[],
-                                                     const size_type k,
-                                                     fft::complex* p,
-                                                     const poly_size_type n,
-                                                     const bool need_high_precision) noexcept {
-            LONGINT_ASSERT_ASSUME(0 < m);
+        ATTRIBUTE_ACCESS(read_write, 5)
+        ATTRIBUTE_ACCESS(read_write, 6)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static void multiply_and_store_to(const digit_t m_ptr[],
+                                          const size_type m,
+                                          const digit_t k_ptr[],
+                                          const size_type k,
+                                          digit_t* const ans,
+                                          digit_t* const scratch) {
             LONGINT_ASSERT_ASSUME(m <= k);
-            LONGINT_ASSERT_ASSUME(m <= max_size());
-            LONGINT_ASSERT_ASSUME(k <= max_size());
-            LONGINT_ASSERT_ASSUME(m + k <= max_size());
-            LONGINT_ASSERT_ASSUME(m + k <= n);
-            LONGINT_ASSERT_ASSUME(need_high_precision || n <= kFFTPrecisionBorder);
-            LONGINT_ASSERT_ASSUME(!need_high_precision || n > kFFTPrecisionBorder * 2);
-            LONGINT_ASSERT_ASSUME(math_functions::is_power_of_two(n));
+            LONGINT_ASSERT_ASSUME(2 * split_size(k) < m);
+
+            /**
+             * Toom-3 with evaluation points 0, 1, -1, 2, inf:
+             *  k = a2 * x^2 + a1 * x + a0, m = b2 * x^2 + b1 * x + b0, x = kNumsBase^s
+             *  v0 = a0 * b0, v1 = (a0 + a1 + a2) * (b0 + b1 + b2), vm1 = (a0 - a1 + a2) * (b0 - b1 + b2),
+             *  v2 = (a0 + 2 a1 + 4 a2) * (b0 + 2 b1 + 4 b2), vinf = a2 * b2
+             * Only vm1 may be negative, so its sign is tracked separately.
+             */
+            const size_type s = split_size(k);
+            const digit_t* const a0 = k_ptr;
+            const digit_t* const a1 = k_ptr + s;
+            const digit_t* const a2 = k_ptr + 2 * s;
+            const size_type a2_size = k - 2 * s;
+            const digit_t* const b0 = m_ptr;
+            const digit_t* const b1 = m_ptr + s;
+            const digit_t* const b2 = m_ptr + 2 * s;
+            const size_type b2_size = m - 2 * s;
+            LONGINT_ASSERT_ASSUME(0 < b2_size && b2_size <= a2_size && a2_size <= s);
+
+            // Values at the points are stored at the beginning of the scratch, the rest is passed to the subproducts
+            const size_type eval_size = s + 1;
+            const size_type prod_size = 2 * eval_size;
+            digit_t* const a_1 = scratch;
+            digit_t* const a_m1 = a_1 + eval_size;
+            digit_t* const a_2 = a_m1 + eval_size;
+            digit_t* const b_1 = a_2 + eval_size;
+            digit_t* const b_m1 = b_1 + eval_size;
+            digit_t* const b_2 = b_m1 + eval_size;
+            digit_t* const v1 = b_2 + eval_size;
+            digit_t* const vm1 = v1 + prod_size;
+            digit_t* const v2 = vm1 + prod_size;
+            digit_t* const subproducts_scratch = v2 + prod_size;
+
+            const bool a_m1_is_negative = evaluate(a0, a1, a2, a2_size, s, a_1, a_m1, a_2);
+            const bool b_m1_is_negative = evaluate(b0, b1, b2, b2_size, s, b_1, b_m1, b_2);
+            const bool vm1_is_negative = a_m1_is_negative != b_m1_is_negative;
+
+            // v0 and vinf are written to the non-overlapping parts of the ans
+            digit_t* const v0 = ans;
+            digit_t* const vinf = ans + 4 * s;
+            const size_type vinf_size = a2_size + b2_size;
+            longint::multiply_and_store_to(b0, s, a0, s, v0, subproducts_scratch);
+            std::fill(v0 + 2 * s, vinf, digit_t{0});
+            longint::multiply_and_store_to(b2, b2_size, a2, a2_size, vinf, subproducts_scratch);
+            longint::multiply_and_store_to(b_1, eval_size, a_1, eval_size, v1, subproducts_scratch);
+            longint::multiply_and_store_to(b_m1, eval_size, a_m1, eval_size, vm1, subproducts_scratch);
+            longint::multiply_and_store_to(b_2, eval_size, a_2, eval_size, v2, subproducts_scratch);
+
+            // Interpolation (see Bodrato, Zanoni "Integer and Polynomial Multiplication:
+            //  Towards Optimal Toom-Cook Matrices"), all the values but vm1 are non-negative.
+            // v2 := (v2 - vm1) / 3 = c1 + c2 + 3 c3 + 5 c4
+            add_or_sub_signed(v2, prod_size, vm1, /* subtract = */ !vm1_is_negative);
+            divide_exact_by_3(v2, prod_size);
+            // vm1 := (v1 - vm1) / 2 = c1 + c3
+            if (vm1_is_negative) {
+                add_in_place(vm1, prod_size, v1, prod_size);
+            } else {
+                sub_in_place_reversed(vm1, prod_size, v1);
+            }
+            shift_right_by_one(vm1, prod_size);
+            // v1 := v1 - v0 = c1 + c2 + c3 + c4
+            sub_in_place(v1, prod_size, v0, 2 * s);
+            // v2 := (v2 - v1) / 2 = c3 + 2 c4
+            sub_in_place(v2, prod_size, v1, prod_size);
+            shift_right_by_one(v2, prod_size);
+            // v1 := v1 - vm1 - vinf = c2
+            sub_in_place(v1, prod_size, vm1, prod_size);
+            sub_in_place(v1, prod_size, vinf, vinf_size);
+            // v2 := v2 - 2 vinf = c3
+            sub_in_place(v2, prod_size, vinf, vinf_size);
+            sub_in_place(v2, prod_size, vinf, vinf_size);
+            // vm1 := vm1 - v2 = c1
+            sub_in_place(vm1, prod_size, v2, prod_size);
+
+            const size_type ans_size = m + k;
+            LongIntKaratsuba::add_shifted_to(ans, ans_size, vm1, prod_size, s);
+            LongIntKaratsuba::add_shifted_to(ans, ans_size, v1, prod_size, 2 * s);
+            LongIntKaratsuba::add_shifted_to(ans, ans_size, v2, prod_size, 3 * s);
+        }
 
-            static_assert(kDigitBits == 32);
-            if (likely(!need_high_precision)) {
-                for (size_type i = 0; i < m; i++) {
-                    digit_t m_value = m_ptr[i];
-                    digit_t k_value = k_ptr[i];
+        ATTRIBUTE_CONST
+        [[nodiscard]]
+        static constexpr size_type split_size(const size_type k) noexcept {
+            return (k + 2) / 3;
+        }
+
+        /// @brief Number of the scratch digits needed by the multiply_and_store_to() for the m and k digits
+        ATTRIBUTE_CONST
+        [[nodiscard]]
+        static constexpr std::size_t scratch_size(const size_type m, const size_type k) noexcept {
+            const size_type s = split_size(k);
+            const size_type eval_size = s + 1;
+            const std::size_t subproducts_scratch_size =
+                std::max({longint::mult_scratch_size(s, s), longint::mult_scratch_size(m - 2 * s, k - 2 * s),
+                          longint::mult_scratch_size(eval_size, eval_size)});
+            return 12 * std::size_t{eval_size} + subproducts_scratch_size;
+        }
+
+    private:
+        /// @brief p(1) = p0 + p1 + p2, |p(-1)| = |p0 - p1 + p2|, p(2) = p0 + 2 p1 + 4 p2
+        /// @return true if p(-1) < 0
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        [[nodiscard]]
+        static bool evaluate(const digit_t p0[],
+                             const digit_t p1[],
+                             const digit_t p2[],
+                             const size_type p2_size,
+                             const size_type s,
+                             digit_t p_1[],
+                             digit_t p_m1[],
+                             digit_t p_2[]) noexcept {
+            LONGINT_ASSERT_ASSUME(p2_size <= s);
+            // p_2 = p0 + p2
+            LongIntKaratsuba::add_and_store_to(p0, s, p2, p2_size, p_2);
+            // p_1 = p0 + p2 + p1
+            std::copy_n(p_2, s + 1, p_1);
+            const bool carry = longint_add_with_carry(p_1, s + 1, p1, s);
+            LONGINT_DEBUG_ASSERT(!carry);
+            std::ignore = carry;
+            // p_m1 = |p0 + p2 - p1|
+            std::copy_n(p_2, s + 1, p_m1);
+            const bool is_negative = longint_subtract_with_free_space(p_m1, s + 1, p1, s);
+            // p_2 = p0 + 2 p1 + 4 p2 = ((p2 << 1) + p1) << 1 + p0
+            double_digit_t acc_carry = 0;
+            for (size_type i = 0; i <= s; i++) {
+                const double_digit_t p0_i = i < s ? p0[i] : 0;
+                const double_digit_t p1_i = i < s ? p1[i] : 0;
+                const double_digit_t p2_i = i < p2_size ? p2[i] : 0;
+                const double_digit_t res = p0_i + 2 * p1_i + 4 * p2_i + acc_carry;
+                p_2[i] = static_cast<digit_t>(res);
+                acc_carry = res >> kDigitBits;
+            }
+            LONGINT_DEBUG_ASSERT(acc_carry == 0);
+            return is_negative;
+        }
+
+        /// @brief x[0..size) := |x - y| if subtract else x + y, x - y should be non-negative
+        ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 2)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static constexpr void add_or_sub_signed(digit_t x[],
+                                                const size_type size,
+                                                const digit_t y[],
+                                                const bool subtract) noexcept {
+            if (subtract) {
+                sub_in_place(x, size, y, size);
+            } else {
+                add_in_place(x, size, y, size);
+            }
+        }
+
+        ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static constexpr void add_in_place(digit_t x[],
+                                           const size_type x_size,
+                                           const digit_t y[],
+                                           const size_type y_size) noexcept {
+            const bool carry = longint_add_with_carry(x, x_size, y, y_size);
+            LONGINT_DEBUG_ASSERT(!carry);
+            std::ignore = carry;
+        }
+
+        ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static constexpr void sub_in_place(digit_t x[],
+                                           const size_type x_size,
+                                           const digit_t y[],
+                                           const size_type y_size) noexcept {
+            const bool borrow = longint_subtract_with_carry(x, x_size, y, y_size);
+            LONGINT_DEBUG_ASSERT(!borrow);
+            std::ignore = borrow;
+        }
+
+        /// @brief x[0..size) := y[0..size) - x[0..size)
+        ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 2)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static constexpr void sub_in_place_reversed(digit_t x[], const size_type size, const digit_t y[]) noexcept {
+            bool borrow = false;
+            for (size_type i = 0; i < size; i++) {
+                const auto sub_val = double_digit_t{x[i]} + double_digit_t{borrow};
+                const digit_t y_i = y[i];
+                x[i] = y_i - static_cast<digit_t>(sub_val);
+                borrow = y_i < sub_val;
+            }
+            LONGINT_DEBUG_ASSERT(!borrow);
+        }
+
+        ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static constexpr void divide_exact_by_3(digit_t x[], const size_type size) noexcept {
+            double_digit_t rem = 0;
+            for (size_type i = size; i > 0; i--) {
+                const double_digit_t cur = (rem << kDigitBits) | x[i - 1];
+                x[i - 1] = static_cast<digit_t>(cur / 3);
+                rem = cur % 3;
+            }
+            LONGINT_DEBUG_ASSERT(rem == 0);
+        }
+
+        ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static constexpr void shift_right_by_one(digit_t x[], const size_type size) noexcept {
+            LONGINT_ASSERT_ASSUME(size > 0);
+            LONGINT_DEBUG_ASSERT(x[0] % 2 == 0);
+            for (size_type i = 0; i + 1 < size; i++) {
+                x[i] = (x[i] >> 1) | static_cast<digit_t>(x[i + 1] << (kDigitBits - 1));
+            }
+            x[size - 1] >>= 1;
+        }
+    };
+
+    /// @brief Computes k_ptr[0..k) * m_ptr[0..m) (k >= 2 * m) by slicing the k_ptr
+    ///         into blocks of m digits and multiplying them by the m_ptr
+    /// @note scratch should have at least multiply_unbalanced_scratch_size(m, k) digits
+    ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+    ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+    ATTRIBUTE_ACCESS(read_write, 5)
+    ATTRIBUTE_ACCESS(read_write, 6)
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void multiply_unbalanced(const digit_t m_ptr[],
+                                    const size_type m,
+                                    const digit_t k_ptr[],
+                                    const size_type k,
+                                    digit_t* const ans,
+                                    digit_t* const scratch) {
+        LONGINT_ASSERT_ASSUME(0 < m && 2 * m <= k);
+
+        // Block product is stored at the beginning of the scratch, the rest is passed to the block products
+        digit_t* const block_product = scratch;
+        digit_t* const block_scratch = block_product + 2 * std::size_t{m};
+        longint::multiply_and_store_to(m_ptr, m, k_ptr, m, ans, block_scratch);
+        size_type offset = m;
+        for (; offset + m <= k; offset += m) {
+            // ans[offset..offset + m) are already set, ans[offset + m..offset + 2 m) are not
+            longint::multiply_and_store_to(m_ptr, m, k_ptr + offset, m, block_product, block_scratch);
+            std::fill_n(ans + offset + m, m, digit_t{0});
+            LongIntKaratsuba::add_shifted_to(ans, offset + 2 * m, block_product, 2 * m, offset);
+        }
+
+        if (offset < k) {
+            const size_type tail = k - offset;
+            longint::multiply_and_store_to(k_ptr + offset, tail, m_ptr, m, block_product, block_scratch);
+            std::fill_n(ans + offset + m, tail, digit_t{0});
+            LongIntKaratsuba::add_shifted_to(ans, m + k, block_product, m + tail, offset);
+        }
+    }
+
+    /// @brief Number of the scratch digits needed by the multiply_unbalanced() for the m and k digits
+    ATTRIBUTE_CONST
+    [[nodiscard]]
+    static constexpr std::size_t multiply_unbalanced_scratch_size(const size_type m, const size_type k) noexcept {
+        const size_type tail = k % m;
+        return 2 * std::size_t{m} + std::max(mult_scratch_size(m, m), tail == 0 ? 0 : mult_scratch_size(tail, m));
+    }
+
+    /// @brief Computes m_ptr[0..m) * k_ptr[0..k) and stores it to the ans[0..m + k)
+    ///         choosing the multiplication algorithm based on the operands sizes
+    /// @note ans should not overlap with the m_ptr and k_ptr. Scratch buffer of the Karatsuba
+    ///        and Toom-3 recursion is allocated once here, see mult_scratch_size()
+    template <class MultPolicy = DefaultMultPolicy>
+    ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+    ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+    ATTRIBUTE_ACCESS(read_write, 5)
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static void multiply_and_store_to(const digit_t m_ptr[],
+                                      const size_type m,
+                                      const digit_t k_ptr[],
+                                      const size_type k,
+                                      digit_t* const ans) {
+        const std::size_t scratch_size = mult_scratch_size(m, k);
+        if (scratch_size == 0) {
+            multiply_and_store_to<MultPolicy>(m_ptr, m, k_ptr, k, ans, nullptr);
+            return;
+        }
+
+        std::vector<digit_t> scratch(scratch_size);
+        multiply_and_store_to<MultPolicy>(m_ptr, m, k_ptr, k, ans, scratch.data());
+    }
+
+    /// @brief Same as multiply_and_store_to(m_ptr, m, k_ptr, k, ans), but the Karatsuba and Toom-3 take
+    ///         their buffers from the @a scratch of at least mult_scratch_size(m, k) digits (nullptr if it is 0)
+    template <class MultPolicy = DefaultMultPolicy>
+    ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+    ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+    ATTRIBUTE_ACCESS(read_write, 5)
+    ATTRIBUTE_NONNULL(1, 3, 5)
+    static void multiply_and_store_to(const digit_t m_ptr[],
+                                      size_type m,
+                                      const digit_t k_ptr[],
+                                      size_type k,
+                                      digit_t* const ans,
+                                      digit_t* const scratch) {
+        if (m > k) {
+            std::swap(m_ptr, k_ptr);
+            std::swap(m, k);
+        }
+        LONGINT_ASSERT_ASSUME(0 < m && m <= k);
+
+        if (m < kKaratsubaMultThreshold) {
+            std::fill_n(ans, m + k, digit_t{0});
+            LongIntNaive::multiply_and_store_to(m_ptr, m, k_ptr, k, ans);
+        } else if (m >= kFFTMultThreshold) {
+            if (use_fft_for_product<MultPolicy>(m + k)) {
+                LongIntFFT::multiply_and_store_to(m_ptr, m, k_ptr, k, ans);
+            } else {
+                LongIntNTT::multiply_and_store_to(m_ptr, m, k_ptr, k, ans);
+            }
+        } else if (k >= 2 * m) {
+            longint::multiply_unbalanced(m_ptr, m, k_ptr, k, ans, scratch);
+        } else if (m >= kToomCook3MultThreshold && 2 * LongIntToomCook3::split_size(k) < m) {
+            LongIntToomCook3::multiply_and_store_to(m_ptr, m, k_ptr, k, ans, scratch);
+        } else {
+            LongIntKaratsuba::multiply_and_store_to(m_ptr, m, k_ptr, k, ans, scratch);
+        }
+    }
+
+    /// @brief Number of the scratch digits needed by the multiply_and_store_to() for the m and k digits:
+    ///         every Karatsuba, Toom-3 or unbalanced step takes its buffers from the beginning of the
+    ///         scratch and passes the rest to its subproducts (FFT and NTT allocate their own buffers)
+    ATTRIBUTE_CONST
+    [[nodiscard]]
+    static constexpr std::size_t mult_scratch_size(const size_type m_size, const size_type k_size) noexcept {
+        const size_type m = std::min(m_size, k_size);
+        const size_type k = std::max(m_size, k_size);
+
+        if (m < kKaratsubaMultThreshold || m >= kFFTMultThreshold) {
+            return 0;
+        }
+        if (k >= 2 * m) {
+            return multiply_unbalanced_scratch_size(m, k);
+        }
+        if (m >= kToomCook3MultThreshold && 2 * LongIntToomCook3::split_size(k) < m) {
+            return LongIntToomCook3::scratch_size(m, k);
+        }
+        return LongIntKaratsuba::scratch_size(m, k);
+    }
+
+    template <class MultPolicy>
+    ATTRIBUTE_CONST [[nodiscard]] static constexpr bool use_fft_for_product(const size_type prod_size) noexcept {
+        if constexpr (std::is_same_v<MultPolicy, FFTMultPolicy>) {
+            return true;
+        } else if constexpr (std::is_same_v<MultPolicy, NTTMultPolicy>) {
+            return false;
+        } else {
+            static_assert(std::is_same_v<MultPolicy, AutoMultPolicy>, "Unknown multiplication policy");
+            return !LongIntFFT::compute_fft_product_params(prod_size).need_high_precision;
+        }
+    }
+
+    struct LongIntNTT final {
+        /// @brief Max size of the blocks the operands are split into when
+        ///         m + k > ntt::kMaxProductSize
+        static constexpr size_type kMaxBlockSize = static_cast<size_type>(ntt::kMaxProductSize / 2);
+
+        ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+        ATTRIBUTE_ACCESS(write_only, 5)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static void multiply_and_store_to(const digit_t m_ptr[],
+                                          const size_type m,
+                                          const digit_t k_ptr[],
+                                          const size_type k,
+                                          digit_t* const ans) {
+            LONGINT_ASSERT_ASSUME(0 < m && m <= k);
+            const size_type prod_size = m + k;
+            const std::size_t max_threads = max_fft_threads();
+            if (likely(prod_size <= ntt::kMaxProductSize)) {
+                ntt::multiply_base_2_32(m_ptr, m, k_ptr, k, ans, max_threads);
+                return;
+            }
+
+            struct BlocksPair final {
+                size_type m_offset;
+                size_type k_offset;
+            };
+            std::vector<BlocksPair> blocks_pairs;
+            for (size_type i = 0; i < m; i += kMaxBlockSize) {
+                for (size_type j = 0; j < k; j += kMaxBlockSize) {
+                    blocks_pairs.push_back({i, j});
+                }
+            }
+
+            // Products of the blocks are independent, so up to max_threads of them are computed at once.
+            //  They are summed up by the current thread, all partial sums fit in the prod_size digits
+            std::fill_n(ans, prod_size, digit_t{0});
+            const std::size_t batch_size = std::min(max_threads, blocks_pairs.size());
+            const std::size_t block_product_threads = std::max(max_threads / batch_size, std::size_t{1});
+            constexpr std::size_t kMaxBlockProductSize = 2 * std::size_t{kMaxBlockSize};
+            std::vector<digit_t> block_products(batch_size * kMaxBlockProductSize);
+            for (std::size_t first = 0; first < blocks_pairs.size(); first += batch_size) {
+                const std::size_t count = std::min(batch_size, blocks_pairs.size() - first);
+                misc::thread_pool::instance().run(count, [&, first](const std::size_t index) {
+                    const auto [i, j] = blocks_pairs[first + index];
+                    ntt::multiply_base_2_32(m_ptr + i, std::min(kMaxBlockSize, m - i), k_ptr + j,
+                                            std::min(kMaxBlockSize, k - j),
+                                            block_products.data() + index * kMaxBlockProductSize,
+                                            block_product_threads);
+                });
+                for (std::size_t index = 0; index < count; index++) {
+                    const auto [i, j] = blocks_pairs[first + index];
+                    LongIntKaratsuba::add_shifted_to(ans, prod_size,
+                                                     block_products.data() + index * kMaxBlockProductSize,
+                                                     std::min(kMaxBlockSize, m - i) + std::min(kMaxBlockSize, k - j),
+                                                     i + j);
+                }
+            }
+        }
+    };
+
+    struct LongIntFFT final {
+        using poly_size_type = std::size_t;
+
+        struct FFTParams final {
+            poly_size_type poly_size;
+            bool need_high_precision;
+        };
+
+        ATTRIBUTE_NODISCARD_WITH_MESSAGE("impl error in fft longint product")
+        ATTRIBUTE_ALWAYS_INLINE
+        ATTRIBUTE_CONST
+        static constexpr FFTParams compute_fft_product_params(const size_type product_size) noexcept {
+            static_assert(max_size() * 2 > max_size());
+            static_assert(2 * math_functions::nearest_greater_equal_power_of_two(max_size()) >= 2 * max_size());
+            poly_size_type n = 2 * math_functions::nearest_greater_equal_power_of_two(product_size);
+            const bool need_high_precision = n > kFFTPrecisionBorder;
+            if (need_high_precision) {
+                n *= 2;
+            }
+            LONGINT_ASSERT_ASSUME(math_functions::is_power_of_two(n));
+            return {n, need_high_precision};
+        }
+
+        ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+        ATTRIBUTE_ACCESS(write_only, 5)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        static void multiply_and_store_to(const digit_t m_ptr[],
+                                          const size_type m,
+                                          const digit_t k_ptr[],
+                                          const size_type k,
+                                          digit_t* const ans) {
+            LONGINT_ASSERT_ASSUME(0 < m && m <= k);
+            const size_type prod_size = m + k;
+            const auto [n, need_high_precision] = compute_fft_product_params(prod_size);
+            // Allocate n complex numbers for p1 and n complex numbers for p2
+            const std::unique_ptr<fft::complex, struct ComplexDeleter> p1(allocate_complex_array_for_unique_ptr(2 * n));
+            if (m_ptr == k_ptr && m == k) {
+                convert_longint_nums_to_fft_poly(m_ptr, m, p1.get(), n, need_high_precision);
+            } else {
+                convert_longint_nums_to_fft_poly(m_ptr, m, k_ptr, k, p1.get(), n, need_high_precision);
+            }
+            fft::complex* const p2 = p1.get() + n;
+            fft::forward_backward_fft(p1.get(), p2, n, max_fft_threads());
+            convert_fft_poly_to_longint_nums(need_high_precision, p2, ans, prod_size);
+        }
+
+        /// @brief Writes the 16-bit halves of the digits as the real polynomial in the
+        ///         packed form (see fft::PrecomputedOperand): one complex number per digit
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(write_only, 3, 4)
+        static void convert_longint_nums_to_packed_fft_poly(const digit_t nums[],
+                                                            const size_type nums_size,
+                                                            fft::complex* RESTRICT_QUALIFIER p,
+                                                            const poly_size_type packed_size) noexcept {
+            LONGINT_ASSERT_ASSUME(nums_size <= packed_size);
+            static_assert(kDigitBits == 32);
+            for (size_type i = 0; i < nums_size; i++) {
+                const digit_t value = nums[i];
+                p[i] = fft::complex{
+                    static_cast<double>(value & 0xFFFF),
+                    static_cast<double>(value >> 16),
+                };
+            }
+            std::fill(p + nums_size, p + packed_size, fft::complex{});
+        }
+
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        ATTRIBUTE_ACCESS(read_only, 1)
+        ATTRIBUTE_SIZED_ACCESS(write_only, 2, 3)
+        static void convert_packed_fft_poly_to_longint_nums(const fft::complex* RESTRICT_QUALIFIER poly,
+                                                           digit_t* RESTRICT_QUALIFIER nums,
+                                                           const size_type nums_size) noexcept {
+            double_digit_t carry = 0;
+            for (size_type i = 0; i < nums_size; i++) {
+                const auto low = static_cast<double_digit_t>(poly[i].real() + kFFTFloatRoundError);
+                const auto high = static_cast<double_digit_t>(poly[i].imag() + kFFTFloatRoundError);
+                // high may take up to 50 bits, so it is shifted in two parts
+                const double_digit_t res = carry + low + ((high & 0xFFFF) << 16);
+                nums[i] = static_cast<digit_t>(res);
+                carry = (res >> kDigitBits) + (high >> 16);
+            }
+            assert(carry == 0);
+        }
+
+        /// @brief Same as convert_packed_fft_poly_to_longint_nums(), but for the cyclic product: the carry out
+        ///         of the highest digit is added to the lowest one, so the nums hold the product
+        ///         modulo kNumsBase^{nums_size} - 1 (not fully reduced, it may be equal to the modulus)
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        ATTRIBUTE_ACCESS(read_only, 1)
+        ATTRIBUTE_SIZED_ACCESS(write_only, 2, 3)
+        static void convert_packed_fft_poly_to_longint_nums_mod(const fft::complex* RESTRICT_QUALIFIER poly,
+                                                               digit_t* RESTRICT_QUALIFIER nums,
+                                                               const size_type nums_size) noexcept {
+            double_digit_t carry = 0;
+            for (size_type i = 0; i < nums_size; i++) {
+                const auto low = static_cast<double_digit_t>(poly[i].real() + kFFTFloatRoundError);
+                const auto high = static_cast<double_digit_t>(poly[i].imag() + kFFTFloatRoundError);
+                const double_digit_t res = carry + low + ((high & 0xFFFF) << 16);
+                nums[i] = static_cast<digit_t>(res);
+                carry = (res >> kDigitBits) + (high >> 16);
+            }
+            add_carry_mod(nums, nums_size, carry);
+        }
+
+        /// @brief nums += carry modulo kNumsBase^{nums_size} - 1
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+        static void add_carry_mod(digit_t nums[], const size_type nums_size, double_digit_t carry) noexcept {
+            LONGINT_ASSERT_ASSUME(nums_size > 0);
+            // kNumsBase^{nums_size} = 1, so the carry out of the highest digit goes to the lowest one
+            for (size_type i = 0; carry != 0; i = i + 1 == nums_size ? 0 : i + 1) {
+                const double_digit_t res = carry + nums[i];
+                nums[i] = static_cast<digit_t>(res);
+                carry = res >> kDigitBits;
+            }
+        }
+
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        ATTRIBUTE_ACCESS(read_only, 2)
+        ATTRIBUTE_SIZED_ACCESS(write_only, 3, 4)
+        static void convert_fft_poly_to_longint_nums(const bool is_high_precision,
+                                                     const fft::complex* RESTRICT_QUALIFIER poly,
+                                                     digit_t* RESTRICT_QUALIFIER nums,
+                                                     const size_type nums_size) {
+            LONGINT_ASSERT_ASSUME(nums_size > 0);
+
+            static_assert(sizeof(digit_t) == sizeof(uint32_t));
+            double_digit_t carry = 0;
+            const digit_t* const nums_end = nums + nums_size;
+            if (likely(!is_high_precision)) {
+                do {
+                    double_digit_t res = carry;
+                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError);
+                    poly++;
+                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError) << 16;
+                    poly++;
+                    *nums = static_cast<digit_t>(res);
+                    carry = res / kNumsBase;
+                    nums++;
+                } while (nums < nums_end);
+            } else {
+                do {
+                    double_digit_t res = carry;
+                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError);
+                    poly++;
+                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError) << 8;
+                    poly++;
+                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError) << 16;
+                    poly++;
+                    res += static_cast<double_digit_t>(poly->real() + kFFTFloatRoundError) << 24;
+                    poly++;
+                    *nums = static_cast<digit_t>(res);
+                    carry = res / kNumsBase;
+                    nums++;
+                } while (nums < nums_end);
+            }
+            assert(carry == 0);
+        }
+
+        ATTRIBUTE_NONNULL_ALL_ARGS
+        ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+        ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+        ATTRIBUTE_SIZED_ACCESS(write_only, 5, 6)
+        static void convert_longint_nums_to_fft_poly(const digit_t m_ptr[],
+                                                     const size_type m,
+                                                     const digit_t k_ptr[],
+                                                     const size_type k,
+                                                     fft::complex* p,
+                                                     const poly_size_type n,
+                                                     const bool need_high_precision) noexcept {
+            LONGINT_ASSERT_ASSUME(0 < m);
+            LONGINT_ASSERT_ASSUME(m <= k);
+            LONGINT_ASSERT_ASSUME(m <= max_size());
+            LONGINT_ASSERT_ASSUME(k <= max_size());
+            LONGINT_ASSERT_ASSUME(m + k <= max_size());
+            LONGINT_ASSERT_ASSUME(m + k <= n);
+            LONGINT_ASSERT_ASSUME(need_high_precision || n <= kFFTPrecisionBorder);
+            LONGINT_ASSERT_ASSUME(!need_high_precision || n > kFFTPrecisionBorder * 2);
+            LONGINT_ASSERT_ASSUME(math_functions::is_power_of_two(n));
+
+            static_assert(kDigitBits == 32);
+            if (likely(!need_high_precision)) {
+                for (size_type i = 0; i < m; i++) {
+                    digit_t m_value = m_ptr[i];
+                    digit_t k_value = k_ptr[i];
 
                     *p = fft::complex{
                         static_cast<double>(static_cast<uint16_t>(m_value)),
@@ -2365,29 +4005,335 @@ private:
         }
     };
 
-    static void check_dec_str(std::string_view str) {
-        constexpr auto is_digit = [](const char chr) constexpr noexcept {
-            const std::uint32_t widen{static_cast<unsigned char>(chr)};
-            return widen - '0' <= '9' - '0';
-        };
-        if (!str.empty() && str.front() == '-') {
-            str.remove_prefix(1);
-        }
-        if (unlikely(str.empty() || !all_of(str, is_digit))) {
-            throw_on_invalid_dec_str(LONGINT_FILE_LOCATION(), str);
+    ATTRIBUTE_ALWAYS_INLINE
+    static void store_u32_le(std::byte* const out, const std::uint32_t value) noexcept {
+        for (std::size_t i = 0; i < sizeof(value); i++) {
+            out[i] = static_cast<std::byte>(value >> (8 * i));
         }
     }
 
-    template <typename P>
-    [[nodiscard]] static bool all_of(const std::string_view str,
-                                     P pred) noexcept(std::is_nothrow_invocable_r_v<bool, P, char>) {
-        static_assert(std::is_invocable_r_v<bool, P, char>);
-        bool ret = true;
-        for (const char c : str) {
-            ret &= pred(c);
+    ATTRIBUTE_ALWAYS_INLINE
+    ATTRIBUTE_PURE
+    [[nodiscard]] static std::uint32_t load_u32_le(const std::byte* const data) noexcept {
+        std::uint32_t value = 0;
+        for (std::size_t i = 0; i < sizeof(value); i++) {
+            value |= std::uint32_t{std::to_integer<std::uint8_t>(data[i])} << (8 * i);
         }
+        return value;
+    }
 
-        return ret;
+    /// @brief Checks that @a data[0..size) is the longint binary format
+    /// @return size() of the stored number
+    ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+    [[nodiscard]] static ssize_type check_binary(const std::byte data[], const std::size_t size) {
+        if (unlikely(size < kBinaryHeaderSize || load_u32_le(data) != kBinaryMagic)) {
+            throw_on_invalid_binary(LONGINT_FILE_LOCATION(), "bad header");
+        }
+        const auto ssize_value = static_cast<ssize_type>(load_u32_le(data + 4));
+        const size_type usize_value = math_functions::uabs(ssize_value);
+        if (unlikely(usize_value > max_size())) {
+            throw_on_invalid_binary(LONGINT_FILE_LOCATION(), "too many digits");
+        }
+        if (unlikely(size != kBinaryHeaderSize + std::size_t{usize_value} * sizeof(digit_t))) {
+            throw_on_invalid_binary(LONGINT_FILE_LOCATION(), "size mismatch");
+        }
+        if (unlikely(usize_value > 0 &&
+                     load_u32_le(data + kBinaryHeaderSize + (usize_value - 1) * sizeof(digit_t)) == 0)) {
+            throw_on_invalid_binary(LONGINT_FILE_LOCATION(), "leading zero digit");
+        }
+        return ssize_value;
+    }
+
+    ATTRIBUTE_COLD
+    [[noreturn]] static void throw_on_invalid_binary(const char* const file_location,
+                                                     const char* const function_name,
+                                                     const char* const reason) {
+        std::string msg = "Can't read longint from the binary data (";
+        msg.append(reason);
+        msg.append(") at ");
+        msg.append(file_location);
+        msg.push_back(' ');
+        msg.append(function_name);
+        throw std::invalid_argument{msg};
+    }
+
+    static constexpr std::string_view kBaseDigitChars = "0123456789abcdefghijklmnopqrstuvwxyz";
+    static constexpr uint32_t kMaxStringBase = static_cast<uint32_t>(kBaseDigitChars.size());
+
+    static void check_base(const char* const file_location, const char* const function_name, const uint32_t base) {
+        if (unlikely(base < 2 || base > kMaxStringBase)) {
+            throw_on_invalid_base(file_location, function_name, base);
+        }
+    }
+
+    ATTRIBUTE_COLD
+    [[noreturn]] static void throw_on_invalid_base(const char* const file_location,
+                                                   const char* const function_name,
+                                                   const uint32_t base) {
+        std::string msg = "Invalid base ";
+        msg += std::to_string(base);
+        msg.append(" of the longint string at ");
+        msg.append(file_location);
+        msg.push_back(' ');
+        msg.append(function_name);
+        throw std::invalid_argument{msg};
+    }
+
+    /// @return value of the digit @a chr or value >= 36 if it is not a digit
+    ATTRIBUTE_CONST [[nodiscard]] static constexpr uint32_t char_to_base_digit(const char chr) noexcept {
+        const std::uint32_t widen{static_cast<unsigned char>(chr)};
+        if (widen - '0' <= '9' - '0') {
+            return widen - '0';
+        }
+        // 'a' = 'A' | 0x20
+        const std::uint32_t lower = widen | 0x20U;
+        if (lower - 'a' <= 'z' - 'a') {
+            return lower - 'a' + 10;
+        }
+        return kMaxStringBase;
+    }
+
+    static void check_str_in_base(std::string_view str, const uint32_t base) {
+        const std::string_view full_str = str;
+        if (!str.empty() && str.front() == '-') {
+            str.remove_prefix(1);
+        }
+        const auto is_digit = [base](const char chr) constexpr noexcept { return char_to_base_digit(chr) < base; };
+        if (unlikely(str.empty() || !all_of(str, is_digit))) {
+            throw_on_invalid_str_in_base(LONGINT_FILE_LOCATION(), full_str, base);
+        }
+    }
+
+    ATTRIBUTE_COLD
+    [[noreturn]] static void throw_on_invalid_str_in_base(const char* const file_location,
+                                                          const char* const function_name,
+                                                          const std::string_view str,
+                                                          const uint32_t base) {
+        std::string msg = "Can't convert string '";
+        msg.append(str);
+        msg.append("' in base ");
+        msg += std::to_string(base);
+        msg.append(" to longint at ");
+        msg.append(file_location);
+        msg.push_back(' ');
+        msg.append(function_name);
+        throw std::invalid_argument{msg};
+    }
+
+    /// @brief Sets *this to the non-negative number written with @a bits_per_char bits per char
+    void set_pow2_base_str_impl(const std::string_view digits, const uint32_t bits_per_char) {
+        LONGINT_ASSERT_ASSUME(1 <= bits_per_char && bits_per_char <= 5);
+        const std::size_t total_bits = digits.size() * bits_per_char;
+        const size_type nums_size = check_size((total_bits + kDigitBits - 1) / kDigitBits);
+        reserveUninitializedWithoutCopy(nums_size);
+
+        size_type i = 0;
+        double_digit_t bits = 0;
+        uint32_t bits_count = 0;
+        for (auto iter = digits.rbegin(); iter != digits.rend(); ++iter) {
+            bits |= double_digit_t{char_to_base_digit(*iter)} << bits_count;
+            bits_count += bits_per_char;
+            if (bits_count >= kDigitBits) {
+                nums_[i++] = static_cast<digit_t>(bits);
+                bits >>= kDigitBits;
+                bits_count -= kDigitBits;
+            }
+        }
+        if (bits_count > 0) {
+            nums_[i++] = static_cast<digit_t>(bits);
+        }
+        LONGINT_ASSERT_ASSUME(i == nums_size);
+        set_ssize_from_size_and_sign(nums_size, /* sign = */ 1);
+        pop_leading_zeros();
+    }
+
+    /// @brief Appends |*this| != 0 written with @a bits_per_char bits per char to the @a ans
+    void append_pow2_base_str(std::string& ans, const uint32_t bits_per_char) const {
+        LONGINT_ASSERT_ASSUME(1 <= bits_per_char && bits_per_char <= 5);
+        const size_type usize_value = usize();
+        LONGINT_ASSERT_ASSUME(usize_value > 0);
+        const auto top_digit_bits =
+            kDigitBits - static_cast<std::size_t>(math_functions::countl_zero(nums_[usize_value - 1]));
+        const std::size_t total_bits = std::size_t{usize_value - 1} * kDigitBits + top_digit_bits;
+        std::size_t chars = (total_bits + bits_per_char - 1) / bits_per_char;
+        const std::size_t old_size = ans.size();
+        ans.resize(old_size + chars);
+        char* str = ans.data() + old_size;
+
+        if (bits_per_char == 4) {
+            // All digits except the highest one are written as 8 hex chars with the byte table
+            static constexpr auto kHexBytes = []() constexpr noexcept {
+                std::array<std::array<char, 2>, 256> table{};
+                for (std::size_t byte = 0; byte < table.size(); byte++) {
+                    table[byte][0] = kBaseDigitChars[byte >> 4U];
+                    table[byte][1] = kBaseDigitChars[byte & 0xFU];
+                }
+                return table;
+            }();
+            const std::size_t low_chars = std::size_t{usize_value - 1} * (kDigitBits / 4);
+            char* low_str = str + (chars - low_chars);
+            for (size_type i = usize_value - 1; i > 0; i--) {
+                const digit_t digit = nums_[i - 1];
+                for (uint32_t shift = kDigitBits; shift > 0; shift -= 8) {
+                    const auto& pair = kHexBytes[(digit >> (shift - 8)) & 0xFFU];
+                    *low_str++ = pair[0];
+                    *low_str++ = pair[1];
+                }
+            }
+            chars -= low_chars;
+        }
+
+        const digit_t mask = (digit_t{1} << bits_per_char) - 1;
+        for (std::size_t char_index = 0; char_index < chars; char_index++) {
+            const std::size_t bit_pos = (chars - 1 - char_index) * bits_per_char +
+                                        (bits_per_char == 4 ? std::size_t{usize_value - 1} * kDigitBits : 0);
+            const std::size_t digit_index = bit_pos / kDigitBits;
+            const auto shift = static_cast<uint32_t>(bit_pos % kDigitBits);
+            digit_t value = nums_[digit_index] >> shift;
+            if (shift + bits_per_char > kDigitBits && digit_index + 1 < usize_value) {
+                value |= nums_[digit_index + 1] << (kDigitBits - shift);
+            }
+            str[char_index] = kBaseDigitChars[value & mask];
+        }
+    }
+
+    /// @brief Parameters of the conversion to / from the base that is not a power of two:
+    ///         chunk_size chars are converted at once to the number < chunk_base = base^{chunk_size}
+    struct BaseChunks final {
+        explicit constexpr BaseChunks(const uint32_t str_base) noexcept
+            : base(str_base), chunk_size(1), chunk_base(str_base) {
+            while (double_digit_t{chunk_base} * base <= std::numeric_limits<uint32_t>::max()) {
+                chunk_base *= base;
+                chunk_size++;
+            }
+        }
+
+        uint32_t base;
+        uint32_t chunk_size;
+        uint32_t chunk_base;
+    };
+
+    /// @brief Nodes with at most kBaseLeafChunks chunks are converted by the schoolbook algorithm
+    static constexpr std::size_t kBaseLeafChunks = 16;
+
+    /// @return P_k = chunk_base^{kBaseLeafChunks * 2^k}, k = 0, ..., pows_count - 1
+    [[nodiscard]] static std::vector<longint> make_base_chunks_pows(const BaseChunks& params,
+                                                                    const std::size_t pows_count) {
+        std::vector<longint> pows;
+        pows.reserve(pows_count);
+        if (pows_count > 0) {
+            pows.emplace_back(params.chunk_base).pow(kBaseLeafChunks);
+        }
+        while (pows.size() < pows_count) {
+            longint square;
+            pows.back().square_this_to(square);
+            pows.push_back(std::move(square));
+        }
+        return pows;
+    }
+
+    /// @return sum(chunks[i] * chunk_base^i), i = 0, ..., count - 1
+    ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+    [[nodiscard]] static longint base_chunks_to_longint(const uint32_t chunks[],
+                                                        const std::size_t count,
+                                                        const std::vector<longint>& pows,
+                                                        const BaseChunks& params) {
+        if (count <= kBaseLeafChunks) {
+            longint ret;
+            for (std::size_t i = count; i > 0; i--) {
+                ret.mul_add_u32(params.chunk_base, chunks[i - 1]);
+            }
+            return ret;
+        }
+
+        // Low part has kBaseLeafChunks * 2^k chunks and its weight is P_k
+        std::size_t k = 0;
+        while ((kBaseLeafChunks << (k + 1)) < count) {
+            k++;
+        }
+        const std::size_t low_count = kBaseLeafChunks << k;
+        LONGINT_ASSERT_ASSUME(k < pows.size());
+        longint ret = base_chunks_to_longint(chunks, low_count, pows, params);
+        const longint high = base_chunks_to_longint(chunks + low_count, count - low_count, pows, params);
+        ret.addmul(high, pows[k]);
+        return ret;
+    }
+
+    inline void set_base_str_impl(std::string_view digits, uint32_t base);
+
+    /// @brief Appends |*this| != 0 written in the @a base (not a power of two) to the @a ans
+    inline void append_base_str_div_conq(std::string& ans, uint32_t base) const;
+
+    /**
+     * @brief Writes exactly @a width digits of the @a x in the params.base (padded with leading zeros)
+     *         to the @a str, see write_dec_digits_div_conq
+     * @note x < base^{width}, width is a multiple of the params.chunk_size
+     */
+    ATTRIBUTE_SIZED_ACCESS(write_only, 5, 6)
+    static inline void write_base_digits_div_conq(longint&& x,
+                                                  const std::vector<longint>& pows,
+                                                  std::size_t pows_count,
+                                                  const BaseChunks& params,
+                                                  char* str,
+                                                  std::size_t width);
+
+    ATTRIBUTE_SIZED_ACCESS(write_only, 3, 4)
+    static void write_base_digits_naive(const longint& x,
+                                        const BaseChunks& params,
+                                        char* const str,
+                                        const std::size_t width) {
+        LONGINT_ASSERT_ASSUME(x.usize() <= kDivConqToStringLeafSize);
+        LONGINT_ASSERT_ASSUME(width % params.chunk_size == 0);
+        std::array<digit_t, kDivConqToStringLeafSize> digits{};
+        size_type size_value = x.usize();
+        std::copy_n(x.nums_, size_value, digits.begin());
+
+        char* str_iter = str + width;
+        while (size_value > 0) {
+            double_digit_t rem = 0;
+            for (size_type i = size_value; i > 0; i--) {
+                const double_digit_t cur = (rem << kDigitBits) | digits[i - 1];
+                digits[i - 1] = static_cast<digit_t>(cur / params.chunk_base);
+                rem = cur % params.chunk_base;
+            }
+            if (digits[size_value - 1] == 0) {
+                size_value--;
+            }
+
+            LONGINT_ASSERT_ASSUME(static_cast<std::size_t>(str_iter - str) >= params.chunk_size);
+            auto chunk = static_cast<std::uint32_t>(rem);
+            for (auto j = params.chunk_size; j > 0; j--) {
+                *--str_iter = kBaseDigitChars[chunk % params.base];
+                chunk /= params.base;
+            }
+        }
+
+        std::fill(str, str_iter, '0');
+    }
+
+    static void check_dec_str(std::string_view str) {
+        constexpr auto is_digit = [](const char chr) constexpr noexcept {
+            const std::uint32_t widen{static_cast<unsigned char>(chr)};
+            return widen - '0' <= '9' - '0';
+        };
+        if (!str.empty() && str.front() == '-') {
+            str.remove_prefix(1);
+        }
+        if (unlikely(str.empty() || !all_of(str, is_digit))) {
+            throw_on_invalid_dec_str(LONGINT_FILE_LOCATION(), str);
+        }
+    }
+
+    template <typename P>
+    [[nodiscard]] static bool all_of(const std::string_view str,
+                                     P pred) noexcept(std::is_nothrow_invocable_r_v<bool, P, char>) {
+        static_assert(std::is_invocable_r_v<bool, P, char>);
+        bool ret = true;
+        for (const char c : str) {
+            ret &= pred(c);
+        }
+
+        return ret;
     }
 
     ATTRIBUTE_COLD
@@ -2417,6 +4363,155 @@ private:
     ATTRIBUTE_SIZED_ACCESS(read_only, 2, 3)
     inline void set_dec_str_impl(const unsigned char* str, const std::size_t str_size);
 
+    /// @brief Levels of the decimal string conversion of the numbers with less digits are done by one thread
+    static constexpr size_type kMinParallelDecStrConvDigits = size_type{1} << 12U;
+
+    /// @brief Buffers for the convert_dec_base_mult_add() with at most conv_len digits:
+    ///         conv_len digits followed by the complex numbers for the FFT
+    class DecStrConvBuffer final {
+    public:
+        explicit DecStrConvBuffer(const size_type conv_len)
+            : poly_offset_(round_up_to_complex_size(conv_len)),
+              allocated_size_(poly_offset_ + poly_size(conv_len) * kDigitsPerComplex),
+              memory_(std::allocator<digit_t>{}.allocate(allocated_size_)) {}
+
+        DecStrConvBuffer(const DecStrConvBuffer&) = delete;
+        DecStrConvBuffer& operator=(const DecStrConvBuffer&) = delete;
+
+        ~DecStrConvBuffer() {
+            std::allocator<digit_t>{}.deallocate(memory_, allocated_size_);
+        }
+
+        [[nodiscard]] digit_t* mult_add_buffer() const noexcept {
+            return memory_;
+        }
+
+        [[nodiscard]] fft::complex* fft_poly_buffer() const noexcept {
+#if CONFIG_COMPILER_ID == CONFIG_GCC_COMPILER_ID
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-align"
+#endif
+#ifdef __STDCPP_DEFAULT_NEW_ALIGNMENT__
+            static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= alignof(fft::complex), "");
+#endif
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            assert(reinterpret_cast<std::uintptr_t>(memory_) % alignof(fft::complex) == 0);
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            return reinterpret_cast<fft::complex*>(memory_ + poly_offset_);
+#if CONFIG_COMPILER_ID == CONFIG_GCC_COMPILER_ID
+#pragma GCC diagnostic pop
+#endif
+        }
+
+    private:
+        static_assert(sizeof(fft::complex) % sizeof(digit_t) == 0);
+        static constexpr std::size_t kDigitsPerComplex = sizeof(fft::complex) / sizeof(digit_t);
+
+        [[nodiscard]] static constexpr std::size_t round_up_to_complex_size(const size_type conv_len) noexcept {
+            return (std::size_t{conv_len} + kDigitsPerComplex - 1) / kDigitsPerComplex * kDigitsPerComplex;
+        }
+
+        [[nodiscard]] static constexpr std::size_t poly_size(const size_type conv_len) noexcept {
+            static_assert(max_size() * 4 > max_size());
+            std::size_t m = std::size_t{conv_len} * 2;
+            if (m > kFFTPrecisionBorder) {
+                m *= 2;
+            }
+            // m complex numbers for p1 and m complex numbers for p2
+            return 2 * m;
+        }
+
+        std::size_t poly_offset_;
+        std::size_t allocated_size_;
+        digit_t* memory_;
+    };
+
+    using DecStrConvBuffers = std::vector<std::unique_ptr<DecStrConvBuffer>>;
+
+    /// @brief Buffers of the tasks of the set_dec_str_impl() levels: task i converts the blocks of
+    ///         at most @a str_conv_digits_size / (i + 1) digits because every level has at least i + 1 blocks.
+    ///         Buffers are allocated once for all the levels
+    [[nodiscard]] static DecStrConvBuffers make_dec_str_conv_buffers(size_type str_conv_digits_size,
+                                                                     std::size_t tasks);
+
+    /// @brief Does one level of the set_dec_str_impl(): blocks of @a conv_len digits of the
+    ///         @a str_conv_digits are split between the @a tasks tasks on the misc::thread_pool,
+    ///         task i uses the @a buffers[i]
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+    static void convert_dec_base_level_in_parallel(digit_t str_conv_digits[],
+                                                   size_type str_conv_digits_size,
+                                                   size_type conv_len,
+                                                   const PrecomputedMultiplier& conv_base_pow,
+                                                   std::size_t tasks,
+                                                   const DecStrConvBuffers& buffers);
+
+    /**
+     * Numbers with less than kDecimalToStringThreshold digits are converted to the decimal string by
+     *  recursively dividing them by the P_k = 10^{9 * 2^k} (longint_static_storage::conv_dec_base_pows):
+     *  every node x < P_k^2 is split by one Barrett step with the cached longint::PrecomputedDivisor of
+     *  the P_k (longint_static_storage::conv_dec_base_pows_divisors), nodes with at most
+     *  kDivConqToStringLeafSize digits are converted by the repeated division by 10^9.
+     * Bigger numbers are converted bottom-up to the Decimal (see convert_bin_base): the divisors of their
+     *  top nodes need the transforms longer than the kFFTPrecisionBorder, so their remainders can not be
+     *  restored from the cyclic products and every split costs two full products instead of one.
+     * Thresholds were picked with number_theory/measure_longint.cpp (x86-64, -O2).
+     */
+    static constexpr size_type kDecimalToStringThreshold = size_type{1} << 18U;
+    static constexpr size_type kDivConqToStringLeafSize = 32;
+
+    class PrecomputedDivisor;
+
+    /**
+     * @brief x := x / divisor.divisor(), rem := x % divisor.divisor() by one Barrett step,
+     *         see longint::PrecomputedDivisor
+     * @note 0 <= x < d * kNumsBase^n (e.g. x < d^2), where d = divisor.divisor() has n digits
+     */
+    static inline void divmod_precomputed(longint& x, const PrecomputedDivisor& divisor, longint& rem);
+
+    /// @brief Appends decimal representation of the *this to the @a ans, usize() < kDecimalToStringThreshold
+    inline void append_to_string_div_conq(std::string& ans) const;
+
+    /**
+     * @brief Writes exactly @a width decimal digits of the @a x (padded with leading zeros) to the @a str
+     * @note x < 10^{width}, x < P_{pows_count}, width is a multiple of 9
+     */
+    ATTRIBUTE_SIZED_ACCESS(write_only, 3, 4)
+    static inline void write_dec_digits_div_conq(longint&& x,
+                                                 std::size_t pows_count,
+                                                 unsigned char* str,
+                                                 std::size_t width);
+
+    ATTRIBUTE_SIZED_ACCESS(write_only, 2, 3)
+    static void write_dec_digits_naive(const longint& x, unsigned char* const str, const std::size_t width) {
+        LONGINT_ASSERT_ASSUME(x.usize() <= kDivConqToStringLeafSize);
+        LONGINT_ASSERT_ASSUME(width % kStrConvBaseDigits == 0);
+        std::array<digit_t, kDivConqToStringLeafSize> digits{};
+        size_type size_value = x.usize();
+        std::copy_n(x.nums_, size_value, digits.begin());
+
+        unsigned char* str_iter = str + width;
+        while (size_value > 0) {
+            double_digit_t rem = 0;
+            for (size_type i = size_value; i > 0; i--) {
+                const double_digit_t cur = (rem << kDigitBits) | digits[i - 1];
+                digits[i - 1] = static_cast<digit_t>(cur / kStrConvBase);
+                rem = cur % kStrConvBase;
+            }
+            if (digits[size_value - 1] == 0) {
+                size_value--;
+            }
+
+            LONGINT_ASSERT_ASSUME(str_iter - str >= kStrConvBaseDigits);
+            auto block = static_cast<std::uint32_t>(rem);
+            for (auto j = kStrConvBaseDigits; j > 0; j--) {
+                *--str_iter = static_cast<unsigned char>('0' + block % 10);
+                block /= 10;
+            }
+        }
+
+        std::fill(str, str_iter, static_cast<unsigned char>('0'));
+    }
+
     [[nodiscard]]
     ATTRIBUTE_PURE constexpr int64_t mod_by_power_of_2_ge_2_impl(const uint32_t n) const noexcept {
         LONGINT_ASSERT_ASSUME((n & (n - 1)) == 0);
@@ -2426,7 +4521,762 @@ private:
         return is_negative() ? -int64_t{remainder} : int64_t{remainder};
     }
 
+    /**
+     * Division tiers (by the length m of the dividend and the length n of the divisor):
+     *   n < kBurnikelZieglerDivThreshold or
+     *   m - n < kBurnikelZieglerDivThreshold  -> Knuth's algorithm D (divmod_impl_schoolbook)
+     *   n >= kNewtonDivThreshold and
+     *   m >= kNewtonDivMinBlocks * n          -> Newton's reciprocal + Barrett reduction
+     *   otherwise                             -> recursive Burnikel-Ziegler division
+     * Computing the reciprocal costs several multiplications of the n digit numbers, so
+     *  it pays off only when it's reused for many blocks of the dividend (or by the longint::Reciprocal).
+     * Thresholds were picked with number_theory/measure_longint.cpp (x86-64, -O2).
+     */
+    static constexpr size_type kBurnikelZieglerDivThreshold = 128;
+    static constexpr size_type kNewtonDivThreshold = 4096;
+    static constexpr size_type kNewtonDivMinBlocks = 8;
+    /// @brief longint::Reciprocal uses the Barrett reduction for the divisors with at least this number of digits
+    static constexpr size_type kReciprocalDivThreshold = 1024;
+    /// @brief Reciprocals of the divisors with at most this number of digits are
+    ///         computed by the schoolbook division
+    static constexpr size_type kNewtonReciprocalBaseSize = 64;
+
+    /// @brief Numbers with at least kHalfGcdThreshold digits are reduced by the half-gcd,
+    ///         smaller ones by Lehmer's algorithm
+    static constexpr size_type kHalfGcdThreshold = 512;
+
+    /// @brief Matrix of the Euclid steps with small cofactors:
+    ///         (x, y) := (a00 * x + a01 * y, a10 * x + a11 * y), |aij| <= 2^32 - 1
+    struct LehmerCofactors final {
+        int64_t a00;
+        int64_t a01;
+        int64_t a10;
+        int64_t a11;
+    };
+
+    /// @brief Product of the Euclid steps (x, y) := M * (x, y), det(M) = +-1
+    struct GcdMatrix;
+
+    /// @return floor(|x| / 2^shift) mod 2^64
+    [[nodiscard]] static std::uint64_t top_bits_at(const longint& x, const std::uint32_t shift) noexcept {
+        const size_type index = shift / kDigitBits;
+        const std::uint32_t offset = shift % kDigitBits;
+        const size_type x_size = x.usize();
+        const auto digit_at = [&](const size_type i) noexcept {
+            return i < x_size ? double_digit_t{x.nums_[i]} : double_digit_t{0};
+        };
+        const double_digit_t low = digit_at(index) | (digit_at(index + 1) << kDigitBits);
+        if (offset == 0) {
+            return low;
+        }
+        return (low >> offset) | (digit_at(index + 2) << (2 * kDigitBits - offset));
+    }
+
+    /**
+     * @brief Knuth's Algorithm L (TAOCP vol. 2, 4.5.2): simulates the Euclid steps on the
+     *         highest 62 bits of the x and y while the quotients of both (x_hat + A) / (y_hat + C)
+     *         and (x_hat + B) / (y_hat + D) coincide
+     * @note x >= y > 0
+     * @return false if no step can be made (then the full division step should be made)
+     */
+    [[nodiscard]] static bool lehmer_cofactors(const longint& x, const longint& y, LehmerCofactors& c) noexcept {
+        constexpr std::uint32_t kHatBits = 62;
+        constexpr std::uint64_t kMaxCofactor = std::numeric_limits<digit_t>::max();
+        const size_type x_size = x.usize();
+        const auto top_digit_zeros = static_cast<std::size_t>(math_functions::countl_zero(x.nums_[x_size - 1]));
+        const auto bits = static_cast<std::uint32_t>(std::size_t{x_size} * kDigitBits - top_digit_zeros);
+        const std::uint32_t shift = bits > kHatBits ? bits - kHatBits : 0;
+        auto x_hat = static_cast<int64_t>(top_bits_at(x, shift));
+        auto y_hat = static_cast<int64_t>(top_bits_at(y, shift));
+
+        int64_t a = 1;
+        int64_t b = 0;
+        int64_t c_ = 0;
+        int64_t d = 1;
+        while (y_hat + c_ > 0 && y_hat + d > 0) {
+            const int64_t q = (x_hat + a) / (y_hat + c_);
+            if (q != (x_hat + b) / (y_hat + d)) {
+                break;
+            }
+            // Cofactors alternate in sign, so |a - q * c| = |a| + q * |c|
+            const auto uq = static_cast<std::uint64_t>(q);
+            const std::uint64_t c_abs = math_functions::uabs(c_);
+            const std::uint64_t d_abs = math_functions::uabs(d);
+            if ((c_abs != 0 && uq > (kMaxCofactor - math_functions::uabs(a)) / c_abs) ||
+                (d_abs != 0 && uq > (kMaxCofactor - math_functions::uabs(b)) / d_abs)) {
+                break;
+            }
+
+            const int64_t next_c = a - q * c_;
+            a = c_;
+            c_ = next_c;
+            const int64_t next_d = b - q * d;
+            b = d;
+            d = next_d;
+            const int64_t next_y_hat = x_hat - q * y_hat;
+            x_hat = y_hat;
+            y_hat = next_y_hat;
+        }
+
+        c = LehmerCofactors{a, b, c_, d};
+        return b != 0;
+    }
+
+    /// @brief (x, y) := (c.a00 * x + c.a01 * y, c.a10 * x + c.a11 * y), @a tmp is a scratch buffer
+    static void apply_lehmer_cofactors(longint& x, longint& y, const LehmerCofactors& c, longint& tmp) {
+        const auto add_scaled = [](longint& lhs, const longint& rhs, const int64_t coef) {
+            const auto coef_abs = static_cast<uint32_t>(math_functions::uabs(coef));
+            if (coef >= 0) {
+                lhs.addmul(rhs, coef_abs);
+            } else {
+                lhs.submul(rhs, coef_abs);
+            }
+        };
+
+        tmp.assign_zero();
+        add_scaled(tmp, x, c.a10);
+        add_scaled(tmp, y, c.a11);
+        x *= static_cast<uint32_t>(math_functions::uabs(c.a00));
+        if (c.a00 < 0) {
+            x.flip_sign();
+        }
+        add_scaled(x, y, c.a01);
+        y.swap(tmp);
+    }
+
+    /// @brief Same as apply_lehmer_cofactors, but in one pass over the digits
+    /// @note x >= y >= 0 and the cofactors are the Euclid steps of the x and y,
+    ///        so both results are non-negative and fit into x.usize() digits
+    static void apply_lehmer_cofactors_to_remainders(longint& x, longint& y, const LehmerCofactors& c) {
+        // Cofactors of the row have opposite signs: row = plus_coef * plus_value - minus_coef * minus_value
+        struct Row final {
+            constexpr Row(const int64_t x_coef, const int64_t y_coef) noexcept
+                : plus_coef(static_cast<digit_t>(math_functions::uabs(y_coef <= 0 ? x_coef : y_coef)))
+                , minus_coef(static_cast<digit_t>(math_functions::uabs(y_coef <= 0 ? y_coef : x_coef)))
+                , plus_is_x(y_coef <= 0) {}
+
+            [[nodiscard]] constexpr digit_t next(const digit_t x_digit, const digit_t y_digit) noexcept {
+                const double_digit_t plus = double_digit_t{plus_is_x ? x_digit : y_digit} * plus_coef + carry;
+                const double_digit_t minus = double_digit_t{plus_is_x ? y_digit : x_digit} * minus_coef + borrow;
+                carry = plus >> kDigitBits;
+                borrow = minus >> kDigitBits;
+                const auto plus_low = static_cast<digit_t>(plus);
+                const auto minus_low = static_cast<digit_t>(minus);
+                borrow += plus_low < minus_low;
+                return plus_low - minus_low;
+            }
+
+            digit_t plus_coef;
+            digit_t minus_coef;
+            bool plus_is_x;
+            double_digit_t carry = 0;
+            double_digit_t borrow = 0;
+        };
+
+        const size_type n = x.usize();
+        const size_type y_size = y.usize();
+        y.reserve(n);
+        std::fill(y.nums_ + y_size, y.nums_ + n, digit_t{0});
+        Row x_row{c.a00, c.a01};
+        Row y_row{c.a10, c.a11};
+        for (size_type i = 0; i < n; i++) {
+            const digit_t x_digit = x.nums_[i];
+            const digit_t y_digit = y.nums_[i];
+            x.nums_[i] = x_row.next(x_digit, y_digit);
+            y.nums_[i] = y_row.next(x_digit, y_digit);
+        }
+        LONGINT_DEBUG_ASSERT(x_row.carry == x_row.borrow && y_row.carry == y_row.borrow);
+        x.set_ssize_from_size(n);
+        x.pop_leading_zeros();
+        y.set_ssize_from_size(n);
+        y.pop_leading_zeros();
+    }
+
+    /// @brief (x, y) := (y, x - q * y)
+    static void apply_euclid_quotient(longint& x, longint& y, const longint& q) {
+        x.submul(y, q);
+        x.swap(y);
+    }
+
+    /**
+     * @brief Makes one step of Lehmer's algorithm: the step of the cofactors
+     *         found by lehmer_cofactors or the full division step
+     * @note x >= y > 0
+     * @return true if the @a c was applied and false if the quotient @a q was applied
+     */
+    static bool lehmer_step(longint& x, longint& y, LehmerCofactors& c, longint& q, longint& tmp) {
+        LONGINT_DEBUG_ASSERT(x >= y && !y.is_negative() && !y.is_zero());
+        if (lehmer_cofactors(x, y, c)) {
+            apply_lehmer_cofactors_to_remainders(x, y, c);
+            return true;
+        }
+
+        q = x;
+        q.divmod(y, tmp);
+        x.swap(y);
+        y.swap(tmp);
+        return false;
+    }
+
+    /// @brief Reduces x >= y >= 0 by Lehmer's algorithm until x has at most @a target_size digits
+    ///         or y is zero, the steps are accumulated in the @a m
+    static inline void lehmer_reduce(longint& x, longint& y, GcdMatrix& m, size_type target_size);
+
+    /**
+     * @brief Thull, Yap "A Unified Approach to HGCD Algorithms for polynomials and integers" (1990):
+     *         reduces x >= y >= 0 with n digits to the numbers with about n / 2 digits
+     *         by the two recursive calls on the highest halves
+     * @return matrix M such that (x_new, y_new) = M * (x, y), x_new >= y_new >= 0
+     */
+    [[nodiscard]] static inline GcdMatrix half_gcd(longint& x, longint& y);
+
+    /// @brief Reduces x >= y >= 0 by the half_gcd of the x / kNumsBase^k and y / kNumsBase^k
+    ///         and applies the found steps to the lowest k digits of the x and y
+    [[nodiscard]] static inline GcdMatrix half_gcd_of_high_part(longint& x, longint& y, size_type k);
+
+    /**
+     * @brief Reduces x >= y >= 0 to (gcd(x, y), 0),
+     *         (x_coef, y_coef) := M * (x_coef, y_coef) for all the steps M made
+     */
+    template <bool TrackCoefficients>
+    static inline void gcd_impl(longint& x, longint& y, longint& x_coef, longint& y_coef);
+
+    /**
+     * @brief Odd moduli with less than kMontgomeryPowModThreshold digits are handled by the
+     *         Montgomery multiplication with the schoolbook REDC, bigger ones by the fast multiplication
+     *         and the division by the longint::Reciprocal.
+     * Threshold was picked with number_theory/measure_longint.cpp (x86-64, -O2).
+     */
+    static constexpr size_type kMontgomeryPowModThreshold = 128;
+
+    /// @return x mod m such that 0 <= x mod m < m, m > 0
+    [[nodiscard]] static longint non_negative_mod(const longint& x, const longint& m) {
+        LONGINT_DEBUG_ASSERT(m.size() > 0);
+        const bool is_negative = x.is_negative();
+        longint quot = x;
+        quot.set_ssize_from_size_and_sign(quot.usize(), /* sign = */ 1);
+        longint rem;
+        quot.divmod(m, rem);
+        if (is_negative && !rem.is_zero()) {
+            rem.flip_sign();
+            rem += m;
+        }
+        return rem;
+    }
+
+    /// @return bit @a i of the |x|
+    [[nodiscard]] ATTRIBUTE_PURE static bool bit_at(const longint& x, const std::size_t i) noexcept {
+        const std::size_t index = i / kDigitBits;
+        return index < x.usize() && ((x.nums_[index] >> (i % kDigitBits)) & 1U) != 0;
+    }
+
+    /// @return number of bits in the |x|
+    [[nodiscard]] ATTRIBUTE_PURE static std::size_t bit_width(const longint& x) noexcept {
+        const size_type x_size = x.usize();
+        if (x_size == 0) {
+            return 0;
+        }
+        const auto top_digit_zeros = static_cast<std::size_t>(math_functions::countl_zero(x.nums_[x_size - 1]));
+        return std::size_t{x_size} * kDigitBits - top_digit_zeros;
+    }
+
+    /// @brief Width of the window for the exponent with @a exp_bits bits that
+    ///         minimizes the number of multiplications (HAC, table 14.16)
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr std::uint32_t pow_mod_window_bits(
+        const std::size_t exp_bits) noexcept {
+        constexpr std::size_t kMaxExpBits[] = {7, 25, 81, 241, 673};
+        std::uint32_t window_bits = 1;
+        for (const std::size_t max_exp_bits : kMaxExpBits) {
+            if (exp_bits <= max_exp_bits) {
+                break;
+            }
+            window_bits++;
+        }
+        return window_bits;
+    }
+
+    /**
+     * @brief Left-to-right sliding window exponentiation (HAC, algorithm 14.85) for the exp > 0.
+     *         square() makes x := x^2, multiply_by(i) makes x := x * g^{2 i + 1} and
+     *         assign(i) makes x := g^{2 i + 1} (called once for the highest window),
+     *         where 0 <= i < 2^{window_bits - 1}
+     */
+    template <class Square, class MultiplyBy, class Assign>
+    static void sliding_window_pow(const longint& exp,
+                                   const std::uint32_t window_bits,
+                                   Square&& square,
+                                   MultiplyBy&& multiply_by,
+                                   Assign&& assign) {
+        LONGINT_DEBUG_ASSERT(exp.size() > 0);
+        bool is_first_window = true;
+        std::size_t i = bit_width(exp);
+        while (i > 0) {
+            if (!bit_at(exp, i - 1)) {
+                square();
+                i--;
+                continue;
+            }
+
+            // Window [j; i) starts and ends with the set bit
+            std::size_t j = i > window_bits ? i - window_bits : 0;
+            while (!bit_at(exp, j)) {
+                j++;
+            }
+            std::uint32_t window = 0;
+            for (std::size_t k = i; k > j; k--) {
+                window = (window << 1U) | (bit_at(exp, k - 1) ? 1U : 0U);
+            }
+
+            if (is_first_window) {
+                assign(window >> 1U);
+                is_first_window = false;
+            } else {
+                for (std::size_t k = j; k < i; k++) {
+                    square();
+                }
+                multiply_by(window >> 1U);
+            }
+            i = j;
+        }
+    }
+
+    /// @brief *this := *this^exp mod reciprocal.divisor() for the 0 <= *this < reciprocal.divisor() and exp > 0
+    void pow_mod_by_reciprocal(const longint& exp, const Reciprocal& reciprocal);
+
+    /// @brief floor(n^{1/k}) for the n > 0 and k >= 2
+    [[nodiscard]] static longint iroot_impl(const longint& n, uint32_t k);
+
+    /// @brief floor(n^{1/k}) for the 0 < n < 2^64 and k >= 2
+    [[nodiscard]] static std::uint64_t iroot_u64(std::uint64_t n, uint32_t k) noexcept;
+
+    /// @return Table of the values x^2 mod Mod for the x in [0; Mod)
+    template <std::uint32_t Mod>
+    [[nodiscard]] static constexpr std::array<bool, Mod> make_squares_mod_table() noexcept {
+        std::array<bool, Mod> table{};
+        for (std::uint32_t x = 0; x < Mod; x++) {
+            table[(x * x) % Mod] = true;
+        }
+        return table;
+    }
+
+    /// @brief Leaves of the product tree grow up to this number of digits by the *= uint32_t
+    static constexpr size_type kProductLeafDigits = 16;
+
+    /// @brief Product of the @a nums[0], ..., @a nums[count - 1], @a nums are moved from.
+    ///         If @a parallel, halves of the subtrees with at least 2 kMinParallelProductLeaves
+    ///         leaves are multiplied on the misc::thread_pool
+    static longint product_tree(longint* const nums, const std::size_t count, const bool parallel) {
+        if (count == 0) {
+            return longint{uint32_t{1}};
+        }
+        if (!parallel || count < 2 * kMinParallelProductLeaves) {
+            for (std::size_t step = 1; step < count; step *= 2) {
+                for (std::size_t i = 0; i + step < count; i += 2 * step) {
+                    nums[i] *= nums[i + step];
+                }
+            }
+            return std::move(nums[0]);
+        }
+
+        const std::size_t half = count / 2;
+        longint halves[2];
+        misc::thread_pool::instance().run(2, [&halves, nums, half, count](const std::size_t i) {
+            halves[i] = i == 0 ? product_tree(nums, half, /* parallel = */ true)
+                               : product_tree(nums + half, count - half, /* parallel = */ true);
+        });
+        return halves[0] *= halves[1];
+    }
+
+    /// @brief Subtrees with less than kMinParallelProductLeaves leaves are multiplied by one thread
+    static constexpr std::size_t kMinParallelProductLeaves = 64;
+
+    /// @return primes in [2; n]
+    [[nodiscard]] static std::vector<uint32_t> primes_up_to(const uint32_t n) {
+        const std::vector<bool> is_prime = math_functions::dynamic_primes_sieve(n);
+        std::vector<uint32_t> primes;
+        for (uint32_t i = 2; i <= n; i++) {
+            if (is_prime[i]) {
+                primes.push_back(i);
+            }
+        }
+        return primes;
+    }
+
+    /// @brief swing(n) = n! / ((n / 2)!)^2, @a primes contain all the primes <= n
+    [[nodiscard]] static longint prime_swing(const uint32_t n,
+                                             const std::vector<uint32_t>& primes,
+                                             const std::size_t max_threads) {
+        // Exponent of the prime p in the swing(n) is sum of floor(n / p^i) mod 2,
+        //  so p^e <= n fits into the uint32_t
+        std::vector<uint32_t> factors;
+        for (const uint32_t p : primes) {
+            if (p > n) {
+                break;
+            }
+            uint32_t p_pow = 1;
+            for (uint32_t q = n / p; q > 0; q /= p) {
+                if (q % 2 != 0) {
+                    p_pow *= p;
+                }
+            }
+            if (p_pow > 1) {
+                factors.push_back(p_pow);
+            }
+        }
+        return product(factors.begin(), factors.end(), max_threads);
+    }
+
+    ATTRIBUTE_COLD
+    [[noreturn]] static void throw_on_invalid_root(const char* const file_location,
+                                                   const char* const function_name,
+                                                   const uint32_t k) {
+        std::string msg = "Invalid root of degree ";
+        msg += std::to_string(k);
+        msg.append(" at ");
+        msg.append(file_location);
+        msg.push_back(' ');
+        msg.append(function_name);
+        throw std::invalid_argument{msg};
+    }
+
+    ATTRIBUTE_COLD
+    [[noreturn]] static void throw_on_even_modulus(const char* const file_location, const char* const function_name) {
+        std::string msg = "Modulus should be odd at ";
+        msg.append(file_location);
+        msg.push_back(' ');
+        msg.append(function_name);
+        throw std::invalid_argument{msg};
+    }
+
+    ATTRIBUTE_COLD
+    [[noreturn]] static void throw_on_negative_exponent(const char* const file_location,
+                                                        const char* const function_name) {
+        std::string msg = "Exponent should be non-negative at ";
+        msg.append(file_location);
+        msg.push_back(' ');
+        msg.append(function_name);
+        throw std::invalid_argument{msg};
+    }
+
+    ATTRIBUTE_COLD
+    [[noreturn]] static void throw_on_non_positive_modulus(const char* const file_location,
+                                                           const char* const function_name) {
+        std::string msg = "Modulus should be positive at ";
+        msg.append(file_location);
+        msg.push_back(' ');
+        msg.append(function_name);
+        throw std::invalid_argument{msg};
+    }
+
     void divmod_impl(const longint& other, longint& rem) {
+        const size_type m = usize();
+        const size_type n = other.usize();
+        if (n < kBurnikelZieglerDivThreshold || m < n || m - n < kBurnikelZieglerDivThreshold) {
+            divmod_impl_schoolbook(other, rem);
+            return;
+        }
+
+        const ssize_type sign_product = size() ^ other.size();
+        longint divisor = other;
+        divisor.set_ssize_from_size_and_sign(n, /* sign = */ 1);
+        set_ssize_from_size_and_sign(m, /* sign = */ 1);
+        longint quot;
+        if (n < kNewtonDivThreshold || m / n < kNewtonDivMinBlocks) {
+            quot = divmod_burnikel_ziegler(*this, divisor, rem);
+        } else {
+            const std::uint32_t shift = normalization_shift(divisor);
+            divisor <<= shift;
+            const longint reciprocal = newton_reciprocal(divisor);
+            quot = divmod_barrett(*this, divisor, shift, reciprocal, rem);
+        }
+        *this = std::move(quot);
+        set_ssize_from_size_and_sign(usize(), /* sign = */ sign_product);
+    }
+
+    /// @brief Returns |x| / kNumsBase^from mod kNumsBase^count
+    [[nodiscard]] static longint digits_slice(const longint& x, const size_type from, size_type count) {
+        longint res;
+        const size_type x_size = x.usize();
+        if (from >= x_size || count == 0) {
+            return res;
+        }
+
+        count = std::min(count, x_size - from);
+        res.reserveUninitializedWithoutCopy(count);
+        std::copy_n(x.nums_ + from, count, res.nums_);
+        res.set_ssize_from_size(count);
+        res.pop_leading_zeros();
+        return res;
+    }
+
+    /// @brief x *= kNumsBase^shift
+    static void shift_left_by_digits(longint& x, const size_type shift) {
+        const size_type x_size = x.usize();
+        if (x_size == 0 || shift == 0) {
+            return;
+        }
+
+        const size_type new_size = check_size(std::size_t{x_size} + std::size_t{shift});
+        x.reserve(new_size);
+        std::copy_backward(x.nums_, x.nums_ + x_size, x.nums_ + new_size);
+        std::fill_n(x.nums_, shift, digit_t{0});
+        x.set_ssize_from_size(new_size);
+    }
+
+    /// @brief x /= kNumsBase^shift (rounding towards zero)
+    static void shift_right_by_digits(longint& x, const size_type shift) {
+        const size_type x_size = x.usize();
+        if (shift == 0) {
+            return;
+        }
+        if (shift >= x_size) {
+            x.assign_zero();
+            return;
+        }
+
+        std::copy(x.nums_ + shift, x.nums_ + x_size, x.nums_);
+        x.set_ssize_from_size(x_size - shift);
+    }
+
+    /// @brief Computes q = a / b and r = a % b using Knuth's algorithm D, a >= 0, b > 0
+    static void divmod_schoolbook(const longint& a, const longint& b, longint& q, longint& r) {
+        q = a;
+        q.divmod_impl_schoolbook(b, r);
+    }
+
+    /**
+     * @brief Splits |a| into blocks of the block_size digits and divides them from the highest one
+     *         by the divide_2n_by_1n, which accepts z < b * kNumsBase^{block_size} and returns
+     *         z / b < kNumsBase^{block_size} (and stores z % b to its last argument)
+     * @return a / b, a % b is stored to the rem
+     */
+    template <class DivideTwoBlocks>
+    [[nodiscard]] static longint divmod_by_blocks(const longint& a,
+                                                  const size_type block_size,
+                                                  DivideTwoBlocks divide_2n_by_1n,
+                                                  longint& rem) {
+        const size_type a_size = a.usize();
+        const size_type blocks = (a_size + block_size - 1) / block_size;
+        longint quot;
+        quot.reserveUninitializedWithoutCopy(check_size(std::size_t{blocks} * block_size));
+        std::fill_n(quot.nums_, std::size_t{blocks} * block_size, digit_t{0});
+
+        longint r;
+        longint z;
+        for (size_type i = blocks; i > 0; i--) {
+            // z = r * kNumsBase^{block_size} + a_{i - 1}, r < b
+            z = digits_slice(a, (i - 1) * block_size, block_size);
+            if (!r.is_zero()) {
+                longint shifted_r = std::move(r);
+                shift_left_by_digits(shifted_r, block_size);
+                z += shifted_r;
+            }
+
+            const longint q_i = divide_2n_by_1n(z, r);
+            LONGINT_DEBUG_ASSERT(q_i.usize() <= block_size);
+            std::copy_n(q_i.nums_, q_i.usize(), quot.nums_ + std::size_t{i - 1} * block_size);
+        }
+
+        quot.set_ssize_from_size(blocks * block_size);
+        quot.pop_leading_zeros();
+        rem = std::move(r);
+        return quot;
+    }
+
+    /**
+     * @brief Burnikel, Ziegler "Fast Recursive Division" (1998)
+     * @note a >= 0, b > 0
+     * @return a / b, a % b is stored to the rem
+     */
+    [[nodiscard]] static longint divmod_burnikel_ziegler(const longint& a, const longint& b, longint& rem) {
+        const size_type n = b.usize();
+        // Block size n' = j * 2^k >= n, j <= kBurnikelZieglerDivThreshold, so that
+        //  halving in the recursion reaches the schoolbook division evenly
+        size_type pow2 = 1;
+        while (pow2 * kBurnikelZieglerDivThreshold <= n) {
+            pow2 *= 2;
+        }
+        const size_type j = (n + pow2 - 1) / pow2;
+        const size_type block_size = j * pow2;
+
+        // Normalize: the highest bit of the highest digit of the b should be set
+        const std::uint32_t sigma_bits = normalization_shift(b);
+        const size_type sigma_digits = block_size - n;
+        longint b_norm = b;
+        b_norm <<= sigma_bits;
+        shift_left_by_digits(b_norm, sigma_digits);
+        longint a_norm = a;
+        a_norm <<= sigma_bits;
+        shift_left_by_digits(a_norm, sigma_digits);
+        LONGINT_DEBUG_ASSERT(b_norm.usize() == block_size);
+
+        longint quot = divmod_by_blocks(
+            a_norm, block_size,
+            [&b_norm, block_size](const longint& z, longint& r) {
+                longint q;
+                bz_divide_2n_by_1n(z, b_norm, block_size, q, r);
+                return q;
+            },
+            rem);
+
+        shift_right_by_digits(rem, sigma_digits);
+        rem >>= sigma_bits;
+        return quot;
+    }
+
+    /// @brief q = a / b, r = a % b, where b has n digits and is normalized, a < b * kNumsBase^n
+    static void bz_divide_2n_by_1n(const longint& a, const longint& b, const size_type n, longint& q, longint& r) {
+        LONGINT_DEBUG_ASSERT(b.usize() == n);
+        if (n % 2 != 0 || n < kBurnikelZieglerDivThreshold) {
+            divmod_schoolbook(a, b, q, r);
+            return;
+        }
+
+        // a = [a1, a2, a3, a4], blocks of the h digits
+        const size_type h = n / 2;
+        longint a123 = digits_slice(a, h, 3 * h);
+        longint q1;
+        longint r1;
+        bz_divide_3n_by_2n(a123, b, h, q1, r1);
+        shift_left_by_digits(r1, h);
+        r1 += digits_slice(a, 0, h);
+        bz_divide_3n_by_2n(r1, b, h, q, r);
+        shift_left_by_digits(q1, h);
+        q += q1;
+    }
+
+    /// @brief q = a / b, r = a % b, where b = [b1, b2] has 2 h digits and is normalized,
+    ///         a = [a1, a2, a3] < b * kNumsBase^h
+    static void bz_divide_3n_by_2n(const longint& a, const longint& b, const size_type h, longint& q, longint& r) {
+        const longint a12 = digits_slice(a, h, 2 * h);
+        const longint a1 = digits_slice(a, 2 * h, h);
+        const longint b1 = digits_slice(b, h, h);
+        const longint b2 = digits_slice(b, 0, h);
+
+        longint c;
+        if (a1 < b1) {
+            bz_divide_2n_by_1n(a12, b1, h, q, c);
+        } else {
+            // q = kNumsBase^h - 1, c = a12 - q * b1 = a12 - b1 * kNumsBase^h + b1
+            q = uint32_t{1};
+            shift_left_by_digits(q, h);
+            q -= uint32_t{1};
+            c = b1;
+            shift_left_by_digits(c, h);
+            c.flip_sign();
+            c += a12;
+            c += b1;
+        }
+
+        // r = c * kNumsBase^h + a3 - q * b2
+        shift_left_by_digits(c, h);
+        c += digits_slice(a, 0, h);
+        c -= q * b2;
+        while (c.is_negative()) {
+            q -= uint32_t{1};
+            c += b;
+        }
+        r = std::move(c);
+    }
+
+    /**
+     * @brief Computes floor(kNumsBase^{2 n} / v) using Newton's iteration
+     *         x := x + x * (kNumsBase^{2 n} - v * x) / kNumsBase^{2 n},
+     *         starting from the reciprocal of the highest (n + 3) / 2 digits of the v
+     * @note v has n digits and is normalized (the highest bit of the v is set),
+     *        otherwise the initial approximation may be arbitrarily bad
+     */
+    [[nodiscard]] static longint newton_reciprocal(const longint& v) {
+        const size_type n = v.usize();
+        LONGINT_ASSERT_ASSUME(n > 0);
+        LONGINT_DEBUG_ASSERT(v.nums_[n - 1] >= digit_t{1} << (kDigitBits - 1));
+        longint pow = uint32_t{1};
+        shift_left_by_digits(pow, 2 * n);
+        if (n <= kNewtonReciprocalBaseSize) {
+            longint x;
+            longint rem;
+            divmod_schoolbook(pow, v, x, rem);
+            return x;
+        }
+
+        // 2 k >= n + 3, so the relative error of the x after one
+        //  step is O(kNumsBase^{-n}) and only O(1) corrections are needed
+        const size_type k = (n + 3) / 2;
+        LONGINT_ASSERT_ASSUME(k < n);
+        longint x = newton_reciprocal(digits_slice(v, n - k, k));
+        shift_left_by_digits(x, n - k);
+
+        // e = kNumsBase^{2 n} - v * x
+        longint e = pow;
+        e -= v * x;
+        const bool e_is_negative = e.is_negative();
+        e.set_ssize_from_size_and_sign(e.usize(), /* sign = */ 1);
+        longint t = x * e;
+        shift_right_by_digits(t, 2 * n);
+        if (e_is_negative) {
+            e.flip_sign();
+            t.flip_sign();
+        }
+        x += t;
+
+        // r = kNumsBase^{2 n} - v * x = e - v * t
+        longint r = std::move(e);
+        r -= v * t;
+        while (r.is_negative()) {
+            x -= uint32_t{1};
+            r += v;
+        }
+        while (r >= v) {
+            x += uint32_t{1};
+            r -= v;
+        }
+        return x;
+    }
+
+    /// @brief Number of bits the b should be shifted left by so that its highest bit is set
+    [[nodiscard]] static std::uint32_t normalization_shift(const longint& b) noexcept {
+        LONGINT_ASSERT_ASSUME(b.usize() > 0);
+        static_assert(kDigitBits == 32);
+        return static_cast<std::uint32_t>(math_functions::countl_zero(b.nums_[b.usize() - 1]));
+    }
+
+    /**
+     * @brief Barrett reduction by blocks of the n digits:
+     *         q = floor(floor(z / kNumsBase^{n - 1}) * reciprocal / kNumsBase^{n + 1})
+     *         is at most 2 less than z / b
+     * @note a >= 0, b = divisor * 2^shift > 0 has n digits and is normalized,
+     *        reciprocal = newton_reciprocal(b)
+     * @return a / divisor, a % divisor is stored to the rem
+     */
+    [[nodiscard]] static longint divmod_barrett(const longint& a,
+                                                const longint& b,
+                                                const std::uint32_t shift,
+                                                const longint& reciprocal,
+                                                longint& rem) {
+        const size_type n = b.usize();
+        longint a_norm = a;
+        a_norm <<= shift;
+        longint quot = divmod_by_blocks(
+            a_norm, n,
+            [&b, &reciprocal, n](const longint& z, longint& r) {
+                // Only the highest n + 1 digits of the z are needed for the estimate
+                longint q = digits_slice(z, n - 1, n + 1);
+                q *= reciprocal;
+                shift_right_by_digits(q, n + 1);
+                r = z;
+                r -= q * b;
+                while (r >= b) {
+                    q += uint32_t{1};
+                    r -= b;
+                }
+                return q;
+            },
+            rem);
+        rem >>= shift;
+        return quot;
+    }
+
+    void divmod_impl_schoolbook(const longint& other, longint& rem) {
         /**
          * See Hackers Delight 9-2.
          */
@@ -2657,11 +5507,8 @@ private:
     void reserveUninitializedWithoutCopy(const size_type capacity) {
         size_ = 0;
         if (capacity > capacity_) {
-            deallocate(nums_, capacity_);
-            nums_ = nullptr;
-            capacity_ = 0;
-            nums_ = allocate_uninitialized(capacity);
-            capacity_ = capacity;
+            digit_t* const new_nums = allocate_uninitialized(capacity);
+            adopt_digits_sequence_without_changing_size(new_nums, capacity);
         }
     }
 
@@ -2677,30 +5524,38 @@ private:
 
     ATTRIBUTE_ALWAYS_INLINE
     ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
-    ATTRIBUTE_SIZED_ACCESS(read_write, 4, 2)
-    ATTRIBUTE_ACCESS(read_write, 5)
+    ATTRIBUTE_SIZED_ACCESS(read_write, 5, 2)
+    ATTRIBUTE_ACCESS(read_write, 6)
     static void convert_dec_base_mult_add(digit_t conv_digits[],
                                           const size_type conv_len,
                                           const longint& conv_base_pow,
+                                          const fft::PrecomputedOperand& conv_base_pow_spectrum,
                                           digit_t mult_add_buffer[],
-                                          fft::complex fft_poly_buffer[]) {
+                                          fft::complex fft_poly_buffer[],
+                                          const std::size_t fft_threads) {
         LONGINT_ASSERT_ASSUME(0 < conv_base_pow.size_);
         const size_type m_size = conv_base_pow.usize();
         const digit_t* const m_ptr = conv_base_pow.nums_;
         assert(0 < m_size && m_size <= conv_len / 2);
-        convert_dec_base_mult_add_impl(conv_digits, conv_len, m_ptr, m_size, mult_add_buffer, fft_poly_buffer);
+        convert_dec_base_mult_add_impl(conv_digits, conv_len, m_ptr, m_size, conv_base_pow_spectrum, mult_add_buffer,
+                                       fft_poly_buffer, fft_threads);
     }
 
+    /// @note @a m_spectrum is either empty or holds the spectrum of the
+    ///        m_ptr[0..m_size) for the products with conv_len / 2 digits.
+    ///       FFT products are split between at most @a fft_threads threads
     ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
     ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
-    ATTRIBUTE_SIZED_ACCESS(read_write, 5, 2)
-    ATTRIBUTE_ACCESS(read_write, 6)
+    ATTRIBUTE_SIZED_ACCESS(read_write, 6, 2)
+    ATTRIBUTE_ACCESS(read_write, 7)
     static void convert_dec_base_mult_add_impl(digit_t conv_digits[],
                                                const size_type conv_len,
                                                const digit_t m_ptr[],
                                                const size_type m_size,
+                                               const fft::PrecomputedOperand& m_spectrum,
                                                digit_t mult_add_buffer[],
-                                               fft::complex fft_poly_buffer[]) {
+                                               fft::complex fft_poly_buffer[],
+                                               const std::size_t fft_threads) {
         const size_type half_conv_len = conv_len / 2;
         LONGINT_ASSERT_ASSUME(0 < m_size);
         LONGINT_ASSERT_ASSUME(m_size <= half_conv_len);
@@ -2712,13 +5567,20 @@ private:
         std::fill_n(mult_add_buffer, conv_len, digit_t{0});
         if (half_conv_len <= 32) {
             LongIntNaive::multiply_and_store_to(m_ptr, m_size, num_hi, half_conv_len, mult_add_buffer);
+        } else if (m_size < kFFTMultThreshold) {
+            multiply_and_store_to(m_ptr, m_size, num_hi, half_conv_len, mult_add_buffer);
+        } else if (!m_spectrum.empty()) {
+            LongIntFFT::convert_longint_nums_to_packed_fft_poly(num_hi, half_conv_len, fft_poly_buffer,
+                                                                m_spectrum.size() / 2);
+            m_spectrum.multiply(fft_poly_buffer, fft_threads);
+            LongIntFFT::convert_packed_fft_poly_to_longint_nums(fft_poly_buffer, mult_add_buffer, prod_size);
         } else {
             const auto [n, need_high_precision] = LongIntFFT::compute_fft_product_params(prod_size);
             fft::complex* const p1 = fft_poly_buffer;
             LongIntFFT::convert_longint_nums_to_fft_poly(m_ptr, m_size, num_hi, half_conv_len, p1, n,
                                                          need_high_precision);
             fft::complex* const p2 = p1 + n;
-            fft::forward_backward_fft(p1, p2, n);
+            fft::forward_backward_fft(p1, p2, n, fft_threads);
             LongIntFFT::convert_fft_poly_to_longint_nums(need_high_precision, p2, mult_add_buffer, prod_size);
         }
 
@@ -2806,16 +5668,6 @@ private:
         return new_size;
     }
 
-    void allocate_default_capacity_32() {
-        nums_ = allocate_uninitialized(kDefaultLINumsCapacity32);
-        capacity_ = kDefaultLINumsCapacity32;
-    }
-    void ensure_default_capacity_op_asgn_32() {
-        if (capacity_ < kDefaultLINumsCapacity32) {
-            deallocate(nums_, capacity_);
-            allocate_default_capacity_32();
-        }
-    }
     constexpr void assign_u32_unchecked(const uint32_t n) noexcept {
         static_assert(kDigitBits >= 32);
         size_ = n != 0;
@@ -2826,16 +5678,6 @@ private:
         size_ = math_functions::sign(n);
         nums_[0] = math_functions::uabs(n);
     }
-    void allocate_default_capacity_64() {
-        nums_ = allocate_uninitialized(kDefaultLINumsCapacity64);
-        capacity_ = kDefaultLINumsCapacity64;
-    }
-    void ensure_default_capacity_op_asgn_64() {
-        if (capacity_ < kDefaultLINumsCapacity64) {
-            deallocate(nums_, capacity_);
-            allocate_default_capacity_64();
-        }
-    }
     constexpr void assign_u64_unchecked(uint64_t n) noexcept {
         static_assert(kDigitBits == 32);
         size_ = n != 0;
@@ -2850,16 +5692,6 @@ private:
         size_ *= sgn;
     }
 #if defined(HAS_INT128_TYPEDEF)
-    void allocate_default_capacity_128() {
-        nums_ = allocate_uninitialized(kDefaultLINumsCapacity128);
-        capacity_ = kDefaultLINumsCapacity128;
-    }
-    void ensure_default_capacity_op_asgn_128() {
-        if (capacity_ < kDefaultLINumsCapacity128) {
-            deallocate(nums_, capacity_);
-            allocate_default_capacity_128();
-        }
-    }
     I128_CONSTEXPR void assign_u128_unchecked(uint128_t n) noexcept {
         static_assert(kDigitBits == 32);
         size_ = n != 0;
@@ -2881,6 +5713,188 @@ private:
     }
 #endif
 
+    /// @brief Products with at most kFusedOpsStackBufferSize digits are stored on the stack by addmul() and submul()
+    static constexpr size_type kFusedOpsStackBufferSize = 2 * kKaratsubaMultThreshold;
+
+    void add_product(const longint& a, const longint& b, const bool negate_product) {
+        size_type m = a.usize();
+        size_type k = b.usize();
+        const digit_t* m_ptr = a.nums_;
+        const digit_t* k_ptr = b.nums_;
+        if (m > k) {
+            std::swap(m_ptr, k_ptr);
+            std::swap(m, k);
+        }
+        if (unlikely(m == 0)) {
+            return;
+        }
+
+        const bool product_is_negative = ((a.size_ ^ b.size_) < 0) != negate_product;
+        static_assert(max_size() + max_size() > max_size());
+        const size_type prod_size = check_size(std::size_t{m} + k);
+        const bool add_magnitudes = is_zero() || (size_ < 0) == product_is_negative;
+        if (add_magnitudes && m < kKaratsubaMultThreshold && this != &a && this != &b) {
+            // Schoolbook product is accumulated right into the digits of *this
+            const bool was_zero = is_zero();
+            const size_type new_size = set_size_at_least(std::max(usize(), prod_size) + 1);
+            for (size_type j = 0; j < m; j++) {
+                const digit_t carry = longint_mul_add_row(nums_ + j, k_ptr, k, m_ptr[j]);
+                longint_add_carry(nums_ + j + k, new_size - j - k, carry);
+            }
+            if (was_zero && product_is_negative) {
+                flip_sign();
+            }
+            pop_leading_zeros();
+            return;
+        }
+
+        if (prod_size <= kFusedOpsStackBufferSize) {
+            digit_t product[kFusedOpsStackBufferSize];
+            multiply_and_store_to(m_ptr, m, k_ptr, k, product);
+            add_digits(product, prod_size, product_is_negative);
+        } else {
+            std::vector<digit_t> product(prod_size);
+            multiply_and_store_to(m_ptr, m, k_ptr, k, product.data());
+            add_digits(product.data(), prod_size, product_is_negative);
+        }
+    }
+
+    void add_product_u32(const longint& a, const uint32_t b, const bool negate_product) {
+        const size_type m = a.usize();
+        if (unlikely(m == 0 || b == 0)) {
+            return;
+        }
+
+        const bool product_is_negative = (a.size_ < 0) != negate_product;
+        const bool add_magnitudes = is_zero() || (size_ < 0) == product_is_negative;
+        if (add_magnitudes && this != &a) {
+            const bool was_zero = is_zero();
+            static_assert(max_size() + 2 > max_size());
+            const size_type new_size = set_size_at_least(std::max(usize(), m + 1) + 1);
+            const digit_t carry = longint_mul_add_row(nums_, a.nums_, m, b);
+            longint_add_carry(nums_ + m, new_size - m, carry);
+            if (was_zero && product_is_negative) {
+                flip_sign();
+            }
+            pop_leading_zeros();
+            return;
+        }
+
+        const auto store_product = [&](digit_t* const product) noexcept {
+            std::fill_n(product, m, digit_t{0});
+            product[m] = longint_mul_add_row(product, a.nums_, m, b);
+        };
+        if (m < kFusedOpsStackBufferSize) {
+            digit_t product[kFusedOpsStackBufferSize];
+            store_product(product);
+            add_digits(product, m + 1, product_is_negative);
+        } else {
+            std::vector<digit_t> product(std::size_t{m} + 1);
+            store_product(product.data());
+            add_digits(product.data(), m + 1, product_is_negative);
+        }
+    }
+
+    /// @brief *this += (negative ? -1 : 1) * digits[0..digits_size)
+    /// @note @a digits should not point to the digits of *this
+    ATTRIBUTE_SIZED_ACCESS(read_only, 2, 3)
+    void add_digits(const digit_t digits[], const size_type digits_size, const bool negative) {
+        const bool find_sum = (size_ < 0) == negative;
+        static_assert(max_size() + 1 > max_size());
+        const size_type this_usize = set_size_at_least(std::max(usize(), digits_size) + (find_sum ? 1u : 0u));
+        if (find_sum) {
+            longint_add_with_free_space(nums_, this_usize, digits, digits_size);
+        } else if (longint_subtract_with_free_space(nums_, this_usize, digits, digits_size)) {
+            flip_sign();
+        }
+        pop_leading_zeros();
+    }
+
+    /// @brief lhs[0..n) += rhs[0..n) * multiplier
+    /// @return carry out of the lhs[n - 1]
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 3)
+    ATTRIBUTE_SIZED_ACCESS(read_only, 2, 3)
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    [[nodiscard]]
+    static constexpr digit_t longint_mul_add_row(digit_t* RESTRICT_QUALIFIER lhs,
+                                                 const digit_t* RESTRICT_QUALIFIER rhs,
+                                                 const size_type n,
+                                                 const digit_t multiplier) noexcept {
+        double_digit_t carry = 0;
+        for (size_type i = 0; i < n; i++) {
+            // (2^32 - 1) + (2^32 - 1)^2 + (2^32 - 1) = 2^64 - 1
+            const double_digit_t res = double_digit_t{rhs[i]} * multiplier + lhs[i] + carry;
+            lhs[i] = static_cast<digit_t>(res);
+            carry = res >> kDigitBits;
+        }
+        return static_cast<digit_t>(carry);
+    }
+
+    /// @brief lhs[0..lhs_size) += carry, the sum should fit into lhs_size digits
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    static constexpr void longint_add_carry(digit_t lhs[], const size_type lhs_size, const digit_t carry) noexcept {
+        if (carry == 0) {
+            return;
+        }
+        const digit_t lhs_0 = lhs[0];
+        lhs[0] = lhs_0 + carry;
+        if (lhs[0] >= lhs_0) {
+            return;
+        }
+        for (size_type i = 1; i < lhs_size; i++) {
+            if (++lhs[i] != 0) {
+                return;
+            }
+        }
+        assert(false);
+    }
+
+    /// @brief Sums, differences and shifts of at least kCarryKernelMinDigits digits are done
+    ///         by the longint_detail::carry_kernels selected for the CPU, shorter ones
+    ///         by the inline loops without the indirect call
+    static constexpr size_type kCarryKernelMinDigits = 16;
+
+    /// @brief lhs[0..n) += rhs[0..n)
+    /// @return carry out of the lhs[n - 1]
+    ATTRIBUTE_ALWAYS_INLINE
+    [[nodiscard]] static constexpr bool add_digits(digit_t lhs[], const digit_t rhs[], const size_type n) noexcept {
+        if (n >= kCarryKernelMinDigits && !config::is_constant_evaluated()) {
+            return longint_detail::carry_kernels::kernels().add_n(lhs, rhs, n);
+        }
+        return longint_detail::carry_kernels::add_n_default(lhs, rhs, n);
+    }
+
+    /// @brief lhs[0..n) -= rhs[0..n)
+    /// @return borrow out of the lhs[n - 1]
+    ATTRIBUTE_ALWAYS_INLINE
+    [[nodiscard]] static constexpr bool subtract_digits(digit_t lhs[], const digit_t rhs[], const size_type n) noexcept {
+        if (n >= kCarryKernelMinDigits && !config::is_constant_evaluated()) {
+            return longint_detail::carry_kernels::kernels().sub_n(lhs, rhs, n);
+        }
+        return longint_detail::carry_kernels::sub_n_default(lhs, rhs, n);
+    }
+
+    /// @brief nums[0..n) <<= shift, 0 < shift < kDigitBits
+    ATTRIBUTE_ALWAYS_INLINE
+    static constexpr void shift_left_digits(digit_t nums[], const size_type n, const uint32_t shift) noexcept {
+        if (n >= kCarryKernelMinDigits && !config::is_constant_evaluated()) {
+            longint_detail::carry_kernels::kernels().shift_left(nums, n, shift);
+        } else {
+            longint_detail::carry_kernels::shift_left_default(nums, n, shift);
+        }
+    }
+
+    /// @brief nums[0..n) >>= shift, 0 < shift < kDigitBits
+    ATTRIBUTE_ALWAYS_INLINE
+    static constexpr void shift_right_digits(digit_t nums[], const size_type n, const uint32_t shift) noexcept {
+        if (n >= kCarryKernelMinDigits && !config::is_constant_evaluated()) {
+            longint_detail::carry_kernels::kernels().shift_right(nums, n, shift);
+        } else {
+            longint_detail::carry_kernels::shift_right_default(nums, n, shift);
+        }
+    }
+
     ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
     ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
     ATTRIBUTE_NONNULL_ALL_ARGS
@@ -2890,14 +5904,9 @@ private:
                                                       const size_type rhs_size) noexcept {
         LONGINT_ASSERT_ASSUME(lhs_size > rhs_size);
 
-        double_digit_t carry = 0;
         const digit_t* const lhs_end = lhs + lhs_size;
-        const digit_t* const rhs_end = rhs + rhs_size;
-        for (; rhs != rhs_end; ++rhs, ++lhs) {
-            const double_digit_t res = double_digit_t{*lhs} + double_digit_t{*rhs} + carry;
-            *lhs = static_cast<digit_t>(res);
-            carry = res / kNumsBase;
-        }
+        double_digit_t carry = add_digits(lhs, rhs, rhs_size) ? 1 : 0;
+        lhs += rhs_size;
 
         for (; carry != 0; ++lhs) {
             assert(lhs != lhs_end);
@@ -2907,6 +5916,30 @@ private:
         }
     }
 
+    /// @brief lhs[0..lhs_size) += rhs[0..rhs_size)
+    /// @return carry out of the lhs[lhs_size - 1]
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+    ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    [[nodiscard]]
+    static constexpr bool longint_add_with_carry(digit_t lhs[],
+                                                 const size_type lhs_size,
+                                                 const digit_t rhs[],
+                                                 const size_type rhs_size) noexcept {
+        LONGINT_ASSERT_ASSUME(lhs_size >= rhs_size);
+
+        const digit_t* const lhs_end = lhs + lhs_size;
+        double_digit_t carry = add_digits(lhs, rhs, rhs_size) ? 1 : 0;
+        lhs += rhs_size;
+        for (; carry != 0 && lhs != lhs_end; ++lhs) {
+            const digit_t lhs_val = *lhs;
+            *lhs = lhs_val + 1;
+            carry = lhs_val == std::numeric_limits<digit_t>::max();
+        }
+
+        return carry != 0;
+    }
+
     ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
     ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
     ATTRIBUTE_NONNULL_ALL_ARGS
@@ -2919,9 +5952,14 @@ private:
 
         const bool overflowed = longint_subtract_with_carry(lhs, lhs_size, rhs, rhs_size);
         if (overflowed) {
-            lhs[0] = -lhs[0];
-            for (size_type i = 1; i < lhs_size; i++) {
-                lhs[i] = -(lhs[i] + 1);
+            // -x = ~x + 1, the lowest zero digits stay zero and absorb the + 1
+            size_type i = 0;
+            while (lhs[i] == 0) {
+                i++;
+            }
+            lhs[i] = -lhs[i];
+            for (i++; i < lhs_size; i++) {
+                lhs[i] = ~lhs[i];
             }
         }
 
@@ -2939,15 +5977,8 @@ private:
         LONGINT_ASSERT_ASSUME(lhs_size >= rhs_size);
 
         const digit_t* const lhs_end = lhs + lhs_size;
-        const digit_t* const rhs_end = rhs + rhs_size;
-        bool carry = false;
-        for (; rhs != rhs_end; ++rhs, ++lhs) {
-            const digit_t lhs_val = *lhs;
-            const auto sub_val = double_digit_t{*rhs} + double_digit_t{carry};
-            const digit_t res_val = lhs_val - static_cast<digit_t>(sub_val);
-            carry = lhs_val < sub_val;
-            *lhs = res_val;
-        }
+        const bool carry = subtract_digits(lhs, rhs, rhs_size);
+        lhs += rhs_size;
         if (carry) {
             for (; lhs != lhs_end; ++lhs) {
                 const digit_t lhs_val = *lhs;
@@ -3003,11 +6034,14 @@ private:
             const bool carry = res > low_num;
             nums_iter[0] = res;
             if (carry) {
-                do {
-                    ++nums_iter;
-                } while (nums_iter[0] == 0);
-                if (--nums_iter[0] == 0) {
-                    size_ = sign();
+                // Zero digits become 2^32 - 1 until the borrow is taken from the first non-zero one
+                while ((++nums_iter)[0] == 0) {
+                    nums_iter[0] = std::numeric_limits<digit_t>::max();
+                }
+                --nums_iter[0];
+                // Only the highest digit can become a leading zero
+                if (nums_[usize_value - 1] == 0) {
+                    size_ -= sign();
                 }
             }
         } else if (n <= low_num) {
@@ -3047,107 +6081,892 @@ private:
         void operator()(fft::complex* const memory) noexcept {
             ::operator delete(static_cast<void*>(memory));
         }
-    };
+    };
+
+    ATTRIBUTE_ALWAYS_INLINE static fft::complex* allocate_complex_array_for_unique_ptr(std::size_t size) {
+        const auto size_bytes = size * sizeof(fft::complex);
+        return static_cast<fft::complex*>(::operator new(size_bytes));
+    }
+
+    ATTRIBUTE_ALWAYS_INLINE static size_type check_size(const std::size_t value) {
+        if (unlikely(value > max_size())) {
+            throw_size_error(LONGINT_FILE_LOCATION(), value, max_size());
+        }
+        const size_type checked_value = static_cast<size_type>(value);
+        CONFIG_ASSUME_STATEMENT(checked_value <= max_size());
+        LONGINT_ASSERT_ASSUME(checked_value == value);
+        return checked_value;
+    }
+
+    void adopt_digits_sequence_without_changing_size(digit_t* const new_nums,
+                                                     const size_type new_nums_capacity) noexcept {
+        deallocate_nums();
+        nums_ = new_nums;
+        capacity_ = new_nums_capacity;
+    }
+
+    ATTRIBUTE_ALWAYS_INLINE
+    ATTRIBUTE_PURE
+    [[nodiscard]] constexpr bool has_inline_digits() const noexcept {
+        return nums_ == inline_digits_;
+    }
+
+    void deallocate_nums() noexcept {
+        if (!has_inline_digits()) {
+            deallocate(nums_, capacity_);
+        }
+    }
+
+    ATTRIBUTE_COLD
+    [[noreturn]] static void throw_size_error(const char* const file_location,
+                                              const char* const function_name,
+                                              const std::size_t new_size_value,
+                                              const std::size_t max_size_value) {
+        static constexpr std::size_t kMessageSize = 1024;
+        std::array<char, kMessageSize> message{};
+        const int bytes_written = std::snprintf(
+            message.data(), message.size(), "%s: size error at %s: new size (which is %zu) > max size (which is %zu)",
+            file_location, function_name, new_size_value, max_size_value);
+
+        if (unlikely(bytes_written < 0)) {
+            constexpr std::string_view kFallbackMessage = "size error at ";
+            std::char_traits<char>::copy(message.data(), kFallbackMessage.data(), kFallbackMessage.size());
+            const auto fn_name_size = std::char_traits<char>::length(function_name);
+            static_assert(kFallbackMessage.size() < kMessageSize);
+            const auto fn_name_copy_size = std::min(fn_name_size, message.size() - 1 - kFallbackMessage.size());
+            std::char_traits<char>::copy(std::addressof(message[kFallbackMessage.size()]), function_name,
+                                         fn_name_copy_size);
+            message[kFallbackMessage.size() + fn_name_copy_size] = '\0';
+        }
+
+        throw std::length_error{message.data()};
+    }
+
+    ATTRIBUTE_COLD
+    [[noreturn]] static void throw_on_failed_uint_checked_cast(const char* const file_location,
+                                                               const char* const function_name) {
+        static constexpr std::size_t kMessageSize = 1024;
+        std::array<char, kMessageSize> message{};
+        const int bytes_written =
+            std::snprintf(message.data(), message.size(), "%s: checked cast longint to integral type failed at %s",
+                          file_location, function_name);
+        if (unlikely(bytes_written < 0)) {
+            constexpr std::string_view kFallbackMessage = "checked cast longint to integral type failed";
+            static_assert(kFallbackMessage.size() <= kMessageSize);
+            std::char_traits<char>::copy(message.data(), kFallbackMessage.data(), kFallbackMessage.size());
+            message[kFallbackMessage.size()] = '\0';
+        }
+
+        throw std::runtime_error{message.data()};
+    }
+
+    friend class longint_view;
+
+    static inline std::atomic<std::size_t> fft_max_threads_{1};
+
+    /// @brief Points either to the inline_digits_ or to the heap memory
+    digit_t* nums_ = inline_digits_;
+    /**
+     * size_ < 0 <=> sign = -1; size_ == 0 <=> sign = 0; size > 0 <=> sign = 1
+     */
+    ssize_type size_ = 0;
+    size_type capacity_ = kInlineDigitsCapacity;
+    digit_t inline_digits_[kInlineDigitsCapacity]{};
+};
+
+/**
+ * @brief Divisor together with its precomputed reciprocal floor(2^{64 n} / v), where n is the
+ *         number of digits in the divisor and v = |divisor| * 2^s is the divisor shifted left by
+ *         s = normalization_shift(divisor) bits so that its highest bit is set (newton_reciprocal
+ *         needs the normalized divisor). Dividend is shifted by the same s bits before the Barrett
+ *         reduction and the remainder is shifted back. Makes repeated divisions by the same big
+ *         divisor (e.g. modular reductions) cost two multiplications per n digits of the dividend
+ *         without recomputing the reciprocal every time.
+ */
+class longint::Reciprocal final {
+public:
+    explicit Reciprocal(longint divisor)
+        : divisor_(std::move(divisor))
+        , normalized_divisor_(divisor_.usize() >= kReciprocalDivThreshold ? normalize(divisor_) : longint{})
+        , reciprocal_(normalized_divisor_.is_zero() ? longint{} : longint::newton_reciprocal(normalized_divisor_))
+        , shift_(normalized_divisor_.is_zero() ? 0 : longint::normalization_shift(divisor_)) {}
+
+    [[nodiscard]] ATTRIBUTE_PURE const longint& divisor() const noexcept ATTRIBUTE_LIFETIME_BOUND {
+        return divisor_;
+    }
+
+private:
+    friend longint;
+
+    [[nodiscard]] static longint normalize(const longint& divisor) {
+        longint normalized_divisor = divisor;
+        normalized_divisor.set_ssize_from_size_and_sign(divisor.usize(), /* sign = */ 1);
+        normalized_divisor <<= longint::normalization_shift(divisor);
+        return normalized_divisor;
+    }
+
+    longint divisor_;
+    /// @brief |divisor_| * 2^shift_ with the highest bit set. Empty (as well as the reciprocal_)
+    ///         if the divisor is small enough for the schoolbook division
+    longint normalized_divisor_;
+    longint reciprocal_;
+    std::uint32_t shift_{};
+};
+
+inline void longint::divmod(const Reciprocal& reciprocal, longint& rem) {
+    const longint& other = reciprocal.divisor_;
+    const size_type m = usize();
+    const size_type n = other.usize();
+    if (reciprocal.reciprocal_.is_zero() || m < n || m - n < kBurnikelZieglerDivThreshold) {
+        this->divmod_impl(other, rem);
+        return;
+    }
+
+    const ssize_type sign_product = size() ^ other.size();
+    set_ssize_from_size_and_sign(m, /* sign = */ 1);
+    longint quot =
+        divmod_barrett(*this, reciprocal.normalized_divisor_, reciprocal.shift_, reciprocal.reciprocal_, rem);
+    *this = std::move(quot);
+    set_ssize_from_size_and_sign(usize(), /* sign = */ sign_product);
+}
+
+/**
+ * @brief Odd modulus m with n digits together with -m^{-1} mod kNumsBase and R^2 mod m, R = kNumsBase^n.
+ *         Makes repeated modular exponentiations by the same modulus (e.g. batches of the RSA-scale
+ *         pow_mod) skip the precomputation and work in the Montgomery representation x * R mod m,
+ *         where the reduction after each product costs n^2 digit multiplications without division.
+ */
+class longint::MontgomeryContext final {
+public:
+    /// @throws std::invalid_argument if the @a modulus is not odd and positive
+    explicit MontgomeryContext(longint modulus)
+        : modulus_(check_modulus(std::move(modulus))), r2_(make_r2(modulus_)), m_inv_(make_m_inv(modulus_)) {}
+
+    [[nodiscard]] ATTRIBUTE_PURE const longint& modulus() const noexcept ATTRIBUTE_LIFETIME_BOUND {
+        return modulus_;
+    }
+
+    /// @return base^exp mod modulus() in [0; modulus())
+    /// @throws std::invalid_argument if exp < 0
+    [[nodiscard]] longint pow_mod(const longint& base, const longint& exp) const {
+        if (unlikely(exp.is_negative())) {
+            longint::throw_on_negative_exponent(LONGINT_FILE_LOCATION());
+        }
+        longint res = longint::non_negative_mod(base, modulus_);
+        pow_mod_reduced(res, exp);
+        return res;
+    }
+
+private:
+    friend longint;
+
+    [[nodiscard]] static longint check_modulus(longint modulus) {
+        if (unlikely(modulus.size() <= 0)) {
+            longint::throw_on_non_positive_modulus(LONGINT_FILE_LOCATION());
+        }
+        if (unlikely(modulus.nums_[0] % 2 == 0)) {
+            longint::throw_on_even_modulus(LONGINT_FILE_LOCATION());
+        }
+        return modulus;
+    }
+
+    /// @return R^2 mod m zero padded to the n digits
+    [[nodiscard]] static std::vector<digit_t> make_r2(const longint& modulus) {
+        const size_type n = modulus.usize();
+        longint r2 = uint32_t{1};
+        r2 <<= static_cast<uint32_t>(std::size_t{2} * n * kDigitBits);
+        r2 = longint::non_negative_mod(r2, modulus);
+        std::vector<digit_t> digits(n);
+        std::copy_n(r2.nums_, r2.usize(), digits.begin());
+        return digits;
+    }
+
+    /// @return -m^{-1} mod kNumsBase
+    [[nodiscard]] ATTRIBUTE_CONST static digit_t make_m_inv(const longint& modulus) noexcept {
+        const digit_t m0 = modulus.nums_[0];
+        // Newton's iteration doubles the number of correct low bits, m0 * m0 = 1 (mod 2^3)
+        digit_t inv = m0;
+        for (int i = 0; i < 4; i++) {
+            inv *= 2 - m0 * inv;
+        }
+        LONGINT_DEBUG_ASSERT(m0 * inv == 1);
+        return -inv;
+    }
+
+    /**
+     * @brief out := a * b * R^{-1} mod m by the coarsely integrated operand scanning (CIOS) REDC,
+     *         see Koc, Acar, Kaliski "Analyzing and Comparing Montgomery Multiplication Algorithms" (1996)
+     * @note a, b < m have n digits each (zero padded), @a out may alias the @a a or the @a b,
+     *        @a t is a scratch buffer with n + 2 digits
+     */
+    ATTRIBUTE_NONNULL_ALL_ARGS
+    void redc_mul(const digit_t* const a, const digit_t* const b, digit_t* const out, digit_t* RESTRICT_QUALIFIER const t)
+        const noexcept {
+        const size_type n = modulus_.usize();
+        const digit_t* const m = modulus_.nums_;
+        std::fill_n(t, n + 2, digit_t{0});
+        for (size_type i = 0; i < n; i++) {
+            // t += a * b[i]
+            const double_digit_t b_i = b[i];
+            double_digit_t carry = 0;
+            for (size_type j = 0; j < n; j++) {
+                const double_digit_t s = t[j] + a[j] * b_i + carry;
+                t[j] = static_cast<digit_t>(s);
+                carry = s >> kDigitBits;
+            }
+            double_digit_t s = t[n] + carry;
+            t[n] = static_cast<digit_t>(s);
+            t[n + 1] = static_cast<digit_t>(s >> kDigitBits);
+
+            // t := (t + q * m) / kNumsBase, the lowest digit of t + q * m is 0
+            const digit_t q = t[0] * m_inv_;
+            carry = (t[0] + double_digit_t{q} * m[0]) >> kDigitBits;
+            for (size_type j = 1; j < n; j++) {
+                s = t[j] + double_digit_t{q} * m[j] + carry;
+                t[j - 1] = static_cast<digit_t>(s);
+                carry = s >> kDigitBits;
+            }
+            s = t[n] + carry;
+            t[n - 1] = static_cast<digit_t>(s);
+            t[n] = t[n + 1] + static_cast<digit_t>(s >> kDigitBits);
+        }
+
+        // t < 2 m
+        bool t_less_than_m = t[n] == 0;
+        if (t_less_than_m) {
+            for (size_type j = n; j > 0; j--) {
+                if (t[j - 1] != m[j - 1]) {
+                    t_less_than_m = t[j - 1] < m[j - 1];
+                    break;
+                }
+            }
+        }
+        if (t_less_than_m) {
+            std::copy_n(t, n, out);
+            return;
+        }
+        digit_t borrow = 0;
+        for (size_type j = 0; j < n; j++) {
+            const double_digit_t d = double_digit_t{t[j]} - m[j] - borrow;
+            out[j] = static_cast<digit_t>(d);
+            borrow = static_cast<digit_t>(d >> kDigitBits) & 1U;
+        }
+    }
+
+    /// @brief x := x^exp mod m for the 0 <= x < m and exp >= 0.
+    ///         All the buffers are allocated once before the exponentiation loop
+    void pow_mod_reduced(longint& x, const longint& exp) const {
+        if (exp.is_zero()) {
+            x = modulus_ == uint32_t{1} ? longint{} : longint{uint32_t{1}};
+            return;
+        }
+
+        const size_type n = modulus_.usize();
+        const std::uint32_t window_bits = longint::pow_mod_window_bits(longint::bit_width(exp));
+        const std::size_t table_size = std::size_t{1} << (window_bits - 1);
+        // g^1 * R, g^3 * R, ..., g^{2 table_size - 1} * R; accumulator; g^2 * R; scratch for the redc_mul
+        std::vector<digit_t> buffer((table_size + 2) * n + n + 2);
+        digit_t* const table = buffer.data();
+        digit_t* const acc = table + table_size * n;
+        digit_t* const g2 = acc + n;
+        digit_t* const t = g2 + n;
+
+        std::copy_n(x.nums_, x.usize(), acc);
+        redc_mul(acc, r2_.data(), table, t);
+        if (table_size > 1) {
+            redc_mul(table, table, g2, t);
+            for (std::size_t i = 1; i < table_size; i++) {
+                redc_mul(table + (i - 1) * n, g2, table + i * n, t);
+            }
+        }
+
+        longint::sliding_window_pow(
+            exp, window_bits, [&]() noexcept { redc_mul(acc, acc, acc, t); },
+            [&](const std::uint32_t i) noexcept { redc_mul(acc, table + i * n, acc, t); },
+            [&](const std::uint32_t i) noexcept { std::copy_n(table + i * n, n, acc); });
+
+        // acc * R * R^{-1} = acc
+        std::fill_n(g2, n, digit_t{0});
+        g2[0] = 1;
+        redc_mul(acc, g2, acc, t);
+        x.reserveUninitializedWithoutCopy(n);
+        std::copy_n(acc, n, x.nums_);
+        x.set_ssize_from_size(n);
+        x.pop_leading_zeros();
+    }
+
+    longint modulus_;
+    std::vector<digit_t> r2_;
+    digit_t m_inv_;
+};
+
+inline longint& longint::pow_mod(const longint& exp, const longint& mod) ATTRIBUTE_LIFETIME_BOUND {
+    if (unlikely(mod.size() <= 0)) {
+        throw_on_non_positive_modulus(LONGINT_FILE_LOCATION());
+    }
+    if (unlikely(exp.is_negative())) {
+        throw_on_negative_exponent(LONGINT_FILE_LOCATION());
+    }
+
+    *this = non_negative_mod(*this, mod);
+    if (mod.nums_[0] % 2 != 0 && mod.usize() < kMontgomeryPowModThreshold) {
+        MontgomeryContext{mod}.pow_mod_reduced(*this, exp);
+    } else if (exp.is_zero()) {
+        *this = mod == uint32_t{1} ? longint{} : longint{uint32_t{1}};
+    } else {
+        pow_mod_by_reciprocal(exp, Reciprocal{mod});
+    }
+    return *this;
+}
+
+inline void longint::pow_mod_by_reciprocal(const longint& exp, const Reciprocal& reciprocal) {
+    const std::uint32_t window_bits = pow_mod_window_bits(bit_width(exp));
+    const std::size_t table_size = std::size_t{1} << (window_bits - 1);
+    // prod and rem are reused by all the reductions: quotient goes to the prod, remainder is swapped into it
+    longint prod;
+    longint rem;
+    const auto reduce_prod_to = [&](longint& res) {
+        prod.divmod(reciprocal, rem);
+        res.swap(rem);
+    };
+
+    std::vector<longint> table(table_size);
+    table[0] = std::move(*this);
+    if (table_size > 1) {
+        longint g2;
+        table[0].square_this_to(prod);
+        reduce_prod_to(g2);
+        for (std::size_t i = 1; i < table_size; i++) {
+            prod = table[i - 1];
+            prod *= g2;
+            reduce_prod_to(table[i]);
+        }
+    }
+
+    longint& acc = *this;
+    sliding_window_pow(
+        exp, window_bits,
+        [&]() {
+            acc.square_this_to(prod);
+            reduce_prod_to(acc);
+        },
+        [&](const std::uint32_t i) {
+            prod = acc;
+            prod *= table[i];
+            reduce_prod_to(acc);
+        },
+        [&](const std::uint32_t i) { acc = table[i]; });
+}
+
+/**
+ * @brief Multiplier together with its precomputed FFT. Makes repeated multiplications
+ *         by the same big number (e.g. Horner-style evaluation) cost two half-size transforms
+ *         per product instead of two full-size ones (see fft::PrecomputedOperand).
+ */
+class longint::PrecomputedMultiplier final {
+public:
+    /// @brief Prepares @a multiplier for the products by the numbers with at most @a max_other_size digits
+    ///         (products by the bigger numbers are still correct, but do not reuse the FFT)
+    PrecomputedMultiplier(longint multiplier, const size_type max_other_size)
+        : multiplier_(std::move(multiplier))
+        , spectrum_(make_spectrum(multiplier_, max_other_size))
+        , max_other_size_(max_other_size) {}
+
+    [[nodiscard]] ATTRIBUTE_PURE const longint& multiplier() const noexcept ATTRIBUTE_LIFETIME_BOUND {
+        return multiplier_;
+    }
+
+private:
+    friend longint;
+    friend struct longint_detail::longint_static_storage;
+
+    [[nodiscard]] static fft::PrecomputedOperand make_spectrum(const longint& multiplier,
+                                                               const size_type max_other_size) {
+        const size_type m = multiplier.usize();
+        if (m < kFFTMultThreshold || max_other_size < kFFTMultThreshold) {
+            return {};
+        }
+
+        const auto [n, need_high_precision] =
+            LongIntFFT::compute_fft_product_params(check_size(std::size_t{m} + max_other_size));
+        if (need_high_precision) {
+            return {};
+        }
+
+        const std::size_t packed_size = n / 2;
+        const std::unique_ptr<fft::complex, struct ComplexDeleter> p(
+            allocate_complex_array_for_unique_ptr(packed_size));
+        LongIntFFT::convert_longint_nums_to_packed_fft_poly(multiplier.nums_, m, p.get(), packed_size);
+        return fft::PrecomputedOperand{p.get(), n, max_fft_threads()};
+    }
+
+    longint multiplier_;
+    /// @brief Empty if the products by this multiplier are done without the FFT
+    ///         or need the high precision mode
+    fft::PrecomputedOperand spectrum_;
+    size_type max_other_size_;
+};
+
+inline longint& longint::operator*=(const PrecomputedMultiplier& multiplier) ATTRIBUTE_LIFETIME_BOUND {
+    const longint& other = multiplier.multiplier_;
+    const size_type k = usize();
+    if (multiplier.spectrum_.empty() || k < kFFTMultThreshold || k > multiplier.max_other_size_) {
+        return *this *= other;
+    }
+
+    const ssize_type sign_product = size_ ^ other.size_;
+    static_assert(max_size() + max_size() > max_size());
+    const size_type prod_size = check_size(std::size_t{k} + other.usize());
+    const std::size_t packed_size = multiplier.spectrum_.size() / 2;
+    const std::unique_ptr<fft::complex, struct ComplexDeleter> p(allocate_complex_array_for_unique_ptr(packed_size));
+    LongIntFFT::convert_longint_nums_to_packed_fft_poly(nums_, k, p.get(), packed_size);
+    multiplier.spectrum_.multiply(p.get(), max_fft_threads());
+    reserveUninitializedWithoutCopy(prod_size);
+    LongIntFFT::convert_packed_fft_poly_to_longint_nums(p.get(), nums_, prod_size);
+    set_ssize_from_size_and_sign(prod_size, /* sign = */ sign_product);
+    pop_leading_zeros();
+    return *this;
+}
+
+/**
+ * @brief Divisor d with n digits prepared for the divisions of the numbers 0 <= x < d * kNumsBase^n
+ *         (e.g. x < d^2) by one Barrett step, see longint::divmod_precomputed(). Keeps the reciprocal
+ *         of the normalized divisor v = d * 2^s (see longint::Reciprocal) with its FFT and the FFT of
+ *         the v modulo kNumsBase^L - 1, L >= n + 2: remainder of the Barrett step is less than
+ *         kNumsBase^{n + 1}, so it is restored from the cyclic product of the quotient by the v,
+ *         which takes the transforms of half the length of the full product.
+ */
+class longint::PrecomputedDivisor final {
+public:
+    explicit PrecomputedDivisor(longint divisor)
+        : divisor_(std::move(divisor))
+        , normalized_divisor_(divisor_.usize() >= kBurnikelZieglerDivThreshold ? normalize(divisor_) : longint{})
+        , reciprocal_(normalized_divisor_.is_zero() ? longint{} : longint::newton_reciprocal(normalized_divisor_),
+                      normalized_divisor_.usize() + 1)
+        , cyclic_spectrum_(make_cyclic_spectrum(normalized_divisor_))
+        , shift_(normalized_divisor_.is_zero() ? 0 : longint::normalization_shift(divisor_)) {}
+
+    [[nodiscard]] ATTRIBUTE_PURE const longint& divisor() const noexcept ATTRIBUTE_LIFETIME_BOUND {
+        return divisor_;
+    }
+
+private:
+    friend longint;
+
+    [[nodiscard]] static longint normalize(const longint& divisor) {
+        longint normalized_divisor = divisor;
+        normalized_divisor.set_ssize_from_size_and_sign(divisor.usize(), /* sign = */ 1);
+        normalized_divisor <<= longint::normalization_shift(divisor);
+        return normalized_divisor;
+    }
+
+    [[nodiscard]] static fft::PrecomputedOperand make_cyclic_spectrum(const longint& normalized_divisor) {
+        const size_type n = normalized_divisor.usize();
+        if (n < kFFTMultThreshold) {
+            return {};
+        }
+
+        // Coefficients of the cyclic product sum up to twice as many terms as
+        //  the ones of the full product of the same length, so the precision
+        //  is checked for the full product of the quotient and the divisor
+        if (LongIntFFT::compute_fft_product_params(check_size(2 * std::size_t{n} + 2)).need_high_precision) {
+            return {};
+        }
+
+        const std::size_t n_cyclic = LongIntFFT::compute_fft_product_params(check_size(std::size_t{n} + 2)).poly_size;
+        const std::size_t packed_size = n_cyclic / 2;
+        const std::unique_ptr<fft::complex, struct ComplexDeleter> p(
+            allocate_complex_array_for_unique_ptr(packed_size));
+        LongIntFFT::convert_longint_nums_to_packed_fft_poly(normalized_divisor.nums_, n, p.get(), packed_size);
+        return fft::PrecomputedOperand{p.get(), n_cyclic, max_fft_threads()};
+    }
+
+    /**
+     * @brief Computes z - q * normalized_divisor_ < kNumsBase^{n + 1}, the cyclic_spectrum_ should not be empty
+     * @note z < kNumsBase^{2 L}, where kNumsBase^L - 1 is the modulus of the cyclic product
+     */
+    [[nodiscard]] longint cyclic_remainder(const longint& z, const longint& q) const {
+        const size_type packed_size = static_cast<size_type>(cyclic_spectrum_.size() / 2);
+        const size_type n = normalized_divisor_.usize();
+        LONGINT_ASSERT_ASSUME(q.usize() <= packed_size && z.usize() <= 2 * packed_size);
+
+        const std::unique_ptr<fft::complex, struct ComplexDeleter> p(
+            allocate_complex_array_for_unique_ptr(packed_size));
+        LongIntFFT::convert_longint_nums_to_packed_fft_poly(q.nums_, q.usize(), p.get(), packed_size);
+        cyclic_spectrum_.multiply(p.get(), max_fft_threads());
+        std::vector<digit_t> product(packed_size);
+        LongIntFFT::convert_packed_fft_poly_to_longint_nums_mod(p.get(), product.data(), packed_size);
+
+        // r = z mod (kNumsBase^L - 1)
+        longint r;
+        r.reserveUninitializedWithoutCopy(packed_size);
+        const size_type z_size = z.usize();
+        const size_type low_size = std::min(z_size, packed_size);
+        std::copy_n(z.nums_, low_size, r.nums_);
+        std::fill(r.nums_ + low_size, r.nums_ + packed_size, digit_t{0});
+        double_digit_t carry = 0;
+        for (size_type i = 0; i < z_size - low_size; i++) {
+            const double_digit_t res = carry + r.nums_[i] + z.nums_[packed_size + i];
+            r.nums_[i] = static_cast<digit_t>(res);
+            carry = res >> kDigitBits;
+        }
+        for (size_type i = z_size - low_size; carry != 0 && i < packed_size; i++) {
+            const double_digit_t res = carry + r.nums_[i];
+            r.nums_[i] = static_cast<digit_t>(res);
+            carry = res >> kDigitBits;
+        }
+        LongIntFFT::add_carry_mod(r.nums_, packed_size, carry);
+
+        // r = (r - q * v) mod (kNumsBase^L - 1), kNumsBase^L = 1
+        digit_t borrow = 0;
+        for (size_type i = 0; i < packed_size; i++) {
+            const double_digit_t res = double_digit_t{r.nums_[i]} - product[i] - borrow;
+            r.nums_[i] = static_cast<digit_t>(res);
+            borrow = static_cast<digit_t>(res >> (2 * kDigitBits - 1));
+        }
+        for (size_type i = 0; borrow != 0; i++) {
+            borrow = r.nums_[i] == 0 ? 1 : 0;
+            r.nums_[i]--;
+        }
+
+        // Remainder is less than kNumsBase^{n + 1} < kNumsBase^L - 1, so it is either r or
+        //  0 represented by the kNumsBase^L - 1 (the only residue with the highest digit set)
+        if (r.nums_[packed_size - 1] != 0) {
+            LONGINT_DEBUG_ASSERT(std::all_of(r.nums_, r.nums_ + packed_size,
+                                             [](const digit_t digit) { return digit == ~digit_t{0}; }));
+            return longint{};
+        }
+        LONGINT_DEBUG_ASSERT(std::all_of(r.nums_ + n + 1, r.nums_ + packed_size,
+                                         [](const digit_t digit) { return digit == 0; }));
+        r.set_ssize_from_size(n + 1);
+        r.pop_leading_zeros();
+        return r;
+    }
+
+    longint divisor_;
+    /// @brief |divisor_| * 2^shift_ with the highest bit set. Empty (as well as the reciprocal_)
+    ///         if the divisor is small enough for the schoolbook division
+    longint normalized_divisor_;
+    /// @brief floor(kNumsBase^{2 n} / normalized_divisor_) for the products by the n + 1 digits
+    PrecomputedMultiplier reciprocal_;
+    /// @brief FFT of the normalized_divisor_ for the cyclic products, empty if the
+    ///         normalized_divisor_ is too small or the products need the high precision mode
+    fft::PrecomputedOperand cyclic_spectrum_;
+    std::uint32_t shift_{};
+};
+
+inline void longint::divmod_precomputed(longint& x, const PrecomputedDivisor& divisor, longint& rem) {
+    const longint& v = divisor.normalized_divisor_;
+    if (v.is_zero()) {
+        x.divmod_impl(divisor.divisor_, rem);
+        return;
+    }
+
+    const size_type n = v.usize();
+    longint z = std::move(x);
+    z <<= divisor.shift_;
+    const size_type m = z.usize();
+    if (m < n) {
+        x = longint{};
+        rem = std::move(z);
+        rem >>= divisor.shift_;
+        return;
+    }
+
+    // Barrett estimate q = floor(floor(z / kNumsBase^{n - 1}) * reciprocal / kNumsBase^{n + 1}) is at most
+    //  2 less than z / v < kNumsBase^k. Short quotients are estimated from the highest k + 1 digits of the
+    //  reciprocal only, which lowers the estimate by at most 1 more
+    const size_type k = m - n + 1;
+    LONGINT_ASSERT_ASSUME(k <= n + 1);
+    longint q = digits_slice(z, n - 1, k);
+    if (k > n / 2) {
+        q *= divisor.reciprocal_;
+        shift_right_by_digits(q, n + 1);
+    } else {
+        q *= digits_slice(divisor.reciprocal_.multiplier(), n - k, k + 1);
+        shift_right_by_digits(q, k + 1);
+    }
+
+    if (divisor.cyclic_spectrum_.empty()) {
+        z -= q * v;
+    } else {
+        z = divisor.cyclic_remainder(z, q);
+    }
+    while (z >= v) {
+        q += uint32_t{1};
+        z -= v;
+    }
+
+    z >>= divisor.shift_;
+    rem = std::move(z);
+    x = std::move(q);
+}
+
+/**
+ * @brief Non-owning read-only view of the number stored in the externally owned
+ *         32-bit limbs, e.g. in the mmap'd file with the longint binary format
+ *         (see longint::to_binary()). Limbs should outlive the view.
+ * @note The view of the longint with at most longint::kInlineDigitsCapacity digits points
+ *        into the longint object itself (see longint::kInlineDigitsCapacity). Move and swap
+ *        copy such digits, so after `longint m = std::move(n);` or `n.swap(m)` the view
+ *        taken from n does not follow the value to m, and it dangles once n is destroyed.
+ *        Views of the longer numbers point to the heap buffer, which moves with the value.
+ */
+class longint_view final {
+public:
+    using digit_t = longint::digit_t;
+    using size_type = longint::size_type;
+    using ssize_type = longint::ssize_type;
+    using const_iterator = const digit_t*;
+
+    constexpr longint_view() noexcept = default;
+
+    /// @brief View of the (negative ? -1 : 1) * sum(digits[i] * 2^{32 i}), i = 0, ..., digits_count - 1
+    /// @note Leading zero limbs are skipped
+    ATTRIBUTE_SIZED_ACCESS(read_only, 2, 3)
+    constexpr longint_view(const digit_t digits[], size_type digits_count, const bool negative = false) noexcept
+        : nums_(digits), size_() {
+        LONGINT_ASSERT_ASSUME(digits_count <= longint::max_size());
+        while (digits_count > 0 && digits[digits_count - 1] == 0) {
+            digits_count--;
+        }
+        size_ = static_cast<ssize_type>(negative ? -digits_count : digits_count);
+    }
+
+    /* implicit */ constexpr longint_view(const longint& n ATTRIBUTE_LIFETIME_BOUND) noexcept
+        : nums_(n.begin()), size_(n.size()) {}
+
+#if CONFIG_BYTE_ORDER_LITTLE_ENDIAN
+    /// @brief View of the number written by the longint::to_binary(), the digits are not copied
+    /// @throws std::invalid_argument if @a data[0..size) is not the longint binary format
+    ///          or the digits are not aligned to the alignof(digit_t)
+    ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+    [[nodiscard]] static longint_view from_binary(const std::byte data[] ATTRIBUTE_LIFETIME_BOUND,
+                                                  const std::size_t size) {
+        const ssize_type ssize_value = longint::check_binary(data, size);
+        const std::byte* const digits = data + longint::kBinaryHeaderSize;
+        if (unlikely(reinterpret_cast<std::uintptr_t>(digits) % alignof(digit_t) != 0)) {
+            longint::throw_on_invalid_binary(LONGINT_FILE_LOCATION(), "unaligned digits");
+        }
+        longint_view ret;
+        ret.nums_ = static_cast<const digit_t*>(static_cast<const void*>(digits));
+        ret.size_ = ssize_value;
+        return ret;
+    }
+#endif
+
+    [[nodiscard]] ATTRIBUTE_PURE constexpr ssize_type size() const noexcept {
+        return size_;
+    }
+    [[nodiscard]] ATTRIBUTE_PURE constexpr size_type usize() const noexcept {
+        return math_functions::uabs(size_);
+    }
+    [[nodiscard]] ATTRIBUTE_PURE constexpr std::int32_t sign() const noexcept {
+        return math_functions::sign(size_);
+    }
+    [[nodiscard]] ATTRIBUTE_PURE constexpr bool is_zero() const noexcept {
+        return size_ == 0;
+    }
+    [[nodiscard]] ATTRIBUTE_PURE constexpr bool is_negative() const noexcept {
+        return size_ < 0;
+    }
+    [[nodiscard]] ATTRIBUTE_PURE constexpr const_iterator begin() const noexcept {
+        return nums_;
+    }
+    [[nodiscard]] ATTRIBUTE_PURE constexpr const_iterator end() const noexcept {
+        return nums_ + usize();
+    }
+    [[nodiscard]] constexpr digit_t operator[](const std::size_t pos) const noexcept {
+        return nums_[pos];
+    }
+
+    /// @brief Same as longint::mod(uint32_t)
+    [[nodiscard]] ATTRIBUTE_PURE constexpr int64_t mod(const uint32_t n) const noexcept {
+        if (unlikely(n == 0)) {
+            /* Quite return when dividing by zero, i.e. n = 0. */
+            return 0;
+        }
 
-    ATTRIBUTE_ALWAYS_INLINE static fft::complex* allocate_complex_array_for_unique_ptr(std::size_t size) {
-        const auto size_bytes = size * sizeof(fft::complex);
-        return static_cast<fft::complex*>(::operator new(size_bytes));
+        longint::double_digit_t carry = 0;
+        for (size_type i = usize(); i > 0; i--) {
+            carry = ((carry << longint::kDigitBits) | nums_[i - 1]) % n;
+        }
+        const auto remainder = static_cast<uint32_t>(carry);
+        return is_negative() ? -int64_t{remainder} : int64_t{remainder};
     }
 
-    ATTRIBUTE_ALWAYS_INLINE static size_type check_size(const std::size_t value) {
-        if (unlikely(value > max_size())) {
-            throw_size_error(LONGINT_FILE_LOCATION(), value, max_size());
-        }
-        const size_type checked_value = static_cast<size_type>(value);
-        CONFIG_ASSUME_STATEMENT(checked_value <= max_size());
-        LONGINT_ASSERT_ASSUME(checked_value == value);
-        return checked_value;
+    [[nodiscard]] ATTRIBUTE_PURE constexpr int64_t operator%(const uint32_t n) const noexcept {
+        return mod(n);
     }
 
-    void adopt_digits_sequence_without_changing_size(digit_t* const new_nums,
-                                                     const size_type new_nums_capacity) noexcept {
-        deallocate(nums_, capacity_);
-        nums_ = new_nums;
-        capacity_ = new_nums_capacity;
+    [[nodiscard]] longint to_longint() const {
+        return longint::from_digits(nums_, usize(), is_negative());
     }
 
-    ATTRIBUTE_COLD
-    [[noreturn]] static void throw_size_error(const char* const file_location,
-                                              const char* const function_name,
-                                              const std::size_t new_size_value,
-                                              const std::size_t max_size_value) {
-        static constexpr std::size_t kMessageSize = 1024;
-        std::array<char, kMessageSize> message{};
-        const int bytes_written = std::snprintf(
-            message.data(), message.size(), "%s: size error at %s: new size (which is %zu) > max size (which is %zu)",
-            file_location, function_name, new_size_value, max_size_value);
+    [[nodiscard]] ATTRIBUTE_PURE friend constexpr bool operator==(const longint_view lhs,
+                                                                  const longint_view rhs) noexcept {
+        return lhs.size_ == rhs.size_ && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+    [[nodiscard]] ATTRIBUTE_PURE friend constexpr bool operator!=(const longint_view lhs,
+                                                                  const longint_view rhs) noexcept {
+        return !(lhs == rhs);
+    }
+    [[nodiscard]] ATTRIBUTE_PURE friend constexpr bool operator<(const longint_view lhs,
+                                                                 const longint_view rhs) noexcept {
+        return compare(lhs, rhs) < 0;
+    }
+    [[nodiscard]] ATTRIBUTE_PURE friend constexpr bool operator>(const longint_view lhs,
+                                                                 const longint_view rhs) noexcept {
+        return compare(lhs, rhs) > 0;
+    }
+    [[nodiscard]] ATTRIBUTE_PURE friend constexpr bool operator<=(const longint_view lhs,
+                                                                  const longint_view rhs) noexcept {
+        return compare(lhs, rhs) <= 0;
+    }
+    [[nodiscard]] ATTRIBUTE_PURE friend constexpr bool operator>=(const longint_view lhs,
+                                                                  const longint_view rhs) noexcept {
+        return compare(lhs, rhs) >= 0;
+    }
 
-        if (unlikely(bytes_written < 0)) {
-            constexpr std::string_view kFallbackMessage = "size error at ";
-            std::char_traits<char>::copy(message.data(), kFallbackMessage.data(), kFallbackMessage.size());
-            const auto fn_name_size = std::char_traits<char>::length(function_name);
-            static_assert(kFallbackMessage.size() < kMessageSize);
-            const auto fn_name_copy_size = std::min(fn_name_size, message.size() - 1 - kFallbackMessage.size());
-            std::char_traits<char>::copy(std::addressof(message[kFallbackMessage.size()]), function_name,
-                                         fn_name_copy_size);
-            message[kFallbackMessage.size() + fn_name_copy_size] = '\0';
+private:
+    /// @return -1, 0 or 1 if lhs < rhs, lhs == rhs or lhs > rhs respectively
+    [[nodiscard]] ATTRIBUTE_PURE static constexpr int compare(const longint_view lhs, const longint_view rhs) noexcept {
+        if (lhs.size_ != rhs.size_) {
+            return lhs.size_ < rhs.size_ ? -1 : 1;
+        }
+        for (size_type i = lhs.usize(); i > 0; i--) {
+            if (lhs.nums_[i - 1] != rhs.nums_[i - 1]) {
+                const bool abs_less = lhs.nums_[i - 1] < rhs.nums_[i - 1];
+                return abs_less != lhs.is_negative() ? -1 : 1;
+            }
         }
+        return 0;
+    }
 
-        throw std::length_error{message.data()};
+    const digit_t* nums_ = nullptr;
+    /// @brief Same as longint::size_
+    ssize_type size_ = 0;
+};
+
+inline longint& longint::assign_product(const longint_view lhs, const longint_view rhs) ATTRIBUTE_LIFETIME_BOUND {
+    size_type m = lhs.usize();
+    size_type k = rhs.usize();
+    const digit_t* m_ptr = lhs.begin();
+    const digit_t* k_ptr = rhs.begin();
+    if (m > k) {
+        std::swap(m_ptr, k_ptr);
+        std::swap(m, k);
+    }
+    if (unlikely(m == 0)) {
+        assign_zero();
+        return *this;
     }
 
-    ATTRIBUTE_COLD
-    [[noreturn]] static void throw_on_failed_uint_checked_cast(const char* const file_location,
-                                                               const char* const function_name) {
-        static constexpr std::size_t kMessageSize = 1024;
-        std::array<char, kMessageSize> message{};
-        const int bytes_written =
-            std::snprintf(message.data(), message.size(), "%s: checked cast longint to integral type failed at %s",
-                          file_location, function_name);
-        if (unlikely(bytes_written < 0)) {
-            constexpr std::string_view kFallbackMessage = "checked cast longint to integral type failed";
-            static_assert(kFallbackMessage.size() <= kMessageSize);
-            std::char_traits<char>::copy(message.data(), kFallbackMessage.data(), kFallbackMessage.size());
-            message[kFallbackMessage.size()] = '\0';
+    const bool negative = lhs.is_negative() != rhs.is_negative();
+    static_assert(max_size() + max_size() > max_size());
+    const size_type prod_size = check_size(std::size_t{m} + k);
+    if (prod_size <= kInlineDigitsCapacity) {
+        // Operands may point to the digits of *this
+        digit_t product[kInlineDigitsCapacity];
+        multiply_and_store_to(m_ptr, m, k_ptr, k, product);
+        reserveUninitializedWithoutCopy(prod_size);
+        std::copy_n(product, prod_size, nums_);
+    } else {
+        digit_t* const product = allocate_uninitialized(prod_size);
+        multiply_and_store_to(m_ptr, m, k_ptr, k, product);
+        adopt_digits_sequence_without_changing_size(product, prod_size);
+    }
+    set_ssize_from_size_and_sign(prod_size, /* sign = */ negative ? -1 : 1);
+    pop_leading_zeros();
+    return *this;
+}
+
+namespace longint_detail {
+
+/**
+ * @brief Append-only table of the values that are computed on demand and shared between the threads.
+ *
+ * Elements are never changed, moved or freed after being published (like the fft roots tiers,
+ * see fft::detail::private_impl), so they are read without locking, only the growth
+ * (see ensure_size()) is done under the mutex.
+ */
+template <class T>
+class published_table final {
+public:
+    /// @note i < size(), e.g. after the ensure_size(n) with n > i
+    [[nodiscard]] ATTRIBUTE_ALWAYS_INLINE const T& operator[](const std::size_t i) const noexcept {
+        LONGINT_DEBUG_ASSERT(i < kMaxSize);
+        const T* const element = elements_[i].load(std::memory_order_acquire);
+        LONGINT_DEBUG_ASSERT(element != nullptr);
+        return *element;
+    }
+
+    /// @brief Makes elements with indexes [0; n) available, element i is created by make_element(i)
+    ///         (called under the lock, it may read the elements [0; i) of this table)
+    template <class Factory>
+    void ensure_size(const std::size_t n, Factory make_element) {
+        LONGINT_DEBUG_ASSERT(n <= kMaxSize);
+        if (likely(size_.load(std::memory_order_acquire) >= n)) {
+            return;
         }
 
-        throw std::runtime_error{message.data()};
+        const std::lock_guard lock{mutex_};
+        for (std::size_t i = size_.load(std::memory_order_relaxed); i < n; i++) {
+            std::unique_ptr<T> element = std::make_unique<T>(make_element(i));
+            elements_[i].store(element.get(), std::memory_order_release);
+            storage_[i] = std::move(element);
+            size_.store(i + 1, std::memory_order_release);
+        }
     }
 
-    digit_t* nums_ = nullptr;
-    /**
-     * size_ < 0 <=> sign = -1; size_ == 0 <=> sign = 0; size > 0 <=> sign = 1
-     */
-    ssize_type size_ = 0;
-    size_type capacity_ = 0;
-};
+private:
+    /// @brief Tables are indexed by the log2 of the sizes
+    static constexpr std::size_t kMaxSize = sizeof(std::size_t) * CHAR_BIT;
 
-namespace longint_detail {
+    std::atomic<const T*> elements_[kMaxSize]{};
+    std::atomic<std::size_t> size_{0};
+    std::unique_ptr<T> storage_[kMaxSize]{};
+    std::mutex mutex_{};
+};
 
 struct longint_static_storage final {
 private:
     friend longint;
 
-    static std::vector<longint> create_initial_conv_dec_base_pows() {
-        std::vector<longint> pows;
-        auto local_copy{longint::kStrConvBase};
-        pows.emplace_back(local_copy);
-        return pows;
+    /// @brief conv_dec_base_pows[k] = P_k = 10^{9 * 2^k}
+    static inline published_table<longint> conv_dec_base_pows{};
+
+    /// @brief conv_dec_base_pows_divisors[k] holds the conv_dec_base_pows[k] prepared for the divisions
+    ///         of the numbers less than its square (see longint::append_to_string_div_conq())
+    static inline published_table<longint::PrecomputedDivisor> conv_dec_base_pows_divisors{};
+
+    static void ensureDecBasePowsDivisorsCapacity(std::size_t pows_size) {
+        ensureDecBasePowsCapacity(pows_size);
+        conv_dec_base_pows_divisors.ensure_size(
+            pows_size, [](const std::size_t i) { return longint::PrecomputedDivisor{conv_dec_base_pows[i]}; });
     }
 
-    static inline std::vector<longint> conv_dec_base_pows =
-        longint_detail::longint_static_storage::create_initial_conv_dec_base_pows();
+    /// @brief conv_dec_base_pows_multipliers[k] holds the conv_dec_base_pows[k] together with its FFT
+    ///         for the products by the numbers with 2^k digits (see longint::set_dec_str_impl())
+    static inline published_table<longint::PrecomputedMultiplier> conv_dec_base_pows_multipliers{};
+
+    static void ensureDecBasePowsMultipliersCapacity(std::size_t pows_size) {
+        ensureDecBasePowsCapacity(pows_size);
+        conv_dec_base_pows_multipliers.ensure_size(pows_size, [](const std::size_t i) {
+            return longint::PrecomputedMultiplier{conv_dec_base_pows[i], longint::size_type{1} << i};
+        });
+    }
 
     static void ensureDecBasePowsCapacity(std::size_t pows_size) {
-        std::size_t i = conv_dec_base_pows.size();
-        if (i >= pows_size) {
-            return;
-        }
-        conv_dec_base_pows.reserve(pows_size);
-        do {
-            conv_dec_base_pows.emplace_back();
-            conv_dec_base_pows[i - 1].square_this_to(conv_dec_base_pows.back());
-        } while (++i != pows_size);
+        conv_dec_base_pows.ensure_size(pows_size, [](const std::size_t i) {
+            if (i == 0) {
+                auto local_copy{longint::kStrConvBase};
+                return longint{local_copy};
+            }
+            longint pow;
+            conv_dec_base_pows[i - 1].square_this_to(pow);
+            return pow;
+        });
     }
 };
 
@@ -3201,73 +7020,40 @@ inline void longint::set_dec_str_impl(const unsigned char* const str, const std:
             *--str_conv_digits_iter = current;
         }
 
-        do {
-            static_assert(kStrConvBaseDigits == 9);
-            uint32_t current = uint32_t{*str_iter} - '0';
-            str_iter++;
-            current = current * 10 + uint32_t{*str_iter} - '0';
-            str_iter++;
-            current = current * 10 + uint32_t{*str_iter} - '0';
-            str_iter++;
-            current = current * 10 + uint32_t{*str_iter} - '0';
-            str_iter++;
-            current = current * 10 + uint32_t{*str_iter} - '0';
-            str_iter++;
-            current = current * 10 + uint32_t{*str_iter} - '0';
-            str_iter++;
-            current = current * 10 + uint32_t{*str_iter} - '0';
-            str_iter++;
-            current = current * 10 + uint32_t{*str_iter} - '0';
-            str_iter++;
-            current = current * 10 + uint32_t{*str_iter} - '0';
-            str_iter++;
-            *--str_conv_digits_iter = current;
-        } while (str_iter != str_end);
+        static_assert(kStrConvBaseDigits == longint_detail::dec_str_kernels::kBlockDigits);
+        const auto blocks = static_cast<std::size_t>(str_end - str_iter) / kStrConvBaseDigits;
+        longint_detail::dec_str_kernels::pack()(str_iter, blocks, str_conv_digits_iter);
     }
 
-    static_assert(max_size() * 4 > max_size());
-    std::size_t m = aligned_str_conv_digits_size * 2;
-    if (m > kFFTPrecisionBorder) {
-        m *= 2;
-    }
-    longint_detail::longint_static_storage::ensureDecBasePowsCapacity(
+    longint_detail::longint_static_storage::ensureDecBasePowsMultipliersCapacity(
         math_functions::log2_floor(aligned_str_conv_digits_size));
+    const std::size_t max_threads = max_fft_threads();
+    const std::size_t max_tasks = aligned_str_conv_digits_size >= kMinParallelDecStrConvDigits
+                                      ? std::min(max_threads, std::size_t{aligned_str_conv_digits_size} / 2)
+                                      : 1;
+    const DecStrConvBuffers buffers = make_dec_str_conv_buffers(aligned_str_conv_digits_size, max_tasks);
 
-    // Allocate m complex numbers for p1 and m complex numbers for p2
-    const std::size_t max_fft_poly_length = 2 * m;
-    static_assert(sizeof(fft::complex) % sizeof(digit_t) == 0);
-    const std::size_t allocated_nums_and_poly_size =
-        std::size_t{aligned_str_conv_digits_size} + max_fft_poly_length * (sizeof(fft::complex) / sizeof(digit_t));
-    digit_t* const mult_add_buffer = std::allocator<digit_t>{}.allocate(allocated_nums_and_poly_size);
-
-#if CONFIG_COMPILER_ID == CONFIG_GCC_COMPILER_ID
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wcast-align"
-#endif
-
-    assert((aligned_str_conv_digits_size * sizeof(digit_t)) % alignof(fft::complex) == 0);
-#ifdef __STDCPP_DEFAULT_NEW_ALIGNMENT__
-    static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= alignof(fft::complex), "");
-#endif
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-    assert(reinterpret_cast<std::uintptr_t>(mult_add_buffer) % alignof(fft::complex) == 0);
-    auto* const fft_poly_buffer = reinterpret_cast<fft::complex*>(mult_add_buffer + aligned_str_conv_digits_size);
-    // NOLINTPREVLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-
-#if CONFIG_COMPILER_ID == CONFIG_GCC_COMPILER_ID
-#pragma GCC diagnostic pop
-#endif
-
-    const longint* conv_dec_base_pows_iter = longint_detail::longint_static_storage::conv_dec_base_pows.data();
+    std::size_t conv_dec_base_pow_index = 0;
     static_assert(max_size() * 2 > max_size());
-    for (size_type conv_len = 2; conv_len <= aligned_str_conv_digits_size; conv_len *= 2, ++conv_dec_base_pows_iter) {
+    for (size_type conv_len = 2; conv_len <= aligned_str_conv_digits_size; conv_len *= 2, ++conv_dec_base_pow_index) {
+        const PrecomputedMultiplier& conv_dec_base_pow =
+            longint_detail::longint_static_storage::conv_dec_base_pows_multipliers[conv_dec_base_pow_index];
         LONGINT_ASSERT_ASSUME(math_functions::is_power_of_two(conv_len));
+        // Blocks of the level are independent, so they are split between the threads while there are
+        //  at least 2 of them, the FFT products of the last levels get all the threads
+        const std::size_t blocks = aligned_str_conv_digits_size / conv_len;
+        const std::size_t tasks = std::min(max_tasks, blocks);
+        if (tasks > 1) {
+            convert_dec_base_level_in_parallel(str_conv_digits, aligned_str_conv_digits_size, conv_len,
+                                               conv_dec_base_pow, tasks, buffers);
+            continue;
+        }
         for (size_type pos = 0; pos < aligned_str_conv_digits_size; pos += conv_len) {
-            convert_dec_base_mult_add(str_conv_digits + pos, conv_len, *conv_dec_base_pows_iter, mult_add_buffer,
-                                      fft_poly_buffer);
+            convert_dec_base_mult_add(str_conv_digits + pos, conv_len, conv_dec_base_pow.multiplier_,
+                                      conv_dec_base_pow.spectrum_, buffers[0]->mult_add_buffer(),
+                                      buffers[0]->fft_poly_buffer(), max_threads);
         }
     }
-    std::allocator<digit_t>{}.deallocate(mult_add_buffer, allocated_nums_and_poly_size);
 
     size_type usize_value = aligned_str_conv_digits_size;
     while (usize_value > 0 && nums_[usize_value - 1] == 0) {
@@ -3276,6 +7062,628 @@ inline void longint::set_dec_str_impl(const unsigned char* const str, const std:
     set_ssize_from_size_and_sign(usize_value, sgn);
 }
 
+inline longint::DecStrConvBuffers longint::make_dec_str_conv_buffers(const size_type str_conv_digits_size,
+                                                                      const std::size_t tasks) {
+    DecStrConvBuffers buffers(tasks);
+    for (std::size_t i = 0; i < tasks; i++) {
+        // Max power of two conv_len such that str_conv_digits_size / conv_len >= i + 1
+        const auto max_conv_len = static_cast<size_type>(
+            str_conv_digits_size >> math_functions::log2_ceil(static_cast<std::uint64_t>(i + 1)));
+        buffers[i] = std::make_unique<DecStrConvBuffer>(max_conv_len);
+    }
+    return buffers;
+}
+
+inline void longint::convert_dec_base_level_in_parallel(digit_t str_conv_digits[],
+                                                        const size_type str_conv_digits_size,
+                                                        const size_type conv_len,
+                                                        const PrecomputedMultiplier& conv_base_pow,
+                                                        const std::size_t tasks,
+                                                        const DecStrConvBuffers& buffers) {
+    LONGINT_ASSERT_ASSUME(tasks >= 2 && tasks <= buffers.size());
+    const std::size_t blocks = str_conv_digits_size / conv_len;
+    const std::size_t fft_threads = std::max(max_fft_threads() / tasks, std::size_t{1});
+    misc::thread_pool::instance().run(tasks, [=, &conv_base_pow, &buffers](const std::size_t task) {
+        const DecStrConvBuffer& buffer = *buffers[task];
+        const std::size_t first_block = blocks * task / tasks;
+        const std::size_t last_block = blocks * (task + 1) / tasks;
+        for (std::size_t block = first_block; block < last_block; block++) {
+            convert_dec_base_mult_add(str_conv_digits + block * conv_len, conv_len, conv_base_pow.multiplier_,
+                                      conv_base_pow.spectrum_, buffer.mult_add_buffer(), buffer.fft_poly_buffer(),
+                                      fft_threads);
+        }
+    });
+}
+
+inline void longint::append_to_string_div_conq(std::string& ans) const {
+    const size_type usize_value = usize();
+    LONGINT_ASSERT_ASSUME(usize_value > 2 && usize_value < kDecimalToStringThreshold);
+
+    // Upper bound on the number of the base 10^9 digits: 32 * log10(2) / 9 = 1.0703...
+    static_assert(kDigitBits == 32 && kStrConvBaseDigits == 9);
+    const std::size_t dec_blocks = (std::size_t{usize_value} * 1071 + 999) / 1000 + 1;
+    // |*this| < 10^{9 * dec_blocks} <= 10^{9 * 2^{pows_count}} = P_{pows_count - 1}^2
+    const std::size_t pows_count = math_functions::log2_ceil(uint64_t{dec_blocks});
+    longint_detail::longint_static_storage::ensureDecBasePowsDivisorsCapacity(pows_count);
+
+    const std::size_t width = dec_blocks * kStrConvBaseDigits;
+    const std::size_t old_size = ans.size();
+    ans.resize(old_size + width);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto* const str = reinterpret_cast<unsigned char*>(ans.data() + old_size);
+
+    longint abs_value = *this;
+    abs_value.set_ssize_from_size_and_sign(usize_value, /* sign = */ 1);
+    write_dec_digits_div_conq(std::move(abs_value), pows_count, str, width);
+
+    const auto leading_zeros = static_cast<std::size_t>(
+        std::find_if(str, str + width, [](const unsigned char c) { return c != '0'; }) - str);
+    LONGINT_ASSERT_ASSUME(leading_zeros < width);
+    ans.erase(old_size, leading_zeros);
+}
+
+inline void longint::write_dec_digits_div_conq(longint&& x,
+                                               std::size_t pows_count,
+                                               unsigned char* const str,
+                                               const std::size_t width) {
+    LONGINT_ASSERT_ASSUME(width % kStrConvBaseDigits == 0);
+    const auto& pows = longint_detail::longint_static_storage::conv_dec_base_pows_divisors;
+    // Skip the powers that are greater than the x
+    while (x.usize() > kDivConqToStringLeafSize && x < pows[pows_count - 1].divisor()) {
+        LONGINT_ASSERT_ASSUME(pows_count > 1);
+        pows_count--;
+    }
+    if (x.usize() <= kDivConqToStringLeafSize) {
+        write_dec_digits_naive(x, str, width);
+        return;
+    }
+
+    // x = q * P_{pows_count - 1} + r
+    const std::size_t low_width = std::size_t{kStrConvBaseDigits} << (pows_count - 1);
+    LONGINT_ASSERT_ASSUME(low_width < width);
+    longint r;
+    divmod_precomputed(x, pows[pows_count - 1], r);
+    write_dec_digits_div_conq(std::move(x), pows_count - 1, str, width - low_width);
+    write_dec_digits_div_conq(std::move(r), pows_count - 1, str + (width - low_width), low_width);
+}
+
+inline void longint::set_base_str_impl(const std::string_view digits, const uint32_t base) {
+    const BaseChunks params{base};
+    // Chunks of the params.chunk_size chars, lowest first (the highest one may be shorter)
+    std::vector<uint32_t> chunks((digits.size() + params.chunk_size - 1) / params.chunk_size);
+    std::size_t chunk_end = digits.size();
+    for (uint32_t& chunk : chunks) {
+        const std::size_t chunk_begin = chunk_end >= params.chunk_size ? chunk_end - params.chunk_size : 0;
+        uint32_t value = 0;
+        for (std::size_t i = chunk_begin; i < chunk_end; i++) {
+            value = value * base + char_to_base_digit(digits[i]);
+        }
+        chunk = value;
+        chunk_end = chunk_begin;
+    }
+
+    std::size_t pows_count = 0;
+    while ((kBaseLeafChunks << pows_count) < chunks.size()) {
+        pows_count++;
+    }
+    const std::vector<longint> pows = make_base_chunks_pows(params, pows_count);
+    *this = base_chunks_to_longint(chunks.data(), chunks.size(), pows, params);
+}
+
+inline void longint::append_base_str_div_conq(std::string& ans, const uint32_t base) const {
+    const size_type usize_value = usize();
+    LONGINT_ASSERT_ASSUME(usize_value > 0);
+    const BaseChunks params{base};
+
+    // |*this| < 2^{32 usize} <= base^{width}
+    const auto max_chars = static_cast<std::size_t>(static_cast<double>(usize_value) * kDigitBits /
+                                                    std::log2(static_cast<double>(base))) + 2;
+    const std::size_t chunks = (max_chars + params.chunk_size - 1) / params.chunk_size;
+    const std::size_t width = chunks * params.chunk_size;
+    std::size_t pows_count = 0;
+    while ((kBaseLeafChunks << pows_count) * 2 <= chunks) {
+        pows_count++;
+    }
+    const std::vector<longint> pows = make_base_chunks_pows(params, pows_count);
+
+    const std::size_t old_size = ans.size();
+    ans.resize(old_size + width);
+    char* const str = ans.data() + old_size;
+    longint abs_value = *this;
+    abs_value.set_ssize_from_size_and_sign(usize_value, /* sign = */ 1);
+    write_base_digits_div_conq(std::move(abs_value), pows, pows_count, params, str, width);
+
+    const auto leading_zeros =
+        static_cast<std::size_t>(std::find_if(str, str + width, [](const char c) { return c != '0'; }) - str);
+    LONGINT_ASSERT_ASSUME(leading_zeros < width);
+    ans.erase(old_size, leading_zeros);
+}
+
+inline void longint::write_base_digits_div_conq(longint&& x,
+                                                const std::vector<longint>& pows,
+                                                std::size_t pows_count,
+                                                const BaseChunks& params,
+                                                char* const str,
+                                                const std::size_t width) {
+    LONGINT_ASSERT_ASSUME(width % params.chunk_size == 0);
+    // Skip the powers that are greater than the x
+    while (x.usize() > kDivConqToStringLeafSize && x < pows[pows_count - 1]) {
+        LONGINT_ASSERT_ASSUME(pows_count > 1);
+        pows_count--;
+    }
+    if (x.usize() <= kDivConqToStringLeafSize) {
+        write_base_digits_naive(x, params, str, width);
+        return;
+    }
+
+    // x = q * P_{pows_count - 1} + r
+    const std::size_t low_width = (kBaseLeafChunks * params.chunk_size) << (pows_count - 1);
+    LONGINT_ASSERT_ASSUME(low_width < width);
+    longint r;
+    x.divmod(pows[pows_count - 1], r);
+    write_base_digits_div_conq(std::move(x), pows, pows_count, params, str, width - low_width);
+    write_base_digits_div_conq(std::move(r), pows, pows_count - 1, params, str + (width - low_width), low_width);
+}
+
+struct longint::ExtendedGcdResult final {
+    longint u_value;
+    longint v_value;
+    longint gcd_value;
+};
+
+struct longint::GcdMatrix final {
+    longint m00{uint32_t{1}};
+    longint m01{};
+    longint m10{};
+    longint m11{uint32_t{1}};
+
+    /// @brief M := C * M
+    void apply_cofactors(const LehmerCofactors& c, longint& tmp) {
+        apply_lehmer_cofactors(m00, m10, c, tmp);
+        apply_lehmer_cofactors(m01, m11, c, tmp);
+    }
+
+    /// @brief M := [[0, 1], [1, -q]] * M
+    void apply_quotient(const longint& q) {
+        apply_euclid_quotient(m00, m10, q);
+        apply_euclid_quotient(m01, m11, q);
+    }
+
+    void negate_row(const bool second_row) noexcept {
+        (second_row ? m10 : m00).flip_sign();
+        (second_row ? m11 : m01).flip_sign();
+    }
+
+    void swap_rows() noexcept {
+        m00.swap(m10);
+        m01.swap(m11);
+    }
+
+    /// @brief (x, y) := M * (x, y)
+    void apply_to(longint& x, longint& y) const {
+        longint new_y = m10 * x;
+        new_y.addmul(m11, y);
+        x *= m00;
+        x.addmul(m01, y);
+        y = std::move(new_y);
+    }
+
+    /// @brief M := lhs * M
+    void multiply_left(const GcdMatrix& lhs) {
+        lhs.apply_to(m00, m10);
+        lhs.apply_to(m01, m11);
+    }
+};
+
+inline longint longint::gcd(const longint& a, const longint& b) {
+    longint x = a;
+    longint y = b;
+    x.set_ssize_from_size_and_sign(x.usize(), /* sign = */ 1);
+    y.set_ssize_from_size_and_sign(y.usize(), /* sign = */ 1);
+    if (x < y) {
+        x.swap(y);
+    }
+    longint unused_x_coef;
+    longint unused_y_coef;
+    gcd_impl</* TrackCoefficients = */ false>(x, y, unused_x_coef, unused_y_coef);
+    return x;
+}
+
+inline longint::ExtendedGcdResult longint::extended_gcd(const longint& a, const longint& b) {
+    if (b.is_zero()) {
+        longint u{a.sign()};
+        longint g = a;
+        g.set_ssize_from_size_and_sign(g.usize(), /* sign = */ 1);
+        return {std::move(u), longint{}, std::move(g)};
+    }
+
+    // x = x_coef * |a| (mod |b|), y = y_coef * |a| (mod |b|)
+    longint x = a;
+    longint y = b;
+    x.set_ssize_from_size_and_sign(x.usize(), /* sign = */ 1);
+    y.set_ssize_from_size_and_sign(y.usize(), /* sign = */ 1);
+    longint x_coef{uint32_t{1}};
+    longint y_coef{};
+    if (x < y) {
+        x.swap(y);
+        x_coef.swap(y_coef);
+    }
+    gcd_impl</* TrackCoefficients = */ true>(x, y, x_coef, y_coef);
+
+    // a * u = g (mod |b|), 0 <= u < |b| / g
+    longint b_div_g = b;
+    b_div_g.set_ssize_from_size_and_sign(b_div_g.usize(), /* sign = */ 1);
+    b_div_g /= x;
+    const bool negate_u = a.is_negative() != x_coef.is_negative();
+    x_coef.set_ssize_from_size_and_sign(x_coef.usize(), /* sign = */ 1);
+    longint u;
+    x_coef.divmod(b_div_g, u);
+    if (negate_u && !u.is_zero()) {
+        u.flip_sign();
+        u += b_div_g;
+    }
+
+    // v = (g - a * u) / b
+    longint v = x;
+    v.submul(a, u);
+    v /= b;
+    return {std::move(u), std::move(v), std::move(x)};
+}
+
+inline longint longint::inv_mod(const longint& a, const longint& m) {
+    if (unlikely(m.size() <= 0)) {
+        throw_on_non_positive_modulus(LONGINT_FILE_LOCATION());
+    }
+
+    ExtendedGcdResult res = extended_gcd(a, m);
+    if (res.gcd_value != uint32_t{1}) {
+        return longint{};
+    }
+    return std::move(res.u_value);
+}
+
+inline void longint::lehmer_reduce(longint& x, longint& y, GcdMatrix& m, const size_type target_size) {
+    LehmerCofactors c{};
+    longint q;
+    longint tmp;
+    while (!y.is_zero() && x.usize() > target_size) {
+        if (lehmer_step(x, y, c, q, tmp)) {
+            m.apply_cofactors(c, tmp);
+        } else {
+            m.apply_quotient(q);
+        }
+    }
+}
+
+inline longint::GcdMatrix longint::half_gcd_of_high_part(longint& x, longint& y, const size_type k) {
+    longint x_high = digits_slice(x, k, x.usize());
+    longint y_high = digits_slice(y, k, y.usize());
+    GcdMatrix m = half_gcd(x_high, y_high);
+
+    // (x, y) = M * (x_high * kNumsBase^k + x_low, y_high * kNumsBase^k + y_low)
+    longint x_low = digits_slice(x, 0, k);
+    longint y_low = digits_slice(y, 0, k);
+    m.apply_to(x_low, y_low);
+    shift_left_by_digits(x_high, k);
+    shift_left_by_digits(y_high, k);
+    x = std::move(x_high);
+    x += x_low;
+    y = std::move(y_high);
+    y += y_low;
+
+    // The last quotients of the highest parts may be wrong for the whole numbers,
+    //  but any unimodular matrix keeps the gcd, so just restore x >= y >= 0
+    if (x.is_negative()) {
+        x.flip_sign();
+        m.negate_row(/* second_row = */ false);
+    }
+    if (y.is_negative()) {
+        y.flip_sign();
+        m.negate_row(/* second_row = */ true);
+    }
+    if (x < y) {
+        x.swap(y);
+        m.swap_rows();
+    }
+    return m;
+}
+
+inline longint::GcdMatrix longint::half_gcd(longint& x, longint& y) {
+    LONGINT_DEBUG_ASSERT(x >= y && !y.is_negative());
+    const size_type n = x.usize();
+    const size_type target_size = n / 2 + 1;
+    if (n < kHalfGcdThreshold || y.is_zero()) {
+        GcdMatrix m;
+        lehmer_reduce(x, y, m, target_size);
+        return m;
+    }
+
+    // x, y: n -> about 3 n / 4 digits
+    GcdMatrix m = half_gcd_of_high_part(x, y, n / 2);
+    if (y.is_zero() || x.usize() <= target_size) {
+        return m;
+    }
+
+    {
+        longint q = x;
+        longint r;
+        q.divmod(y, r);
+        x.swap(y);
+        y.swap(r);
+        m.apply_quotient(q);
+    }
+
+    // x, y: about 3 n / 4 -> about n / 2 digits
+    const size_type x_size = x.usize();
+    if (y.is_zero() || x_size <= target_size) {
+        return m;
+    }
+    if (x_size < n) {
+        const size_type k = n - x_size;
+        if (x_size - k >= 2) {
+            m.multiply_left(half_gcd_of_high_part(x, y, k));
+        }
+    }
+    lehmer_reduce(x, y, m, target_size);
+    return m;
+}
+
+template <bool TrackCoefficients>
+inline void longint::gcd_impl(longint& x, longint& y, longint& x_coef, longint& y_coef) {
+    LehmerCofactors c{};
+    longint q;
+    longint tmp;
+    while (!y.is_zero()) {
+        LONGINT_DEBUG_ASSERT(x >= y && !y.is_negative());
+        if constexpr (!TrackCoefficients) {
+            if (x.usize() <= 2) {
+                const auto to_u64 = [](const longint& n) noexcept {
+                    return n.usize() == 2 ? (double_digit_t{n.nums_[1]} << kDigitBits) | n.nums_[0] : n.nums_[0];
+                };
+                x = std::gcd(to_u64(x), to_u64(y));
+                y.assign_zero();
+                return;
+            }
+        }
+
+        const size_type x_size = x.usize();
+        if (y.usize() >= kHalfGcdThreshold && x_size - y.usize() <= 1) {
+            const GcdMatrix m = half_gcd(x, y);
+            if constexpr (TrackCoefficients) {
+                m.apply_to(x_coef, y_coef);
+            }
+        } else if (lehmer_step(x, y, c, q, tmp)) {
+            if constexpr (TrackCoefficients) {
+                apply_lehmer_cofactors(x_coef, y_coef, c, tmp);
+            }
+        } else {
+            if constexpr (TrackCoefficients) {
+                apply_euclid_quotient(x_coef, y_coef, q);
+            }
+        }
+    }
+}
+
+inline longint longint::iroot(const longint& n, const uint32_t k) {
+    if (unlikely(k == 0 || (k % 2 == 0 && n.is_negative()))) {
+        throw_on_invalid_root(LONGINT_FILE_LOCATION(), k);
+    }
+    if (k == 1 || n.is_zero()) {
+        return n;
+    }
+
+    longint abs_n = n;
+    abs_n.set_ssize_from_size_and_sign(abs_n.usize(), /* sign = */ 1);
+    longint root = iroot_impl(abs_n, k);
+    if (n.is_negative()) {
+        root.flip_sign();
+    }
+    return root;
+}
+
+inline std::uint64_t longint::iroot_u64(const std::uint64_t n, const uint32_t k) noexcept {
+    LONGINT_DEBUG_ASSERT(n > 0 && k >= 2);
+    if (k == 2) {
+        return math_functions::isqrt(n);
+    }
+    if (k >= 64) {
+        return 1;
+    }
+
+    // x^k <= n
+    const auto fits = [n, k](const std::uint64_t x) noexcept {
+        std::uint64_t p = 1;
+        for (uint32_t i = 0; i < k; i++) {
+            if (p > n / x) {
+                return false;
+            }
+            p *= x;
+        }
+        return true;
+    };
+    auto root = static_cast<std::uint64_t>(std::pow(static_cast<double>(n), 1.0 / k));
+    root = std::max(root, std::uint64_t{1});
+    while (!fits(root)) {
+        root--;
+    }
+    while (fits(root + 1)) {
+        root++;
+    }
+    return root;
+}
+
+inline longint longint::iroot_impl(const longint& n, const uint32_t k) {
+    LONGINT_DEBUG_ASSERT(n.size() > 0 && k >= 2);
+    const std::size_t n_bits = bit_width(n);
+    if (n_bits <= 64) {
+        return longint{iroot_u64(n.to_uint_unchecked<std::uint64_t>(), k)};
+    }
+    if (k >= n_bits) {
+        return longint{uint32_t{1}};
+    }
+
+    // x > n^{1/k}
+    const std::size_t root_bits = (n_bits - 1) / k + 1;
+    const std::size_t k_bits = math_functions::log2_floor(k) + 1;
+    longint x;
+    if (root_bits > 2 * k_bits + 4) {
+        // x = (floor((n / 2^{k s})^{1/k}) + 1) * 2^s with the error below 2^{s + 1}, so after
+        //  one Newton's step the error is about (k - 1) 2^{2 s + 2} / 2^{root_bits} < 2
+        const auto s = static_cast<uint32_t>((root_bits - k_bits - 3) / 2);
+        longint high = n;
+        high >>= static_cast<uint32_t>(std::size_t{k} * s);
+        x = iroot_impl(high, k);
+        x += uint32_t{1};
+        x <<= s;
+    } else {
+        x = uint32_t{1};
+        x <<= static_cast<uint32_t>(root_bits);
+    }
+
+    // Newton's step y = ((k - 1) x + n / x^{k - 1}) / k >= floor(n^{1/k}) for any x > 0
+    //  and y < x while x > floor(n^{1/k})
+    longint x_pow;
+    longint y;
+    while (true) {
+        x_pow = x;
+        x_pow.pow(k - 1);
+        y = n;
+        y /= x_pow;
+        y.addmul(x, k - 1);
+        y /= k;
+        if (y >= x) {
+            return x;
+        }
+        x.swap(y);
+        if (root_bits > 2 * k_bits + 4) {
+            break;
+        }
+    }
+
+    // floor(n^{1/k}) <= x <= floor(n^{1/k}) + 2
+    while (true) {
+        x_pow = x;
+        x_pow.pow(k);
+        if (x_pow <= n) {
+            return x;
+        }
+        x -= uint32_t{1};
+    }
+}
+
+inline math_functions::IsPerfectSquareResult<longint> longint::is_perfect_square(const longint& n) {
+    static constexpr auto kSquaresMod64 = make_squares_mod_table<64>();
+    static constexpr auto kSquaresMod63 = make_squares_mod_table<63>();
+    static constexpr auto kSquaresMod65 = make_squares_mod_table<65>();
+    static constexpr auto kSquaresMod11 = make_squares_mod_table<11>();
+
+    if (n.is_negative()) {
+        return {longint{}, false};
+    }
+    if (n.is_zero()) {
+        return {longint{}, true};
+    }
+    if (!kSquaresMod64[n.nums_[0] % 64]) {
+        return {longint{}, false};
+    }
+    // One pass over the digits for all the odd moduli
+    const auto r = static_cast<std::uint32_t>(n.mod(63U * 65U * 11U));
+    if (!kSquaresMod63[r % 63] || !kSquaresMod65[r % 65] || !kSquaresMod11[r % 11]) {
+        return {longint{}, false};
+    }
+
+    longint root = iroot_impl(n, 2);
+    longint root_square;
+    root.square_this_to(root_square);
+    if (root_square != n) {
+        return {longint{}, false};
+    }
+    return {std::move(root), true};
+}
+
+template <class Iterator>
+inline longint longint::product(Iterator first, Iterator last, const std::size_t max_threads) {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    static_assert(std::is_same_v<value_type, longint> || (std::is_integral_v<value_type> && sizeof(value_type) <= 4),
+                  "longint::product() multiplies longint or integers with at most 32 bits");
+
+    std::vector<longint> leaves;
+    longint leaf = uint32_t{1};
+    for (; first != last; ++first) {
+        if constexpr (std::is_same_v<value_type, longint>) {
+            leaf *= *first;
+        } else if constexpr (std::is_unsigned_v<value_type>) {
+            leaf *= static_cast<uint32_t>(*first);
+        } else {
+            leaf *= static_cast<int32_t>(*first);
+        }
+        if (leaf.usize() >= kProductLeafDigits) {
+            leaves.push_back(std::move(leaf));
+            leaf = uint32_t{1};
+        }
+    }
+    if (leaves.empty() || leaf != uint32_t{1}) {
+        leaves.push_back(std::move(leaf));
+    }
+    const bool parallel = max_threads > 1;
+    if (parallel) {
+        misc::thread_pool::instance().reserve(max_threads - 1);
+    }
+    return product_tree(leaves.data(), leaves.size(), parallel);
+}
+
+inline longint longint::factorial(const uint32_t n, const std::size_t max_threads) {
+    constexpr uint32_t kMaxSmallFactorial = 20;
+    if (n <= kMaxSmallFactorial) {
+        std::uint64_t f = 1;
+        for (uint32_t i = 2; i <= n; i++) {
+            f *= i;
+        }
+        return longint{f};
+    }
+
+    const std::vector<uint32_t> primes = primes_up_to(n);
+    // n! = ((n / 2)!)^2 * swing(n) = (((n / 4)!)^2 * swing(n / 2))^2 * swing(n) = ...
+    uint32_t levels = 0;
+    while ((n >> levels) > kMaxSmallFactorial) {
+        levels++;
+    }
+    longint res = factorial(n >> levels);
+    for (uint32_t i = levels; i > 0; i--) {
+        res.square_inplace();
+        res *= prime_swing(n >> (i - 1), primes, max_threads);
+    }
+    return res;
+}
+
+inline longint longint::binomial(const uint32_t n, const uint32_t k, const std::size_t max_threads) {
+    if (k > n) {
+        return longint{};
+    }
+    const uint32_t m = std::min(k, n - k);
+    if (m == 0) {
+        return longint{uint32_t{1}};
+    }
+
+    // Exponent of the prime p in the C(n, k) is the number of carries when adding k and n - k
+    //  in base p (Kummer's theorem), so p^e <= n fits into the uint32_t
+    std::vector<uint32_t> factors;
+    for (const uint32_t p : primes_up_to(n)) {
+        uint32_t p_pow = 1;
+        uint32_t carry = 0;
+        for (uint32_t a = m, b = n - m; a > 0 || b > 0 || carry > 0; a /= p, b /= p) {
+            carry = (a % p + b % p + carry) >= p ? 1 : 0;
+            if (carry != 0) {
+                p_pow *= p;
+            }
+        }
+        if (p_pow > 1) {
+            factors.push_back(p_pow);
+        }
+    }
+    return product(factors.begin(), factors.end(), max_threads);
+}
+
 // clang-format off
 // NOLINTEND(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays,
 // cppcoreguidelines-avoid-magic-numbers)
@@ -3284,6 +7692,9 @@ inline void longint::set_dec_str_impl(const unsigned char* const str, const std:
 #if defined(HAS_CUSTOM_LONGINT_ALLOCATOR)
 #undef HAS_CUSTOM_LONGINT_ALLOCATOR
 #endif
+#if defined(LONGINT_HAS_X86_SIMD_INTRINSICS)
+#undef LONGINT_HAS_X86_SIMD_INTRINSICS
+#endif
 #undef CONSTEXPR_VECTOR
 #undef LONGINT_FILE_LOCATION
 #undef CONCAT_STR_STR_INT2
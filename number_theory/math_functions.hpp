@@ -47,6 +47,10 @@
 #include <numbers>
 #define MATH_FUNCTIONS_HAS_NUMBERS
 #endif
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L && CONFIG_HAS_INCLUDE(<span>)
+#include <span>
+#define MATH_FUNCTIONS_HAS_SPAN
+#endif
 
 #if CONFIG_HAS_CONCEPTS
 #include <concepts>
@@ -1991,6 +1995,141 @@ template <class IntType>
     return prime_factors_map;
 }
 
+namespace detail {
+
+ATTRIBUTE_ALWAYS_INLINE inline void prefetch_for_read(const void* const address) noexcept {
+#if CONFIG_COMPILER_IS_GCC_OR_ANY_CLANG
+    __builtin_prefetch(address, 0, 3);
+#else
+    static_cast<void>(address);
+#endif
+}
+
+/// @brief Calls visitor(PrimeFactor<uint32_t>) for the prime factors of n in the increasing order
+///         (if visitor returns bool, stops after the first false), lpf(m) should return the least
+///         prime factor of the odd m >= 3
+template <class LeastPrimeFactorFunction, class F>
+ATTRIBUTE_ALWAYS_INLINE constexpr void visit_prime_factors_by_lpf(uint32_t n,
+                                                                  const LeastPrimeFactorFunction& lpf,
+                                                                  F& visitor) {
+    constexpr bool kCheckEarlyExit = std::is_invocable_r_v<bool, F&, PrimeFactor<uint32_t>>;
+    const auto visit = [&visitor](const uint32_t factor, const uint32_t factor_power) {
+        if constexpr (kCheckEarlyExit) {
+            return static_cast<bool>(visitor(PrimeFactor<uint32_t>{factor, factor_power}));
+        } else {
+            visitor(PrimeFactor<uint32_t>{factor, factor_power});
+            return true;
+        }
+    };
+
+    if (n % 2 == 0 && n > 0) {
+        const auto [n_div_pow_of_2, power_of_2] = math_functions::extract_pow2(n);
+        if (!visit(uint32_t{2}, power_of_2)) {
+            return;
+        }
+        n = n_div_pow_of_2;
+    }
+
+    while (n >= 3) {
+        const uint32_t factor = lpf(n);
+        CONFIG_ASSUME_STATEMENT(factor >= 3);
+        uint32_t factor_power = 0;
+        do {
+            n /= factor;
+            factor_power++;
+        } while (n % factor == 0);
+        if (!visit(factor, factor_power)) {
+            return;
+        }
+    }
+}
+
+/// @brief Number of the numbers factorized simultaneously by the factorize_by_lpf()
+inline constexpr size_t kFactorizeBatchSize = 16;
+
+/**
+ * @brief Calls visitor(i, PrimeFactor<uint32_t>) for the prime factors of every numbers[i].
+ *
+ * Every next lookup lpf(m) of the factorization depends on the previous one, so
+ * kFactorizeBatchSize numbers are factorized in the round robin order and the entry of
+ * the next lookup of every number is prefetched (by the prefetch(m)) one round before
+ * it is used, so the latencies of the lookups in the huge table overlap.
+ * Prime factors of every number are visited in the increasing order, but calls
+ * for the different numbers are interleaved.
+ */
+template <class LeastPrimeFactorFunction, class PrefetchFunction, class F>
+void factorize_by_lpf(const uint32_t numbers[],
+                      const size_t size,
+                      const LeastPrimeFactorFunction& lpf,
+                      const PrefetchFunction& prefetch,
+                      F& visitor) {
+    struct Slot final {
+        size_t index;
+        uint32_t n;
+        uint32_t factor;
+        uint32_t factor_power;
+    };
+
+    std::array<Slot, kFactorizeBatchSize> slots{};
+    size_t active_slots = 0;
+    size_t next_number = 0;
+    // Takes numbers until one of them has odd part >= 3 and puts it to the slot
+    const auto fill_slot = [&](Slot& slot) {
+        for (; next_number < size; next_number++) {
+            uint32_t n = numbers[next_number];
+            if (n % 2 == 0 && n > 0) {
+                const auto [n_div_pow_of_2, power_of_2] = math_functions::extract_pow2(n);
+                visitor(next_number, PrimeFactor<uint32_t>{uint32_t{2}, power_of_2});
+                n = n_div_pow_of_2;
+            }
+            if (n >= 3) {
+                prefetch(n);
+                slot = Slot{next_number, n, 0, 0};
+                next_number++;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    while (active_slots < kFactorizeBatchSize && fill_slot(slots[active_slots])) {
+        active_slots++;
+    }
+
+    while (active_slots > 0) {
+        for (size_t i = 0; i < active_slots;) {
+            Slot& slot = slots[i];
+            const uint32_t factor = lpf(slot.n);
+            CONFIG_ASSUME_STATEMENT(factor >= 3);
+            if (factor == slot.factor) {
+                slot.factor_power++;
+            } else {
+                if (slot.factor_power > 0) {
+                    visitor(slot.index, PrimeFactor<uint32_t>{slot.factor, slot.factor_power});
+                }
+                slot.factor = factor;
+                slot.factor_power = 1;
+            }
+            slot.n /= factor;
+            if (slot.n >= 3) {
+                prefetch(slot.n);
+                i++;
+                continue;
+            }
+
+            visitor(slot.index, PrimeFactor<uint32_t>{slot.factor, slot.factor_power});
+            if (!fill_slot(slot)) {
+                // Slots are not ordered, so the last active slot takes the place of the finished one
+                slot = slots[--active_slots];
+            } else {
+                i++;
+            }
+        }
+    }
+}
+
+}  // namespace detail
+
 /// @brief https://cp-algorithms.com/algebra/prime-sieve-linear.html
 class [[nodiscard]] ATTRIBUTE_GSL_OWNER(std::vector<uint32_t>) Factorizer final {
 public:
@@ -2068,6 +2207,34 @@ public:
         return math_functions::Factorizer::number_of_unique_prime_factors_impl(least_prime_factor_.data(), n);
     }
 
+    /// @brief Calls visitor(PrimeFactor<uint32_t>) for every prime factor of n in the increasing order
+    ///         without allocations. If visitor returns bool, stops after the first false
+    template <class F>
+    CONSTEXPR_VECTOR void for_each_prime_factor(const uint32_t n, F visitor) const {
+        assert(n <= max_checkable_number());
+        const uint32_t* const lpf_table = least_prime_factor_.data();
+        math_functions::detail::visit_prime_factors_by_lpf(
+            n, [lpf_table](const uint32_t m) noexcept { return lpf_table[m]; }, visitor);
+    }
+
+    /// @brief Calls visitor(i, PrimeFactor<uint32_t>) for every prime factor of every numbers[i],
+    ///         lookups in the table are prefetched (see math_functions::detail::factorize_by_lpf())
+    template <class F>
+    void factorize(const uint32_t numbers[], const size_t size, F visitor) const {
+        const uint32_t* const lpf_table = least_prime_factor_.data();
+        math_functions::detail::factorize_by_lpf(
+            numbers, size, [lpf_table](const uint32_t m) noexcept { return lpf_table[m]; },
+            [lpf_table](const uint32_t m) noexcept { math_functions::detail::prefetch_for_read(lpf_table + m); },
+            visitor);
+    }
+
+#ifdef MATH_FUNCTIONS_HAS_SPAN
+    template <class F>
+    void factorize(const std::span<const uint32_t> numbers, F visitor) const {
+        factorize(numbers.data(), numbers.size(), std::move(visitor));
+    }
+#endif
+
 private:
     ATTRIBUTE_PURE
     ATTRIBUTE_ACCESS(read_only, 1)
@@ -2102,6 +2269,130 @@ private:
     NumbersContainer least_prime_factor_;
 };
 
+/**
+ * @brief Factorizer of the numbers in [0; n] that takes n bytes instead of 4 n bytes.
+ *
+ * Only odd numbers are stored and least prime factor of every odd composite
+ * number m <= n < 2^32 is less than 2^16, so it is stored as uint16_t,
+ * primes are marked by 0 (so their least prime factor is the number itself).
+ * Table is built by the sieve of Eratosthenes over the L2-sized segments.
+ */
+class [[nodiscard]] ATTRIBUTE_GSL_OWNER(std::vector<uint16_t>) CompactFactorizer final {
+public:
+    using PrimeFactors = std::vector<PrimeFactor<uint32_t>>;
+
+    explicit CompactFactorizer(const uint32_t n) : n_(n), odd_least_prime_factor_(size_t{n / 2} + 1) {
+        const uint32_t root = math_functions::isqrt(n);
+        std::vector<uint32_t> sieving_primes;
+        std::vector<uint64_t> next_multiple_index;
+        {
+            std::vector<bool> is_composite(size_t{root} + 1);
+            for (uint32_t p = 3; p <= root; p += 2) {
+                if (is_composite[p]) {
+                    continue;
+                }
+                sieving_primes.push_back(p);
+                // Index of p^2 in the odd_least_prime_factor_
+                next_multiple_index.push_back(uint64_t{p} * p / 2);
+                for (uint32_t m = p * p; m <= root; m += 2 * p) {
+                    is_composite[m] = true;
+                }
+            }
+        }
+
+        // Primes are sieved in the increasing order, so the first one
+        //  that marks the number is its least prime factor
+        const size_t table_size = odd_least_prime_factor_.size();
+        for (size_t segment_begin = 0; segment_begin < table_size; segment_begin += kSegmentSize) {
+            const size_t segment_end = std::min(segment_begin + kSegmentSize, table_size);
+            for (size_t i = 0; i < sieving_primes.size(); i++) {
+                const uint32_t p = sieving_primes[i];
+                uint64_t index = next_multiple_index[i];
+                for (; index < segment_end; index += p) {
+                    uint16_t& lpf = odd_least_prime_factor_[static_cast<size_t>(index)];
+                    if (lpf == 0) {
+                        lpf = static_cast<uint16_t>(p);
+                    }
+                }
+                next_multiple_index[i] = index;
+            }
+        }
+        // 1 is not a prime
+        odd_least_prime_factor_[0] = 1;
+    }
+
+    [[nodiscard]] uint32_t max_checkable_number() const noexcept {
+        return n_;
+    }
+
+    [[nodiscard]] bool is_prime(const uint32_t n) const noexcept {
+        assert(n <= max_checkable_number());
+        return n % 2 == 0 ? n == 2 : odd_least_prime_factor_[n / 2] == 0;
+    }
+
+    /// @note n >= 2
+    [[nodiscard]] uint32_t least_prime_factor(const uint32_t n) const noexcept {
+        assert(2 <= n && n <= max_checkable_number());
+        return n % 2 == 0 ? 2 : odd_least_prime_factor(odd_least_prime_factor_.data(), n);
+    }
+
+    [[nodiscard]] PrimeFactors prime_factors(const uint32_t n) const {
+        PrimeFactors pfs;
+        for_each_prime_factor(n, [&pfs](const PrimeFactor<uint32_t> pf) { pfs.push_back(pf); });
+        return pfs;
+    }
+
+    [[nodiscard]] uint32_t number_of_unique_prime_factors(const uint32_t n) const noexcept {
+        uint32_t unique_pfs_count = 0;
+        for_each_prime_factor(n, [&unique_pfs_count](PrimeFactor<uint32_t>) noexcept { unique_pfs_count++; });
+        return unique_pfs_count;
+    }
+
+    /// @brief Calls visitor(PrimeFactor<uint32_t>) for every prime factor of n in the increasing order
+    ///         without allocations. If visitor returns bool, stops after the first false
+    template <class F>
+    void for_each_prime_factor(const uint32_t n, F visitor) const {
+        assert(n <= max_checkable_number());
+        const uint16_t* const lpf_table = odd_least_prime_factor_.data();
+        math_functions::detail::visit_prime_factors_by_lpf(
+            n, [lpf_table](const uint32_t m) noexcept { return odd_least_prime_factor(lpf_table, m); }, visitor);
+    }
+
+    /// @brief Calls visitor(i, PrimeFactor<uint32_t>) for every prime factor of every numbers[i],
+    ///         lookups in the table are prefetched (see math_functions::detail::factorize_by_lpf())
+    template <class F>
+    void factorize(const uint32_t numbers[], const size_t size, F visitor) const {
+        const uint16_t* const lpf_table = odd_least_prime_factor_.data();
+        math_functions::detail::factorize_by_lpf(
+            numbers, size, [lpf_table](const uint32_t m) noexcept { return odd_least_prime_factor(lpf_table, m); },
+            [lpf_table](const uint32_t m) noexcept { math_functions::detail::prefetch_for_read(lpf_table + m / 2); },
+            visitor);
+    }
+
+#ifdef MATH_FUNCTIONS_HAS_SPAN
+    template <class F>
+    void factorize(const std::span<const uint32_t> numbers, F visitor) const {
+        factorize(numbers.data(), numbers.size(), std::move(visitor));
+    }
+#endif
+
+private:
+    /// @brief 256 KiB
+    static constexpr size_t kSegmentSize = size_t{1} << 17U;
+
+    ATTRIBUTE_PURE
+    ATTRIBUTE_ALWAYS_INLINE
+    [[nodiscard]]
+    static uint32_t odd_least_prime_factor(const uint16_t* const lpf_table, const uint32_t m) noexcept {
+        CONFIG_ASSUME_STATEMENT(m % 2 == 1);
+        const uint32_t lpf = lpf_table[m / 2];
+        return lpf == 0 ? m : lpf;
+    }
+
+    uint32_t n_;
+    std::vector<uint16_t> odd_least_prime_factor_;
+};
+
 /// @brief Find all prime numbers in [2; n]
 /// @param n inclusive upper bound
 /// @return vector, such that vector[n] == true \iff n is prime
@@ -3369,6 +3660,9 @@ constexpr std::common_type_t<M, N> gcd(const M m, const N n) noexcept(detail::is
 #ifdef MATH_FUNCTIONS_HAS_BIT
 #undef MATH_FUNCTIONS_HAS_BIT
 #endif
+#ifdef MATH_FUNCTIONS_HAS_SPAN
+#undef MATH_FUNCTIONS_HAS_SPAN
+#endif
 
 #ifdef MATH_FUNCTIONS_HPP_ENABLE_TARGET_OPTIONS
 #if defined(__GNUG__)
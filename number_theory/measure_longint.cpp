@@ -0,0 +1,683 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../misc/do_not_optimize_away.h"
+#include "longint.hpp"
+
+/**
+ * Without arguments prints the time of the longint operations for the hand-picked sizes.
+ *
+ * With --csv or --json sweeps the operand sizes over all the multiplication, division and
+ * string conversion tiers of the longint (up to --max-digits=N digits) and prints one row
+ * per (operation, size) in the CSV or JSON format, so that the results of two builds can be diffed.
+ *
+ * ns_per_digit is the time of one operation divided by the number of the 32-bit digits
+ * of the result (for the divmod: of the dividend), allocations are the longint_allocator
+ * counters (pages and heap) per one operation. The counters are tracked only if the
+ * longint uses the longint_allocator (compile with -DLONGINT_USE_CUSTOM_ALLOCATOR),
+ * otherwise they are 0.
+ */
+
+// Same condition as for the HAS_CUSTOM_LONGINT_ALLOCATOR in the longint.hpp
+#if (CONFIG_COMPILER_ID == CONFIG_GCC_COMPILER_ID || CONFIG_COMPILER_ID == CONFIG_CLANG_COMPILER_ID || \
+     CONFIG_COMPILER_ID == CONFIG_CLANG_CL_COMPILER_ID) &&                                               \
+    defined(LONGINT_USE_CUSTOM_ALLOCATOR)
+#define MEASURE_LONGINT_ALLOCATIONS
+#endif
+
+namespace {
+
+longint make_random_longint(std::mt19937& rnd, const std::uint32_t digits_count) {
+    std::vector<longint::digit_t> digits(digits_count);
+    // Make every digit non-zero so that n has exactly digits_count digits
+    std::generate(digits.begin(), digits.end(), [&rnd]() { return static_cast<longint::digit_t>(rnd() | 1U); });
+    return longint::from_digits(digits.data(), digits.size());
+}
+
+std::uint32_t iterations_for(const std::uint32_t m, const std::uint32_t k) {
+    constexpr std::uint64_t kWorkPerMeasurement = std::uint64_t{1} << 24;
+    const std::uint64_t work = std::uint64_t{m} * k + 1;
+    return static_cast<std::uint32_t>(std::max(std::uint64_t{16}, kWorkPerMeasurement / work));
+}
+
+template <class MultPolicy = longint::DefaultMultPolicy>
+std::uint64_t measure_mult_ns(std::mt19937& rnd, const std::uint32_t m, const std::uint32_t k) {
+    const longint lhs = make_random_longint(rnd, k);
+    const longint rhs = make_random_longint(rnd, m);
+    const std::uint32_t iterations = iterations_for(m, k);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        longint prod = lhs;
+        prod.multiply_inplace<MultPolicy>(rhs);
+        config::do_not_optimize_away(prod[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+std::uint64_t measure_square_ns(std::mt19937& rnd, const std::uint32_t m) {
+    const longint n = make_random_longint(rnd, m);
+    const std::uint32_t iterations = iterations_for(m, m);
+
+    longint sq;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        n.square_this_to(sq);
+        config::do_not_optimize_away(sq[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+/// @brief Measures the construction, copy and arithmetic of the numbers with at most 4 digits
+std::uint64_t measure_small_values_ns(std::mt19937& rnd) {
+    constexpr std::uint32_t kValues = 256;
+    std::vector<uint128_t> values(kValues);
+    for (uint128_t& value : values) {
+        value = (uint128_t{rnd()} << 96U) | (uint128_t{rnd()} << 64U) | (uint128_t{rnd()} << 32U) | rnd();
+        value >>= rnd() % 128U;
+    }
+    constexpr std::uint32_t kIterations = 2'000;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < kIterations; i++) {
+        longint sum;
+        for (const uint128_t value : values) {
+            const longint n = value;
+            longint copy = n;
+            copy *= 3U;
+            copy += n;
+            sum = copy;
+            sum -= n;
+        }
+        config::do_not_optimize_away(sum.size());
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / (kIterations * kValues);
+}
+
+/// @brief Measures sum(a_i * b_i) computed with the operators and with the longint::addmul
+std::pair<std::uint64_t, std::uint64_t> measure_dot_product_ns(std::mt19937& rnd,
+                                                               const std::uint32_t m,
+                                                               const std::uint32_t terms) {
+    std::vector<longint> a(terms);
+    std::vector<longint> b(terms);
+    for (std::uint32_t i = 0; i < terms; i++) {
+        a[i] = make_random_longint(rnd, m);
+        b[i] = make_random_longint(rnd, m);
+    }
+    const std::uint32_t iterations = std::max(std::uint32_t{1}, iterations_for(m, m * terms));
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        longint sum;
+        for (std::uint32_t j = 0; j < terms; j++) {
+            sum = sum + a[j] * b[j];
+        }
+        config::do_not_optimize_away(sum[0]);
+    }
+    const auto middle = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        longint sum;
+        for (std::uint32_t j = 0; j < terms; j++) {
+            sum.addmul(a[j], b[j]);
+        }
+        config::do_not_optimize_away(sum[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return {
+        static_cast<std::uint64_t>(std::chrono::nanoseconds{middle - start}.count()) / iterations,
+        static_cast<std::uint64_t>(std::chrono::nanoseconds{end - middle}.count()) / iterations,
+    };
+}
+
+std::uint64_t measure_divmod_ns(std::mt19937& rnd, const std::uint32_t m, const std::uint32_t n) {
+    const longint dividend = make_random_longint(rnd, m);
+    const longint divisor = make_random_longint(rnd, n);
+    const std::uint32_t iterations = iterations_for(m - n + 1, n);
+
+    longint rem;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        longint quot = dividend;
+        quot.divmod(divisor, rem);
+        config::do_not_optimize_away(rem[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+std::uint64_t measure_reciprocal_divmod_ns(std::mt19937& rnd, const std::uint32_t m, const std::uint32_t n) {
+    const longint dividend = make_random_longint(rnd, m);
+    const longint::Reciprocal reciprocal{make_random_longint(rnd, n)};
+    const std::uint32_t iterations = iterations_for(m - n + 1, n);
+
+    longint rem;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        longint quot = dividend;
+        quot.divmod(reciprocal, rem);
+        config::do_not_optimize_away(rem[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+std::uint64_t measure_to_string_ns(std::mt19937& rnd, const std::uint32_t m) {
+    const longint n = make_random_longint(rnd, m);
+    const std::uint32_t iterations = iterations_for(m, m / 8 + 1);
+
+    std::string buffer;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        n.to_string(buffer);
+        config::do_not_optimize_away(buffer[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+std::uint64_t measure_gcd_ns(std::mt19937& rnd, const std::uint32_t m, const bool extended) {
+    const longint lhs = make_random_longint(rnd, m);
+    const longint rhs = make_random_longint(rnd, m);
+    const std::uint32_t iterations = iterations_for(m, m);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        if (extended) {
+            const longint::ExtendedGcdResult res = longint::extended_gcd(lhs, rhs);
+            config::do_not_optimize_away(res.gcd_value[0]);
+        } else {
+            const longint g = longint::gcd(lhs, rhs);
+            config::do_not_optimize_away(g[0]);
+        }
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+std::pair<std::uint64_t, std::uint64_t> measure_pow_mod_ns(std::mt19937& rnd, const std::uint32_t m) {
+    const longint base = make_random_longint(rnd, m);
+    const longint exp = make_random_longint(rnd, m);
+    // make_random_longint() makes odd numbers
+    const longint odd_mod = make_random_longint(rnd, m);
+    longint even_mod = odd_mod;
+    even_mod += 1U;
+    const std::uint32_t iterations = std::max(std::uint32_t{1}, iterations_for(m, m) / (m * 32));
+
+    const longint::MontgomeryContext context{odd_mod};
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        const longint res = context.pow_mod(base, exp);
+        config::do_not_optimize_away(res[0]);
+    }
+    const auto middle = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        // Even moduli are reduced by the division
+        longint res = base;
+        res.pow_mod(exp, even_mod);
+        config::do_not_optimize_away(res[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return {
+        static_cast<std::uint64_t>(std::chrono::nanoseconds{middle - start}.count()) / iterations,
+        static_cast<std::uint64_t>(std::chrono::nanoseconds{end - middle}.count()) / iterations,
+    };
+}
+
+std::uint64_t measure_isqrt_ns(std::mt19937& rnd, const std::uint32_t m) {
+    const longint n = make_random_longint(rnd, m);
+    const std::uint32_t iterations = iterations_for(m, m / 8 + 1);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        const longint root = longint::isqrt(n);
+        config::do_not_optimize_away(root[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+std::uint64_t measure_factorial_ns(const std::uint32_t n, const std::size_t max_threads) {
+    const std::uint32_t iterations = std::max(std::uint32_t{1}, (std::uint32_t{1} << 22U) / n);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        const longint f = longint::factorial(n, max_threads);
+        config::do_not_optimize_away(f[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+/// @return nanoseconds per digit of the add, sub, shift left and shift right of the @a kernels
+std::array<double, 4> measure_carry_kernels_ns(std::mt19937& rnd,
+                                               const longint_detail::carry_kernels::kernels_table& kernels,
+                                               const std::uint32_t n) {
+    std::vector<std::uint32_t> lhs(n);
+    std::vector<std::uint32_t> rhs(n);
+    for (std::uint32_t i = 0; i < n; i++) {
+        lhs[i] = static_cast<std::uint32_t>(rnd());
+        rhs[i] = static_cast<std::uint32_t>(rnd());
+    }
+    const std::uint32_t iterations = std::max(std::uint32_t{4}, (std::uint32_t{1} << 26U) / n);
+
+    std::array<double, 4> ns_per_digit{};
+    const auto measure = [&](const std::size_t index, auto&& operation) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (std::uint32_t i = 0; i < iterations; i++) {
+            operation();
+            config::do_not_optimize_away(lhs[i % n]);
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        ns_per_digit[index] = static_cast<double>(std::chrono::nanoseconds{end - start}.count()) /
+                              (static_cast<double>(iterations) * static_cast<double>(n));
+    };
+    measure(0, [&]() { config::do_not_optimize_away(kernels.add_n(lhs.data(), rhs.data(), n)); });
+    measure(1, [&]() { config::do_not_optimize_away(kernels.sub_n(lhs.data(), rhs.data(), n)); });
+    measure(2, [&]() { kernels.shift_left(lhs.data(), n, 13); });
+    measure(3, [&]() { kernels.shift_right(lhs.data(), n, 13); });
+    return ns_per_digit;
+}
+
+/// @return nanoseconds per set_string() of the decimal string with @a length digits
+std::uint64_t measure_set_string_ns(std::mt19937& rnd, const std::uint32_t length, const std::size_t max_threads) {
+    std::string str(length, '0');
+    for (char& c : str) {
+        c = static_cast<char>('0' + rnd() % 10);
+    }
+    str.front() = '9';
+    const std::uint32_t iterations = std::max(std::uint32_t{1}, (std::uint32_t{1} << 24U) / length);
+
+    longint::set_max_fft_threads(max_threads);
+    longint n;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        n.set_string(str);
+        config::do_not_optimize_away(n[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    longint::set_max_fft_threads(1);
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+/// @brief Returns the time of the to_string and of the set_string of the number with @a length decimal digits
+std::pair<std::uint64_t, std::uint64_t> measure_dec_string_ns(std::mt19937& rnd, const std::uint32_t length) {
+    std::string str(length, '0');
+    for (char& c : str) {
+        c = static_cast<char>('0' + rnd() % 10);
+    }
+    str.front() = '9';
+    longint n;
+    n.set_string(str);
+    const std::uint32_t iterations = std::max(std::uint32_t{1}, (std::uint32_t{1} << 24U) / length);
+
+    std::string buffer;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        n.to_string(buffer);
+        config::do_not_optimize_away(buffer[0]);
+    }
+    const auto middle = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        n.set_string(buffer);
+        config::do_not_optimize_away(n[0]);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return {
+        static_cast<std::uint64_t>(std::chrono::nanoseconds{middle - start}.count()) / iterations,
+        static_cast<std::uint64_t>(std::chrono::nanoseconds{end - middle}.count()) / iterations,
+    };
+}
+
+/**
+ * Sizes around the naive / Karatsuba / Toom-3 / FFT crossover points
+ */
+constexpr std::uint32_t kSizes[] = {
+    8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 128, 160, 192, 224, 256, 320, 384, 512, 768, 1024, 2048,
+};
+
+/**
+ * Sizes below and above the longint::kFFTPrecisionBorder
+ */
+constexpr std::uint32_t kBigSizes[] = {
+    1024, 4096, 16384, 65536, 100000, 150000, 300000,
+};
+
+/**
+ * Divisor sizes around the schoolbook / Burnikel-Ziegler / Newton crossover points
+ */
+constexpr std::uint32_t kDivSizes[] = {
+    32, 64, 96, 128, 192, 256, 512, 1024, 2048, 4096, 8192, 16384,
+};
+
+
+#ifdef MEASURE_LONGINT_ALLOCATIONS
+constexpr bool kAllocationsTracked = true;
+#else
+constexpr bool kAllocationsTracked = false;
+#endif
+
+struct AllocationCounts final {
+    std::uint64_t allocations;
+    std::uint64_t heap_allocations;
+    std::uint64_t heap_bytes;
+};
+
+AllocationCounts current_allocation_counts() noexcept {
+#ifdef MEASURE_LONGINT_ALLOCATIONS
+    const longint_allocator::AllocatorStats stats = longint_allocator::GetStats();
+    return AllocationCounts{
+        stats.small_pages_rented + stats.middle_pages_rented + stats.heap_allocations,
+        stats.heap_allocations,
+        stats.heap_bytes_allocated,
+    };
+#else
+    return AllocationCounts{0, 0, 0};
+#endif
+}
+
+struct Measurement final {
+    const char* operation;
+    std::uint32_t lhs_digits;
+    std::uint32_t rhs_digits;
+    std::uint32_t result_digits;
+    std::uint32_t iterations;
+    std::uint64_t ns_per_operation;
+    double ns_per_digit;
+    double allocations_per_operation;
+    double heap_allocations_per_operation;
+    double heap_bytes_per_operation;
+};
+
+/// @brief Every measurement takes about kWorkPerMeasurement / (n log n) iterations
+std::uint32_t tier_iterations_for(const std::uint32_t digits) {
+    constexpr std::uint64_t kWorkPerMeasurement = std::uint64_t{1} << 26U;
+    const std::uint64_t log_digits = std::uint64_t{math_functions::log2_floor(digits | 1U)} + 1;
+    const std::uint64_t work = std::uint64_t{digits} * log_digits;
+    return static_cast<std::uint32_t>(std::max(std::uint64_t{1}, std::min(std::uint64_t{1} << 20U,
+                                                                           kWorkPerMeasurement / work)));
+}
+
+/// @brief Calls @a operation once to warm up the caches and tables and then @a iterations times
+template <class Operation>
+Measurement measure_tier_operation(const char* const operation_name,
+                                   const std::uint32_t lhs_digits,
+                                   const std::uint32_t rhs_digits,
+                                   const std::uint32_t result_digits,
+                                   const std::uint32_t iterations,
+                                   Operation&& operation) {
+    operation();
+    const AllocationCounts counts_before = current_allocation_counts();
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (std::uint32_t i = 0; i < iterations; i++) {
+        operation();
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    const AllocationCounts counts_after = current_allocation_counts();
+
+    const auto total_ns = static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count());
+    const auto iterations_f = static_cast<double>(iterations);
+    return Measurement{
+        operation_name,
+        lhs_digits,
+        rhs_digits,
+        result_digits,
+        iterations,
+        total_ns / iterations,
+        static_cast<double>(total_ns) / iterations_f / static_cast<double>(std::max(result_digits, 1U)),
+        static_cast<double>(counts_after.allocations - counts_before.allocations) / iterations_f,
+        static_cast<double>(counts_after.heap_allocations - counts_before.heap_allocations) / iterations_f,
+        static_cast<double>(counts_after.heap_bytes - counts_before.heap_bytes) / iterations_f,
+    };
+}
+
+void measure_tier_size(std::mt19937& rnd, const std::uint32_t m, std::vector<Measurement>& results) {
+    const longint lhs = make_random_longint(rnd, m);
+    const longint rhs = make_random_longint(rnd, m);
+    const std::uint32_t iterations = tier_iterations_for(m);
+
+    longint res;
+    results.push_back(measure_tier_operation("mult", m, m, 2 * m, iterations, [&]() {
+        res = lhs;
+        res *= rhs;
+        config::do_not_optimize_away(res[0]);
+    }));
+    results.push_back(measure_tier_operation("square", m, m, 2 * m, iterations, [&]() {
+        res = lhs;
+        res.square_inplace();
+        config::do_not_optimize_away(res[0]);
+    }));
+
+    // 2m / m digits division: both quotient and remainder have m digits
+    longint dividend = lhs;
+    dividend *= rhs;
+    longint quotient;
+    longint remainder;
+    results.push_back(measure_tier_operation("divmod", 2 * m, m, 2 * m, std::max(iterations / 4, 1U), [&]() {
+        quotient = dividend;
+        quotient.divmod(rhs, remainder);
+        config::do_not_optimize_away(remainder[0]);
+    }));
+
+    std::string str;
+    results.push_back(measure_tier_operation("to_string", m, 0, m, std::max(iterations / 8, 1U), [&]() {
+        lhs.to_string(str);
+        config::do_not_optimize_away(str[0]);
+    }));
+    results.push_back(measure_tier_operation("set_string", static_cast<std::uint32_t>(str.size()), 0, m,
+                                             std::max(iterations / 8, 1U), [&]() {
+                                                 res.set_string(str);
+                                                 config::do_not_optimize_away(res[0]);
+                                             }));
+
+    // Shifts by the whole digits and by the bits inside the digit
+    constexpr std::uint32_t kShift = 32 * 3 + 13;
+    results.push_back(measure_tier_operation("shift_left", m, 0, m + 4, iterations * 4, [&]() {
+        res = lhs;
+        res <<= kShift;
+        config::do_not_optimize_away(res[0]);
+    }));
+    results.push_back(measure_tier_operation("shift_right", m, 0, m, iterations * 4, [&]() {
+        res = lhs;
+        res >>= kShift;
+        config::do_not_optimize_away(res[0]);
+    }));
+}
+
+void print_tiers_csv(const std::vector<Measurement>& results) {
+    std::printf(
+        "operation,lhs_digits,rhs_digits,result_digits,iterations,ns_per_operation,ns_per_digit,"
+        "allocations_per_operation,heap_allocations_per_operation,heap_bytes_per_operation\n");
+    for (const Measurement& res : results) {
+        std::printf("%s,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu64 ",%.4f,%.2f,%.2f,%.1f\n",
+                    res.operation, res.lhs_digits, res.rhs_digits, res.result_digits, res.iterations,
+                    res.ns_per_operation, res.ns_per_digit, res.allocations_per_operation,
+                    res.heap_allocations_per_operation, res.heap_bytes_per_operation);
+    }
+}
+
+void print_tiers_json(const std::vector<Measurement>& results) {
+    std::printf("{\n  \"allocations_tracked\": %s,\n  \"measurements\": [\n",
+                kAllocationsTracked ? "true" : "false");
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const Measurement& res = results[i];
+        std::printf("    {\"operation\": \"%s\", \"lhs_digits\": %" PRIu32 ", \"rhs_digits\": %" PRIu32
+                    ", \"result_digits\": %" PRIu32 ", \"iterations\": %" PRIu32 ", \"ns_per_operation\": %" PRIu64
+                    ", \"ns_per_digit\": %.4f, \"allocations_per_operation\": %.2f"
+                    ", \"heap_allocations_per_operation\": %.2f, \"heap_bytes_per_operation\": %.1f}%s\n",
+                    res.operation, res.lhs_digits, res.rhs_digits, res.result_digits, res.iterations,
+                    res.ns_per_operation, res.ns_per_digit, res.allocations_per_operation,
+                    res.heap_allocations_per_operation, res.heap_bytes_per_operation,
+                    i + 1 < results.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+}
+
+/**
+ * Sizes around the naive / Karatsuba / Toom-3 / FFT multiplication crossover points,
+ * the Burnikel-Ziegler / Newton division and the divide and conquer to_string thresholds,
+ * and below and above the longint::kFFTPrecisionBorder (FFT with the higher precision and the NTT)
+ */
+constexpr std::uint32_t kTierSizes[] = {
+    4,    8,     16,    32,    47,    48,     64,     128,    191,    192,    255,
+    256,  512,   1024,  2048,  4096,  8192,   16384,  65536,  131072, 262144, 524288,
+};
+
+void print_report(std::mt19937& rnd) {
+    std::printf("balanced multiplication, square (nanoseconds per operation)\n");
+    for (const std::uint32_t m : kSizes) {
+        const std::uint64_t mult_ns = measure_mult_ns(rnd, m, m);
+        const std::uint64_t square_ns = measure_square_ns(rnd, m);
+        std::printf("%5" PRIu32 " x %5" PRIu32 ": %10" PRIu64 " ns, square: %10" PRIu64 " ns\n", m, m, mult_ns,
+                    square_ns);
+    }
+
+    std::printf("unbalanced multiplication (nanoseconds per operation)\n");
+    for (const std::uint32_t m : kSizes) {
+        for (const std::uint32_t ratio : {2U, 3U, 8U}) {
+            const std::uint32_t k = m * ratio;
+            std::printf("%5" PRIu32 " x %5" PRIu32 ": %10" PRIu64 " ns\n", m, k, measure_mult_ns(rnd, m, k));
+        }
+    }
+
+    std::printf("complex FFT vs NTT (nanoseconds per operation)\n");
+    for (const std::uint32_t m : kBigSizes) {
+        const std::uint64_t fft_ns = measure_mult_ns<longint::FFTMultPolicy>(rnd, m, m);
+        const std::uint64_t ntt_ns = measure_mult_ns<longint::NTTMultPolicy>(rnd, m, m);
+        std::printf("%7" PRIu32 " x %7" PRIu32 ": fft: %12" PRIu64 " ns, ntt: %12" PRIu64 " ns\n", m, m, fft_ns,
+                    ntt_ns);
+    }
+
+    std::printf("small values (nanoseconds per 2 constructions, 2 copies, 3 arithmetic operations): %" PRIu64 " ns\n",
+                measure_small_values_ns(rnd));
+
+    std::printf("dot product of 64 pairs, operators vs addmul (nanoseconds per dot product)\n");
+    for (const std::uint32_t m : {1U, 2U, 4U, 8U, 16U, 32U, 64U, 256U, 1024U}) {
+        const auto [operators_ns, addmul_ns] = measure_dot_product_ns(rnd, m, 64);
+        std::printf("%5" PRIu32 ": %10" PRIu64 " ns, addmul: %10" PRIu64 " ns\n", m, operators_ns, addmul_ns);
+    }
+
+    std::printf("division, division with the precomputed reciprocal (nanoseconds per operation)\n");
+    for (const std::uint32_t n : kDivSizes) {
+        for (const std::uint32_t ratio : {2U, 8U}) {
+            const std::uint32_t m = n * ratio;
+            const std::uint64_t div_ns = measure_divmod_ns(rnd, m, n);
+            const std::uint64_t reciprocal_div_ns = measure_reciprocal_divmod_ns(rnd, m, n);
+            std::printf("%6" PRIu32 " / %5" PRIu32 ": %12" PRIu64 " ns, reciprocal: %12" PRIu64 " ns\n", m, n,
+                        div_ns, reciprocal_div_ns);
+        }
+    }
+
+    std::printf("to_string (nanoseconds per operation)\n");
+    for (const std::uint32_t m : kDivSizes) {
+        std::printf("%6" PRIu32 ": %12" PRIu64 " ns\n", m, measure_to_string_ns(rnd, m));
+    }
+
+    // Numbers with less than longint::kDecimalToStringThreshold digits (~2.5 * 10^6 decimal digits)
+    //  are converted by the divide and conquer, bigger ones by the Decimal
+    std::printf("to_string, set_string of the big numbers (nanoseconds per operation)\n");
+    for (const std::uint32_t length : {1'000'000U, 2'000'000U, 4'000'000U}) {
+        const auto [to_string_ns, set_string_ns] = measure_dec_string_ns(rnd, length);
+        std::printf("%8" PRIu32 ": %14" PRIu64 " ns, set_string: %14" PRIu64 " ns\n", length, to_string_ns,
+                    set_string_ns);
+    }
+
+    std::printf("gcd, extended gcd (nanoseconds per operation)\n");
+    for (const std::uint32_t m : kDivSizes) {
+        const std::uint64_t gcd_ns = measure_gcd_ns(rnd, m, /* extended = */ false);
+        const std::uint64_t extended_gcd_ns = measure_gcd_ns(rnd, m, /* extended = */ true);
+        std::printf("%6" PRIu32 ": %12" PRIu64 " ns, extended: %12" PRIu64 " ns\n", m, gcd_ns, extended_gcd_ns);
+    }
+
+    std::printf("pow_mod with the Montgomery context, with the division (nanoseconds per operation)\n");
+    for (const std::uint32_t m : {8U, 16U, 32U, 64U, 96U, 128U, 192U, 256U, 512U}) {
+        const auto [montgomery_ns, division_ns] = measure_pow_mod_ns(rnd, m);
+        std::printf("%5" PRIu32 ": %14" PRIu64 " ns, division: %14" PRIu64 " ns\n", m, montgomery_ns, division_ns);
+    }
+
+    std::printf("isqrt (nanoseconds per operation)\n");
+    for (const std::uint32_t m : kDivSizes) {
+        std::printf("%6" PRIu32 ": %12" PRIu64 " ns\n", m, measure_isqrt_ns(rnd, m));
+    }
+
+    std::printf("factorial, factorial with 4 threads (nanoseconds per operation)\n");
+    for (const std::uint32_t n : {1'000U, 10'000U, 100'000U, 1'000'000U}) {
+        const std::uint64_t one_thread_ns = measure_factorial_ns(n, 1);
+        const std::uint64_t four_threads_ns = measure_factorial_ns(n, 4);
+        std::printf("%8" PRIu32 "!: %14" PRIu64 " ns, 4 threads: %14" PRIu64 " ns\n", n, one_thread_ns,
+                    four_threads_ns);
+    }
+
+    std::printf("add, sub, shift left, shift right: default / CPU-specific kernels (nanoseconds per digit)\n");
+    for (const std::uint32_t n : {1'024U, 16'384U, 131'072U, 1'048'576U}) {
+        const auto default_ns = measure_carry_kernels_ns(rnd, longint_detail::carry_kernels::default_kernels(), n);
+        const auto selected_ns = measure_carry_kernels_ns(rnd, longint_detail::carry_kernels::kernels(), n);
+        std::printf("%8" PRIu32 ": add %.3f / %.3f, sub %.3f / %.3f, shl %.3f / %.3f, shr %.3f / %.3f\n", n,
+                    default_ns[0], selected_ns[0], default_ns[1], selected_ns[1], default_ns[2], selected_ns[2],
+                    default_ns[3], selected_ns[3]);
+    }
+
+    std::printf("set_string, set_string with 4 threads (nanoseconds per operation)\n");
+    for (const std::uint32_t length : {1'000U, 10'000U, 100'000U, 1'000'000U, 4'000'000U}) {
+        const std::uint64_t one_thread_ns = measure_set_string_ns(rnd, length, 1);
+        const std::uint64_t four_threads_ns = measure_set_string_ns(rnd, length, 4);
+        std::printf("%8" PRIu32 ": %14" PRIu64 " ns, 4 threads: %14" PRIu64 " ns\n", length, one_thread_ns,
+                    four_threads_ns);
+    }
+}
+
+void print_tiers(std::mt19937& rnd, const std::uint32_t max_digits, const bool json) {
+    std::vector<Measurement> results;
+    for (const std::uint32_t m : kTierSizes) {
+        if (m <= max_digits) {
+            measure_tier_size(rnd, m, results);
+        }
+    }
+
+    if (json) {
+        print_tiers_json(results);
+    } else {
+        print_tiers_csv(results);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    bool tiers = false;
+    bool json = false;
+    std::uint32_t max_digits = kTierSizes[std::size(kTierSizes) - 1];
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            tiers = true;
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            tiers = true;
+            json = true;
+        } else if (std::strncmp(argv[i], "--max-digits=", std::strlen("--max-digits=")) == 0) {
+            max_digits = static_cast<std::uint32_t>(std::strtoul(argv[i] + std::strlen("--max-digits="), nullptr, 10));
+        } else {
+            std::fprintf(stderr, "Usage: %s [--csv | --json] [--max-digits=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 rnd{42};
+    if (tiers) {
+        print_tiers(rnd, max_digits, json);
+    } else {
+        print_report(rnd);
+    }
+}
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../misc/do_not_optimize_away.h"
+#include "integers_128_bit.hpp"
+#include "is_prime.hpp"
+#include "math_functions.hpp"
+#include "pollard_rho.hpp"
+
+/**
+ * Prints the throughput (factorizations per second) of the math_functions::visit_prime_factors_rho
+ * on the random 64-bit numbers and the semiprimes with the factors of the given sizes, and
+ * of the trial division in the math_functions::visit_prime_factors on the same 48-bit semiprimes.
+ */
+
+namespace {
+
+template <class T>
+using Numbers = std::vector<T>;
+
+std::mt19937_64 rnd{std::mt19937_64::default_seed};
+
+std::uint64_t random_prime(const std::uint32_t bits) {
+    while (true) {
+        const std::uint64_t p = (rnd() >> (64U - bits)) | (std::uint64_t{1} << (bits - 1)) | 1U;
+        if (math_functions::is_prime_bpsw(p)) {
+            return p;
+        }
+    }
+}
+
+template <class T>
+Numbers<T> semiprimes(const std::size_t count, const std::uint32_t p_bits, const std::uint32_t q_bits) {
+    Numbers<T> numbers(count);
+    for (T& n : numbers) {
+        n = static_cast<T>(T{random_prime(p_bits)} * random_prime(q_bits));
+    }
+    return numbers;
+}
+
+template <class T, class Function>
+void measure(const char* const name, const Numbers<T>& numbers, Function&& factorize) {
+    std::uint64_t factors_sum = 0;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (const T n : numbers) {
+        factorize(n, [&factors_sum](const math_functions::PrimeFactor<T> pf) {
+            factors_sum += pf.factor_power;
+        });
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    config::do_not_optimize_away(factors_sum);
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%-44s %8zu numbers %10.3f s %14.1f factorizations/s\n", name, numbers.size(), seconds,
+                static_cast<double>(numbers.size()) / seconds);
+    std::fflush(stdout);
+}
+
+constexpr auto kRho = [](const auto n, auto visitor) { math_functions::visit_prime_factors_rho(n, visitor); };
+constexpr auto kTrialDivision = [](const auto n, auto visitor) { math_functions::visit_prime_factors(n, visitor); };
+
+}  // namespace
+
+int main() {
+    Numbers<std::uint64_t> random_numbers(200'000);
+    for (std::uint64_t& n : random_numbers) {
+        n = rnd();
+    }
+    measure("rho, random u64", random_numbers, kRho);
+
+    const auto semiprimes_24_24 = semiprimes<std::uint64_t>(200, 24, 24);
+    measure("rho, u64 semiprimes 24 x 24 bits", semiprimes_24_24, kRho);
+    measure("trial division, u64 semiprimes 24 x 24 bits", semiprimes_24_24, kTrialDivision);
+
+    measure("rho, u64 semiprimes 32 x 32 bits", semiprimes<std::uint64_t>(5'000, 32, 32), kRho);
+    measure("rho, u128 semiprimes 32 x 64 bits", semiprimes<uint128_t>(1'000, 32, 64), kRho);
+    measure("rho, u128 semiprimes 40 x 40 bits", semiprimes<uint128_t>(100, 40, 40), kRho);
+    measure("rho, u128 semiprimes 48 x 48 bits", semiprimes<uint128_t>(10, 48, 48), kRho);
+}
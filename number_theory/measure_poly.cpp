@@ -0,0 +1,149 @@
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../misc/do_not_optimize_away.h"
+#include "poly.hpp"
+
+/**
+ * Measures the operations of the poly::PolynomialRing998244353 for the degrees 10^3 ... 10^6
+ * and prints one row per (operation, degree) in the CSV format.
+ *
+ * The composition takes O(sqrt(n) * n log n + n^2) operations and is measured only for the
+ * degrees up to kMaxComposeDegree.
+ */
+
+namespace {
+
+using Ring = poly::PolynomialRing998244353;
+using poly_t = Ring::poly_t;
+
+constexpr std::size_t kMaxComposeDegree = 10000;
+
+poly_t make_random_poly(std::mt19937& rnd, const std::size_t size) {
+    poly_t a(size);
+    for (std::uint32_t& coeff : a) {
+        coeff = static_cast<std::uint32_t>(rnd() % Ring::kMod);
+    }
+    return a;
+}
+
+/// @brief Calls @a operation until at least kMinMeasurementTime passes and returns the time of one call
+template <class Operation>
+std::uint64_t measure_ns(Operation&& operation) {
+    constexpr std::chrono::milliseconds kMinMeasurementTime{200};
+
+    std::uint64_t iterations = 0;
+    const auto start = std::chrono::high_resolution_clock::now();
+    auto end = start;
+    do {
+        operation();
+        iterations++;
+        end = std::chrono::high_resolution_clock::now();
+    } while (end - start < kMinMeasurementTime);
+    return static_cast<std::uint64_t>(std::chrono::nanoseconds{end - start}.count()) / iterations;
+}
+
+template <class Operation>
+void measure_and_print(const char* const operation_name, const std::size_t degree, Operation&& operation) {
+    const std::uint64_t ns = measure_ns(operation);
+    std::printf("%s,%zu,%" PRIu64 ",%.2f\n", operation_name, degree, ns,
+                static_cast<double>(ns) / static_cast<double>(degree + 1));
+    std::fflush(stdout);
+}
+
+void measure_degree(std::mt19937& rnd, const std::size_t degree) {
+    const std::size_t n = degree + 1;
+    const poly_t a = make_random_poly(rnd, n);
+    const poly_t b = make_random_poly(rnd, n);
+
+    measure_and_print("multiply", degree, [&]() {
+        const poly_t c = Ring::multiply(a, b);
+        config::do_not_optimize_away(c[0]);
+    });
+
+    poly_t invertible = a;
+    invertible[0] |= 1U;
+    measure_and_print("inverse", degree, [&]() {
+        const poly_t c = Ring::inverse(invertible, n);
+        config::do_not_optimize_away(c[0]);
+    });
+
+    // 2n / n division: both quotient and remainder have about n coefficients
+    poly_t dividend = Ring::multiply(a, b);
+    dividend.back() |= 1U;
+    poly_t divisor = b;
+    divisor.back() |= 1U;
+    measure_and_print("divmod", degree, [&]() {
+        const auto [q, r] = Ring::divmod(dividend, divisor);
+        config::do_not_optimize_away(q[0]);
+        config::do_not_optimize_away(r.size());
+    });
+
+    poly_t log_arg = a;
+    log_arg[0] = 1;
+    measure_and_print("log", degree, [&]() {
+        const poly_t c = Ring::log(log_arg, n);
+        config::do_not_optimize_away(c[0]);
+    });
+
+    poly_t exp_arg = a;
+    exp_arg[0] = 0;
+    measure_and_print("exp", degree, [&]() {
+        const poly_t c = Ring::exp(exp_arg, n);
+        config::do_not_optimize_away(c[0]);
+    });
+
+    // Distinct points
+    poly_t points(n);
+    for (std::size_t i = 0; i < n; i++) {
+        points[i] = static_cast<std::uint32_t>(i * 3 + rnd() % 3);
+    }
+    measure_and_print("evaluate", degree, [&]() {
+        const poly_t values = Ring::evaluate(a, points);
+        config::do_not_optimize_away(values[0]);
+    });
+
+    const poly_t values = Ring::evaluate(a, points);
+    measure_and_print("interpolate", degree, [&]() {
+        const poly_t c = Ring::interpolate(points, values);
+        config::do_not_optimize_away(c.size());
+    });
+
+    if (degree <= kMaxComposeDegree) {
+        measure_and_print("compose", degree, [&]() {
+            const poly_t c = Ring::compose(a, b, n);
+            config::do_not_optimize_away(c[0]);
+        });
+    }
+}
+
+constexpr std::size_t kDegrees[] = {1000, 10000, 100000, 1000000};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t max_degree = kDegrees[std::size(kDegrees) - 1];
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--max-degree=", std::strlen("--max-degree=")) == 0) {
+            max_degree = static_cast<std::size_t>(std::strtoull(argv[i] + std::strlen("--max-degree="), nullptr, 10));
+        } else {
+            std::fprintf(stderr, "Usage: %s [--max-degree=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 rnd{42};
+    std::printf("operation,degree,ns_per_operation,ns_per_coefficient\n");
+    for (const std::size_t degree : kDegrees) {
+        if (degree <= max_degree) {
+            measure_degree(rnd, degree);
+        }
+    }
+}
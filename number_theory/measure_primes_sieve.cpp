@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "math_functions.hpp"
+#include "segmented_sieve.hpp"
+
+/**
+ * Compares the time of counting primes up to n by the math_functions::count_primes
+ * (segmented sieve, 1 and all hardware threads) with the math_functions::dynamic_primes_sieve
+ * and math_functions::fixed_primes_sieve (they take uint32_t bound, so only n = 10^9 is measured).
+ */
+
+namespace {
+
+template <class Function>
+void measure(const char* const name, const std::uint64_t n, Function&& count_primes) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    const std::uint64_t count = count_primes();
+    const auto end = std::chrono::high_resolution_clock::now();
+    const auto ms =
+        static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    std::printf("%-34s n = %-12" PRIu64 " pi(n) = %-12" PRIu64 " %8" PRIu64 " ms\n", name, n, count, ms);
+    std::fflush(stdout);
+}
+
+constexpr std::uint32_t kFixedSieveN = 1'000'000'000;
+
+}  // namespace
+
+int main() {
+    const std::size_t hardware_threads = std::max(std::size_t{std::thread::hardware_concurrency()}, std::size_t{1});
+
+    measure("dynamic_primes_sieve", kFixedSieveN, []() {
+        const std::vector<bool> is_prime = math_functions::dynamic_primes_sieve(kFixedSieveN);
+        std::uint64_t count = 0;
+        for (const bool flag : is_prime) {
+            count += flag;
+        }
+        return count;
+    });
+    measure("fixed_primes_sieve", kFixedSieveN, []() {
+        return std::uint64_t{math_functions::fixed_primes_sieve<kFixedSieveN>().count()};
+    });
+
+    for (const std::uint64_t n : {std::uint64_t{1'000'000'000}, std::uint64_t{4'000'000'000},
+                                  std::uint64_t{10'000'000'000}}) {
+        measure("count_primes, 1 thread", n, [n]() { return math_functions::count_primes(0, n); });
+        if (hardware_threads > 1) {
+            measure("count_primes, all threads", n,
+                    [n, hardware_threads]() { return math_functions::count_primes(0, n, hardware_threads); });
+        }
+    }
+
+    // Sieving primes up to 2^32 are generated for the window instead of being stored
+    constexpr std::uint64_t kMax = static_cast<std::uint64_t>(-1);
+    measure("count_primes [2^64 - 10^9, 2^64)", kMax, [hardware_threads]() {
+        return math_functions::count_primes(kMax - 1'000'000'000 + 1, kMax, hardware_threads);
+    });
+}
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../misc/assert.hpp"
+#include "../misc/config_macros.hpp"
+#include "../misc/thread_pool.hpp"
+
+namespace ntt {
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+/// @brief Max size of the product that can be computed by the
+///         multiply_base_2_32(), equals to the max length of the NTT
+///         supported by all of the three primes used
+inline constexpr size_t kMaxProductSize = size_t{1} << 23U;
+
+/// @brief Products with the NTT length less than kMinParallelTransformSize are always computed in one thread
+inline constexpr size_t kMinParallelTransformSize = size_t{1} << 16U;
+
+/// @brief Computes a[0..a_size) * b[0..b_size) where a and b are
+///         numbers in base 2^32 (little endian) and stores the product
+///         to the result[0..a_size + b_size)
+/// @note  Product is exact: convolution is computed modulo three NTT-friendly
+///         primes (using Montgomery arithmetic) and the coefficients are
+///         restored by the CRT. a and b may point to the same array
+///         (in this case only two NTTs are computed per prime).
+///         If @a max_threads > 1 and the NTT length is at least kMinParallelTransformSize,
+///         convolutions modulo the three primes are computed by at most
+///         min(@a max_threads, 3) threads of the misc::thread_pool (including the calling one)
+/// @throws std::runtime_error if a_size == 0 or b_size == 0 or
+///         a_size + b_size > kMaxProductSize
+///         std::bad_alloc if allocation of the buffers failed
+ATTRIBUTE_SIZED_ACCESS(read_only, 1, 2)
+ATTRIBUTE_SIZED_ACCESS(read_only, 3, 4)
+ATTRIBUTE_ACCESS(write_only, 5)
+ATTRIBUTE_NONNULL_ALL_ARGS
+inline void multiply_base_2_32(const uint32_t a[],
+                               size_t a_size,
+                               const uint32_t b[],
+                               size_t b_size,
+                               uint32_t result[],
+                               size_t max_threads = 1);
+
+/// @brief Computes the roots of unity used by the multiply_base_2_32() for the
+///         products of at most @a max_product_size digits, so that the first big
+///         multiplication does not pay for them (e.g. call it once at the program startup)
+/// @note Tables are grown lazily by the multiply_base_2_32() anyway, this function is
+///        thread-safe like it
+/// @throws std::runtime_error if max_product_size > kMaxProductSize
+///         std::bad_alloc if allocation of the tables failed
+inline void precompute_tables(size_t max_product_size);
+
+namespace detail {
+
+/// @brief Arithmetic modulo odd prime Mod < 2^30 in the Montgomery form with R = 2^32
+template <uint32_t Mod, uint32_t PrimitiveRoot>
+struct MontgomeryField final {
+    static_assert(Mod % 2 == 1 && Mod < (uint32_t{1} << 30U), "4 * Mod should fit in uint32_t");
+
+    static constexpr uint32_t kMod = Mod;
+    static constexpr uint32_t kPrimitiveRoot = PrimitiveRoot;
+
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr uint32_t compute_mod_inverse_negated() noexcept {
+        // Newton's iteration, each step doubles number of the correct low bits
+        uint32_t inv = Mod;
+        for (int i = 0; i < 5; i++) {
+            inv *= 2 - Mod * inv;
+        }
+        return -inv;
+    }
+
+    /// @brief -Mod^{-1} mod 2^32
+    static constexpr uint32_t kModInverseNegated = compute_mod_inverse_negated();
+    static_assert(static_cast<uint32_t>(kModInverseNegated * Mod) == static_cast<uint32_t>(-1));
+    /// @brief R^2 mod Mod = 2^64 mod Mod
+    static constexpr uint32_t kR2 = static_cast<uint32_t>((static_cast<uint64_t>(-1) % Mod + 1) % Mod);
+
+    /// @brief Returns t * R^{-1} mod Mod
+    /// @note t < Mod * 2^32
+    [[nodiscard]] ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST static constexpr uint32_t reduce(const uint64_t t) noexcept {
+        const uint32_t m = static_cast<uint32_t>(t) * kModInverseNegated;
+        const uint32_t u = static_cast<uint32_t>((t + uint64_t{m} * Mod) >> 32U);
+        return u >= Mod ? u - Mod : u;
+    }
+
+    /// @brief Returns a * b * R^{-1} mod Mod
+    [[nodiscard]] ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST static constexpr uint32_t mul(const uint32_t a,
+                                                                                         const uint32_t b) noexcept {
+        return reduce(uint64_t{a} * b);
+    }
+
+    [[nodiscard]] ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST static constexpr uint32_t add(const uint32_t a,
+                                                                                         const uint32_t b) noexcept {
+        const uint32_t sum = a + b;
+        return sum >= Mod ? sum - Mod : sum;
+    }
+
+    [[nodiscard]] ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST static constexpr uint32_t sub(const uint32_t a,
+                                                                                         const uint32_t b) noexcept {
+        return a >= b ? a - b : a + Mod - b;
+    }
+
+    /// @brief Returns x * R mod Mod
+    /// @note x may be any 32-bit number (not only x < Mod)
+    [[nodiscard]] ATTRIBUTE_ALWAYS_INLINE ATTRIBUTE_CONST static constexpr uint32_t to_montgomery(
+        const uint32_t x) noexcept {
+        return reduce(uint64_t{x} * kR2);
+    }
+
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr uint32_t pow_mod(uint64_t x, uint64_t p) noexcept {
+        uint64_t res = 1;
+        x %= Mod;
+        for (; p > 0; p >>= 1U) {
+            if (p & 1U) {
+                res = res * x % Mod;
+            }
+            x = x * x % Mod;
+        }
+        return static_cast<uint32_t>(res);
+    }
+
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr size_t compute_max_transform_size() noexcept {
+        size_t n = 1;
+        while ((Mod - 1) % (2 * n) == 0) {
+            n *= 2;
+        }
+        return n;
+    }
+
+    /// @brief Max n = 2^k such that n | (Mod - 1)
+    static constexpr size_t kMaxTransformSize = compute_max_transform_size();
+    static_assert(kMaxTransformSize >= kMaxProductSize);
+};
+
+template <class Field>
+struct transform_impl final {
+    static constexpr uint32_t kMod = Field::kMod;
+
+    /// @brief Max number of the roots tiers, tier t holds the roots for len = 2^t
+    static constexpr size_t kMaxRootsTiers = sizeof(size_t) * 8;
+
+    /*
+     * roots_tiers[t][j] = w_{2 len}^j and inv_roots_tiers[t][j] = w_{2 len}^{-j}
+     * (in the Montgomery form) for len = 2^t and 0 <= j < len,
+     * where w_{2 len} is a primitive root of unity of degree 2 len.
+     *
+     * Tiers are never changed or freed after being published, so the transforms read them
+     * without locking, only the growth (see ensure_roots_capacity()) is done under the mutex.
+     */
+    static inline std::atomic<const uint32_t*> roots_tiers[kMaxRootsTiers]{};
+    static inline std::atomic<const uint32_t*> inv_roots_tiers[kMaxRootsTiers]{};
+    /// @brief Roots are computed for all transforms of size at most roots_capacity
+    static inline std::atomic<size_t> roots_capacity{1};
+    static inline std::unique_ptr<uint32_t[]> roots_tiers_storage[kMaxRootsTiers]{};
+    static inline std::unique_ptr<uint32_t[]> inv_roots_tiers_storage[kMaxRootsTiers]{};
+    static inline std::mutex roots_mutex{};
+
+    ATTRIBUTE_CONST [[nodiscard]] static constexpr uint32_t tier_index(const size_t len) noexcept {
+        uint32_t log2_len = 0;
+        while ((size_t{1} << log2_len) < len) {
+            log2_len++;
+        }
+        return log2_len;
+    }
+
+    /// @brief Makes roots for all len < n available
+    static void ensure_roots_capacity(const size_t n) {
+        assert(n > 0 && (n & (n - 1)) == 0);
+        if (likely(roots_capacity.load(std::memory_order_acquire) >= n)) {
+            return;
+        }
+
+        const std::lock_guard lock{roots_mutex};
+        size_t current_len = roots_capacity.load(std::memory_order_relaxed);
+        for (; current_len < n; current_len *= 2) {
+            add_roots_tier(current_len);
+            roots_capacity.store(current_len * 2, std::memory_order_release);
+        }
+    }
+
+    /// @brief Computes the tiers with w_{2 len}^{+-j}, j = 0, 1, ..., len - 1
+    static void add_roots_tier(const size_t len) {
+        CONFIG_ASSUME_STATEMENT(len > 0);
+        // w is a primitive root of unity of degree 2 * len
+        const uint32_t w = Field::pow_mod(Field::kPrimitiveRoot, (kMod - 1) / (2 * len));
+        const uint32_t w_inv = Field::pow_mod(w, kMod - 2);
+        const uint32_t w_mont = Field::to_montgomery(w);
+        const uint32_t w_inv_mont = Field::to_montgomery(w_inv);
+        std::unique_ptr<uint32_t[]> tier = std::make_unique<uint32_t[]>(len);
+        std::unique_ptr<uint32_t[]> inv_tier = std::make_unique<uint32_t[]>(len);
+        tier[0] = Field::to_montgomery(1);
+        inv_tier[0] = Field::to_montgomery(1);
+        for (size_t j = 1; j < len; j++) {
+            tier[j] = Field::mul(tier[j - 1], w_mont);
+            inv_tier[j] = Field::mul(inv_tier[j - 1], w_inv_mont);
+        }
+
+        const uint32_t index = tier_index(len);
+        roots_tiers[index].store(tier.get(), std::memory_order_release);
+        inv_roots_tiers[index].store(inv_tier.get(), std::memory_order_release);
+        roots_tiers_storage[index] = std::move(tier);
+        inv_roots_tiers_storage[index] = std::move(inv_tier);
+    }
+
+    /// @brief Decimation in frequency NTT: natural order -> bit reversed order
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+    ATTRIBUTE_NONNULL(1)
+    static void forward(uint32_t* const p, const size_t n) noexcept {
+        for (size_t len = n / 2; len >= 1; len /= 2) {
+            const uint32_t* const points = roots_tiers[tier_index(len)].load(std::memory_order_acquire);
+            for (size_t block_start = 0; block_start < n; block_start += 2 * len) {
+                uint32_t* const lo = p + block_start;
+                uint32_t* const hi = lo + len;
+                for (size_t j = 0; j < len; j++) {
+                    const uint32_t u = lo[j];
+                    const uint32_t v = hi[j];
+                    lo[j] = Field::add(u, v);
+                    hi[j] = Field::mul(Field::sub(u, v), points[j]);
+                }
+            }
+        }
+    }
+
+    /// @brief Decimation in time inverse NTT: bit reversed order -> natural order
+    /// @note Result is not divided by n
+    ATTRIBUTE_SIZED_ACCESS(read_write, 1, 2)
+    ATTRIBUTE_NONNULL(1)
+    static void backward(uint32_t* const p, const size_t n) noexcept {
+        for (size_t len = 1; len < n; len *= 2) {
+            const uint32_t* const points = inv_roots_tiers[tier_index(len)].load(std::memory_order_acquire);
+            for (size_t block_start = 0; block_start < n; block_start += 2 * len) {
+                uint32_t* const lo = p + block_start;
+                uint32_t* const hi = lo + len;
+                for (size_t j = 0; j < len; j++) {
+                    const uint32_t u = lo[j];
+                    const uint32_t v = Field::mul(hi[j], points[j]);
+                    lo[j] = Field::add(u, v);
+                    hi[j] = Field::sub(u, v);
+                }
+            }
+        }
+    }
+
+    /// @brief Computes cyclic convolution of a[0..a_size) and b[0..b_size)
+    ///         of length n modulo kMod and stores it to the out[0..n)
+    /// @note b may be nullptr, then a is squared. buffer should have at least n elements
+    static void convolution(const uint32_t a[],
+                            const size_t a_size,
+                            const uint32_t* const b,
+                            const size_t b_size,
+                            uint32_t* const RESTRICT_QUALIFIER out,
+                            uint32_t* const RESTRICT_QUALIFIER buffer,
+                            const size_t n) {
+        ensure_roots_capacity(n);
+
+        // Digits are not converted to the Montgomery form because
+        //  mul(x, w * R) == x * w. The extra R^{-1} of the pointwise
+        //  product is compensated while dividing by n
+        const auto load = [n](const uint32_t src[], const size_t src_size, uint32_t* const dst) noexcept {
+            for (size_t i = 0; i < src_size; i++) {
+                dst[i] = src[i] % kMod;
+            }
+            std::fill(dst + src_size, dst + n, uint32_t{0});
+        };
+
+        load(a, a_size, out);
+        forward(out, n);
+        if (b == nullptr) {
+            for (size_t i = 0; i < n; i++) {
+                out[i] = Field::mul(out[i], out[i]);
+            }
+        } else {
+            load(b, b_size, buffer);
+            forward(buffer, n);
+            for (size_t i = 0; i < n; i++) {
+                out[i] = Field::mul(out[i], buffer[i]);
+            }
+        }
+        backward(out, n);
+
+        // out[i] = c_i * n * R^{-1}, so multiply by mul(., n^{-1} * R^2) = n^{-1} * R
+        const uint32_t n_inv = Field::pow_mod(n % kMod, kMod - 2);
+        const uint32_t scale = Field::to_montgomery(Field::to_montgomery(n_inv));
+        for (size_t i = 0; i < n; i++) {
+            out[i] = Field::mul(out[i], scale);
+        }
+    }
+};
+
+// 7 * 2^26 + 1, 5 * 2^25 + 1, 119 * 2^23 + 1, 3 is a primitive root modulo each of them
+using Field1 = MontgomeryField<469762049, 3>;
+using Field2 = MontgomeryField<167772161, 3>;
+using Field3 = MontgomeryField<998244353, 3>;
+
+/*
+ * Every coefficient of the product of a and b is less than
+ *  min(a_size, b_size) * (2^32 - 1)^2 < 2^22 * 2^64 = 2^86 < Mod1 * Mod2 * Mod3 ~ 2^86.02
+ */
+static_assert(kMaxProductSize / 2 <= (size_t{1} << 22U));
+
+ATTRIBUTE_CONST [[nodiscard]] constexpr uint32_t mod_inverse(const uint64_t x, const uint32_t mod) noexcept {
+    // mod is prime
+    uint64_t res = 1;
+    uint64_t base = x % mod;
+    for (uint32_t p = mod - 2; p > 0; p >>= 1U) {
+        if (p & 1U) {
+            res = res * base % mod;
+        }
+        base = base * base % mod;
+    }
+    return static_cast<uint32_t>(res);
+}
+
+/// @brief Number of the primes the convolution is computed modulo
+inline constexpr size_t kPrimesCount = 3;
+
+inline constexpr uint32_t kMod1 = Field1::kMod;
+inline constexpr uint32_t kMod2 = Field2::kMod;
+inline constexpr uint32_t kMod3 = Field3::kMod;
+inline constexpr uint64_t kMod1Mod2 = uint64_t{kMod1} * kMod2;
+inline constexpr uint32_t kMod1Mod2Low = static_cast<uint32_t>(kMod1Mod2);
+inline constexpr uint32_t kMod1Mod2High = static_cast<uint32_t>(kMod1Mod2 >> 32U);
+inline constexpr uint32_t kMod1InverseModMod2 = mod_inverse(kMod1, kMod2);
+inline constexpr uint32_t kMod1Mod2InverseModMod3 = mod_inverse(kMod1Mod2, kMod3);
+
+/// @brief Smallest power of two not less than @a prod_size
+ATTRIBUTE_CONST [[nodiscard]] constexpr size_t transform_size(const size_t prod_size) noexcept {
+    size_t n = 1;
+    while (n < prod_size) {
+        n *= 2;
+    }
+    return n;
+}
+
+}  // namespace detail
+
+inline void multiply_base_2_32(const uint32_t a[],
+                               const size_t a_size,
+                               const uint32_t b[],
+                               const size_t b_size,
+                               uint32_t result[],
+                               const size_t max_threads) {
+    THROW_IF(a_size == 0 || b_size == 0);
+    const size_t prod_size = a_size + b_size;
+    THROW_IF(prod_size > kMaxProductSize);
+
+    const size_t n = detail::transform_size(prod_size);
+    const bool square = a == b && a_size == b_size;
+    using detail::kPrimesCount;
+    const size_t threads =
+        max_threads > 1 && n >= kMinParallelTransformSize ? std::min(max_threads, kPrimesCount) : 1;
+    // 3 results and a buffer for the transform of b per thread
+    std::vector<uint32_t> buffer((kPrimesCount + threads) * n);
+    uint32_t* const r1 = buffer.data();
+    uint32_t* const r2 = r1 + n;
+    uint32_t* const r3 = r2 + n;
+    const uint32_t* const b_or_null = square ? nullptr : b;
+    const auto convolutions = [=](const size_t thread_index) {
+        uint32_t* const tmp = r3 + n * (1 + thread_index);
+        for (size_t i = thread_index; i < kPrimesCount; i += threads) {
+            switch (i) {
+                case 0:
+                    detail::transform_impl<detail::Field1>::convolution(a, a_size, b_or_null, b_size, r1, tmp, n);
+                    break;
+                case 1:
+                    detail::transform_impl<detail::Field2>::convolution(a, a_size, b_or_null, b_size, r2, tmp, n);
+                    break;
+                default:
+                    detail::transform_impl<detail::Field3>::convolution(a, a_size, b_or_null, b_size, r3, tmp, n);
+                    break;
+            }
+        }
+    };
+    if (threads > 1) {
+        misc::thread_pool::instance().run(threads, convolutions);
+    } else {
+        convolutions(0);
+    }
+
+    /*
+     * Garner's algorithm:
+     *  c = x1 + Mod1 * t2 + Mod1 * Mod2 * t3, where
+     *  t2 = (x2 - x1) * Mod1^{-1} mod Mod2,
+     *  t3 = (x3 - x1 - Mod1 * t2) * (Mod1 * Mod2)^{-1} mod Mod3
+     * c is added to the carry without 128-bit arithmetic:
+     *  Mod1 * Mod2 * t3 = (Mod1Mod2High * 2^32 + Mod1Mod2Low) * t3
+     */
+    using detail::kMod1;
+    using detail::kMod2;
+    using detail::kMod3;
+    uint64_t carry = 0;
+    for (size_t i = 0; i < prod_size; i++) {
+        const uint64_t x1 = r1[i];
+        const uint64_t x2 = r2[i];
+        const uint64_t x3 = r3[i];
+        const uint64_t t2 = (x2 + kMod2 - x1 % kMod2) * detail::kMod1InverseModMod2 % kMod2;
+        const uint64_t x1_plus_mod1_t2 = x1 + kMod1 * t2;
+        const uint64_t t3 = (x3 + kMod3 - x1_plus_mod1_t2 % kMod3) * detail::kMod1Mod2InverseModMod3 % kMod3;
+        // carry < 2^56, x1 + Mod1 * t2 < 2^58, Mod1Mod2Low * t3 < 2^62
+        const uint64_t low = carry + x1_plus_mod1_t2 + detail::kMod1Mod2Low * t3;
+        result[i] = static_cast<uint32_t>(low);
+        carry = (low >> 32U) + detail::kMod1Mod2High * t3;
+    }
+    assert(carry == 0);
+}
+
+inline void precompute_tables(const size_t max_product_size) {
+    THROW_IF(max_product_size > kMaxProductSize);
+    const size_t n = detail::transform_size(max_product_size);
+    detail::transform_impl<detail::Field1>::ensure_roots_capacity(n);
+    detail::transform_impl<detail::Field2>::ensure_roots_capacity(n);
+    detail::transform_impl<detail::Field3>::ensure_roots_capacity(n);
+}
+
+}  // namespace ntt
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "../misc/config_macros.hpp"
+#include "integers_128_bit.hpp"
+#include "is_prime.hpp"
+#include "math_functions.hpp"
+
+namespace math_functions {
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+namespace detail {
+
+/// @brief Numbers are divided by the odd primes below kRhoTrialDivisionBound before the rho
+inline constexpr uint32_t kRhoTrialDivisionBound = 256;
+/// @brief Odd primes below kRhoTrialDivisionBound
+inline constexpr size_t kRhoTrialDivisorsCount = 53;
+/// @brief Number of the differences multiplied together before one gcd in the Brent's loop
+inline constexpr uint32_t kRhoGcdBatch = 128;
+
+/**
+ * Odd n is divisible by the odd p \iff n * p^-1 mod 2^k <= (2^k - 1) / p,
+ * and then n / p == n * p^-1 mod 2^k (k is the bit width of T).
+ */
+template <class T>
+struct RhoTrialDivisor final {
+    T inverse;
+    T max_quotient;
+    uint32_t prime;
+};
+
+template <class T>
+[[nodiscard]] inline const std::array<RhoTrialDivisor<T>, kRhoTrialDivisorsCount>& rho_trial_divisors() noexcept {
+    static const std::array<RhoTrialDivisor<T>, kRhoTrialDivisorsCount> divisors = []() noexcept {
+        std::array<RhoTrialDivisor<T>, kRhoTrialDivisorsCount> table{};
+        size_t size = 0;
+        for (uint32_t p = 3; p < kRhoTrialDivisionBound; p += 2) {
+            if (math_functions::is_prime_sqrt(p)) {
+                table[size++] = RhoTrialDivisor<T>{
+                    math_functions::detail::inverse_mod_word(T{p}),
+                    static_cast<T>(std::numeric_limits<T>::max() / p),
+                    p,
+                };
+            }
+        }
+        assert(size == kRhoTrialDivisorsCount);
+        return table;
+    }();
+    return divisors;
+}
+
+/// @brief Upper bound of the number of the prime factors of the n without factors below kRhoTrialDivisionBound
+template <class T>
+inline constexpr size_t kMaxRhoPrimeFactors = sizeof(T) * CHAR_BIT / 8;
+
+/**
+ * @brief Brent's variant of the Pollard's rho (R. P. Brent, "An improved Monte Carlo
+ *         factorization algorithm", 1980) with f(y) = y^2 + c in the Montgomery form:
+ *         differences are multiplied together by kRhoGcdBatch and the last batch is
+ *         replayed one by one if the gcd of the product is n. If c fails, next c is taken.
+ * @param n odd composite number without prime factors below kRhoTrialDivisionBound
+ * @return divisor d of n, 1 < d < n
+ */
+template <class T>
+[[nodiscard]] ATTRIBUTE_CONST T pollard_brent_rho_divisor(const T n) noexcept {
+    CONFIG_ASSUME_STATEMENT(n % 2 == 1);
+    CONFIG_ASSUME_STATEMENT(n > kRhoTrialDivisionBound * kRhoTrialDivisionBound);
+
+    const math_functions::detail::MontgomeryForm<T> mont(n);
+    for (T c = 1;; c++) {
+        const auto f = [&mont, c](const T y) noexcept { return mont.add(mont.mul(y, y), c); };
+
+        T x = 2;
+        T y = x;
+        T ys = y;
+        T product = 1;
+        T g = 1;
+        for (uint32_t r = 1; g == 1; r *= 2) {
+            x = y;
+            for (uint32_t i = 0; i < r; i++) {
+                y = f(y);
+            }
+            for (uint32_t k = 0; k < r && g == 1; k += kRhoGcdBatch) {
+                ys = y;
+                const uint32_t steps = std::min(kRhoGcdBatch, r - k);
+                for (uint32_t i = 0; i < steps; i++) {
+                    y = f(y);
+                    product = mont.mul(product, mont.sub(x, y));
+                }
+                g = static_cast<T>(math_functions::gcd(product, n));
+            }
+        }
+
+        if (g == n) {
+            do {
+                ys = f(ys);
+                g = static_cast<T>(math_functions::gcd(mont.sub(x, ys), n));
+            } while (g == 1);
+        }
+
+        if (g != n) {
+            return g;
+        }
+    }
+}
+
+/// @brief Returns 1 if n is prime and its divisor d, 1 < d < n, otherwise
+/// @param n odd number without prime factors below kRhoTrialDivisionBound
+template <class T>
+[[nodiscard]] ATTRIBUTE_CONST T rho_divisor_or_one(const T n) noexcept {
+    if constexpr (std::is_same_v<T, uint128_t>) {
+        if (n <= std::numeric_limits<uint64_t>::max()) {
+            return T{math_functions::detail::rho_divisor_or_one(static_cast<uint64_t>(n))};
+        }
+    }
+
+    if (n < kRhoTrialDivisionBound * kRhoTrialDivisionBound || math_functions::is_prime_bpsw(n)) {
+        return 1;
+    }
+    return math_functions::detail::pollard_brent_rho_divisor(n);
+}
+
+/// @brief Writes the prime factors of n (with repetitions) to the primes in the increasing order
+/// @param n odd number without prime factors below kRhoTrialDivisionBound, n > 1
+/// @return number of the prime factors
+template <class T>
+size_t rho_prime_factors(const T n, std::array<T, kMaxRhoPrimeFactors<T>>& primes) noexcept {
+    std::array<T, kMaxRhoPrimeFactors<T>> composites{};
+    size_t composites_size = 0;
+    size_t primes_size = 0;
+    composites[composites_size++] = n;
+    do {
+        const T m = composites[--composites_size];
+        const T d = math_functions::detail::rho_divisor_or_one(m);
+        if (d == 1) {
+            primes[primes_size++] = m;
+        } else {
+            composites[composites_size++] = d;
+            composites[composites_size++] = m / d;
+        }
+        CONFIG_ASSUME_STATEMENT(primes_size + composites_size <= kMaxRhoPrimeFactors<T>);
+    } while (composites_size > 0);
+
+    std::sort(primes.begin(), primes.begin() + static_cast<std::ptrdiff_t>(primes_size));
+    return primes_size;
+}
+
+}  // namespace detail
+
+// clang-format off
+
+/**
+ * @brief Calls visitor(PrimeFactor<make_unsigned_t<IntType>>) for the prime factors of n in the
+ *         increasing order, like visit_prime_factors (if visitor returns bool, stops after the
+ *         first false), but in the expected O(n^(1/4)) multiplications instead of O(n^(1/2)) divisions.
+ *
+ * Powers of 2 are extracted by shift, odd primes below 256 are divided out by the multiplication
+ * by their inverses modulo 2^k. The rest is split by the Pollard-Brent rho in the Montgomery form
+ * until is_prime_bpsw accepts every part. Parts of the 128-bit numbers that fit into uint64_t are
+ * factored by the 64-bit arithmetic. Nothing is allocated.
+ */
+template <class IntType, class F>
+void visit_prime_factors_rho(const IntType n, F visitor) noexcept(
+    std::is_nothrow_invocable_v<F, math_functions::PrimeFactor<math_functions::make_unsigned_t<IntType>>>) {
+    // clang-format on
+
+    math_functions::detail::check_math_int_type<IntType>();
+
+    static_assert(sizeof(IntType) >= sizeof(int), "integral type should be at least int in size");
+
+    using UnsignedIntType = math_functions::make_unsigned_t<IntType>;
+    using PrimeFactorType = math_functions::PrimeFactor<UnsignedIntType>;
+    using WordType = std::conditional_t<sizeof(UnsignedIntType) <= sizeof(uint64_t), uint64_t, uint128_t>;
+
+    static_assert(std::is_invocable_v<F, PrimeFactorType>,
+                  "Passed function should accept type PrimeFactor<make_unsigned<IntType>>");
+
+    constexpr bool kCheckEarlyExit = std::is_invocable_r_v<bool, F&, PrimeFactorType>;
+    const auto visit = [&visitor](const WordType factor, const uint32_t factor_power) -> bool {
+        const PrimeFactorType pf{static_cast<UnsignedIntType>(factor), factor_power};
+        if constexpr (kCheckEarlyExit) {
+            return static_cast<bool>(visitor(pf));
+        } else {
+            visitor(pf);
+            return true;
+        }
+    };
+
+    WordType m = math_functions::uabs(n);
+    if (m == 0) {
+        return;
+    }
+
+    if (m % 2 == 0) {
+        const auto [odd_part, power_of_2] = math_functions::extract_pow2(m);
+        m = odd_part;
+        if (!visit(WordType{2}, power_of_2)) {
+            return;
+        }
+    }
+
+    for (const auto& divisor : math_functions::detail::rho_trial_divisors<WordType>()) {
+        if (m < WordType{divisor.prime} * divisor.prime) {
+            break;
+        }
+        WordType quotient = m * divisor.inverse;
+        if (quotient <= divisor.max_quotient) {
+            uint32_t power = 0;
+            do {
+                m = quotient;
+                power++;
+                quotient = m * divisor.inverse;
+            } while (quotient <= divisor.max_quotient);
+            if (!visit(WordType{divisor.prime}, power)) {
+                return;
+            }
+        }
+    }
+
+    using math_functions::detail::kRhoTrialDivisionBound;
+    if (m < kRhoTrialDivisionBound * kRhoTrialDivisionBound) {
+        if (m > 1) {
+            visit(m, uint32_t{1});
+        }
+        return;
+    }
+
+    std::array<WordType, math_functions::detail::kMaxRhoPrimeFactors<WordType>> primes{};
+    const size_t primes_size = math_functions::detail::rho_prime_factors(m, primes);
+    for (size_t i = 0; i < primes_size;) {
+        const WordType p = primes[i];
+        uint32_t power = 0;
+        do {
+            power++;
+            i++;
+        } while (i < primes_size && primes[i] == p);
+        if (!visit(p, power)) {
+            return;
+        }
+    }
+}
+
+/// @brief
+/// @tparam IntType
+/// @param[in] n
+/// @return vector of pairs { prime_div : power_of_prime_div },
+///          sorted by prime_div (see visit_prime_factors_rho).
+template <class IntType>
+[[nodiscard]] inline auto prime_factors_rho_as_vector(const IntType n)
+    -> std::vector<math_functions::PrimeFactor<math_functions::make_unsigned_t<IntType>>> {
+    math_functions::detail::check_math_int_type<IntType>();
+
+    using UnsignedIntType = math_functions::make_unsigned_t<IntType>;
+    std::vector<math_functions::PrimeFactor<UnsignedIntType>> prime_factors_vector;
+    math_functions::visit_prime_factors_rho(n, [&prime_factors_vector](const PrimeFactor<UnsignedIntType> pf) {
+        prime_factors_vector.push_back(pf);
+    });
+    return prime_factors_vector;
+}
+
+}  // namespace math_functions
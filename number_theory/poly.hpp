@@ -0,0 +1,406 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../misc/assert.hpp"
+#include "../misc/config_macros.hpp"
+#include "ntt.hpp"
+
+namespace poly {
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+/**
+ * @brief Arithmetic of the polynomials over the field Z / Mod Z, products are computed by the NTT
+ *         (see ntt::detail::transform_impl), so Mod should be a prime with 2^k | Mod - 1 for the
+ *         transforms of size 2^k and PrimitiveRoot should be a primitive root modulo Mod.
+ *
+ * Polynomial a_0 + a_1 x + ... + a_{n - 1} x^{n - 1} is the std::vector{a_0, a_1, ..., a_{n - 1}}
+ *  with all a_i in [0; Mod), trailing zeros are allowed, the empty vector is the zero polynomial.
+ *
+ * Series inverse, log and exp are computed by the Newton iterations in O(n log n),
+ *  division with remainder in O(n log n), multipoint evaluation and interpolation
+ *  by the subproduct tree in O(n log^2 n).
+ */
+template <uint32_t Mod, uint32_t PrimitiveRoot>
+class PolynomialRing final {
+    using Field = ntt::detail::MontgomeryField<Mod, PrimitiveRoot>;
+    using Transform = ntt::detail::transform_impl<Field>;
+
+public:
+    using poly_t = std::vector<uint32_t>;
+
+    static constexpr uint32_t kMod = Mod;
+    /// @brief Max size of the product a * b (deg(a) + deg(b) + 1), equals to the max length of the NTT modulo Mod
+    static constexpr size_t kMaxProductSize = Field::kMaxTransformSize;
+
+    /// @throws std::runtime_error if a.size() + b.size() - 1 > kMaxProductSize
+    [[nodiscard]] static poly_t multiply(const poly_t& a, const poly_t& b) {
+        if (a.empty() || b.empty()) {
+            return {};
+        }
+
+        const size_t prod_size = a.size() + b.size() - 1;
+        THROW_IF(prod_size > kMaxProductSize);
+        if (std::min(a.size(), b.size()) <= kMaxNaiveMultiplicationSize) {
+            poly_t product(prod_size);
+            for (size_t i = 0; i < a.size(); i++) {
+                for (size_t j = 0; j < b.size(); j++) {
+                    product[i + j] = add(product[i + j], mul(a[i], b[j]));
+                }
+            }
+            return product;
+        }
+
+        const size_t n = transform_size(prod_size);
+        poly_t out(n);
+        poly_t buffer(n);
+        // Square needs only two transforms
+        const uint32_t* const b_or_null = &a == &b ? nullptr : b.data();
+        Transform::convolution(a.data(), a.size(), b_or_null, b.size(), out.data(), buffer.data(), n);
+        out.resize(prod_size);
+        return out;
+    }
+
+    /// @return b such that a * b = 1 mod x^n
+    /// @throws std::runtime_error if a is empty or a[0] == 0
+    [[nodiscard]] static poly_t inverse(const poly_t& a, const size_t n) {
+        THROW_IF(a.empty() || a[0] == 0);
+
+        // b_{2k} = b_k * (2 - a * b_k) mod x^{2k}
+        poly_t b{inv(a[0])};
+        for (size_t len = 1; len < n; len *= 2) {
+            const size_t new_len = 2 * len;
+            poly_t ab = multiply(truncated(a, new_len), b);
+            ab.resize(new_len);
+            for (uint32_t& coeff : ab) {
+                coeff = neg(coeff);
+            }
+            ab[0] = add(ab[0], 2);
+            b = multiply(b, ab);
+            b.resize(new_len);
+        }
+        b.resize(n);
+        return b;
+    }
+
+    /// @return {q, r} such that a = b * q + r and deg(r) < deg(b) (without the trailing zeros)
+    /// @throws std::runtime_error if b is the zero polynomial
+    [[nodiscard]] static std::pair<poly_t, poly_t> divmod(poly_t a, poly_t b) {
+        normalize(a);
+        normalize(b);
+        THROW_IF(b.empty());
+        if (a.size() < b.size()) {
+            return {poly_t{}, std::move(a)};
+        }
+
+        const size_t q_size = a.size() - b.size() + 1;
+        poly_t q;
+        if (std::min(q_size, b.size()) <= kMaxNaiveMultiplicationSize) {
+            // Long division
+            q.resize(q_size);
+            const uint32_t lead_inv = inv(b.back());
+            for (size_t i = q_size; i-- > 0;) {
+                const uint32_t coeff = mul(a[i + b.size() - 1], lead_inv);
+                q[i] = coeff;
+                for (size_t j = 0; j < b.size(); j++) {
+                    a[i + j] = sub(a[i + j], mul(coeff, b[j]));
+                }
+            }
+            a.resize(b.size() - 1);
+            normalize(a);
+            return {std::move(q), std::move(a)};
+        }
+
+        // rev(q) = rev(a) / rev(b) mod x^{q_size}
+        poly_t a_rev(a.rbegin(), a.rbegin() + static_cast<std::ptrdiff_t>(q_size));
+        poly_t b_rev(b.rbegin(), b.rend());
+        q = multiply(a_rev, inverse(b_rev, q_size));
+        q.resize(q_size);
+        std::reverse(q.begin(), q.end());
+
+        poly_t bq = multiply(b, q);
+        a.resize(b.size() - 1);
+        for (size_t i = 0; i < a.size(); i++) {
+            a[i] = sub(a[i], bq[i]);
+        }
+        normalize(a);
+        return {std::move(q), std::move(a)};
+    }
+
+    [[nodiscard]] static poly_t derivative(const poly_t& a) {
+        if (a.size() <= 1) {
+            return {};
+        }
+        poly_t d(a.size() - 1);
+        for (size_t i = 1; i < a.size(); i++) {
+            d[i - 1] = mul(a[i], static_cast<uint32_t>(i % Mod));
+        }
+        return d;
+    }
+
+    /// @return b such that b' = a and b(0) = 0
+    /// @note deg(a) + 1 should be less than Mod
+    [[nodiscard]] static poly_t integral(const poly_t& a) {
+        poly_t b(a.size() + 1);
+        const std::vector<uint32_t> inverses = inverses_up_to(a.size());
+        for (size_t i = 0; i < a.size(); i++) {
+            b[i + 1] = mul(a[i], inverses[i + 1]);
+        }
+        return b;
+    }
+
+    /// @return log(a) mod x^n = integral(a' / a) mod x^n
+    /// @throws std::runtime_error if a is empty or a[0] != 1
+    [[nodiscard]] static poly_t log(const poly_t& a, const size_t n) {
+        THROW_IF(a.empty() || a[0] != 1);
+        if (n == 0) {
+            return {};
+        }
+
+        poly_t quotient = multiply(derivative(truncated(a, n)), inverse(a, n));
+        quotient.resize(n - 1);
+        poly_t res = integral(quotient);
+        res.resize(n);
+        return res;
+    }
+
+    /// @return exp(a) mod x^n
+    /// @throws std::runtime_error if a is not empty and a[0] != 0
+    [[nodiscard]] static poly_t exp(const poly_t& a, const size_t n) {
+        THROW_IF(!a.empty() && a[0] != 0);
+        if (n == 0) {
+            return {};
+        }
+
+        // b_{2k} = b_k * (1 - log(b_k) + a) mod x^{2k}
+        poly_t b{1};
+        for (size_t len = 1; len < n; len *= 2) {
+            const size_t new_len = 2 * len;
+            poly_t c = log(b, new_len);
+            for (size_t i = 0; i < new_len; i++) {
+                c[i] = sub(i < a.size() ? a[i] : 0, c[i]);
+            }
+            c[0] = add(c[0], 1);
+            b = multiply(b, c);
+            b.resize(new_len);
+        }
+        b.resize(n);
+        return b;
+    }
+
+    /// @return a(b(x)) mod x^n
+    /// @note Brent-Kung: a is split into ~sqrt(deg(a)) blocks of k coefficients, the powers b^0, ..., b^k
+    ///        are computed once and the blocks are combined by the Horner's rule in b^k, so the
+    ///        composition takes O(sqrt(deg(a)) * n log n + deg(a) * n) operations
+    [[nodiscard]] static poly_t compose(const poly_t& a, const poly_t& b, const size_t n) {
+        poly_t res(n);
+        if (a.empty() || n == 0) {
+            return res;
+        }
+
+        size_t k = 1;
+        while (k * k < a.size()) {
+            k++;
+        }
+        std::vector<poly_t> pows(k + 1);
+        pows[0] = poly_t{1};
+        pows[0].resize(n);
+        const poly_t b_truncated = truncated(b, n);
+        for (size_t j = 1; j <= k; j++) {
+            pows[j] = multiply(pows[j - 1], b_truncated);
+            pows[j].resize(n);
+        }
+
+        const size_t blocks = (a.size() + k - 1) / k;
+        for (size_t block = blocks; block-- > 0;) {
+            if (block + 1 != blocks) {
+                res = multiply(res, pows[k]);
+                res.resize(n);
+            }
+            const size_t block_end = std::min(a.size(), (block + 1) * k);
+            for (size_t i = block * k; i < block_end; i++) {
+                const uint32_t coeff = a[i];
+                if (coeff == 0) {
+                    continue;
+                }
+                const poly_t& pow = pows[i - block * k];
+                for (size_t j = 0; j < n; j++) {
+                    res[j] = add(res[j], mul(coeff, pow[j]));
+                }
+            }
+        }
+        return res;
+    }
+
+    /// @return a(points[0]), ..., a(points[m - 1])
+    [[nodiscard]] static poly_t evaluate(const poly_t& a, const poly_t& points) {
+        poly_t values(points.size());
+        if (points.empty()) {
+            return values;
+        }
+
+        const SubproductTree tree(points);
+        tree.evaluate(divmod(a, tree.root()).second, 1, 0, points.size(), values);
+        return values;
+    }
+
+    /// @return polynomial p of degree less than xs.size() such that p(xs[i]) = ys[i]
+    /// @throws std::runtime_error if xs.size() != ys.size() or xs are not distinct
+    [[nodiscard]] static poly_t interpolate(const poly_t& xs, const poly_t& ys) {
+        THROW_IF(xs.size() != ys.size());
+        if (xs.empty()) {
+            return {};
+        }
+
+        // p = \sum_i ys[i] / P'(xs[i]) * P / (x - xs[i]), P = \prod_i (x - xs[i])
+        const SubproductTree tree(xs);
+        poly_t weights(xs.size());
+        tree.evaluate(derivative(tree.root()), 1, 0, xs.size(), weights);
+        for (size_t i = 0; i < xs.size(); i++) {
+            THROW_IF(weights[i] == 0);
+            weights[i] = mul(ys[i], inv(weights[i]));
+        }
+        poly_t p = tree.combine(weights, 1, 0, xs.size());
+        normalize(p);
+        return p;
+    }
+
+    /// @brief Removes the trailing zeros of @a a
+    static void normalize(poly_t& a) noexcept {
+        while (!a.empty() && a.back() == 0) {
+            a.pop_back();
+        }
+    }
+
+private:
+    /// @brief Products with one of the factors of at most kMaxNaiveMultiplicationSize coefficients are done naively
+    static constexpr size_t kMaxNaiveMultiplicationSize = 32;
+    /// @brief Subtrees with at most kMaxNaiveEvaluationPoints points are evaluated by the Horner's rule
+    static constexpr size_t kMaxNaiveEvaluationPoints = 32;
+
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr uint32_t add(const uint32_t a, const uint32_t b) noexcept {
+        return Field::add(a, b);
+    }
+
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr uint32_t sub(const uint32_t a, const uint32_t b) noexcept {
+        return Field::sub(a, b);
+    }
+
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr uint32_t neg(const uint32_t a) noexcept {
+        return a == 0 ? 0 : Mod - a;
+    }
+
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr uint32_t mul(const uint32_t a, const uint32_t b) noexcept {
+        return static_cast<uint32_t>(uint64_t{a} * b % Mod);
+    }
+
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr uint32_t inv(const uint32_t a) noexcept {
+        return Field::pow_mod(a, Mod - 2);
+    }
+
+    /// @brief Smallest power of two not less than @a size (see ntt::multiply_base_2_32())
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr size_t transform_size(const size_t size) noexcept {
+        size_t n = 1;
+        while (n < size) {
+            n *= 2;
+        }
+        return n;
+    }
+
+    [[nodiscard]] static poly_t truncated(const poly_t& a, const size_t n) {
+        return poly_t(a.begin(), a.begin() + static_cast<std::ptrdiff_t>(std::min(a.size(), n)));
+    }
+
+    /// @return 1^{-1}, ..., n^{-1} modulo Mod at the indices 1, ..., n
+    [[nodiscard]] static std::vector<uint32_t> inverses_up_to(const size_t n) {
+        std::vector<uint32_t> inverses(n + 1);
+        if (n >= 1) {
+            inverses[1] = 1;
+        }
+        // i^{-1} = -(Mod / i) * (Mod mod i)^{-1}
+        for (size_t i = 2; i <= n; i++) {
+            inverses[i] = neg(mul(Mod / static_cast<uint32_t>(i), inverses[Mod % i]));
+        }
+        return inverses;
+    }
+
+    /// @brief Horner's rule
+    [[nodiscard]] static uint32_t evaluate_at(const poly_t& a, const uint32_t x) noexcept {
+        uint32_t value = 0;
+        for (size_t i = a.size(); i-- > 0;) {
+            value = add(mul(value, x), a[i]);
+        }
+        return value;
+    }
+
+    /**
+     * @brief nodes_[v] = \prod_{i = l}^{r - 1} (x - points[i]) for the node v of the segment [l; r),
+     *         node 1 is the root, nodes 2 v and 2 v + 1 are the children of the v
+     */
+    class SubproductTree final {
+    public:
+        explicit SubproductTree(const poly_t& points) : points_(points), nodes_(4 * points.size()) {
+            build(1, 0, points.size());
+        }
+
+        [[nodiscard]] const poly_t& root() const noexcept {
+            return nodes_[1];
+        }
+
+        /// @brief values[i] = r(points[i]) for i in [l; r), deg(r) < r - l
+        void evaluate(const poly_t& rem, const size_t v, const size_t l, const size_t r, poly_t& values) const {
+            if (r - l <= kMaxNaiveEvaluationPoints) {
+                for (size_t i = l; i < r; i++) {
+                    values[i] = evaluate_at(rem, points_[i]);
+                }
+                return;
+            }
+            const size_t m = l + (r - l) / 2;
+            evaluate(divmod(rem, nodes_[2 * v]).second, 2 * v, l, m, values);
+            evaluate(divmod(rem, nodes_[2 * v + 1]).second, 2 * v + 1, m, r, values);
+        }
+
+        /// @return \sum_{i = l}^{r - 1} weights[i] * \prod_{j = l, j != i}^{r - 1} (x - points[j])
+        [[nodiscard]] poly_t combine(const poly_t& weights, const size_t v, const size_t l, const size_t r) const {
+            if (r - l == 1) {
+                return poly_t{weights[l]};
+            }
+            const size_t m = l + (r - l) / 2;
+            poly_t left = multiply(combine(weights, 2 * v, l, m), nodes_[2 * v + 1]);
+            const poly_t right = multiply(combine(weights, 2 * v + 1, m, r), nodes_[2 * v]);
+            left.resize(std::max(left.size(), right.size()));
+            for (size_t i = 0; i < right.size(); i++) {
+                left[i] = add(left[i], right[i]);
+            }
+            return left;
+        }
+
+    private:
+        void build(const size_t v, const size_t l, const size_t r) {
+            if (r - l == 1) {
+                nodes_[v] = poly_t{neg(points_[l]), 1};
+                return;
+            }
+            const size_t m = l + (r - l) / 2;
+            build(2 * v, l, m);
+            build(2 * v + 1, m, r);
+            nodes_[v] = multiply(nodes_[2 * v], nodes_[2 * v + 1]);
+        }
+
+        const poly_t& points_;
+        std::vector<poly_t> nodes_;
+    };
+};
+
+/// @brief Polynomials modulo 998244353 = 119 * 2^23 + 1
+using PolynomialRing998244353 = PolynomialRing<998244353, 3>;
+
+}  // namespace poly
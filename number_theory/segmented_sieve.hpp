@@ -0,0 +1,496 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+#include "../misc/config_macros.hpp"
+#include "../misc/thread_pool.hpp"
+#include "math_functions.hpp"
+
+namespace math_functions {
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+namespace detail {
+
+/*
+ * The multiples of the kPresievePrimes are not crossed off one by one: every window starts
+ * as a copy of the repeating pattern of the numbers coprime with them (the pattern of
+ * the odd number 2 t + 1 depends only on t mod kPresievePeriod)
+ */
+inline constexpr uint32_t kPresievePrimes[] = {3, 5, 7, 11, 13};
+inline constexpr uint32_t kPresievePeriod = 3 * 5 * 7 * 11 * 13;
+inline constexpr size_t kPresieveWords = (kPresievePeriod + 128) / 64 + 1;
+
+/// @brief Bit t of the pattern is set \iff gcd(2 (t mod kPresievePeriod) + 1, kPresievePeriod) == 1
+[[nodiscard]] inline const std::array<uint64_t, kPresieveWords>& presieve_pattern() noexcept {
+    static const std::array<uint64_t, kPresieveWords> pattern = []() noexcept {
+        std::array<uint64_t, kPresieveWords> words{};
+        for (size_t bit = 0; bit < kPresieveWords * 64; bit++) {
+            const uint32_t n = 2 * static_cast<uint32_t>(bit % kPresievePeriod) + 1;
+            bool is_coprime = true;
+            for (const uint32_t p : kPresievePrimes) {
+                is_coprime &= n % p != 0;
+            }
+            words[bit / 64] |= uint64_t{is_coprime} << (bit % 64);
+        }
+        return words;
+    }();
+    return pattern;
+}
+
+/**
+ * @brief Sieve of Eratosthenes over the odd numbers in [first; last], bit i of the
+ *         window stands for the number window_first() + 2 i (odd-only storage).
+ *
+ * Window is processed by the L1-sized segments of kSegmentBits bits for the sieving
+ * primes less than kSegmentBits and at once for the greater ones (they cross off at most
+ * one number in every segment). Offsets of the next multiples of the sieving primes are
+ * kept between the windows.
+ *
+ * Sieving primes up to kMaxStoredSievingPrime are passed by the caller. If sqrt(last)
+ * is greater (last > 2^48), the rest of them are generated for every window by another
+ * sieve and are not stored, so the windows are made kStreamingWindowBits long.
+ */
+class OddNumbersSieve final {
+public:
+    /// @brief 32 KiB
+    static constexpr size_t kSegmentBits = size_t{1} << 18U;
+    /// @brief 2 MiB
+    static constexpr size_t kWindowBits = size_t{1} << 24U;
+    /// @brief 64 MiB
+    static constexpr size_t kStreamingWindowBits = size_t{1} << 29U;
+    static constexpr uint32_t kMaxStoredSievingPrime = uint32_t{1} << 24U;
+
+    /// @param first odd number, 3 <= first
+    /// @param last first <= last
+    /// @param sieving_primes all primes in [17; min(sqrt(last), kMaxStoredSievingPrime)] in
+    ///        the increasing order (greater primes are allowed), should outlive the sieve
+    OddNumbersSieve(const uint64_t first, const uint64_t last, const std::vector<uint32_t>& sieving_primes)
+        : sieving_primes_(sieving_primes),
+          root_(math_functions::isqrt(last)),
+          next_first_(first),
+          remaining_bits_((last - first) / 2 + 1) {
+        assert(first % 2 == 1 && 3 <= first && first <= last);
+
+        const uint32_t stored_primes_bound = std::min(root_, kMaxStoredSievingPrime);
+        primes_count_ = static_cast<size_t>(
+            std::upper_bound(sieving_primes.begin(), sieving_primes.end(), stored_primes_bound) -
+            sieving_primes.begin());
+        small_primes_count_ = static_cast<size_t>(
+            std::lower_bound(sieving_primes.begin(), sieving_primes.begin() + static_cast<std::ptrdiff_t>(primes_count_),
+                             static_cast<uint32_t>(kSegmentBits)) -
+            sieving_primes.begin());
+        offsets_.resize(primes_count_);
+        for (size_t i = 0; i < primes_count_; i++) {
+            offsets_[i] = first_multiple_index(sieving_primes[i], first);
+        }
+
+        const size_t max_window_bits = root_ > kMaxStoredSievingPrime ? kStreamingWindowBits : kWindowBits;
+        words_.resize((static_cast<size_t>(std::min(uint64_t{max_window_bits}, remaining_bits_)) + 63) / 64);
+    }
+
+    /// @brief Sieves the next window
+    /// @return false if all the windows have been sieved
+    bool next_window() {
+        if (remaining_bits_ == 0) {
+            return false;
+        }
+
+        window_first_ = next_first_;
+        window_bits_ = static_cast<size_t>(std::min(uint64_t{words_.size()} * 64, remaining_bits_));
+        fill_presieved();
+        cross_off_stored_primes();
+        if (root_ > kMaxStoredSievingPrime) {
+            cross_off_streamed_primes();
+        }
+        restore_presieve_primes();
+
+        remaining_bits_ -= window_bits_;
+        if (remaining_bits_ != 0) {
+            next_first_ = window_first_ + 2 * uint64_t{window_bits_};
+        }
+        return true;
+    }
+
+    [[nodiscard]] uint64_t window_first() const noexcept {
+        return window_first_;
+    }
+
+    [[nodiscard]] size_t window_words_count() const noexcept {
+        return (window_bits_ + 63) / 64;
+    }
+
+    [[nodiscard]] const uint64_t* window_words() const noexcept {
+        return words_.data();
+    }
+
+    [[nodiscard]] uint64_t count_window_primes() const noexcept {
+        uint64_t count = 0;
+        for (size_t i = 0; i < window_words_count(); i++) {
+            count += static_cast<uint32_t>(math_functions::popcount(words_[i]));
+        }
+        return count;
+    }
+
+    template <class Function>
+    void for_each_window_prime(Function&& f) const {
+        for (size_t i = 0; i < window_words_count(); i++) {
+            for (uint64_t word = words_[i]; word != 0; word &= word - 1) {
+                const auto bit = static_cast<uint32_t>(math_functions::countr_zero(word));
+                f(window_first_ + 2 * (uint64_t{i} * 64 + bit));
+            }
+        }
+    }
+
+private:
+    /// @return index (in the odd-only storage starting with the odd number first)
+    ///         of the least odd multiple of the odd prime p not less than max(p^2, first)
+    [[nodiscard]] ATTRIBUTE_CONST static constexpr uint64_t first_multiple_index(const uint32_t p,
+                                                                                 const uint64_t first) noexcept {
+        const uint64_t square = uint64_t{p} * p;
+        if (square >= first) {
+            return (square - first) / 2;
+        }
+        const uint64_t rem = first % p;
+        uint64_t delta = rem == 0 ? 0 : p - rem;
+        // first + delta is odd \iff delta is even
+        if (delta % 2 != 0) {
+            delta += p;
+        }
+        return delta / 2;
+    }
+
+    void fill_presieved() noexcept {
+        const std::array<uint64_t, kPresieveWords>& pattern = presieve_pattern();
+        size_t pos = static_cast<size_t>(((window_first_ - 1) / 2) % kPresievePeriod);
+        const size_t words_count = window_words_count();
+        for (size_t i = 0; i < words_count; i++) {
+            const size_t word_index = pos / 64;
+            const size_t shift = pos % 64;
+            uint64_t word = pattern[word_index] >> shift;
+            if (shift != 0) {
+                word |= pattern[word_index + 1] << (64 - shift);
+            }
+            words_[i] = word;
+            pos += 64;
+            if (pos >= kPresievePeriod) {
+                pos -= kPresievePeriod;
+            }
+        }
+        if (window_bits_ % 64 != 0) {
+            words_[words_count - 1] &= (uint64_t{1} << (window_bits_ % 64)) - 1;
+        }
+    }
+
+    void cross_off(const uint32_t p, uint64_t& offset, const size_t end) noexcept {
+        uint64_t i = offset;
+        for (; i < end; i += p) {
+            words_[i / 64] &= ~(uint64_t{1} << (i % 64));
+        }
+        offset = i;
+    }
+
+    void cross_off_stored_primes() noexcept {
+        for (size_t segment_end = 0; segment_end < window_bits_;) {
+            segment_end = std::min(segment_end + kSegmentBits, window_bits_);
+            for (size_t i = 0; i < small_primes_count_; i++) {
+                cross_off(sieving_primes_[i], offsets_[i], segment_end);
+            }
+        }
+        for (size_t i = small_primes_count_; i < primes_count_; i++) {
+            cross_off(sieving_primes_[i], offsets_[i], window_bits_);
+        }
+        // All offsets are not less than the window_bits_ now
+        for (uint64_t& offset : offsets_) {
+            offset -= window_bits_;
+        }
+    }
+
+    void cross_off_streamed_primes() {
+        const uint64_t window_last = window_first_ + 2 * (uint64_t{window_bits_} - 1);
+        const uint32_t window_root = math_functions::isqrt(window_last);
+        if (window_root <= kMaxStoredSievingPrime) {
+            return;
+        }
+        OddNumbersSieve primes_generator(uint64_t{kMaxStoredSievingPrime} + 1, window_root, sieving_primes_);
+        while (primes_generator.next_window()) {
+            primes_generator.for_each_window_prime([this](const uint64_t p) noexcept {
+                uint64_t offset = first_multiple_index(static_cast<uint32_t>(p), window_first_);
+                cross_off(static_cast<uint32_t>(p), offset, window_bits_);
+            });
+        }
+    }
+
+    void restore_presieve_primes() noexcept {
+        for (const uint32_t p : kPresievePrimes) {
+            if (window_first_ <= p && (p - window_first_) / 2 < window_bits_) {
+                const size_t i = static_cast<size_t>((p - window_first_) / 2);
+                words_[i / 64] |= uint64_t{1} << (i % 64);
+            }
+        }
+    }
+
+    const std::vector<uint32_t>& sieving_primes_;
+    size_t primes_count_{};
+    size_t small_primes_count_{};
+    std::vector<uint64_t> offsets_{};
+    std::vector<uint64_t> words_{};
+    uint32_t root_;
+    uint64_t next_first_;
+    uint64_t remaining_bits_;
+    uint64_t window_first_{};
+    size_t window_bits_{};
+};
+
+/// @return all primes in [17; min(sqrt(hi), OddNumbersSieve::kMaxStoredSievingPrime)]
+[[nodiscard]] inline std::vector<uint32_t> stored_sieving_primes(const uint64_t hi) {
+    const uint32_t bound = std::min(math_functions::isqrt(hi), OddNumbersSieve::kMaxStoredSievingPrime);
+    std::vector<uint32_t> primes;
+    if (bound < 17) {
+        return primes;
+    }
+    const std::vector<bool> is_prime = math_functions::dynamic_primes_sieve(bound);
+    for (uint32_t p = 17; p <= bound; p += 2) {
+        if (is_prime[p]) {
+            primes.push_back(p);
+        }
+    }
+    return primes;
+}
+
+struct OddRange final {
+    uint64_t first;
+    uint64_t last;
+};
+
+/// @return odd numbers in [max(lo, 3); hi] or std::nullopt if there are no such numbers
+[[nodiscard]] ATTRIBUTE_CONST constexpr std::optional<OddRange> odd_range_of(const uint64_t lo,
+                                                                              const uint64_t hi) noexcept {
+    const uint64_t first = std::max(lo, uint64_t{3}) | 1U;
+    if (hi < 3 || first > hi) {
+        return std::nullopt;
+    }
+    return OddRange{first, hi % 2 == 0 ? hi - 1 : hi};
+}
+
+/// @brief Every thread sieves at least kMinParallelSieveOddNumbers odd numbers
+inline constexpr uint64_t kMinParallelSieveOddNumbers = uint64_t{1} << 24U;
+
+/// @brief Splits the odd numbers of the @a range into @a threads contiguous chunks and calls
+///         func(chunk_index, chunk_first, chunk_last) for every chunk on the misc::thread_pool.
+///         Exception thrown by any call is rethrown after all calls are finished.
+template <class Function>
+void sieve_in_parallel(const OddRange range, const size_t threads, const Function& func) {
+    const uint64_t odd_numbers = (range.last - range.first) / 2 + 1;
+    misc::thread_pool::instance().run(threads, [range, odd_numbers, threads, &func](const size_t i) {
+        const uint64_t begin = odd_numbers / threads * i + std::min(uint64_t{i}, odd_numbers % threads);
+        const uint64_t end = odd_numbers / threads * (i + 1) + std::min(uint64_t{i + 1}, odd_numbers % threads);
+        func(i, range.first + 2 * begin, range.first + 2 * (end - 1));
+    });
+}
+
+[[nodiscard]] ATTRIBUTE_CONST constexpr size_t sieve_threads(const OddRange range, const size_t max_threads) noexcept {
+    const uint64_t odd_numbers = (range.last - range.first) / 2 + 1;
+    const uint64_t threads = std::min(uint64_t{max_threads}, odd_numbers / kMinParallelSieveOddNumbers);
+    return static_cast<size_t>(std::max(threads, uint64_t{1}));
+}
+
+}  // namespace detail
+
+/// @brief Calls f(p) for all primes p in [lo; hi] in the increasing order.
+///         Numbers are sieved by the segmented sieve of Eratosthenes,
+///         it takes O(sqrt(hi) / log(hi)) memory for the sieving primes
+///         (but at most ~ 13 MB) and 2 MB for the sieved window (64 MB if hi > 2^48).
+template <class Function>
+void for_each_prime(const uint64_t lo, const uint64_t hi, Function f) {
+    if (lo <= 2 && 2 <= hi) {
+        f(uint64_t{2});
+    }
+    const std::optional<detail::OddRange> range = detail::odd_range_of(lo, hi);
+    if (!range.has_value()) {
+        return;
+    }
+
+    const std::vector<uint32_t> sieving_primes = detail::stored_sieving_primes(range->last);
+    detail::OddNumbersSieve sieve(range->first, range->last, sieving_primes);
+    while (sieve.next_window()) {
+        sieve.for_each_window_prime(f);
+    }
+}
+
+/// @return number of primes in [lo; hi]
+/// @note [lo; hi] is split into at most @a max_threads chunks sieved independently
+[[nodiscard]] inline uint64_t count_primes(const uint64_t lo, const uint64_t hi, const size_t max_threads = 1) {
+    const uint64_t two_count = lo <= 2 && 2 <= hi ? 1 : 0;
+    const std::optional<detail::OddRange> range = detail::odd_range_of(lo, hi);
+    if (!range.has_value()) {
+        return two_count;
+    }
+
+    const std::vector<uint32_t> sieving_primes = detail::stored_sieving_primes(range->last);
+    const size_t threads = detail::sieve_threads(*range, max_threads);
+    std::vector<uint64_t> counts(threads);
+    detail::sieve_in_parallel(*range, threads,
+                              [&sieving_primes, &counts](const size_t i, const uint64_t first, const uint64_t last) {
+                                  detail::OddNumbersSieve sieve(first, last, sieving_primes);
+                                  uint64_t count = 0;
+                                  while (sieve.next_window()) {
+                                      count += sieve.count_window_primes();
+                                  }
+                                  counts[i] = count;
+                              });
+
+    uint64_t count = two_count;
+    for (const uint64_t chunk_count : counts) {
+        count += chunk_count;
+    }
+    return count;
+}
+
+/// @return all primes in [lo; hi] in the increasing order
+/// @note [lo; hi] is split into at most @a max_threads chunks sieved independently
+[[nodiscard]] inline std::vector<uint64_t> primes_in_range(const uint64_t lo,
+                                                           const uint64_t hi,
+                                                           const size_t max_threads = 1) {
+    std::vector<uint64_t> primes;
+    if (lo <= 2 && 2 <= hi) {
+        primes.push_back(2);
+    }
+    const std::optional<detail::OddRange> range = detail::odd_range_of(lo, hi);
+    if (!range.has_value()) {
+        return primes;
+    }
+
+    const std::vector<uint32_t> sieving_primes = detail::stored_sieving_primes(range->last);
+    const size_t threads = detail::sieve_threads(*range, max_threads);
+    std::vector<std::vector<uint64_t>> chunks_primes(threads);
+    detail::sieve_in_parallel(
+        *range, threads, [&sieving_primes, &chunks_primes](const size_t i, const uint64_t first, const uint64_t last) {
+            detail::OddNumbersSieve sieve(first, last, sieving_primes);
+            std::vector<uint64_t>& chunk_primes = chunks_primes[i];
+            while (sieve.next_window()) {
+                sieve.for_each_window_prime([&chunk_primes](const uint64_t p) { chunk_primes.push_back(p); });
+            }
+        });
+
+    for (const std::vector<uint64_t>& chunk_primes : chunks_primes) {
+        primes.insert(primes.end(), chunk_primes.begin(), chunk_primes.end());
+    }
+    return primes;
+}
+
+/// @brief Range of the primes in [lo; hi] in the increasing order, sieved lazily window by window:
+///         for (const uint64_t p : math_functions::PrimesRange{lo, hi}) { ... }
+/// @note Iterators are single-pass (input iterators) and refer to the range, so it can not be moved
+class PrimesRange final {
+public:
+    class iterator final {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint64_t*;
+        using reference = const uint64_t&;
+
+        constexpr iterator() noexcept = default;
+
+        [[nodiscard]] reference operator*() const noexcept {
+            return range_->current_;
+        }
+
+        iterator& operator++() {
+            if (!range_->advance()) {
+                range_ = nullptr;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            const iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        [[nodiscard]] friend bool operator==(const iterator& lhs, const iterator& rhs) noexcept {
+            return lhs.range_ == rhs.range_;
+        }
+
+        [[nodiscard]] friend bool operator!=(const iterator& lhs, const iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class PrimesRange;
+
+        explicit constexpr iterator(PrimesRange* const range) noexcept : range_(range) {}
+
+        PrimesRange* range_{};
+    };
+
+    PrimesRange(const uint64_t lo, const uint64_t hi) : has_two_(lo <= 2 && 2 <= hi) {
+        if (const std::optional<detail::OddRange> range = detail::odd_range_of(lo, hi); range.has_value()) {
+            sieving_primes_ = detail::stored_sieving_primes(range->last);
+            sieve_.emplace(range->first, range->last, sieving_primes_);
+        }
+    }
+
+    PrimesRange(const PrimesRange&) = delete;
+    PrimesRange(PrimesRange&&) = delete;
+    PrimesRange& operator=(const PrimesRange&) = delete;
+    PrimesRange& operator=(PrimesRange&&) = delete;
+    ~PrimesRange() = default;
+
+    /// @note Should be called at most once
+    [[nodiscard]] iterator begin() {
+        return iterator{advance() ? this : nullptr};
+    }
+
+    [[nodiscard]] static constexpr iterator end() noexcept {
+        return iterator{};
+    }
+
+private:
+    bool advance() {
+        if (has_two_) {
+            has_two_ = false;
+            current_ = 2;
+            return true;
+        }
+        if (!sieve_.has_value()) {
+            return false;
+        }
+
+        while (current_word_ == 0) {
+            word_index_++;
+            if (word_index_ >= sieve_->window_words_count()) {
+                if (!sieve_->next_window()) {
+                    return false;
+                }
+                word_index_ = 0;
+            }
+            current_word_ = sieve_->window_words()[word_index_];
+        }
+        const auto bit = static_cast<uint32_t>(math_functions::countr_zero(current_word_));
+        current_word_ &= current_word_ - 1;
+        current_ = sieve_->window_first() + 2 * (uint64_t{word_index_} * 64 + bit);
+        return true;
+    }
+
+    bool has_two_;
+    std::vector<uint32_t> sieving_primes_{};
+    std::optional<detail::OddNumbersSieve> sieve_{};
+    size_t word_index_ = static_cast<size_t>(-1);
+    uint64_t current_word_{};
+    uint64_t current_{};
+};
+
+}  // namespace math_functions
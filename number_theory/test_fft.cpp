@@ -0,0 +1,140 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "../misc/tests/test_tools.hpp"
+#include "fft.hpp"
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+#include <span>
+#endif
+
+// NOLINTBEGIN(cert-dcl03-c, misc-static-assert, hicpp-static-assert,
+// cppcoreguidelines-avoid-magic-numbers)
+
+namespace {
+
+using namespace test_tools;
+
+std::vector<int64_t> naive_convolution(const std::vector<int64_t>& a, const std::vector<int64_t>& b) {
+    std::vector<int64_t> c(a.size() + b.size() - 1);
+    for (size_t i = 0; i < a.size(); i++) {
+        for (size_t j = 0; j < b.size(); j++) {
+            c[i + j] += a[i] * b[j];
+        }
+    }
+    return c;
+}
+
+void test_convolve_real_int() {
+    log_tests_started();
+
+    uint32_t seed = 0x5D1C2E97U;
+    const auto next = [&seed]() noexcept {
+        seed ^= seed << 13U;
+        seed ^= seed >> 17U;
+        seed ^= seed << 5U;
+        return seed;
+    };
+
+    // Sizes around the direct convolution threshold and the powers of two
+    for (const size_t a_size : {1U, 2U, 7U, 32U, 33U, 64U, 100U, 511U, 1000U}) {
+        for (const size_t b_size : {1U, 3U, 31U, 33U, 65U, 255U, 257U, 1500U}) {
+            std::vector<int64_t> a(a_size);
+            std::vector<int64_t> b(b_size);
+            for (int64_t& x : a) {
+                x = static_cast<int64_t>(next() % 20001U) - 10000;
+            }
+            for (int64_t& x : b) {
+                x = static_cast<int64_t>(next() % 20001U) - 10000;
+            }
+            const std::vector<int64_t> expected = naive_convolution(a, b);
+            for (const size_t threads : {1U, 4U}) {
+                std::vector<int64_t> c(expected.size(), -1);
+                fft::convolve_real(a.data(), a.size(), b.data(), b.size(), c.data(), threads);
+                assert(c == expected);
+            }
+        }
+    }
+
+    // Big sequences are split between the threads
+    constexpr size_t kBigSize = size_t{1} << 18U;
+    std::vector<int64_t> a(kBigSize);
+    std::vector<int64_t> b(kBigSize / 2 + 3);
+    for (int64_t& x : a) {
+        x = static_cast<int64_t>(next() % 1024U);
+    }
+    for (int64_t& x : b) {
+        x = static_cast<int64_t>(next() % 1024U);
+    }
+    std::vector<int64_t> one_thread(a.size() + b.size() - 1);
+    std::vector<int64_t> many_threads(one_thread.size());
+    fft::convolve_real(a.data(), a.size(), b.data(), b.size(), one_thread.data());
+    fft::convolve_real(a.data(), a.size(), b.data(), b.size(), many_threads.data(), 4);
+    assert(one_thread == many_threads);
+    // c_0 and c_{last} are the single products, c_k for small k are checked directly
+    for (size_t k = 0; k < 64; k++) {
+        int64_t expected = 0;
+        for (size_t i = 0; i <= k; i++) {
+            expected += a[i] * b[k - i];
+        }
+        assert(one_thread[k] == expected);
+    }
+    assert(one_thread.back() == a.back() * b.back());
+
+    // Empty sequences do not change the output
+    std::vector<int64_t> c{42};
+    fft::convolve_real(a.data(), 0, b.data(), b.size(), c.data());
+    assert(c.front() == 42);
+}
+
+void test_convolve_real_double() {
+    log_tests_started();
+
+    const std::vector<double> a{0.5, -1.25, 2.0, 0.0, 3.5, 1.0, -0.75, 4.0, 0.125, 2.5, -3.0, 1.5,
+                                0.5, -1.25, 2.0, 0.0, 3.5, 1.0, -0.75, 4.0, 0.125, 2.5, -3.0, 1.5,
+                                0.5, -1.25, 2.0, 0.0, 3.5, 1.0, -0.75, 4.0, 0.125, 2.5, -3.0, 1.5};
+    std::vector<double> b(50);
+    for (size_t i = 0; i < b.size(); i++) {
+        b[i] = std::sin(static_cast<double>(i));
+    }
+    std::vector<double> c(a.size() + b.size() - 1);
+    fft::convolve_real(a.data(), a.size(), b.data(), b.size(), c.data());
+    for (size_t k = 0; k < c.size(); k++) {
+        double expected = 0;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (k >= i && k - i < b.size()) {
+                expected += a[i] * b[k - i];
+            }
+        }
+        assert(std::abs(c[k] - expected) < 1e-9);
+    }
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+    std::vector<double> c_span(c.size());
+    fft::convolve_real(std::span<const double>{a}, std::span<const double>{b}, std::span<double>{c_span});
+    assert(c_span == c);
+
+    bool thrown = false;
+    try {
+        fft::convolve_real(std::span<const double>{a}, std::span<const double>{b},
+                           std::span<double>{c_span}.first(c.size() - 1));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+#endif
+}
+
+}  // namespace
+
+// NOLINTEND(cert-dcl03-c, misc-static-assert, hicpp-static-assert,
+// cppcoreguidelines-avoid-magic-numbers)
+
+int main() {
+    test_convolve_real_int();
+    test_convolve_real_double();
+}
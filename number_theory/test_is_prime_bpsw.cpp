@@ -308,6 +308,58 @@ void TestPrimesFromFile() {
     }
 }
 
+void TestU128PrimesFromFile() {
+    log_tests_started();
+
+    FilePtr fin("u128-primes.txt", "r");
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays)
+    char buffer[64] = {};
+    // NOLINTNEXTLINE(cert-err34-c)
+    while (std::fscanf(fin, "%63s", buffer) == 1) {
+        uint128_t p = 0;
+        for (const char* c = buffer; *c != '\0'; c++) {
+            assert('0' <= *c && *c <= '9');
+            p = p * 10 + static_cast<uint32_t>(*c - '0');
+        }
+        assert(is_prime_bpsw(p));
+        // One of p, p + 2 and p + 4 is divisible by 3
+        assert(!is_prime_bpsw(p + 2) || !is_prime_bpsw(p + 4));
+        if (p < (std::numeric_limits<uint128_t>::max() >> 32U)) {
+            assert(!is_prime_bpsw(p * 4294967291U));
+        }
+    }
+}
+
+void TestU128Numbers() noexcept {
+    log_tests_started();
+
+    for (uint32_t n = 0; n < std::numeric_limits<uint16_t>::max(); n++) {
+        assert(is_prime_bpsw(uint128_t{n}) == is_prime_bpsw(uint64_t{n}));
+    }
+
+    for (const uint32_t p : {89U, 107U, 127U}) {
+        const uint128_t mersenne = (uint128_t{1} << p) - 1;
+        assert(is_prime_bpsw(mersenne));
+        assert(!is_prime_bpsw(mersenne + 2));
+    }
+    for (const uint32_t p : {67U, 71U, 73U, 79U, 83U, 97U, 101U, 103U, 109U, 113U}) {
+        assert(!is_prime_bpsw((uint128_t{1} << p) - 1));
+    }
+
+    // Squares and products of two primes above 2^32
+    constexpr uint64_t kU32Primes[] = {4294967291U, 4294967279U, 4294967311U, 4294967357U};
+    for (const uint64_t p : kU32Primes) {
+        for (const uint64_t q : kU32Primes) {
+            assert(!is_prime_bpsw(uint128_t{p} * q * 65537));
+            assert(!is_prime_bpsw(uint128_t{p} * p * q));
+        }
+    }
+    constexpr uint64_t kMaxU64Prime = 18446744073709551557ULL;
+    assert(is_prime_bpsw(uint128_t{kMaxU64Prime}));
+    assert(!is_prime_bpsw(uint128_t{kMaxU64Prime} * kMaxU64Prime));
+    assert(is_prime_bpsw((uint128_t{1} << 64U) + 13));
+}
+
 #if defined(HAS_GMP_DURING_TESTING)
 
 void TestRandomPrimesGMP() noexcept {
@@ -406,6 +458,8 @@ int main() {
     TestMidPrimes();
     TestLargestU64Primes();
     TestPrimesFromFile();
+    TestU128PrimesFromFile();
+    TestU128Numbers();
 #if defined(HAS_GMP_DURING_TESTING)
     TestRandomPrimesGMP();
 #endif
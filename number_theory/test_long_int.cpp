@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <chrono>
@@ -5,11 +6,15 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "../misc/config_macros.hpp"
@@ -855,6 +860,1049 @@ void TestLongIntSquare() {
     AssertInvariants(m);
 }
 
+longint MakeLongIntWithDigits(const uint32_t digits_count, uint32_t seed) {
+    longint n;
+    for (uint32_t i = 0; i < digits_count; i++) {
+        // xorshift32, every digit is non-zero
+        seed ^= seed << 13U;
+        seed ^= seed >> 17U;
+        seed ^= seed << 5U;
+        n <<= longint::kDigitBits;
+        n += seed;
+    }
+    assert(n.usize() == digits_count);
+    return n;
+}
+
+longint SchoolbookMult(const longint& lhs, const longint& rhs) {
+    longint ans;
+    longint shifted_lhs;
+    for (size_t i = 0; i < rhs.usize(); i++) {
+        shifted_lhs = lhs;
+        shifted_lhs *= rhs[i];
+        shifted_lhs <<= static_cast<uint32_t>(i * longint::kDigitBits);
+        ans += shifted_lhs;
+    }
+    if (rhs.sign() < 0) {
+        ans.flip_sign();
+    }
+    return ans;
+}
+
+void TestLongIntMultNegativeIntermediates() {
+    test_tools::log_tests_started();
+
+    // Operands with the zero low digits, e.g. sums of the terms like (2^32 - 2^33) * 2^(32 j), make
+    // the Toom-3 interpolation differences negative with the lowest digits equal to zero
+    uint32_t seed = 0x9E3779B9U;
+    for (uint32_t m = 48; m <= 450; m += 17) {
+        for (const uint32_t zero_digits : {1U, m / 5, m / 3, m / 2}) {
+            longint lhs = MakeLongIntWithDigits(m - zero_digits, seed++);
+            lhs <<= zero_digits * longint::kDigitBits;
+            longint rhs = uint32_t{1};
+            rhs <<= (m - 1) * longint::kDigitBits;
+            for (uint32_t j = zero_digits; j + 1 < m; j += 1 + seed % 7) {
+                longint term = uint32_t{1};
+                term <<= longint::kDigitBits;
+                term -= longint{uint64_t{1} << 33U};
+                term <<= j * longint::kDigitBits;
+                rhs += term;
+            }
+            for (const bool negate : {false, true}) {
+                if (negate) {
+                    rhs.flip_sign();
+                }
+                const longint expected = SchoolbookMult(lhs, rhs);
+                longint prod = lhs;
+                prod *= rhs;
+                assert(prod == expected);
+                AssertInvariants(prod);
+                prod = rhs;
+                prod *= lhs;
+                assert(prod == expected);
+                AssertInvariants(prod);
+            }
+            const longint expected_square = SchoolbookMult(rhs, rhs);
+            rhs *= rhs;
+            assert(rhs == expected_square);
+            AssertInvariants(rhs);
+        }
+    }
+}
+
+void TestLongIntMultTiers() {
+    test_tools::log_tests_started();
+
+    // Sizes around the naive / Karatsuba / Toom-3 / FFT thresholds
+    constexpr std::array<uint32_t, 17> kSizes = {
+        1, 7, 31, 47, 48, 49, 64, 97, 128, 191, 192, 193, 255, 256, 257, 400, 600,
+    };
+
+    uint32_t seed = 0x2545F491U;
+    for (const uint32_t m : kSizes) {
+        for (const uint32_t k : kSizes) {
+            longint lhs = MakeLongIntWithDigits(m, seed++);
+            longint rhs = MakeLongIntWithDigits(k, seed++);
+            if ((seed & 2U) != 0) {
+                lhs.flip_sign();
+            }
+            const longint expected = SchoolbookMult(lhs, rhs);
+            longint prod = lhs;
+            prod *= rhs;
+            assert(prod == expected);
+            AssertInvariants(prod);
+        }
+
+        // All digits equal to 2^32 - 1 make every intermediate carry maximal
+        longint n = uint32_t{1};
+        n <<= m * longint::kDigitBits;
+        n -= uint32_t{1};
+        const longint expected = SchoolbookMult(n, n);
+        longint sq;
+        n.square_this_to(sq);
+        assert(sq == expected);
+        AssertInvariants(sq);
+        n *= n;
+        assert(n == expected);
+        AssertInvariants(n);
+    }
+}
+
+void TestLongIntMultPolicies() {
+    test_tools::log_tests_started();
+
+    uint32_t seed = 0x9E3779B9U;
+    for (const uint32_t size : {256U, 300U, 1000U, 4096U, 5000U}) {
+        const longint lhs = MakeLongIntWithDigits(size, seed++);
+        const longint rhs = MakeLongIntWithDigits(size / 2 + 256, seed++);
+
+        longint fft_prod = lhs;
+        fft_prod.multiply_inplace<longint::FFTMultPolicy>(rhs);
+        longint ntt_prod = lhs;
+        ntt_prod.multiply_inplace<longint::NTTMultPolicy>(rhs);
+        longint auto_prod = lhs;
+        auto_prod *= rhs;
+        assert(fft_prod == ntt_prod);
+        assert(auto_prod == ntt_prod);
+        AssertInvariants(ntt_prod);
+
+        longint fft_sq;
+        lhs.square_this_to<longint::FFTMultPolicy>(fft_sq);
+        longint ntt_sq;
+        lhs.square_this_to<longint::NTTMultPolicy>(ntt_sq);
+        assert(fft_sq == ntt_sq);
+        AssertInvariants(ntt_sq);
+    }
+
+    // (2^(32 n) - 1)^2 = 2^(64 n) - 2^(32 n + 1) + 1, big enough for the
+    //  FFT to use the high precision mode (and the AutoMultPolicy to use the NTT)
+    constexpr uint32_t n = 1U << 17U;
+    longint ones = uint32_t{1};
+    ones <<= n * longint::kDigitBits;
+    ones -= uint32_t{1};
+    // Borrow should propagate through all the zero digits
+    assert(ones.usize() == n);
+    assert(std::all_of(ones.begin(), ones.end(), [](const uint32_t digit) { return digit == ~uint32_t{0}; }));
+    longint expected = uint32_t{1};
+    expected <<= 2 * n * longint::kDigitBits;
+    longint middle = uint32_t{1};
+    middle <<= n * longint::kDigitBits + 1;
+    expected -= middle;
+    expected += uint32_t{1};
+
+    longint prod = ones;
+    prod.multiply_inplace<longint::NTTMultPolicy>(ones);
+    assert(prod == expected);
+    prod = ones;
+    prod *= ones;
+    assert(prod == expected);
+    ones.square_inplace<longint::NTTMultPolicy>();
+    assert(ones == expected);
+    AssertInvariants(ones);
+}
+
+void TestParallelFFTMult() {
+    test_tools::log_tests_started();
+
+    longint::set_max_fft_threads(4);
+    assert(longint::max_fft_threads() == 4);
+
+    uint32_t seed = 0x85EBCA6BU;
+    // Products of 2^15..2^16 digits (AutoMultPolicy uses FFT) and a bigger one (FFT in the high precision mode)
+    for (const auto& [m, k] : {std::pair{20'000U, 15'000U}, std::pair{32'768U, 32'768U}, std::pair{70'000U, 90'000U}}) {
+        const longint lhs = MakeLongIntWithDigits(m, seed++);
+        const longint rhs = MakeLongIntWithDigits(k, seed++);
+
+        longint ntt_prod = lhs;
+        ntt_prod.multiply_inplace<longint::NTTMultPolicy>(rhs);
+        longint fft_prod = lhs;
+        fft_prod.multiply_inplace<longint::FFTMultPolicy>(rhs);
+        assert(fft_prod == ntt_prod);
+        longint auto_prod = lhs;
+        auto_prod *= rhs;
+        assert(auto_prod == ntt_prod);
+        AssertInvariants(fft_prod);
+
+        longint ntt_sq;
+        lhs.square_this_to<longint::NTTMultPolicy>(ntt_sq);
+        longint fft_sq;
+        lhs.square_this_to<longint::FFTMultPolicy>(fft_sq);
+        assert(fft_sq == ntt_sq);
+        AssertInvariants(fft_sq);
+    }
+
+    longint::set_max_fft_threads(0);
+    assert(longint::max_fft_threads() == 1);
+}
+
+void TestFFTTablesMultiThread() {
+    test_tools::log_tests_started();
+
+    // Products of different sizes grow the FFT and NTT tables concurrently, the biggest ones are bigger than
+    // all products in the previous tests, so both tables are grown by several threads at once
+    constexpr uint32_t kSizes[] = {5'000, 140'000, 150'000, 200'000};
+    constexpr size_t kTotalThreads = std::size(kSizes);
+    std::vector<longint> lhs(kTotalThreads);
+    std::vector<longint> rhs(kTotalThreads);
+    for (size_t i = 0; i < kTotalThreads; i++) {
+        lhs[i] = MakeLongIntWithDigits(kSizes[i], static_cast<uint32_t>(0x165667B1U + i));
+        rhs[i] = MakeLongIntWithDigits(kSizes[i], static_cast<uint32_t>(0xD3A2646CU + i));
+    }
+
+    const auto multiply_concurrently = [&]([[maybe_unused]] auto mult_policy) {
+        using MultPolicy = decltype(mult_policy);
+        std::vector<longint> products(kTotalThreads);
+        std::vector<std::thread> threads;
+        threads.reserve(kTotalThreads);
+        for (size_t i = 0; i < kTotalThreads; i++) {
+            threads.emplace_back([&, i]() {
+                products[i] = lhs[i];
+                products[i].template multiply_inplace<MultPolicy>(rhs[i]);
+            });
+        }
+        for (auto&& thread : threads) {
+            thread.join();
+        }
+        return products;
+    };
+
+    // Neither of the tables is computed before the threads are started
+    const std::vector<longint> ntt_products = multiply_concurrently(longint::NTTMultPolicy{});
+    const std::vector<longint> fft_products = multiply_concurrently(longint::FFTMultPolicy{});
+    for (size_t i = 0; i < kTotalThreads; i++) {
+        assert(ntt_products[i] == fft_products[i]);
+        AssertInvariants(ntt_products[i]);
+        AssertInvariants(fft_products[i]);
+    }
+
+    // Tables are already computed, so this one is a no-op
+    longint::precompute_fft_tables(2 * kSizes[kTotalThreads - 1]);
+    longint prod = lhs.back();
+    prod.multiply_inplace<longint::FFTMultPolicy>(rhs.back());
+    assert(prod == ntt_products.back());
+    prod = lhs.back();
+    prod.multiply_inplace<longint::NTTMultPolicy>(rhs.back());
+    assert(prod == fft_products.back());
+}
+
+void TestPrecomputedMultiplier() {
+    test_tools::log_tests_started();
+
+    uint32_t seed = 0x27D4EB2FU;
+    for (const auto& [m, k] : {std::pair{300U, 300U}, std::pair{1'000U, 257U}, std::pair{4'096U, 12'000U},
+                               std::pair{32'768U, 32'768U}}) {
+        const longint multiplier_value = MakeLongIntWithDigits(m, seed++);
+        const longint::PrecomputedMultiplier multiplier{multiplier_value, k};
+        assert(multiplier.multiplier() == multiplier_value);
+
+        // The same multiplier is applied to several numbers, including a too big one,
+        // a too small one and the negative ones
+        for (const uint32_t other_size : {k, k / 2 + 1, k + 1, 10U}) {
+            for (const bool negate : {false, true}) {
+                longint other = MakeLongIntWithDigits(other_size, seed++);
+                if (negate) {
+                    other.flip_sign();
+                }
+
+                longint expected = other;
+                expected.multiply_inplace<longint::NTTMultPolicy>(multiplier_value);
+                other *= multiplier;
+                assert(other == expected);
+                AssertInvariants(other);
+            }
+        }
+    }
+
+    // All digits equal to 2^32 - 1: the biggest coefficients of the product
+    longint all_ones{1};
+    all_ones <<= 32 * 32'768U;
+    all_ones -= 1U;
+    const longint::PrecomputedMultiplier multiplier{all_ones, 32'768U};
+    longint expected = all_ones;
+    expected.multiply_inplace<longint::NTTMultPolicy>(all_ones);
+    longint prod = all_ones;
+    prod *= multiplier;
+    assert(prod == expected);
+    AssertInvariants(prod);
+}
+
+void TestFusedOps() {
+    test_tools::log_tests_started();
+
+    uint32_t seed = 0x9E3779B9U;
+    // Schoolbook, Karatsuba, Toom-3 and FFT sized operands
+    constexpr uint32_t kSizes[] = {0, 1, 2, 5, 47, 48, 200, 300};
+    for (const uint32_t m : kSizes) {
+        for (const uint32_t k : kSizes) {
+            for (const uint32_t acc_size : {0U, 1U, m + k, m + k + 3}) {
+                for (uint32_t signs = 0; signs < 8; signs++) {
+                    longint a = MakeLongIntWithDigits(m, seed++);
+                    longint b = MakeLongIntWithDigits(k, seed++);
+                    longint acc = MakeLongIntWithDigits(acc_size, seed++);
+                    if (signs & 1U) {
+                        a.flip_sign();
+                    }
+                    if (signs & 2U) {
+                        b.flip_sign();
+                    }
+                    if (signs & 4U) {
+                        acc.flip_sign();
+                    }
+
+                    const longint product = a * b;
+                    longint res = acc;
+                    res.addmul(a, b);
+                    assert(res == acc + product);
+                    AssertInvariants(res);
+                    res = acc;
+                    res.submul(a, b);
+                    assert(res == acc - product);
+                    AssertInvariants(res);
+
+                    // Result is zero
+                    res = product;
+                    res.submul(a, b);
+                    assert(res.is_zero());
+                    AssertInvariants(res);
+
+                    const uint32_t b_u32 = k == 0 ? 0 : b[0];
+                    res = acc;
+                    res.addmul(a, b_u32);
+                    assert(res == acc + a * longint{b_u32});
+                    AssertInvariants(res);
+                    res = acc;
+                    res.submul(a, b_u32);
+                    assert(res == acc - a * longint{b_u32});
+                    AssertInvariants(res);
+
+                    res = acc;
+                    res.square_add(a);
+                    assert(res == acc + a * a);
+                    AssertInvariants(res);
+
+                    res = acc;
+                    res.mul_add_u32(b_u32, 0xFFFFFFFFU);
+                    assert(res == acc * longint{b_u32} + longint{0xFFFFFFFFU});
+                    AssertInvariants(res);
+                }
+            }
+        }
+    }
+
+    // Operands may be the accumulator itself
+    for (const uint32_t m : kSizes) {
+        const longint a = MakeLongIntWithDigits(m, seed++);
+        longint res = a;
+        res.addmul(res, a);
+        assert(res == a + a * a);
+        res = a;
+        res.submul(a, res);
+        assert(res == a - a * a);
+        res = a;
+        res.addmul(res, res);
+        assert(res == a + a * a);
+        res = a;
+        res.square_add(res);
+        assert(res == a + a * a);
+        res = a;
+        res.submul(res, 3U);
+        assert(res == a - a * longint{3U});
+        AssertInvariants(res);
+    }
+}
+
+void TestInlineDigits() {
+    test_tools::log_tests_started();
+
+    const longint small = longint{static_cast<uint128_t>(-1)};
+    const longint big = MakeLongIntWithDigits(longint::kInlineDigitsCapacity + 1, 0x2545F491U);
+    assert(longint{}.capacity() == longint::kInlineDigitsCapacity);
+    assert(small.capacity() == longint::kInlineDigitsCapacity);
+
+    // All combinations of the inline and heap digits
+    for (const longint* const lhs_ptr : {&small, &big}) {
+        for (const longint* const rhs_ptr : {&small, &big}) {
+            const longint& lhs_value = *lhs_ptr;
+            const longint& rhs_value = *rhs_ptr;
+
+            longint lhs = lhs_value;
+            longint rhs = rhs_value;
+            lhs.swap(rhs);
+            assert(lhs == rhs_value && rhs == lhs_value);
+            AssertInvariants(lhs);
+            AssertInvariants(rhs);
+
+            longint moved = std::move(lhs);
+            assert(moved == rhs_value);
+            assert(lhs.is_zero());
+            AssertInvariants(lhs);
+            lhs = std::move(moved);
+            assert(lhs == rhs_value);
+
+            lhs = lhs_value;
+            const longint& lhs_ref = lhs;
+            lhs = lhs_ref;
+            assert(lhs == lhs_value);
+            lhs = rhs_value;
+            assert(lhs == rhs_value);
+            lhs += lhs_value;
+            assert(lhs == rhs_value + lhs_value);
+            AssertInvariants(lhs);
+        }
+    }
+
+    std::vector<longint> nums;
+    for (uint32_t i = 0; i < 100; i++) {
+        nums.emplace_back(i % 2 == 0 ? small : big);
+        nums.back() += i;
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        assert(nums[i] == (i % 2 == 0 ? small : big) + longint{i});
+    }
+}
+
+void TestBinaryFormat() {
+    test_tools::log_tests_started();
+
+    {
+        longint n = (uint128_t{1} << 64U) | 0x0102U;
+        n.flip_sign();
+        const std::vector<std::byte> binary = n.to_binary();
+        const std::vector<uint8_t> expected_bytes = {
+            'L', 'I', 'N', 'T', 0xFD, 0xFF, 0xFF, 0xFF, 0x02, 0x01, 0, 0, 0, 0, 0, 0, 0x01, 0, 0, 0,
+        };
+        assert(binary.size() == n.binary_size());
+        assert(binary.size() == expected_bytes.size());
+        for (size_t i = 0; i < binary.size(); i++) {
+            assert(std::to_integer<uint8_t>(binary[i]) == expected_bytes[i]);
+        }
+    }
+
+    uint32_t seed = 0x7FEB352DU;
+    std::vector<longint> nums = {longint{}, longint{1}, longint{-1}, longint{static_cast<uint128_t>(-1)}};
+    for (const uint32_t digits : {1U, 5U, 100U, 3'000U}) {
+        nums.push_back(MakeLongIntWithDigits(digits, seed++));
+        nums.push_back(MakeLongIntWithDigits(digits, seed++));
+        nums.back().flip_sign();
+    }
+
+    for (const longint& n : nums) {
+        const std::vector<std::byte> binary = n.to_binary();
+        const longint read = longint::from_binary(binary.data(), binary.size());
+        assert(read == n);
+        AssertInvariants(read);
+
+        const longint from_digits = longint::from_digits(n.begin(), n.usize(), n.is_negative());
+        assert(from_digits == n);
+        std::vector<longint::digit_t> digits_with_zeros(n.begin(), n.end());
+        digits_with_zeros.resize(digits_with_zeros.size() + 3);
+        longint from_digits_with_zeros;
+        from_digits_with_zeros.set_digits(digits_with_zeros.data(), digits_with_zeros.size(), n.is_negative());
+        assert(from_digits_with_zeros == n);
+        AssertInvariants(from_digits_with_zeros);
+
+        // Zero-copy view over the 4-byte aligned buffer
+        std::vector<uint32_t> aligned_storage((binary.size() + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+        std::memcpy(aligned_storage.data(), binary.data(), binary.size());
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        const auto* const aligned_binary = reinterpret_cast<const std::byte*>(aligned_storage.data());
+        const longint_view view = longint_view::from_binary(aligned_binary, binary.size());
+        assert(view == n);
+        assert(view.to_longint() == n);
+        assert(static_cast<const void*>(view.begin()) == aligned_binary + longint::kBinaryHeaderSize);
+        for (const uint32_t modulo : {1U, 2U, 3U, 1'000'000'007U, 0xFFFFFFFFU}) {
+            assert(view % modulo == n % modulo);
+        }
+    }
+
+    // Comparisons and products of the views
+    for (const longint& lhs : nums) {
+        for (const longint& rhs : nums) {
+            const longint_view lhs_view = lhs;
+            const longint_view rhs_view{rhs.begin(), rhs.usize(), rhs.is_negative()};
+            assert((lhs_view == rhs_view) == (lhs == rhs));
+            assert((lhs_view != rhs_view) == (lhs != rhs));
+            assert((lhs_view < rhs_view) == (lhs < rhs));
+            assert((lhs_view > rhs_view) == (lhs > rhs));
+            assert((lhs_view <= rhs_view) == (lhs <= rhs));
+            assert((lhs_view >= rhs_view) == (lhs >= rhs));
+
+            longint product;
+            product.assign_product(lhs_view, rhs_view);
+            assert(product == lhs * rhs);
+            AssertInvariants(product);
+            // Operands point to the digits of the product
+            product = lhs;
+            product.assign_product(product, rhs);
+            assert(product == lhs * rhs);
+        }
+    }
+
+    // Invalid binary data
+    const std::vector<std::byte> valid = nums.back().to_binary();
+    const auto assert_throws = [](std::vector<std::byte> binary) {
+        try {
+            std::ignore = longint::from_binary(binary.data(), binary.size());
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+    };
+    assert_throws({});
+    assert_throws(std::vector<std::byte>(valid.begin(), valid.end() - 1));
+    std::vector<std::byte> bad_magic = valid;
+    bad_magic[0] = std::byte{'l'};
+    assert_throws(bad_magic);
+    std::vector<std::byte> leading_zero = valid;
+    std::fill(leading_zero.end() - 4, leading_zero.end(), std::byte{0});
+    assert_throws(leading_zero);
+}
+
+void TestStringBases() {
+    test_tools::log_tests_started();
+
+    {
+        const longint n = (uint128_t{0xDEADBEEFU} << 64U) | 0x0123456789ABCDEFU;
+        assert(n.to_string(16) == "deadbeef0123456789abcdef");
+        assert(longint::from_string("DeadBeef0123456789ABCDEF", 16) == n);
+        assert(longint::from_string("-0000ff", 16) == -255);
+        assert(longint{-5}.to_string(2) == "-101");
+        assert(longint{}.to_string(7) == "0");
+        assert(longint::from_string("-0", 36) == 0);
+        assert(longint::from_string("zz", 36) == 36 * 36 - 1);
+        assert(longint{35}.to_string(36) == "z");
+        assert(longint{uint64_t{1} << 40U}.to_string(32) == "100000000");
+        assert(longint{uint64_t{1} << 40U}.to_string(8) == "20000000000000");
+    }
+
+    uint32_t seed = 0x2C1B3C6DU;
+    std::vector<longint> nums = {longint{1}, longint{-1}, longint{static_cast<uint128_t>(-1)}};
+    for (const uint32_t digits : {1U, 4U, 33U, 100U, 1'000U}) {
+        nums.push_back(MakeLongIntWithDigits(digits, seed++));
+        nums.push_back(MakeLongIntWithDigits(digits, seed++));
+        nums.back().flip_sign();
+    }
+    // Powers of the chunk bases are the edge cases of the divide and conquer
+    longint pow = 3U;
+    pow.pow(20 * 16 * 4);
+    nums.push_back(pow);
+    pow -= 1U;
+    nums.push_back(pow);
+
+    for (const longint& n : nums) {
+        for (uint32_t base = 2; base <= 36; base++) {
+            const std::string s = n.to_string(base);
+            assert(s.front() != '0');
+            assert(longint::from_string(s, base) == n);
+            AssertInvariants(longint::from_string(s, base));
+        }
+        assert(n.to_string(10) == n.to_string());
+        // Reference conversion for the base that is not a power of two
+        std::string base3_digits;
+        longint abs_n = n;
+        if (abs_n.is_negative()) {
+            abs_n.flip_sign();
+        }
+        while (!abs_n.is_zero()) {
+            base3_digits.push_back(static_cast<char>('0' + abs_n % 3U));
+            abs_n /= 3U;
+        }
+        std::reverse(base3_digits.begin(), base3_digits.end());
+        assert(n.to_string(3) == (n.is_negative() ? "-" : "") + base3_digits);
+    }
+
+    const auto assert_throws = [](const std::string_view s, const uint32_t base) {
+        try {
+            std::ignore = longint::from_string(s, base);
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            // Message names the base, not only the decimal string
+            assert(std::string_view{e.what()}.find("base " + std::to_string(base)) != std::string_view::npos);
+        }
+    };
+    assert_throws("", 16);
+    assert_throws("-", 16);
+    assert_throws("12g", 16);
+    assert_throws("102", 2);
+    assert_throws("1 2", 7);
+    assert_throws("+1", 7);
+    assert_throws("1", 1);
+    assert_throws("1", 37);
+    try {
+        std::ignore = longint{1}.to_string(0);
+        assert(false);
+    } catch (const std::invalid_argument&) {
+    }
+}
+
+longint NaiveGcd(longint a, longint b) {
+    if (a.is_negative()) {
+        a.flip_sign();
+    }
+    if (b.is_negative()) {
+        b.flip_sign();
+    }
+    longint r;
+    while (!b.is_zero()) {
+        a.divmod(b, r);
+        a.swap(b);
+        b.swap(r);
+    }
+    return a;
+}
+
+void CheckGcd(const longint& a, const longint& b) {
+    const longint g = longint::gcd(a, b);
+    AssertInvariants(g);
+    assert(g == NaiveGcd(a, b));
+    assert(longint::gcd(b, a) == g);
+
+    const longint::ExtendedGcdResult res = longint::extended_gcd(a, b);
+    AssertInvariants(res.u_value);
+    AssertInvariants(res.v_value);
+    assert(res.gcd_value == g);
+    longint check = a * res.u_value;
+    check.addmul(b, res.v_value);
+    assert(check == g);
+    if (!b.is_zero()) {
+        longint b_div_g = b;
+        if (b_div_g.is_negative()) {
+            b_div_g.flip_sign();
+        }
+        b_div_g /= g;
+        assert(!res.u_value.is_negative() && res.u_value < b_div_g);
+    }
+}
+
+void TestGcd() {
+    test_tools::log_tests_started();
+
+    assert(longint::gcd(longint{}, longint{}) == 0);
+    assert(longint::gcd(longint{-12}, longint{}) == 12);
+    assert(longint::gcd(longint{-12}, longint{18}) == 6);
+    assert(longint::extended_gcd(longint{-7}, longint{}).u_value == -1);
+    assert(longint::extended_gcd(longint{}, longint{-7}).gcd_value == 7);
+    CheckGcd(longint{240}, longint{46});
+    CheckGcd(longint{-240}, longint{46});
+    CheckGcd(longint{240}, longint{-46});
+    CheckGcd(longint{static_cast<uint128_t>(-1)}, longint{uint64_t{1} << 63U});
+
+    // Consecutive Fibonacci numbers are the worst case of the Euclid algorithm
+    {
+        longint f0{1};
+        longint f1{1};
+        for (uint32_t i = 0; i < 3000; i++) {
+            f0 += f1;
+            f0.swap(f1);
+        }
+        CheckGcd(f1, f0);
+    }
+
+    uint32_t seed = 0x5A17C0DEU;
+    for (const uint32_t digits : {1U, 2U, 3U, 8U, 50U, 300U, 700U, 1'500U}) {
+        for (const uint32_t common_digits : {0U, 1U, digits / 2 + 1}) {
+            const longint common = common_digits == 0 ? longint{1} : MakeLongIntWithDigits(common_digits, seed++);
+            const longint a = MakeLongIntWithDigits(digits, seed++) * common;
+            const uint32_t b_digits = digits + seed % 3;
+            longint b = MakeLongIntWithDigits(b_digits, seed++) * common;
+            CheckGcd(a, b);
+            b.flip_sign();
+            CheckGcd(a, b);
+            CheckGcd(a, a);
+        }
+    }
+
+    const longint p = longint::from_string("170141183460469231731687303715884105727");  // 2^127 - 1
+    for (const int32_t value : {1, 2, -3, 1'000'000'007}) {
+        const longint inv = longint::inv_mod(longint{value}, p);
+        longint prod = inv * longint{value};
+        if (prod.is_negative()) {
+            prod += p * longint{-value};
+        }
+        longint rem;
+        prod.divmod(p, rem);
+        assert(rem == 1);
+        assert(!inv.is_negative() && inv < p);
+    }
+    assert(longint::inv_mod(longint{6}, longint{9}) == 0);
+    assert(longint::inv_mod(longint{-1}, longint{1}) == 0);
+    try {
+        std::ignore = longint::inv_mod(longint{1}, longint{-5});
+        assert(false);
+    } catch (const std::invalid_argument&) {
+    }
+}
+
+longint NaivePowMod(const longint& base, const longint& exp, const longint& mod) {
+    const auto reduce = [&mod](longint& x) {
+        longint rem;
+        x.divmod(mod, rem);
+        x = std::move(rem);
+    };
+    longint b = base;
+    reduce(b);
+    longint res = uint32_t{1};
+    reduce(res);
+    for (size_t i = exp.usize() * longint::kDigitBits; i > 0; i--) {
+        res *= res;
+        reduce(res);
+        if ((exp[(i - 1) / longint::kDigitBits] >> ((i - 1) % longint::kDigitBits)) & 1U) {
+            res *= b;
+            reduce(res);
+        }
+    }
+    return res;
+}
+
+void TestPowMod() {
+    test_tools::log_tests_started();
+
+    assert(longint{3}.pow_mod(longint{200}, longint{1'000'000'007}) ==
+           math_functions::bin_pow_mod(uint64_t{3}, uint64_t{200}, uint64_t{1'000'000'007}));
+    assert(longint{-2}.pow_mod(longint{3}, longint{10}) == 2);
+    assert(longint{-2}.pow_mod(longint{3}, longint{9}) == 1);
+    assert(longint{5}.pow_mod(longint{}, longint{7}) == 1);
+    assert(longint{5}.pow_mod(longint{}, longint{1}) == 0);
+    assert(longint{}.pow_mod(longint{5}, longint{7}) == 0);
+    assert(longint{}.pow_mod(longint{}, longint{8}) == 1);
+
+    // Fermat's little theorem for the Mersenne primes below and above the Montgomery threshold
+    for (const uint32_t p : {127U, 521U, 4423U}) {
+        longint mod = uint32_t{1};
+        mod <<= p;
+        mod -= uint32_t{1};
+        longint exp = mod;
+        exp -= uint32_t{1};
+        for (const int32_t base : {2, 3, -5, 1'000'000'007}) {
+            assert(longint{base}.pow_mod(exp, mod) == 1);
+        }
+    }
+
+    uint32_t seed = 0x3B1D5E7FU;
+    for (const uint32_t mod_digits : {1U, 2U, 3U, 8U, 17U, 130U}) {
+        for (const bool odd : {true, false}) {
+            longint mod = MakeLongIntWithDigits(mod_digits, seed++);
+            if (odd != ((mod[0] & 1U) != 0)) {
+                mod += uint32_t{1};
+            }
+            const longint base = MakeLongIntWithDigits(mod_digits + 1, seed++);
+            longint neg_base = base;
+            neg_base.flip_sign();
+            longint base_rem;
+            longint(base).divmod(mod, base_rem);
+            for (const uint32_t exp_digits : {1U, 3U, 24U}) {
+                const longint exp = MakeLongIntWithDigits(exp_digits, seed++);
+                const longint expected = NaivePowMod(base, exp, mod);
+                longint res = base;
+                res.pow_mod(exp, mod);
+                AssertInvariants(res);
+                assert(res == expected);
+
+                const longint neg_expected = NaivePowMod(mod - base_rem, exp, mod);
+                res = neg_base;
+                res.pow_mod(exp, mod);
+                assert(res == neg_expected);
+                if (odd) {
+                    const longint::MontgomeryContext ctx{mod};
+                    assert(ctx.pow_mod(base, exp) == expected);
+                    assert(ctx.pow_mod(neg_base, exp) == neg_expected);
+                }
+            }
+        }
+    }
+
+    const auto assert_throws = [](auto&& f) {
+        try {
+            f();
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+    };
+    assert_throws([] { std::ignore = longint{2}.pow_mod(longint{3}, longint{}); });
+    assert_throws([] { std::ignore = longint{2}.pow_mod(longint{3}, longint{-7}); });
+    assert_throws([] { std::ignore = longint{2}.pow_mod(longint{-3}, longint{7}); });
+    assert_throws([] { std::ignore = longint::MontgomeryContext{longint{8}}; });
+    assert_throws([] { std::ignore = longint::MontgomeryContext{longint{-7}}; });
+    assert_throws([] { std::ignore = longint::MontgomeryContext{longint{7}}.pow_mod(longint{2}, longint{-1}); });
+}
+
+void CheckRoot(const longint& n, const uint32_t k) {
+    const longint root = longint::iroot(n, k);
+    AssertInvariants(root);
+    longint abs_n = n;
+    longint abs_root = root;
+    if (n.is_negative()) {
+        assert(root.sign() <= 0);
+        abs_n.flip_sign();
+        abs_root.flip_sign();
+    }
+    longint root_pow = abs_root;
+    root_pow.pow(k);
+    assert(root_pow <= abs_n);
+    root_pow = abs_root;
+    root_pow += uint32_t{1};
+    root_pow.pow(k);
+    assert(root_pow > abs_n);
+}
+
+void TestRoots() {
+    test_tools::log_tests_started();
+
+    for (const uint64_t n : {uint64_t{0}, uint64_t{1}, uint64_t{2}, uint64_t{15}, uint64_t{16}, uint64_t{17},
+                             uint64_t{1} << 32U, (uint64_t{1} << 32U) - 1, std::numeric_limits<uint64_t>::max()}) {
+        assert(longint::isqrt(longint{n}) == math_functions::isqrt(n));
+        assert(longint::iroot(longint{n}, 3) == math_functions::icbrt(n));
+        assert(longint::is_perfect_square(longint{n}).is_perfect_square ==
+               math_functions::is_perfect_square(n).is_perfect_square);
+    }
+    assert(longint::iroot(longint{-27}, 3) == -3);
+    assert(longint::iroot(longint{-28}, 3) == -3);
+    assert(longint::iroot(longint{12345}, 1) == 12345);
+    assert(longint::isqrt(longint{static_cast<uint128_t>(-1)}) == std::numeric_limits<uint64_t>::max());
+
+    uint32_t seed = 0x7E3A9C15U;
+    for (const uint32_t digits : {3U, 4U, 7U, 40U, 300U, 3'000U}) {
+        const longint n = MakeLongIntWithDigits(digits, seed++);
+        for (const uint32_t k : {2U, 3U, 4U, 5U, 7U, 31U, 64U, 200U, 100'000U}) {
+            CheckRoot(n, k);
+            if (k % 2 != 0) {
+                longint neg_n = n;
+                neg_n.flip_sign();
+                CheckRoot(neg_n, k);
+            }
+        }
+
+        // Exact powers and their neighbours
+        const longint r = MakeLongIntWithDigits(digits, seed++);
+        for (const uint32_t k : {2U, 3U, 5U}) {
+            longint p = r;
+            p.pow(k);
+            assert(longint::iroot(p, k) == r);
+            p -= uint32_t{1};
+            assert(longint::iroot(p, k) == r - longint{1});
+        }
+
+        longint sq = r;
+        sq *= r;
+        const auto res = longint::is_perfect_square(sq);
+        assert(res.is_perfect_square && res.root == r);
+        for (const uint32_t delta : {1U, 2U, 4U}) {
+            sq += delta;
+            assert(!longint::is_perfect_square(sq).is_perfect_square);
+            sq -= delta;
+        }
+        sq.flip_sign();
+        assert(!longint::is_perfect_square(sq).is_perfect_square);
+    }
+
+    const auto assert_throws = [](const longint& n, const uint32_t k) {
+        try {
+            std::ignore = longint::iroot(n, k);
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+    };
+    assert_throws(longint{-4}, 2);
+    assert_throws(longint{4}, 0);
+    try {
+        std::ignore = longint::isqrt(longint{-1});
+        assert(false);
+    } catch (const std::invalid_argument&) {
+    }
+}
+
+void TestProductTree() {
+    test_tools::log_tests_started();
+
+    {
+        const std::vector<uint32_t> empty;
+        assert(longint::product(empty.begin(), empty.end()) == 1);
+        const std::vector<int32_t> signed_values = {-2, 3, -5, 7, -11};
+        assert(longint::product(signed_values.begin(), signed_values.end()) == -2310);
+        const std::vector<uint16_t> with_zero = {2, 0, 5};
+        assert(longint::product(with_zero.begin(), with_zero.end()) == 0);
+    }
+
+    uint32_t seed = 0x1F2E3D4CU;
+    for (const uint32_t count : {1U, 2U, 17U, 500U, 5'000U}) {
+        std::vector<uint32_t> values(count);
+        for (uint32_t& value : values) {
+            seed ^= seed << 13U;
+            seed ^= seed >> 17U;
+            seed ^= seed << 5U;
+            value = seed;
+        }
+        longint expected = uint32_t{1};
+        for (const uint32_t value : values) {
+            expected *= value;
+        }
+        for (const std::size_t threads : {std::size_t{1}, std::size_t{3}, std::size_t{8}}) {
+            const longint prod = longint::product(values.begin(), values.end(), threads);
+            AssertInvariants(prod);
+            assert(prod == expected);
+        }
+    }
+    {
+        std::vector<longint> nums;
+        longint expected = uint32_t{1};
+        for (const uint32_t digits : {1U, 100U, 3U, 700U, 20U}) {
+            nums.push_back(MakeLongIntWithDigits(digits, seed++));
+            expected *= nums.back();
+        }
+        assert(longint::product(nums.begin(), nums.end()) == expected);
+    }
+
+    longint expected_factorial = uint32_t{1};
+    for (uint32_t n = 0; n <= 3'000; n++) {
+        if (n > 0) {
+            expected_factorial *= n;
+        }
+        if (n <= 300 || n % 97 == 0 || n == 3'000) {
+            const longint f = longint::factorial(n);
+            AssertInvariants(f);
+            assert(f == expected_factorial);
+        }
+    }
+    assert(longint::factorial(3'000, /* max_threads = */ 4) == expected_factorial);
+
+    // Pascal's triangle
+    std::vector<longint> row = {longint{1}};
+    for (uint32_t n = 1; n <= 400; n++) {
+        std::vector<longint> next_row(n + 1);
+        next_row[0] = 1;
+        next_row[n] = 1;
+        for (uint32_t k = 1; k < n; k++) {
+            next_row[k] = row[k - 1];
+            next_row[k] += row[k];
+        }
+        row.swap(next_row);
+        if (n <= 64 || n % 37 == 0 || n == 400) {
+            for (uint32_t k = 0; k <= n; k++) {
+                assert(longint::binomial(n, k) == row[k]);
+            }
+            assert(longint::binomial(n, n + 1) == 0);
+        }
+    }
+    assert(longint::binomial(0, 0) == 1);
+    // C(2n, n) = (2n)! / (n!)^2
+    longint central = longint::factorial(20'000);
+    central /= longint::factorial(10'000).square_inplace();
+    assert(longint::binomial(20'000, 10'000) == central);
+}
+
+void TestCarryKernels() {
+    test_tools::log_tests_started();
+
+    using longint_detail::carry_kernels;
+    const carry_kernels::kernels_table& kernels = carry_kernels::kernels();
+    constexpr carry_kernels::kernels_table kDefaultKernels = carry_kernels::default_kernels();
+
+    uint32_t seed = 0x6C8E9CF5U;
+    const auto next = [&seed]() noexcept {
+        seed ^= seed << 13U;
+        seed ^= seed >> 17U;
+        seed ^= seed << 5U;
+        return seed;
+    };
+    for (uint32_t n = 1; n <= 80; n++) {
+        std::vector<uint32_t> lhs(n);
+        std::vector<uint32_t> rhs(n);
+        for (uint32_t i = 0; i < n; i++) {
+            lhs[i] = next();
+            // Long carry and borrow chains
+            rhs[i] = i % 7 == 3 ? next() : (i % 2 == 0 ? 0U : std::numeric_limits<uint32_t>::max());
+        }
+
+        std::vector<uint32_t> expected = lhs;
+        std::vector<uint32_t> actual = lhs;
+        assert(kernels.add_n(actual.data(), rhs.data(), n) ==
+               kDefaultKernels.add_n(expected.data(), rhs.data(), n));
+        assert(actual == expected);
+        assert(kernels.sub_n(actual.data(), rhs.data(), n) ==
+               kDefaultKernels.sub_n(expected.data(), rhs.data(), n));
+        assert(actual == lhs && expected == lhs);
+        assert(kernels.sub_n(actual.data(), lhs.data(), n) == false);
+        assert(std::all_of(actual.begin(), actual.end(), [](const uint32_t digit) { return digit == 0; }));
+
+        for (uint32_t shift = 1; shift < 32; shift++) {
+            expected = lhs;
+            actual = lhs;
+            kernels.shift_left(actual.data(), n, shift);
+            kDefaultKernels.shift_left(expected.data(), n, shift);
+            assert(actual == expected);
+            kernels.shift_right(actual.data(), n, shift);
+            kDefaultKernels.shift_right(expected.data(), n, shift);
+            assert(actual == expected);
+        }
+    }
+}
+
+void TestParallelSetString() {
+    test_tools::log_tests_started();
+
+    uint32_t seed = 0x2F6B91C3U;
+    const auto next_char = [&seed]() noexcept {
+        seed ^= seed << 13U;
+        seed ^= seed >> 17U;
+        seed ^= seed << 5U;
+        return static_cast<char>('0' + seed % 10);
+    };
+
+    using longint_detail::dec_str_kernels;
+    for (uint32_t blocks = 1; blocks <= 19; blocks++) {
+        std::string str(blocks * dec_str_kernels::kBlockDigits, '0');
+        std::generate(str.begin(), str.end(), next_char);
+        std::vector<uint32_t> expected(blocks);
+        std::vector<uint32_t> actual(blocks);
+        const auto* const chars = reinterpret_cast<const unsigned char*>(str.data());
+        dec_str_kernels::pack_default(chars, blocks, expected.data() + blocks);
+        dec_str_kernels::pack()(chars, blocks, actual.data() + blocks);
+        assert(actual == expected);
+    }
+
+    // Sizes below and above the longint::kMinParallelDecStrConvDigits base 10^9 digits
+    std::string str;
+    std::string buffer;
+    longint one_thread;
+    longint many_threads;
+    for (const size_t length : {40U, 1000U, 18000U, 36865U, 150001U, 1200000U}) {
+        str.resize(length);
+        std::generate(str.begin(), str.end(), next_char);
+        str.front() = '3';
+
+        longint::set_max_fft_threads(1);
+        one_thread.set_string(str);
+        for (const size_t threads : {2U, 3U, 8U}) {
+            longint::set_max_fft_threads(threads);
+            many_threads.set_string(str);
+            assert(many_threads == one_thread);
+            AssertInvariants(many_threads);
+        }
+        longint::set_max_fft_threads(1);
+        one_thread.to_string(buffer);
+        assert(buffer == str);
+    }
+}
+
 void TestUIntMult() {
     test_tools::log_tests_started();
 
@@ -1167,6 +2215,22 @@ void TestLongIntAddAndSub() {
             AssertInvariants(n);
         }
     }
+
+    // Negative differences with the lowest digits equal to zero
+    for (uint32_t shift = 32; shift < 128; shift += 16) {
+        longint expected = uint128_t{2} << shift;
+        expected.flip_sign();
+        n = uint128_t{1} << shift;
+        m = uint128_t{3} << shift;
+        n -= m;
+        assert(n == expected);
+        AssertInvariants(n);
+        n = uint128_t{1} << shift;
+        m.flip_sign();
+        n += m;
+        assert(n == expected);
+        AssertInvariants(n);
+    }
 }
 
 void AssertAllNumsSet(const longint& n, const size_t expected_set_nums_count) noexcept {
@@ -1308,6 +2372,57 @@ void TestToString() {
     AssertInvariants(n);
 }
 
+void TestToStringDivConq() {
+    test_tools::log_tests_started();
+
+    // Decimal lengths around the P_17 = 10^{9 * 2^17} (the top split of the 10^{1179648} is
+    //  by the divisor of the same length) and above the longint::kDecimalToStringThreshold
+    //  digits (~2.5 * 10^6 decimal digits, converted by the Decimal)
+    uint32_t seed = 0x68E31DA4U;
+    std::string expected;
+    std::string buffer;
+    longint n;
+    for (const size_t length : {20U, 39U, 300U, 2999U, 9999U, 19700U, 19729U, 19730U, 40000U, 1'179'648U, 1'179'649U,
+                                1'300'000U, 2'600'000U}) {
+        expected.clear();
+        for (size_t i = 0; i < length; i++) {
+            seed ^= seed << 13U;
+            seed ^= seed >> 17U;
+            seed ^= seed << 5U;
+            // Long runs of zeros check the padding of the lower halves
+            const bool zeros_run = (i / 1000) % 3 == 1;
+            expected.push_back(zeros_run ? '0' : static_cast<char>('0' + seed % 10));
+        }
+        expected.front() = '7';
+
+        n.set_string(expected);
+        n.to_string(buffer);
+        assert(buffer == expected);
+        AssertInvariants(n);
+
+        // 10^{length - 1}
+        std::fill(expected.begin() + 1, expected.end(), '0');
+        expected.front() = '1';
+        n.set_string(expected);
+        n.to_string(buffer);
+        assert(buffer == expected);
+
+        // 10^{length - 1} - 1
+        n -= uint32_t{1};
+        n.flip_sign();
+        buffer = "prefix ";
+        n.append_to_string(buffer);
+        assert(buffer.size() == std::string_view{"prefix -"}.size() + length - 1);
+        assert(std::string_view{buffer}.substr(0, 8) == "prefix -");
+        assert(std::all_of(buffer.begin() + 8, buffer.end(), [](const char c) { return c == '9'; }));
+    }
+
+    n = 0;
+    buffer = "prefix ";
+    n.append_to_string(buffer);
+    assert(buffer == "prefix 0");
+}
+
 void TestBitShifts() {
     test_tools::log_tests_started();
     static constexpr uint32_t k = 5000;
@@ -1876,6 +2991,167 @@ void TestDivMod() {
     }
 }
 
+void TestDivModTiers() {
+    test_tools::log_tests_started();
+
+    // Divisor sizes around the schoolbook / Burnikel-Ziegler / Newton thresholds
+    constexpr std::array<uint32_t, 9> kDivisorSizes = {
+        2, 127, 128, 129, 257, 640, 1500, 4096, 4500,
+    };
+
+    uint32_t seed = 0x1B873593U;
+    const auto check_divmod = [](const longint& quot, const longint& divisor, const longint& rem) {
+        // |a| = |quot| * |divisor| + rem, 0 <= rem < |divisor|
+        longint dividend = quot * divisor;
+        if (dividend.is_negative()) {
+            dividend -= rem;
+        } else {
+            dividend += rem;
+        }
+
+        longint q = dividend;
+        longint r;
+        q.divmod(divisor, r);
+        assert(q == quot);
+        assert(r == rem);
+        AssertInvariants(q);
+        AssertInvariants(r);
+
+        const longint::Reciprocal reciprocal{divisor};
+        q = dividend;
+        q.divmod(reciprocal, r);
+        assert(q == quot);
+        assert(r == rem);
+        AssertInvariants(q);
+        AssertInvariants(r);
+    };
+
+    for (const uint32_t n : kDivisorSizes) {
+        for (const uint32_t quot_size : {1U, 127U, 128U, 300U, 8 * n + 3}) {
+            longint divisor = MakeLongIntWithDigits(n, seed++);
+            longint quot = MakeLongIntWithDigits(quot_size, seed++);
+            longint rem = MakeLongIntWithDigits(n - 1, seed++);
+            check_divmod(quot, divisor, rem);
+
+            // Divisor with the smallest possible highest digit needs the biggest normalization shift
+            divisor = uint32_t{1};
+            divisor <<= (n - 1) * longint::kDigitBits;
+            divisor += MakeLongIntWithDigits(n / 2, seed++);
+            quot.flip_sign();
+            rem = MakeLongIntWithDigits(n - 1, seed++);
+            check_divmod(quot, divisor, rem);
+
+            // All digits equal to 2^32 - 1 make the quotient digits estimates maximal
+            divisor = uint32_t{1};
+            divisor <<= n * longint::kDigitBits;
+            divisor -= uint32_t{1};
+            rem = divisor;
+            rem -= uint32_t{1};
+            quot = uint32_t{1};
+            quot <<= quot_size * longint::kDigitBits;
+            quot -= uint32_t{1};
+            check_divmod(quot, divisor, rem);
+            divisor.flip_sign();
+            quot.flip_sign();
+            check_divmod(quot, divisor, rem);
+        }
+    }
+
+    // Reciprocal is reused by many divisions
+    const longint divisor = MakeLongIntWithDigits(1100, seed++);
+    const longint::Reciprocal reciprocal{divisor};
+    assert(reciprocal.divisor() == divisor);
+    longint n = MakeLongIntWithDigits(3000, seed++);
+    for (uint32_t i = 0; i < 16; i++) {
+        longint q = n;
+        longint r;
+        q.divmod(reciprocal, r);
+        longint expected_q = n;
+        longint expected_r;
+        expected_q.divmod(divisor, expected_r);
+        assert(q == expected_q);
+        assert(r == expected_r);
+        n *= uint32_t{0x9E3779B9U};
+        n += i;
+    }
+}
+
+
+// Same condition as for the HAS_CUSTOM_LONGINT_ALLOCATOR in the longint.hpp
+#if CONFIG_COMPILER_ID == CONFIG_GCC_COMPILER_ID || CONFIG_COMPILER_ID == CONFIG_CLANG_COMPILER_ID || \
+    CONFIG_COMPILER_ID == CONFIG_CLANG_CL_COMPILER_ID
+
+void TestAllocatorMultiThread() {
+    const longint_allocator::AllocatorStats stats_before = longint_allocator::GetStats();
+
+    constexpr size_t kTotalThreads = 4;
+    constexpr size_t kIterations = 20'000;
+    constexpr size_t kLiveBlocks = 48;
+
+    std::vector<std::thread> threads;
+    threads.reserve(kTotalThreads);
+    for (size_t i = 0; i < kTotalThreads; i++) {
+        threads.emplace_back([thread_id = i]() {
+            // More blocks than pages in the pools, so that both the pages and the heap are used
+            std::array<std::pair<std::byte*, size_t>, kLiveBlocks> blocks{};
+            const auto fill_value = static_cast<std::byte>(thread_id + 1);
+            for (size_t iter = 0; iter < kIterations; iter++) {
+                auto& [block, block_size] = blocks[(iter * 7 + thread_id) % kLiveBlocks];
+                if (block != nullptr) {
+                    for (size_t j = 0; j < block_size; j++) {
+                        assert(block[j] == fill_value);
+                    }
+                    longint_allocator::Deallocate(block);
+                }
+                constexpr size_t kSizes[] = {8, 64, 120, 121, 500, 1016, 1017, 4000};
+                block_size = kSizes[(iter + thread_id) % std::size(kSizes)];
+                block = static_cast<std::byte*>(longint_allocator::Allocate(block_size));
+                std::fill_n(block, block_size, fill_value);
+            }
+            for (auto& [block, block_size] : blocks) {
+                longint_allocator::Deallocate(block);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    const longint_allocator::AllocatorStats stats = longint_allocator::GetStats();
+    assert(stats.total_small_pages > 0);
+    assert(stats.total_middle_pages > 0);
+    assert(stats.small_pages_rented > stats_before.small_pages_rented);
+    assert(stats.middle_pages_rented > stats_before.middle_pages_rented);
+    assert(stats.heap_allocations > stats_before.heap_allocations);
+    assert(stats.small_pages_in_use == stats_before.small_pages_in_use);
+    assert(stats.middle_pages_in_use == stats_before.middle_pages_in_use);
+    assert(stats.heap_allocations_in_use == stats_before.heap_allocations_in_use);
+    assert(stats.max_small_pages_in_use <= stats.total_small_pages);
+    assert(stats.max_middle_pages_in_use <= stats.total_middle_pages);
+    // Pools are already in use
+    assert(!longint_allocator::SetPoolSizes(1, 1));
+}
+
+#if defined(LONGINT_USE_CUSTOM_ALLOCATOR)
+
+void TestLongIntUsesCustomAllocator() {
+    const longint_allocator::AllocatorStats stats_before = longint_allocator::GetStats();
+    {
+        // 20 digits do not fit into the inline storage but fit into the small page
+        longint n;
+        n.reserve(20);
+        assert(n.capacity() >= 20);
+        const longint_allocator::AllocatorStats stats = longint_allocator::GetStats();
+        assert(stats.small_pages_rented > stats_before.small_pages_rented);
+        assert(stats.small_pages_in_use > stats_before.small_pages_in_use);
+    }
+    assert(longint_allocator::GetStats().small_pages_in_use == stats_before.small_pages_in_use);
+}
+
+#endif
+
+#endif
+
 }  // namespace
 
 // clang-format off
@@ -1884,7 +3160,13 @@ void TestDivMod() {
 
 // NOLINTNEXTLINE(bugprone-exception-escape)
 int main() {
+#if defined(LONGINT_USE_CUSTOM_ALLOCATOR)
+    // Pages held by the static caches of the longint are never returned, so the pools are bigger than by default
+    [[maybe_unused]] const bool pools_resized = longint_allocator::SetPoolSizes(256, 64);
+    assert(pools_resized);
+#endif
     TestSemantic();
+    TestInlineDigits();
     TestOperatorEqualsInt();
     TestToIntTypes();
     TestUIntMult();
@@ -1893,11 +3175,35 @@ int main() {
     TestLongIntAddAndSub();
     TestLongIntMult();
     TestLongIntSquare();
+    TestLongIntMultNegativeIntermediates();
+    TestLongIntMultTiers();
+    TestLongIntMultPolicies();
+    TestParallelFFTMult();
+    TestFFTTablesMultiThread();
+    TestPrecomputedMultiplier();
+    TestFusedOps();
     TestDivMod();
+    TestDivModTiers();
     TestBitShifts();
     TestDecimal();
     TestSetString();
     TestToString();
+    TestToStringDivConq();
+    TestBinaryFormat();
+    TestStringBases();
+    TestGcd();
+    TestPowMod();
+    TestRoots();
+    TestProductTree();
+    TestCarryKernels();
+    TestParallelSetString();
+#if CONFIG_COMPILER_ID == CONFIG_GCC_COMPILER_ID || CONFIG_COMPILER_ID == CONFIG_CLANG_COMPILER_ID || \
+    CONFIG_COMPILER_ID == CONFIG_CLANG_CL_COMPILER_ID
+    TestAllocatorMultiThread();
+#if defined(LONGINT_USE_CUSTOM_ALLOCATOR)
+    TestLongIntUsesCustomAllocator();
+#endif
+#endif
 
     // std::ios::sync_with_stdio(false);
     // std::cin.tie(nullptr);
@@ -0,0 +1,3 @@
+// test_long_int.cpp with the longint digits allocated by the longint_allocator
+#define LONGINT_USE_CUSTOM_ALLOCATOR
+#include "test_long_int.cpp"
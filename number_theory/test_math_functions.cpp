@@ -419,6 +419,70 @@ void test_factorizer() {
     }
 }
 
+bool same_prime_factors(const std::vector<PrimeFactor<uint32_t>>& pfs1,
+                        const std::vector<PrimeFactor<uint32_t>>& pfs2) noexcept {
+    return std::equal(pfs1.begin(), pfs1.end(), pfs2.begin(), pfs2.end(), [](auto pf1, auto pf2) constexpr noexcept {
+        return pf1.factor == pf2.factor && pf1.factor_power == pf2.factor_power;
+    });
+}
+
+void test_compact_factorizer() {
+    log_tests_started();
+
+    constexpr auto N = static_cast<uint32_t>(1e6);
+    const Factorizer fact(N);
+    for (const uint32_t n : {0U, 1U, 2U, 3U, 8U, 9U, 25U, 26U, N - 1, N}) {
+        const CompactFactorizer compact_fact(n);
+        assert(compact_fact.max_checkable_number() == n);
+        for (uint32_t i = 0; i <= n; i++) {
+            assert(compact_fact.is_prime(i) == fact.is_prime(i));
+            assert(same_prime_factors(compact_fact.prime_factors(i), fact.prime_factors(i)));
+        }
+    }
+
+    const CompactFactorizer compact_fact(N);
+    std::vector<uint32_t> numbers;
+    for (uint32_t i = 0; i <= N; i++) {
+        if (i >= 2) {
+            assert(compact_fact.least_prime_factor(i) == fact.least_prime_factors()[i]);
+        }
+        assert(compact_fact.number_of_unique_prime_factors(i) == fact.number_of_unique_prime_factors(i));
+
+        std::vector<PrimeFactor<uint32_t>> pfs;
+        fact.for_each_prime_factor(i, [&pfs](const PrimeFactor<uint32_t> pf) { pfs.push_back(pf); });
+        assert(same_prime_factors(pfs, fact.prime_factors(i)));
+
+        // Visitor returning false stops the factorization
+        std::vector<PrimeFactor<uint32_t>> first_pf;
+        compact_fact.for_each_prime_factor(i, [&first_pf](const PrimeFactor<uint32_t> pf) {
+            first_pf.push_back(pf);
+            return false;
+        });
+        assert(first_pf.size() == std::min<size_t>(pfs.size(), 1));
+        assert(same_prime_factors(first_pf, std::vector(pfs.begin(), pfs.begin() + std::ptrdiff_t(first_pf.size()))));
+
+        numbers.push_back(i);
+        numbers.push_back(N - i / 3);
+    }
+
+    std::mt19937 rnd(std::random_device{}());
+    std::shuffle(numbers.begin(), numbers.end(), rnd);
+    std::vector<std::vector<PrimeFactor<uint32_t>>> batch_pfs(numbers.size());
+    std::vector<std::vector<PrimeFactor<uint32_t>>> compact_batch_pfs(numbers.size());
+    fact.factorize(numbers.data(), numbers.size(), [&batch_pfs](const size_t i, const PrimeFactor<uint32_t> pf) {
+        batch_pfs[i].push_back(pf);
+    });
+    compact_fact.factorize(numbers.data(), numbers.size(),
+                           [&compact_batch_pfs](const size_t i, const PrimeFactor<uint32_t> pf) {
+                               compact_batch_pfs[i].push_back(pf);
+                           });
+    for (size_t i = 0; i < numbers.size(); i++) {
+        const auto expected_pfs = fact.prime_factors(numbers[i]);
+        assert(same_prime_factors(batch_pfs[i], expected_pfs));
+        assert(same_prime_factors(compact_batch_pfs[i], expected_pfs));
+    }
+}
+
 #if defined(HAS_INT128_TYPEDEF)
 
 // NOLINTBEGIN(performance-avoid-endl)
@@ -3880,6 +3944,7 @@ int main() {
     test_visit_all_submasks();
     test_prime_bitarrays();
     test_factorizer();
+    test_compact_factorizer();
     test_extended_euclid_algorithm();
     test_solve_congruence_modulo_m_all_roots();
     test_inv_mod_m();
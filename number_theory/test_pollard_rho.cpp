@@ -0,0 +1,186 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "../misc/tests/test_tools.hpp"
+#include "integers_128_bit.hpp"
+#include "is_prime.hpp"
+#include "math_functions.hpp"
+#include "pollard_rho.hpp"
+
+// NOLINTBEGIN(cert-dcl03-c, misc-static-assert, hicpp-static-assert,
+// cppcoreguidelines-avoid-magic-numbers)
+
+namespace {
+
+using namespace test_tools;
+
+template <class T>
+bool is_prime(const T n) {
+    if constexpr (sizeof(T) <= sizeof(uint64_t)) {
+        return math_functions::is_prime_bpsw(uint64_t{n});
+    } else {
+        return math_functions::is_prime_bpsw(n);
+    }
+}
+
+/// @brief Checks that factors are increasing primes and their product is n
+template <class T>
+void check_factorization(const T n, const std::vector<math_functions::PrimeFactor<T>>& factors) {
+    T product = 1;
+    T prev_factor = 1;
+    for (const auto& [factor, factor_power] : factors) {
+        assert(factor > prev_factor);
+        assert(is_prime(factor));
+        assert(factor_power >= 1);
+        prev_factor = factor;
+        for (uint32_t i = 0; i < factor_power; i++) {
+            assert(product <= std::numeric_limits<T>::max() / factor);
+            product *= factor;
+        }
+    }
+    assert(product == (n == 0 ? 1 : n));
+}
+
+template <class T>
+void check_expected_factorization(const T n, const std::vector<math_functions::PrimeFactor<T>>& expected) {
+    const auto factors = math_functions::prime_factors_rho_as_vector(n);
+    assert(factors.size() == expected.size());
+    for (size_t i = 0; i < factors.size(); i++) {
+        assert(factors[i].factor == expected[i].factor);
+        assert(factors[i].factor_power == expected[i].factor_power);
+    }
+    check_factorization(n, factors);
+}
+
+void test_small_numbers() {
+    log_tests_started();
+
+    for (uint32_t n = 0; n < 2'000'000; n++) {
+        const auto factors = math_functions::prime_factors_rho_as_vector(n);
+        const auto expected = math_functions::prime_factors_as_vector(n);
+        assert(factors.size() == expected.size());
+        for (size_t i = 0; i < factors.size(); i++) {
+            assert(factors[i].factor == expected[i].factor);
+            assert(factors[i].factor_power == expected[i].factor_power);
+        }
+    }
+
+    const auto factors = math_functions::prime_factors_rho_as_vector(int64_t{-360});
+    assert(factors.size() == 3);
+    assert(factors[0].factor == 2 && factors[0].factor_power == 3);
+    assert(factors[1].factor == 3 && factors[1].factor_power == 2);
+    assert(factors[2].factor == 5 && factors[2].factor_power == 1);
+}
+
+void test_u64_numbers() {
+    log_tests_started();
+
+    using Factors = std::vector<math_functions::PrimeFactor<uint64_t>>;
+    constexpr uint64_t kMax = std::numeric_limits<uint64_t>::max();
+    check_expected_factorization(kMax, Factors{{3, 1}, {5, 1}, {17, 1}, {257, 1}, {641, 1}, {65537, 1}, {6700417, 1}});
+    check_expected_factorization(uint64_t{18446744073709551557ULL}, Factors{{18446744073709551557ULL, 1}});
+    check_expected_factorization(uint64_t{4294967291} * 4294967279, Factors{{4294967279, 1}, {4294967291, 1}});
+    check_expected_factorization(uint64_t{4294967291} * 4294967291, Factors{{4294967291, 2}});
+    check_expected_factorization(uint64_t{2642239} * 2642239 * 2642239, Factors{{2642239, 3}});
+    check_expected_factorization(uint64_t{257} * 257 * 65537 * 65537, Factors{{257, 2}, {65537, 2}});
+    check_expected_factorization(uint64_t{1} << 63U, Factors{{2, 63}});
+    check_expected_factorization(uint64_t{3} * 1000000007 * 998244353, Factors{{3, 1}, {998244353, 1}, {1000000007, 1}});
+
+    std::mt19937_64 rnd(std::mt19937_64::default_seed);
+    for (size_t test = 0; test < 20'000; test++) {
+        const uint64_t n = rnd();
+        check_factorization(n, math_functions::prime_factors_rho_as_vector(n));
+    }
+
+    // Semiprimes with the 32-bit factors
+    for (size_t test = 0; test < 200; test++) {
+        uint64_t p = 0;
+        uint64_t q = 0;
+        do {
+            p = (rnd() >> 32U) | 1U;
+        } while (!math_functions::is_prime_bpsw(p));
+        do {
+            q = (rnd() >> 32U) | 1U;
+        } while (!math_functions::is_prime_bpsw(q));
+        const auto factors = math_functions::prime_factors_rho_as_vector(p * q);
+        check_factorization(p * q, factors);
+        assert(factors.size() == (p == q ? 1U : 2U));
+    }
+}
+
+void test_u128_numbers() {
+    log_tests_started();
+
+    using Factors = std::vector<math_functions::PrimeFactor<uint128_t>>;
+    constexpr uint128_t kMax = std::numeric_limits<uint128_t>::max();
+    check_expected_factorization(kMax, Factors{
+                                           {3, 1},
+                                           {5, 1},
+                                           {17, 1},
+                                           {257, 1},
+                                           {641, 1},
+                                           {65537, 1},
+                                           {274177, 1},
+                                           {6700417, 1},
+                                           {67280421310721ULL, 1},
+                                       });
+    const uint128_t kMersenne127 = (uint128_t{1} << 127U) - 1;
+    check_expected_factorization(kMersenne127, Factors{{kMersenne127, 1}});
+    check_expected_factorization(uint128_t{1} << 127U, Factors{{2, 127}});
+    // 2^64 + 13 is prime
+    const uint128_t p64 = (uint128_t{1} << 64U) + 13;
+    check_expected_factorization(p64 * 4294967291U, Factors{{4294967291U, 1}, {p64, 1}});
+    check_expected_factorization(uint128_t{18446744073709551557ULL} * 1000000007,
+                                 Factors{{1000000007, 1}, {18446744073709551557ULL, 1}});
+    const uint128_t p40 = 1099511627791ULL;
+    check_expected_factorization(p40 * p40 * p40, Factors{{p40, 3}});
+
+    std::mt19937_64 rnd(std::mt19937_64::default_seed);
+    for (size_t test = 0; test < 1'000; test++) {
+        // Product of several random primes of at most 32 bits and small cofactor
+        uint128_t n = rnd() % 1'000 + 1;
+        for (size_t i = 0; i < 3; i++) {
+            uint64_t p = 0;
+            do {
+                p = (rnd() >> (32U + i * 8U)) | 1U;
+            } while (!math_functions::is_prime_bpsw(p));
+            n *= p;
+        }
+        check_factorization(n, math_functions::prime_factors_rho_as_vector(n));
+    }
+}
+
+void test_early_exit() {
+    log_tests_started();
+
+    constexpr uint64_t n = uint64_t{3} * 5 * 1000000007 * 998244353;
+    std::vector<uint64_t> visited;
+    math_functions::visit_prime_factors_rho(n, [&visited](const math_functions::PrimeFactor<uint64_t> pf) {
+        visited.push_back(pf.factor);
+        return pf.factor < 998244353;
+    });
+    assert((visited == std::vector<uint64_t>{3, 5, 998244353}));
+
+    visited.clear();
+    math_functions::visit_prime_factors_rho(n, [&visited](const math_functions::PrimeFactor<uint64_t> pf) {
+        visited.push_back(pf.factor);
+        return false;
+    });
+    assert((visited == std::vector<uint64_t>{3}));
+}
+
+}  // namespace
+
+// NOLINTEND(cert-dcl03-c, misc-static-assert, hicpp-static-assert,
+// cppcoreguidelines-avoid-magic-numbers)
+
+int main() {
+    test_small_numbers();
+    test_u64_numbers();
+    test_u128_numbers();
+    test_early_exit();
+}
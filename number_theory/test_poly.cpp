@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../misc/tests/test_tools.hpp"
+#include "poly.hpp"
+
+// NOLINTBEGIN(cert-dcl03-c, misc-static-assert, hicpp-static-assert,
+// cppcoreguidelines-avoid-magic-numbers)
+
+namespace {
+
+using namespace test_tools;
+
+using Ring = poly::PolynomialRing998244353;
+using poly_t = Ring::poly_t;
+constexpr uint32_t kMod = Ring::kMod;
+
+uint32_t seed = 0x3A7C91E5U;
+
+uint32_t next_random() noexcept {
+    seed ^= seed << 13U;
+    seed ^= seed >> 17U;
+    seed ^= seed << 5U;
+    return seed;
+}
+
+poly_t random_poly(const size_t size) {
+    poly_t a(size);
+    for (uint32_t& coeff : a) {
+        coeff = next_random() % kMod;
+    }
+    return a;
+}
+
+uint32_t mul_mod(const uint32_t a, const uint32_t b) noexcept {
+    return static_cast<uint32_t>(uint64_t{a} * b % kMod);
+}
+
+poly_t naive_multiply(const poly_t& a, const poly_t& b) {
+    if (a.empty() || b.empty()) {
+        return {};
+    }
+    poly_t c(a.size() + b.size() - 1);
+    for (size_t i = 0; i < a.size(); i++) {
+        for (size_t j = 0; j < b.size(); j++) {
+            c[i + j] = static_cast<uint32_t>((c[i + j] + uint64_t{a[i]} * b[j]) % kMod);
+        }
+    }
+    return c;
+}
+
+poly_t truncated(poly_t a, const size_t n) {
+    a.resize(n);
+    return a;
+}
+
+uint32_t naive_evaluate(const poly_t& a, const uint32_t x) noexcept {
+    uint32_t value = 0;
+    for (size_t i = a.size(); i-- > 0;) {
+        value = static_cast<uint32_t>((uint64_t{value} * x + a[i]) % kMod);
+    }
+    return value;
+}
+
+template <class Function>
+bool throws_runtime_error(Function&& f) {
+    try {
+        f();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void test_multiply() {
+    log_tests_started();
+
+    // Sizes around the naive multiplication threshold and the powers of two
+    for (const size_t a_size : {0U, 1U, 2U, 31U, 32U, 33U, 64U, 100U, 513U}) {
+        for (const size_t b_size : {0U, 1U, 17U, 33U, 128U, 257U, 1000U}) {
+            const poly_t a = random_poly(a_size);
+            const poly_t b = random_poly(b_size);
+            assert(Ring::multiply(a, b) == naive_multiply(a, b));
+        }
+        const poly_t a = random_poly(a_size);
+        assert(Ring::multiply(a, a) == naive_multiply(a, a));
+    }
+}
+
+void test_inverse_and_divmod() {
+    log_tests_started();
+
+    for (const size_t size : {1U, 2U, 5U, 33U, 100U, 1000U, 4097U}) {
+        poly_t a = random_poly(size);
+        a[0] |= 1U;
+        for (const size_t n : {size_t{1}, size / 2 + 1, size, 2 * size + 3}) {
+            const poly_t b = Ring::inverse(a, n);
+            assert(b.size() == n);
+            poly_t ab = truncated(naive_multiply(a, b), n);
+            assert(ab[0] == 1);
+            for (size_t i = 1; i < n; i++) {
+                assert(ab[i] == 0);
+            }
+        }
+    }
+    assert(throws_runtime_error([]() { return Ring::inverse(poly_t{}, 4); }));
+    assert(throws_runtime_error([]() { return Ring::inverse(poly_t{0, 1}, 4); }));
+
+    for (const size_t a_size : {0U, 1U, 30U, 64U, 200U, 2000U}) {
+        for (const size_t b_size : {1U, 2U, 33U, 100U, 1000U}) {
+            const poly_t a = random_poly(a_size);
+            poly_t b = random_poly(b_size);
+            b.back() |= 1U;
+            auto [q, r] = Ring::divmod(a, b);
+            assert(r.size() < b.size());
+            assert(r.empty() || r.back() != 0);
+            poly_t bq_plus_r = naive_multiply(b, q);
+            bq_plus_r.resize(std::max(bq_plus_r.size(), r.size()));
+            for (size_t i = 0; i < r.size(); i++) {
+                bq_plus_r[i] = (bq_plus_r[i] + r[i]) % kMod;
+            }
+            Ring::normalize(bq_plus_r);
+            poly_t a_normalized = a;
+            Ring::normalize(a_normalized);
+            assert(bq_plus_r == a_normalized);
+        }
+    }
+    assert(throws_runtime_error([]() { return Ring::divmod(poly_t{1, 2}, poly_t{0, 0}); }));
+}
+
+void test_log_and_exp() {
+    log_tests_started();
+
+    // exp(x) = \sum x^k / k!, log(1 + x) = \sum (-1)^{k + 1} x^k / k
+    constexpr size_t kTerms = 50;
+    const poly_t exp_x = Ring::exp(poly_t{0, 1}, kTerms);
+    uint32_t factorial = 1;
+    for (size_t k = 0; k < kTerms; k++) {
+        if (k > 0) {
+            factorial = mul_mod(factorial, static_cast<uint32_t>(k));
+        }
+        assert(mul_mod(exp_x[k], factorial) == 1);
+    }
+    const poly_t log_1_plus_x = Ring::log(poly_t{1, 1}, kTerms);
+    assert(log_1_plus_x[0] == 0);
+    for (size_t k = 1; k < kTerms; k++) {
+        const uint32_t expected = k % 2 == 1 ? 1 : kMod - 1;
+        assert(mul_mod(log_1_plus_x[k], static_cast<uint32_t>(k)) == expected);
+    }
+
+    for (const size_t n : {1U, 2U, 7U, 64U, 100U, 1025U, 5000U}) {
+        poly_t a = random_poly(n);
+        a[0] = 0;
+        const poly_t e = Ring::exp(a, n);
+        assert(e.size() == n);
+        assert(Ring::log(e, n) == a);
+
+        // exp(a + b) = exp(a) * exp(b)
+        poly_t b = random_poly(n);
+        b[0] = 0;
+        poly_t a_plus_b(n);
+        for (size_t i = 0; i < n; i++) {
+            a_plus_b[i] = (a[i] + b[i]) % kMod;
+        }
+        assert(truncated(Ring::multiply(e, Ring::exp(b, n)), n) == Ring::exp(a_plus_b, n));
+    }
+    assert(throws_runtime_error([]() { return Ring::log(poly_t{2, 1}, 4); }));
+    assert(throws_runtime_error([]() { return Ring::exp(poly_t{1, 1}, 4); }));
+}
+
+void test_compose() {
+    log_tests_started();
+
+    for (const size_t a_size : {0U, 1U, 2U, 10U, 65U, 300U}) {
+        for (const size_t b_size : {0U, 1U, 3U, 50U, 200U}) {
+            const poly_t a = random_poly(a_size);
+            const poly_t b = random_poly(b_size);
+            for (const size_t n : {0U, 1U, 40U, 257U}) {
+                // Horner's rule
+                poly_t expected;
+                for (size_t i = a.size(); i-- > 0;) {
+                    expected = truncated(naive_multiply(expected, b), n);
+                    expected.resize(n);
+                    if (n > 0) {
+                        expected[0] = (expected[0] + a[i]) % kMod;
+                    }
+                }
+                expected.resize(n);
+                assert(Ring::compose(a, b, n) == expected);
+            }
+        }
+    }
+}
+
+void test_evaluate_and_interpolate() {
+    log_tests_started();
+
+    for (const size_t points_count : {1U, 2U, 31U, 32U, 33U, 100U, 1000U, 3001U}) {
+        poly_t points(points_count);
+        for (size_t i = 0; i < points_count; i++) {
+            // Distinct points
+            points[i] = static_cast<uint32_t>((uint64_t{i} * 7919 + next_random() % 7919) % kMod);
+        }
+        for (const size_t a_size : {size_t{0}, size_t{1}, points_count, 3 * points_count + 5}) {
+            const poly_t a = random_poly(a_size);
+            const poly_t values = Ring::evaluate(a, points);
+            assert(values.size() == points.size());
+            for (size_t i = 0; i < points.size(); i++) {
+                assert(values[i] == naive_evaluate(a, points[i]));
+            }
+        }
+
+        poly_t a = random_poly(points_count);
+        Ring::normalize(a);
+        assert(Ring::interpolate(points, Ring::evaluate(a, points)) == a);
+    }
+    assert(Ring::evaluate(poly_t{1, 2, 3}, poly_t{}).empty());
+    assert(Ring::interpolate(poly_t{}, poly_t{}).empty());
+    assert(throws_runtime_error([]() { return Ring::interpolate(poly_t{1, 2, 1}, poly_t{3, 4, 5}); }));
+    assert(throws_runtime_error([]() { return Ring::interpolate(poly_t{1, 2}, poly_t{3}); }));
+}
+
+}  // namespace
+
+// NOLINTEND(cert-dcl03-c, misc-static-assert, hicpp-static-assert,
+// cppcoreguidelines-avoid-magic-numbers)
+
+int main() {
+    test_multiply();
+    test_inverse_and_divmod();
+    test_log_and_exp();
+    test_compose();
+    test_evaluate_and_interpolate();
+}
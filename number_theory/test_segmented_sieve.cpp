@@ -0,0 +1,131 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../misc/tests/test_tools.hpp"
+#include "is_prime.hpp"
+#include "math_functions.hpp"
+#include "segmented_sieve.hpp"
+
+// NOLINTBEGIN(cert-dcl03-c, misc-static-assert, hicpp-static-assert,
+// cppcoreguidelines-avoid-magic-numbers)
+
+namespace {
+
+using namespace test_tools;
+
+std::vector<uint64_t> primes_by_range_iteration(const uint64_t lo, const uint64_t hi) {
+    std::vector<uint64_t> primes;
+    for (const uint64_t p : math_functions::PrimesRange{lo, hi}) {
+        primes.push_back(p);
+    }
+    return primes;
+}
+
+std::vector<uint64_t> primes_by_callback(const uint64_t lo, const uint64_t hi) {
+    std::vector<uint64_t> primes;
+    math_functions::for_each_prime(lo, hi, [&primes](const uint64_t p) { primes.push_back(p); });
+    return primes;
+}
+
+void check_all_apis(const uint64_t lo, const uint64_t hi, const std::vector<uint64_t>& expected) {
+    assert(math_functions::primes_in_range(lo, hi) == expected);
+    assert(math_functions::primes_in_range(lo, hi, 3) == expected);
+    assert(primes_by_callback(lo, hi) == expected);
+    assert(primes_by_range_iteration(lo, hi) == expected);
+    assert(math_functions::count_primes(lo, hi) == expected.size());
+    assert(math_functions::count_primes(lo, hi, 4) == expected.size());
+}
+
+void test_small_ranges() {
+    log_tests_started();
+
+    constexpr uint32_t kN = 3'000'000;
+    const std::vector<bool> is_prime = math_functions::dynamic_primes_sieve(kN);
+    const auto expected_primes = [&is_prime](const uint64_t lo, const uint64_t hi) {
+        std::vector<uint64_t> primes;
+        for (uint64_t n = lo; n <= hi; n++) {
+            if (is_prime[n]) {
+                primes.push_back(n);
+            }
+        }
+        return primes;
+    };
+
+    // Bounds around the presieve primes, the first sieving prime 17, window boundaries
+    // (2^24 odd numbers) and the square of the first large sieving prime (2^18)
+    for (const uint64_t lo : {0U, 1U, 2U, 3U, 4U, 5U, 12U, 13U, 14U, 16U, 17U, 18U, 289U, 290U, 1000U, 65535U}) {
+        for (const uint64_t hi : {0U, 1U, 2U, 3U, 10U, 13U, 17U, 288U, 289U, 291U, 100'000U, 262147U, kN}) {
+            check_all_apis(lo, hi, lo <= hi ? expected_primes(lo, hi) : std::vector<uint64_t>{});
+        }
+    }
+    for (uint64_t lo = 0; lo < 200; lo++) {
+        for (uint64_t hi = lo; hi < 200; hi += 7) {
+            check_all_apis(lo, hi, expected_primes(lo, hi));
+        }
+    }
+}
+
+void test_prime_counts() {
+    log_tests_started();
+
+    // pi(10^k)
+    constexpr uint64_t kPrimeCounts[] = {0, 4, 25, 168, 1229, 9592, 78498, 664579, 5761455};
+    uint64_t power = 1;
+    for (const uint64_t expected_count : kPrimeCounts) {
+        assert(math_functions::count_primes(0, power) == expected_count);
+        assert(math_functions::count_primes(0, power, 4) == expected_count);
+        power *= 10;
+    }
+
+    // Several windows with the not aligned bounds
+    constexpr uint64_t kLo = 4'000'000'007;
+    constexpr uint64_t kHi = 4'000'000'007 + 100'000'000;
+    uint64_t count = 0;
+    uint64_t last_prime = 0;
+    math_functions::for_each_prime(kLo, kHi, [&count, &last_prime](const uint64_t p) {
+        assert(p > last_prime);
+        last_prime = p;
+        count++;
+    });
+    assert(count == math_functions::count_primes(kLo, kHi, 3));
+    assert(math_functions::primes_in_range(kLo, kHi, 2).size() == count);
+}
+
+void test_large_ranges() {
+    log_tests_started();
+
+    // Sieving primes greater than OddNumbersSieve::kMaxStoredSievingPrime are not stored
+    constexpr uint64_t kMax = std::numeric_limits<uint64_t>::max();
+    constexpr uint64_t kRanges[][2] = {
+        {uint64_t{1} << 40U, (uint64_t{1} << 40U) + 100'000},
+        {(uint64_t{1} << 48U) - 50'000, (uint64_t{1} << 48U) + 50'000},
+        {(uint64_t{1} << 50U) + 12'345, (uint64_t{1} << 50U) + 200'000},
+        {kMax - 20'000, kMax},
+    };
+    for (const auto& [lo, hi] : kRanges) {
+        std::vector<uint64_t> expected;
+        for (uint64_t n = lo;; n++) {
+            if (math_functions::is_prime_bpsw(n)) {
+                expected.push_back(n);
+            }
+            if (n == hi) {
+                break;
+            }
+        }
+        assert(math_functions::primes_in_range(lo, hi) == expected);
+    }
+}
+
+}  // namespace
+
+// NOLINTEND(cert-dcl03-c, misc-static-assert, hicpp-static-assert,
+// cppcoreguidelines-avoid-magic-numbers)
+
+int main() {
+    test_small_ranges();
+    test_prime_counts();
+    test_large_ranges();
+}